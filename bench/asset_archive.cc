@@ -0,0 +1,137 @@
+#include <benchmark/benchmark.h>
+
+#include "asset_archive.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Helpers: the same asset set as loose files and as one archive, and page
+// cache eviction so every iteration starts cold
+// ---------------------------------------------------------------------------
+namespace {
+const auto kDir = std::filesystem::temp_directory_path() / "libretro_pak";
+
+std::vector<std::string> writeAssets(size_t count, size_t size) {
+  std::filesystem::remove_all(kDir);
+  std::filesystem::create_directories(kDir / "loose");
+
+  std::vector<std::string> names;
+  AssetArchiveBuilder builder;
+  const std::vector<uint8_t> data(size, 0x5A);
+  for (size_t i = 0; i < count; ++i) {
+    names.push_back("asset" + std::to_string(i));
+    std::ofstream out{kDir / "loose" / names.back(), std::ios::binary};
+    out.write(reinterpret_cast<const char *>(data.data()),
+              static_cast<std::streamsize>(data.size()));
+    builder.add(names.back(), data);
+  }
+  builder.write(kDir / "assets.pak");
+  return names;
+}
+
+/* Drop a file's clean pages from the page cache (best effort) */
+void evict(const std::filesystem::path &path) {
+#if defined(__unix__)
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+  }
+#else
+  (void)path;
+#endif
+}
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Cold start: open every asset needed at startup and read the first `used`
+// of them. Loose files are read into memory as they are opened; the
+// archive maps once and only pages in what is read
+// ---------------------------------------------------------------------------
+static void BM_ColdStartLooseFiles(benchmark::State &state) {
+  const auto names = writeAssets(static_cast<size_t>(state.range(0)), 16384);
+  const auto used = static_cast<size_t>(state.range(1));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (const auto &name : names) {
+      evict(kDir / "loose" / name);
+    }
+    state.ResumeTiming();
+
+    uint64_t sum = 0;
+    for (size_t i = 0; i < names.size(); ++i) {
+      std::ifstream in{kDir / "loose" / names[i],
+                       std::ios::binary | std::ios::ate};
+      std::vector<char> data(static_cast<size_t>(in.tellg()));
+      in.seekg(0);
+      in.read(data.data(), static_cast<std::streamsize>(data.size()));
+      if (i < used) {
+        for (char c : data) {
+          sum += static_cast<uint8_t>(c);
+        }
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+static void BM_ColdStartArchive(benchmark::State &state) {
+  const auto names = writeAssets(static_cast<size_t>(state.range(0)), 16384);
+  const auto used = static_cast<size_t>(state.range(1));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    evict(kDir / "assets.pak");
+    state.ResumeTiming();
+
+    AssetArchive archive{kDir / "assets.pak"};
+    uint64_t sum = 0;
+    for (size_t i = 0; i < names.size(); ++i) {
+      const auto span = archive.find(names[i]);
+      if (span && i < used) {
+        for (uint8_t c : *span) {
+          sum += c;
+        }
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+BENCHMARK(BM_ColdStartLooseFiles)
+    ->ArgNames({"assets", "used"})
+    ->Args({1000, 1000})
+    ->Args({1000, 50})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ColdStartArchive)
+    ->ArgNames({"assets", "used"})
+    ->Args({1000, 1000})
+    ->Args({1000, 50})
+    ->Unit(benchmark::kMillisecond);
+
+// ---------------------------------------------------------------------------
+// Warm lookups: index search plus name comparison, no I/O
+// ---------------------------------------------------------------------------
+static void BM_ArchiveFind(benchmark::State &state) {
+  const auto names = writeAssets(static_cast<size_t>(state.range(0)), 16);
+  AssetArchive archive{kDir / "assets.pak"};
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(archive.find(names[i]));
+    i = (i + 1) % names.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ArchiveFind)->Arg(100)->Arg(10000);
@@ -0,0 +1,195 @@
+#include <benchmark/benchmark.h>
+
+#include "asset_streamer.h"
+#include "sprite_batch.h"
+#include "window.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helper: a "level" of 256x256 PPM textures on disk, and a frame loop that
+// records the slowest frame while the level loads
+// ---------------------------------------------------------------------------
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kTextureSize = 256;
+const std::string kHeader = "P6\n256 256\n255\n";
+
+std::vector<std::filesystem::path> writeLevel(size_t textures) {
+  const auto dir =
+      std::filesystem::temp_directory_path() / "libretro_bench_level";
+  std::filesystem::create_directories(dir);
+
+  std::string contents = kHeader;
+  contents.resize(kHeader.size() + kTextureSize * kTextureSize * 3, '\x7f');
+
+  std::vector<std::filesystem::path> paths;
+  for (size_t i = 0; i < textures; ++i) {
+    paths.push_back(dir / (std::to_string(i) + ".ppm"));
+    std::ofstream out{paths.back(), std::ios::binary};
+    out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+  }
+  return paths;
+}
+
+/* Read, decode and upload on the calling thread, as a naive loader would */
+GLuint loadNow(const std::filesystem::path &path) {
+  std::ifstream in{path, std::ios::binary};
+  std::vector<char> file(kHeader.size() + kTextureSize * kTextureSize * 3);
+  in.read(file.data(), static_cast<std::streamsize>(file.size()));
+
+  std::vector<uint8_t> rgba(kTextureSize * kTextureSize * 4);
+  const char *src = file.data() + kHeader.size();
+  for (size_t i = 0; i < kTextureSize * kTextureSize; ++i) {
+    rgba[i * 4] = static_cast<uint8_t>(src[i * 3]);
+    rgba[i * 4 + 1] = static_cast<uint8_t>(src[i * 3 + 1]);
+    rgba[i * 4 + 2] = static_cast<uint8_t>(src[i * 3 + 2]);
+    rgba[i * 4 + 3] = 255;
+  }
+
+  GLuint texture = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, kTextureSize, kTextureSize, 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return texture;
+}
+
+struct FrameTimes {
+  double max_ms{};
+  size_t frames{};
+
+  void time(Window &w) {
+    const auto start = Clock::now();
+    w.render();
+    const double ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count();
+    max_ms = std::max(max_ms, ms);
+    ++frames;
+  }
+
+  void report(benchmark::State &state) const {
+    state.counters["max_frame_ms"] = max_ms;
+    state.counters["frames"] = benchmark::Counter(
+        static_cast<double>(frames), benchmark::Counter::kAvgIterations);
+  }
+};
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Baseline: the level loads inside one frame of the render loop
+// ---------------------------------------------------------------------------
+static void BM_LevelLoadBlocking(benchmark::State &state) {
+  const auto paths = writeLevel(static_cast<size_t>(state.range(0)));
+  std::vector<GLuint> textures;
+  bool load = false;
+
+  std::unique_ptr<SpriteBatch> batch;
+  Window w{320,
+           240,
+           "Bench",
+           [&]() noexcept { batch = std::make_unique<SpriteBatch>(); },
+           [&]() noexcept {
+             if (load) {
+               for (const auto &path : paths) {
+                 textures.push_back(loadNow(path));
+               }
+               load = false;
+             }
+             glClear(GL_COLOR_BUFFER_BIT);
+             batch->begin(320.0f, 240.0f);
+             for (GLuint t : textures) {
+               batch->draw({.width = 16, .height = 16, .texture = t});
+             }
+             batch->end();
+           },
+           [&]() noexcept { batch.reset(); },
+           WindowOptions{.headless = true}};
+
+  FrameTimes times;
+  for (auto _ : state) {
+    load = true;
+    times.time(w);
+
+    state.PauseTiming();
+    glDeleteTextures(static_cast<GLsizei>(textures.size()), textures.data());
+    textures.clear();
+    state.ResumeTiming();
+  }
+
+  w.offscreen()->flush();
+  times.report(state);
+}
+BENCHMARK(BM_LevelLoadBlocking)
+    ->Arg(32)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// ---------------------------------------------------------------------------
+// Streaming: frames keep rendering while the level streams in, and each
+// texture is drawn from the frame its fence signals
+// ---------------------------------------------------------------------------
+static void BM_LevelLoadStreaming(benchmark::State &state) {
+  const auto paths = writeLevel(static_cast<size_t>(state.range(0)));
+  std::unique_ptr<AssetStreamer> assets;
+  std::vector<AssetStreamer::Id> ids;
+  size_t ready = 0;
+
+  std::unique_ptr<SpriteBatch> batch;
+  Window w{320,
+           240,
+           "Bench",
+           [&]() noexcept { batch = std::make_unique<SpriteBatch>(); },
+           [&]() noexcept {
+             glClear(GL_COLOR_BUFFER_BIT);
+             batch->begin(320.0f, 240.0f);
+             ready = 0;
+             for (auto id : ids) {
+               if (assets->status(id) == AssetStreamer::Status::Ready) {
+                 ++ready;
+                 batch->draw(
+                     {.width = 16, .height = 16, .texture = assets->name(id)});
+               }
+             }
+             batch->end();
+           },
+           [&]() noexcept { batch.reset(); },
+           WindowOptions{.headless = true}};
+
+  FrameTimes times;
+  for (auto _ : state) {
+    state.PauseTiming();
+    assets = std::make_unique<AssetStreamer>(w);
+    ids.clear();
+    state.ResumeTiming();
+
+    for (const auto &path : paths) {
+      ids.push_back(assets->loadTexture(path));
+    }
+    do {
+      times.time(w);
+    } while (ready < ids.size());
+
+    state.PauseTiming();
+    assets.reset();
+    state.ResumeTiming();
+  }
+
+  w.offscreen()->flush();
+  times.report(state);
+}
+BENCHMARK(BM_LevelLoadStreaming)
+    ->Arg(32)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+
+#include "audio_mixer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+static std::vector<float> noise(size_t count) {
+  std::mt19937 rng{9};
+  std::uniform_real_distribution<float> sample{-1.0f, 1.0f};
+  std::vector<float> samples(count);
+  for (float &s : samples) {
+    s = sample(rng);
+  }
+  return samples;
+}
+
+/* Looping voices at assorted rates, pitches and pans */
+static void playVoices(AudioMixer &mixer, const std::vector<float> &clip,
+                       size_t voices) {
+  for (size_t i = 0; i < voices; ++i) {
+    mixer.play({.samples = clip, .sample_rate = 44100},
+               {.volume = 0.05f,
+                .pan = static_cast<float>(i % 9) / 4.0f - 1.0f,
+                .pitch = 0.5f + static_cast<float>(i % 16) / 8.0f,
+                .loop = true});
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Mixing one 256-frame period offline with each kernel (0 = scalar,
+// 1 = SSE2, 2 = AVX2). voices_per_ms is voice-periods mixed per millisecond
+// ---------------------------------------------------------------------------
+static void BM_AudioMixPeriod(benchmark::State &state) {
+  const auto voices = static_cast<size_t>(state.range(0));
+  NullAudioSink sink{{.sample_rate = 48000, .period_frames = 256}};
+  AudioMixer mixer{sink, voices};
+  const auto isa = mixer.setIsa(static_cast<SpanIsa>(state.range(1)));
+  if (isa != static_cast<SpanIsa>(state.range(1))) {
+    state.SkipWithError("instruction set not supported");
+    return;
+  }
+  const auto clip = noise(48000);
+  playVoices(mixer, clip, voices);
+  std::vector<float> out(256 * 2);
+
+  for (auto _ : state) {
+    mixer.mix(out);
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(spanIsaName(isa));
+  state.counters["voices_per_ms"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * state.range(0)) / 1e3,
+      benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_AudioMixPeriod)
+    ->ArgsProduct({{16, 64, 256}, {0, 1, 2}})
+    ->Unit(benchmark::kMicrosecond);
+
+// ---------------------------------------------------------------------------
+// The mixer thread feeding a paced sink at 256-frame periods for one second
+// per iteration; any underrun is reported
+// ---------------------------------------------------------------------------
+static void BM_AudioRealtime(benchmark::State &state) {
+  const auto voices = static_cast<size_t>(state.range(0));
+  const auto clip = noise(48000);
+  uint64_t underruns = 0;
+  double max_mix_us = 0.0;
+
+  for (auto _ : state) {
+    NullAudioSink sink{{.sample_rate = 48000, .period_frames = 256}, true};
+    AudioMixer mixer{sink, voices};
+    playVoices(mixer, clip, voices);
+    mixer.start();
+    while (sink.periods() < 188) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    mixer.stop();
+    underruns += mixer.stats().underruns;
+    max_mix_us = std::max(max_mix_us, mixer.stats().max_mix_us);
+  }
+  state.counters["underruns"] = static_cast<double>(underruns);
+  state.counters["max_mix_us"] = max_mix_us;
+}
+BENCHMARK(BM_AudioRealtime)
+    ->Arg(64)
+    ->Arg(256)
+    ->Iterations(1)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
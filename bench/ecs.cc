@@ -0,0 +1,154 @@
+#include <benchmark/benchmark.h>
+
+#include "ecs.h"
+#include "sprite_batch.h"
+#include "system_schedule.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// 1M moving entities bouncing inside a 320x240 field: integrate positions,
+// then reflect velocities at the edges. The baseline is the usual game
+// object: a heap-allocated class with a virtual update
+// ---------------------------------------------------------------------------
+namespace {
+constexpr size_t kEntities = 1'000'000;
+constexpr float kDt = 1.0f / 60.0f;
+constexpr float kWidth = 320.0f;
+constexpr float kHeight = 240.0f;
+
+struct Position {
+  float x, y;
+};
+struct Velocity {
+  float x, y;
+};
+
+struct GameObject {
+  virtual ~GameObject() = default;
+  virtual void update(float dt) noexcept = 0;
+};
+
+struct Mover final : GameObject {
+  Position position;
+  Velocity velocity;
+
+  Mover(Position p, Velocity v) : position{p}, velocity{v} {}
+
+  void update(float dt) noexcept override {
+    position.x += velocity.x * dt;
+    position.y += velocity.y * dt;
+    if (position.x < 0.0f || position.x > kWidth) {
+      velocity.x = -velocity.x;
+    }
+    if (position.y < 0.0f || position.y > kHeight) {
+      velocity.y = -velocity.y;
+    }
+  }
+};
+
+template <typename F> void spawn(size_t count, F &&f) {
+  std::mt19937 rng{3};
+  std::uniform_real_distribution<float> x{0.0f, kWidth};
+  std::uniform_real_distribution<float> y{0.0f, kHeight};
+  std::uniform_real_distribution<float> v{-60.0f, 60.0f};
+  for (size_t i = 0; i < count; ++i) {
+    f(Position{x(rng), y(rng)}, Velocity{v(rng), v(rng)});
+  }
+}
+} // namespace
+
+static void BM_ObjectUpdate(benchmark::State &state) {
+  std::vector<std::unique_ptr<GameObject>> objects;
+  spawn(kEntities, [&objects](Position p, Velocity v) {
+    objects.push_back(std::make_unique<Mover>(p, v));
+  });
+  /* Objects created over a session end up scattered across the heap */
+  std::shuffle(objects.begin(), objects.end(), std::mt19937{4});
+
+  for (auto _ : state) {
+    for (const auto &object : objects) {
+      object->update(kDt);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(kEntities));
+}
+BENCHMARK(BM_ObjectUpdate)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_EcsUpdate(benchmark::State &state) {
+  World world;
+  spawn(kEntities, [&world](Position p, Velocity v) { world.create(p, v); });
+
+  SystemSchedule schedule{static_cast<size_t>(state.range(0))};
+  schedule.add<Position, const Velocity>(
+      "integrate", [](size_t n, Position *p, const Velocity *v) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+          p[i].x += v[i].x * kDt;
+          p[i].y += v[i].y * kDt;
+        }
+      });
+  schedule.add<const Position, Velocity>(
+      "bounce", [](size_t n, const Position *p, Velocity *v) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+          const bool out_x = p[i].x < 0.0f || p[i].x > kWidth;
+          const bool out_y = p[i].y < 0.0f || p[i].y > kHeight;
+          v[i].x = out_x ? -v[i].x : v[i].x;
+          v[i].y = out_y ? -v[i].y : v[i].y;
+        }
+      });
+
+  for (auto _ : state) {
+    schedule.run(world);
+  }
+  state.counters["jobs"] = static_cast<double>(schedule.lastJobs());
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(kEntities));
+}
+BENCHMARK(BM_EcsUpdate)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// ---------------------------------------------------------------------------
+// Render feed: 100k entities write their Sprite component in a system and
+// the Sprite columns go straight into SpriteBatch-style contiguous storage
+// ---------------------------------------------------------------------------
+static void BM_EcsSpriteFeed(benchmark::State &state) {
+  World world;
+  spawn(100'000, [&world](Position p, Velocity v) {
+    world.create(p, v, Sprite{.width = 4, .height = 4});
+  });
+
+  SystemSchedule schedule{static_cast<size_t>(state.range(0))};
+  schedule.add<Sprite, const Position>(
+      "sync", [](size_t n, Sprite *s, const Position *p) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+          s[i].x = p[i].x;
+          s[i].y = p[i].y;
+        }
+      });
+
+  std::vector<Sprite> frame;
+  frame.reserve(100'000);
+  for (auto _ : state) {
+    schedule.run(world);
+    frame.clear();
+    world.eachChunk<const Sprite>([&frame](size_t n, const Sprite *s) {
+      frame.insert(frame.end(), s, s + n);
+    });
+    benchmark::DoNotOptimize(frame.data());
+  }
+  state.SetItemsProcessed(state.iterations() * 100'000);
+}
+BENCHMARK(BM_EcsSpriteFeed)
+    ->Arg(1)
+    ->Arg(4)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
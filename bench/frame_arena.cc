@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include "frame_arena.h"
+#include "sprite_batch.h"
+
+#include <cstdio>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Transient frame data: a sprite list, a command list and a few formatted
+// labels, built and thrown away every frame
+// ---------------------------------------------------------------------------
+template <typename SpriteList, typename CommandList, typename String>
+static void buildFrame(SpriteList &sprites, CommandList &commands,
+                       std::vector<String> &labels, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    sprites.push_back({.x = static_cast<float>(i), .width = 8, .height = 8});
+    commands.push_back(static_cast<uint32_t>(i));
+  }
+  for (size_t i = 0; i < 16; ++i) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "entity %zu at frame position %zu", i,
+                  count);
+    labels[i] = text;
+  }
+  benchmark::DoNotOptimize(sprites.data());
+  benchmark::DoNotOptimize(commands.data());
+}
+
+static void BM_TransientHeap(benchmark::State &state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  for (auto _ : state) {
+    std::vector<Sprite> sprites;
+    std::vector<uint32_t> commands;
+    std::vector<std::string> labels(16);
+    buildFrame(sprites, commands, labels, count);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransientHeap)->Arg(100)->Arg(10000);
+
+static void BM_TransientFrameArena(benchmark::State &state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  FrameArena arena{4 << 20};
+  for (auto _ : state) {
+    {
+      std::pmr::vector<Sprite> sprites{&arena};
+      std::pmr::vector<uint32_t> commands{&arena};
+      std::vector<std::pmr::string> labels(16, std::pmr::string{&arena});
+      buildFrame(sprites, commands, labels, count);
+    }
+    arena.endFrame();
+  }
+  state.counters["overflows"] =
+      static_cast<double>(arena.lastFrame().overflows);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransientFrameArena)->Arg(100)->Arg(10000);
@@ -0,0 +1,130 @@
+#include <benchmark/benchmark.h>
+
+#include "window.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+// ---------------------------------------------------------------------------
+// Global allocation counter, reported per iteration by the benchmarks below
+// ---------------------------------------------------------------------------
+static std::atomic<uint64_t> allocations{0};
+
+void *operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+static void reportAllocations(benchmark::State &state, uint64_t before) {
+  state.counters["allocs"] = benchmark::Counter(
+      static_cast<double>(allocations.load() - before),
+      benchmark::Counter::kAvgIterations);
+}
+
+using Callback = Window::NoExceptFunctor<void()>;
+using StdCallback = std::function<void()>;
+
+/* Typical render lambda capturing several GL handles by value */
+struct RenderCapture {
+  int64_t *counter;
+  std::array<unsigned int, 8> handles;
+
+  void operator()() const noexcept {
+    *counter += handles[static_cast<size_t>(*counter) % handles.size()];
+  }
+};
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+static void BM_FunctorDispatchEmpty(benchmark::State &state) {
+  const Callback cb{};
+
+  for (auto _ : state) {
+    cb();
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_FunctorDispatchEmpty);
+
+template <typename F> static void BM_DispatchSmallCapture(benchmark::State &state) {
+  int64_t counter = 0;
+  const F cb{[&counter]() noexcept { ++counter; }};
+  const uint64_t before = allocations.load();
+
+  for (auto _ : state) {
+    cb();
+    benchmark::ClobberMemory();
+  }
+
+  reportAllocations(state, before);
+  benchmark::DoNotOptimize(counter);
+}
+BENCHMARK(BM_DispatchSmallCapture<StdCallback>)->Name("BM_StdFunctionDispatchSmallCapture");
+BENCHMARK(BM_DispatchSmallCapture<Callback>)->Name("BM_FunctorDispatchSmallCapture");
+
+template <typename F> static void BM_DispatchLargeCapture(benchmark::State &state) {
+  int64_t counter = 0;
+  const F cb{RenderCapture{&counter, {1, 2, 3, 4, 5, 6, 7, 8}}};
+  const uint64_t before = allocations.load();
+
+  for (auto _ : state) {
+    cb();
+    benchmark::ClobberMemory();
+  }
+
+  reportAllocations(state, before);
+  benchmark::DoNotOptimize(counter);
+}
+BENCHMARK(BM_DispatchLargeCapture<StdCallback>)->Name("BM_StdFunctionDispatchLargeCapture");
+BENCHMARK(BM_DispatchLargeCapture<Callback>)->Name("BM_FunctorDispatchLargeCapture");
+
+// ---------------------------------------------------------------------------
+// Construction (std::function allocates once captures outgrow its SBO)
+// ---------------------------------------------------------------------------
+template <typename F> static void BM_ConstructLargeCapture(benchmark::State &state) {
+  int64_t counter = 0;
+  const uint64_t before = allocations.load();
+
+  for (auto _ : state) {
+    F cb{RenderCapture{&counter, {1, 2, 3, 4, 5, 6, 7, 8}}};
+    benchmark::DoNotOptimize(cb);
+  }
+
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_ConstructLargeCapture<StdCallback>)->Name("BM_StdFunctionConstructLargeCapture");
+BENCHMARK(BM_ConstructLargeCapture<Callback>)->Name("BM_FunctorConstructLargeCapture");
+
+// ---------------------------------------------------------------------------
+// Whole frames: allocations per render() with a large-capture callback
+// ---------------------------------------------------------------------------
+static void BM_FrameAllocations(benchmark::State &state) {
+  int64_t counter = 0;
+  Window w{64,
+           64,
+           "Bench",
+           []() noexcept {},
+           RenderCapture{&counter, {1, 2, 3, 4, 5, 6, 7, 8}},
+           []() noexcept {},
+           WindowOptions{.headless = true}};
+  const uint64_t before = allocations.load();
+
+  for (auto _ : state) {
+    w.render();
+  }
+
+  reportAllocations(state, before);
+  benchmark::DoNotOptimize(counter);
+}
+BENCHMARK(BM_FrameAllocations);
@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+
+#include "gl_capture.h"
+#include "sprite_batch.h"
+#include "window.h"
+
+#include <array>
+#include <memory>
+#include <random>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Replaying a captured sprite frame (the scene of BM_SpriteBatchFrame) in a
+// tight loop. Comparing the two separates the GL cost of the frame from the
+// CPU work of building it
+// ---------------------------------------------------------------------------
+static void BM_GLReplayFrame(benchmark::State &state) {
+  const auto count = static_cast<size_t>(state.range(0));
+
+  std::unique_ptr<SpriteBatch> batch;
+  std::array<GLuint, 4> textures{};
+  std::vector<Sprite> sprites;
+
+  std::mt19937 rng{42};
+  std::uniform_real_distribution<float> x{0.0f, 312.0f}, y{0.0f, 232.0f};
+
+  /* Started before the window so its targets are part of the setup */
+  auto capture = std::make_unique<GLCapture>();
+  Window w{320,
+           240,
+           "Bench",
+           [&]() noexcept {
+             batch = std::make_unique<SpriteBatch>();
+             const uint32_t white = 0xFFFFFFFF;
+             glGenTextures(4, textures.data());
+             for (GLuint t : textures) {
+               glBindTexture(GL_TEXTURE_2D, t);
+               glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA,
+                            GL_UNSIGNED_BYTE, &white);
+               glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                               GL_NEAREST);
+             }
+           },
+           [&]() noexcept {
+             glClear(GL_COLOR_BUFFER_BIT);
+             batch->begin(320.0f, 240.0f);
+             for (const auto &s : sprites) {
+               batch->draw(s);
+             }
+             batch->end();
+           },
+           [&]() noexcept {
+             glDeleteTextures(4, textures.data());
+             batch.reset();
+           },
+           WindowOptions{.headless = true}};
+
+  for (size_t i = 0; i < count; ++i) {
+    sprites.push_back({.x = x(rng),
+                       .y = y(rng),
+                       .width = 8,
+                       .height = 8,
+                       .texture = textures[i % textures.size()]});
+  }
+
+  w.render();
+  capture->stop();
+
+  GLReplay replay{
+      std::vector<uint8_t>(capture->data().begin(), capture->data().end())};
+  replay.setup();
+  for (auto _ : state) {
+    replay.replayFrame(0);
+  }
+  glFinish();
+
+  state.counters["stream_kb"] =
+      static_cast<double>(capture->data().size()) / 1024.0;
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_GLReplayFrame)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+
+#include "input.h"
+#include "window.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// ---------------------------------------------------------------------------
+// Queue throughput: one thread pushing a batch of events and draining it,
+// the shape of a poll followed by a simulation step
+// ---------------------------------------------------------------------------
+static void BM_InputQueuePushDrain(benchmark::State &state) {
+  const auto batch = static_cast<size_t>(state.range(0));
+  auto queue = std::make_unique<InputQueue>();
+  InputState input;
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < batch; ++i) {
+      queue->push({.type = InputEvent::Type::CursorPos,
+                   .x = static_cast<double>(i),
+                   .y = 1.0,
+                   .time = 1});
+    }
+    queue->drain([&input](const InputEvent &e) noexcept { input.apply(e); });
+  }
+  benchmark::DoNotOptimize(input.cursorX());
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(batch));
+}
+BENCHMARK(BM_InputQueuePushDrain)->Arg(1)->Arg(16)->Arg(256);
+
+// ---------------------------------------------------------------------------
+// The same with the producer on its own thread, pushing as fast as it can
+// ---------------------------------------------------------------------------
+static void BM_InputQueueCrossThread(benchmark::State &state) {
+  auto queue = std::make_unique<InputQueue>();
+  std::atomic<bool> stop{false};
+  std::thread producer{[&] {
+    int64_t time = 1;
+    while (!stop.load(std::memory_order_relaxed)) {
+      queue->push({.type = InputEvent::Type::Key, .time = time++});
+    }
+  }};
+
+  size_t events = 0;
+  for (auto _ : state) {
+    events += queue->drain([](const InputEvent &) noexcept {});
+  }
+  stop = true;
+  producer.join();
+
+  state.SetItemsProcessed(static_cast<int64_t>(events));
+  state.counters["dropped"] = static_cast<double>(queue->dropped());
+}
+BENCHMARK(BM_InputQueueCrossThread)->UseRealTime();
+
+// ---------------------------------------------------------------------------
+// Input-to-photon latency of a headless window: an event arrives, the
+// simulation consumes it, and the next frame presents it
+// ---------------------------------------------------------------------------
+static void BM_InputToPhoton(benchmark::State &state) {
+  Window w{320,
+           240,
+           "Bench",
+           []() noexcept {},
+           []() noexcept { glClear(GL_COLOR_BUFFER_BIT); },
+           []() noexcept {},
+           WindowOptions{.headless = true, .input_events = true}};
+  InputQueue &queue = *w.input();
+  InputState input;
+
+  for (auto _ : state) {
+    queue.push({.type = InputEvent::Type::Key,
+                .action = GLFW_PRESS,
+                .time = InputQueue::now()});
+    queue.drain([&input](const InputEvent &e) noexcept { input.apply(e); });
+    w.render();
+  }
+
+  const InputLatency latency = queue.latency();
+  state.counters["latency_ms"] = latency.mean_ms;
+  state.counters["max_ms"] = latency.max_ms;
+}
+BENCHMARK(BM_InputToPhoton)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+
+#include "sprite_batch.h"
+#include "window.h"
+
+#include <memory>
+
+// ---------------------------------------------------------------------------
+// Fill cost: 8 layers of fullscreen blended sprites on a 1280x960 window,
+// rendered natively (logical = 0) or at 320x240 and integer-scaled
+// ---------------------------------------------------------------------------
+static void BM_FullscreenOverdraw(benchmark::State &state) {
+  const auto logical_width = static_cast<size_t>(state.range(0));
+  const auto logical_height = logical_width * 3 / 4;
+  const float vw = logical_width ? float(logical_width) : 1280.0f;
+  const float vh = logical_width ? float(logical_height) : 960.0f;
+
+  std::unique_ptr<SpriteBatch> batch;
+  Window w{1280,
+           960,
+           "Bench",
+           [&batch]() noexcept { batch = std::make_unique<SpriteBatch>(); },
+           [&batch, vw, vh]() noexcept {
+             glClear(GL_COLOR_BUFFER_BIT);
+             batch->begin(vw, vh);
+             for (int i = 0; i < 8; ++i) {
+               batch->draw({.width = vw,
+                            .height = vh,
+                            .color = Sprite::rgba(255, 128, 64, 32)});
+             }
+             batch->end();
+           },
+           [&batch]() noexcept { batch.reset(); },
+           WindowOptions{.headless = true,
+                         .logical_width = logical_width,
+                         .logical_height = logical_height}};
+
+  for (auto _ : state) {
+    w.render();
+  }
+
+  w.offscreen()->flush();
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_FullscreenOverdraw)
+    ->Arg(0)
+    ->Arg(320)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+
+#include "particles.h"
+#include "window.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+static std::vector<ParticleSpawn> randomSpawns(size_t count) {
+  std::mt19937 rng{5};
+  std::uniform_real_distribution<float> x{0.0f, 320.0f}, y{0.0f, 240.0f},
+      v{-40.0f, 40.0f}, life{1.0f, 1000.0f};
+  std::vector<ParticleSpawn> spawns(count);
+  for (auto &p : spawns) {
+    p = {.x = x(rng), .y = y(rng), .vx = v(rng), .vy = v(rng),
+         .life = life(rng)};
+  }
+  return spawns;
+}
+
+constexpr ParticleForces kForces{.gravity_y = 98.0f, .drag = 0.1f};
+
+// ---------------------------------------------------------------------------
+// Updating a full CPU pool with each kernel (0 = scalar, 1 = SSE2, 2 = AVX2)
+// ---------------------------------------------------------------------------
+static void BM_CpuParticlesUpdate(benchmark::State &state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  CpuParticles particles{count};
+  const auto isa = particles.setIsa(static_cast<SpanIsa>(state.range(1)));
+  if (isa != static_cast<SpanIsa>(state.range(1))) {
+    state.SkipWithError("instruction set not supported");
+    return;
+  }
+  particles.emit(randomSpawns(count));
+
+  for (auto _ : state) {
+    particles.update(1.0f / 60.0f, kForces);
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(spanIsaName(isa));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CpuParticlesUpdate)
+    ->ArgsProduct({{1 << 20}, {0, 1, 2}})
+    ->Unit(benchmark::kMillisecond);
+
+// ---------------------------------------------------------------------------
+// Updating a full GPU pool with transform feedback, waiting for the GPU
+// every iteration. With draw = 1 the pool is also rendered into a 320x240
+// headless window, as one frame would
+// ---------------------------------------------------------------------------
+static void BM_GpuParticlesFrame(benchmark::State &state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  const bool draw = state.range(1) != 0;
+
+  std::unique_ptr<GpuParticles> particles;
+  Window w{320,
+           240,
+           "Bench",
+           [&]() noexcept {
+             particles = std::make_unique<GpuParticles>(count);
+           },
+           [&]() noexcept {
+             glClear(GL_COLOR_BUFFER_BIT);
+             particles->draw(320.0f, 240.0f);
+           },
+           [&]() noexcept { particles.reset(); },
+           WindowOptions{.headless = true}};
+  particles->emit(randomSpawns(count));
+  glFinish();
+
+  for (auto _ : state) {
+    particles->update(1.0f / 60.0f, kForces);
+    if (draw) {
+      w.render();
+    }
+    glFinish();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GpuParticlesFrame)
+    ->ArgsProduct({{1 << 20}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,143 @@
+#include <benchmark/benchmark.h>
+
+#include "window.h"
+
+// ---------------------------------------------------------------------------
+// The two-triangle quad scene from src/main.cpp
+// ---------------------------------------------------------------------------
+namespace {
+float vertices[] = {
+    0.5f,  0.5f,  0.0f, // top right
+    0.5f,  -0.5f, 0.0f, // bottom right
+    -0.5f, -0.5f, 0.0f, // bottom left
+    -0.5f, 0.5f,  0.0f  // top left
+};
+unsigned int indices[] = {
+    0, 1, 3, // first triangle
+    1, 2, 3  // second triangle
+};
+
+const char *vertexShaderSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "void main()\n"
+    "{\n"
+    "   gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);\n"
+    "}\0";
+
+const char *fragmentShaderSource1 =
+    "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "  FragColor = vec4(1.0f, 0.5f, 0.2f, 1.0f);\n"
+    "}\0";
+
+const char *fragmentShaderSource2 =
+    "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "  FragColor = vec4(0.5f, 0.5f, 0.9f, 1.0f);\n"
+    "}\0";
+
+struct QuadScene {
+  unsigned int VAO{}, VBO{}, EBO{}, shaderProgram1{}, shaderProgram2{};
+
+  void init() noexcept {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices,
+                 GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
+                          static_cast<void *>(0));
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+
+    const auto vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
+    glCompileShader(vertexShader);
+
+    const auto fragmentShader1 = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader1, 1, &fragmentShaderSource1, nullptr);
+    glCompileShader(fragmentShader1);
+
+    const auto fragmentShader2 = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader2, 1, &fragmentShaderSource2, nullptr);
+    glCompileShader(fragmentShader2);
+
+    shaderProgram1 = glCreateProgram();
+    glAttachShader(shaderProgram1, vertexShader);
+    glAttachShader(shaderProgram1, fragmentShader1);
+    glLinkProgram(shaderProgram1);
+
+    shaderProgram2 = glCreateProgram();
+    glAttachShader(shaderProgram2, vertexShader);
+    glAttachShader(shaderProgram2, fragmentShader2);
+    glLinkProgram(shaderProgram2);
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader1);
+    glDeleteShader(fragmentShader2);
+  }
+
+  /* One iteration issues the same four calls per quad as main.cpp */
+  void draw(int64_t quads) const noexcept {
+    glBindVertexArray(VAO);
+    for (int64_t i = 0; i < quads; ++i) {
+      glUseProgram(shaderProgram1);
+      glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, 0);
+
+      glUseProgram(shaderProgram2);
+      glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT,
+                     reinterpret_cast<void *>(3 * sizeof(unsigned int)));
+    }
+  }
+
+  void cleanup() noexcept {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    glDeleteProgram(shaderProgram1);
+    glDeleteProgram(shaderProgram2);
+  }
+};
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Draw-call throughput
+// ---------------------------------------------------------------------------
+static void BM_QuadSceneDraws(benchmark::State &state) {
+  QuadScene scene;
+  const int64_t quads = state.range(0);
+
+  Window w{320,
+           240,
+           "Bench",
+           [&scene]() noexcept { scene.init(); },
+           [&scene, quads]() noexcept {
+             glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+             glClear(GL_COLOR_BUFFER_BIT);
+             scene.draw(quads);
+           },
+           [&scene]() noexcept { scene.cleanup(); },
+           WindowOptions{.headless = true}};
+
+  for (auto _ : state) {
+    w.render();
+  }
+
+  w.offscreen()->flush();
+  state.counters["draws"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * quads * 2),
+      benchmark::Counter::kIsRate);
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_QuadSceneDraws)->RangeMultiplier(10)->Range(1, 1000);
@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+
+#include "render_queue.h"
+#include "window.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Draw submission: random draws over 8 programs, 8 VAOs and 8 textures,
+// either bound naively per draw or sorted and filtered by the state cache
+// ---------------------------------------------------------------------------
+static void BM_DrawSubmission(benchmark::State &state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  const bool sorted = state.range(1) != 0;
+
+  std::array<GLuint, 8> programs{};
+  std::array<GLuint, 8> vaos{};
+  std::array<GLuint, 8> textures{};
+  std::vector<DrawCommand> draws;
+  RenderQueue queue;
+  GLStateCache cache;
+
+  Window w{64,
+           64,
+           "Bench",
+           [&]() noexcept {
+             const char *vs = "#version 330 core\n"
+                              "void main() { gl_Position = vec4(2.0); }\n";
+             const char *fs = "#version 330 core\n"
+                              "out vec4 c;\n"
+                              "void main() { c = vec4(1.0); }\n";
+             for (auto &program : programs) {
+               const GLuint v = glCreateShader(GL_VERTEX_SHADER);
+               glShaderSource(v, 1, &vs, nullptr);
+               glCompileShader(v);
+               const GLuint f = glCreateShader(GL_FRAGMENT_SHADER);
+               glShaderSource(f, 1, &fs, nullptr);
+               glCompileShader(f);
+               program = glCreateProgram();
+               glAttachShader(program, v);
+               glAttachShader(program, f);
+               glLinkProgram(program);
+               glDeleteShader(v);
+               glDeleteShader(f);
+             }
+             glGenVertexArrays(8, vaos.data());
+             glGenTextures(8, textures.data());
+           },
+           [&]() noexcept {
+             if (sorted) {
+               for (const auto &d : draws) {
+                 queue.push(d);
+               }
+               queue.submit(cache);
+               return;
+             }
+             for (const auto &d : draws) {
+               glUseProgram(d.program);
+               glBindVertexArray(d.vao);
+               glBindTexture(GL_TEXTURE_2D, d.texture);
+               glDrawArrays(d.mode, d.first, d.count);
+             }
+           },
+           [&]() noexcept {
+             glDeleteTextures(8, textures.data());
+             glDeleteVertexArrays(8, vaos.data());
+             for (GLuint program : programs) {
+               glDeleteProgram(program);
+             }
+           },
+           WindowOptions{.headless = true}};
+
+  std::mt19937 rng{42};
+  std::uniform_int_distribution<size_t> pick{0, 7};
+  std::uniform_real_distribution<float> depth{0.0f, 1.0f};
+  for (size_t i = 0; i < count; ++i) {
+    draws.push_back({.program = programs[pick(rng)],
+                     .vao = vaos[pick(rng)],
+                     .texture = textures[pick(rng)],
+                     .depth = depth(rng),
+                     .mode = GL_POINTS,
+                     .count = 1,
+                     .index_type = 0});
+  }
+  queue.reserve(count);
+
+  for (auto _ : state) {
+    w.render();
+  }
+
+  w.offscreen()->flush();
+  if (sorted) {
+    state.counters["binds_issued"] = benchmark::Counter(
+        static_cast<double>(cache.counters().binds_issued),
+        benchmark::Counter::kAvgIterations);
+  }
+  state.counters["draws"] =
+      benchmark::Counter(static_cast<double>(state.iterations() * count),
+                         benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_DrawSubmission)
+    ->ArgNames({"draws", "sorted"})
+    ->ArgsProduct({{1000, 10000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// ---------------------------------------------------------------------------
+// Key sort: radix sort against std::sort on random 64-bit keys
+// ---------------------------------------------------------------------------
+static std::vector<SortEntry> randomEntries(size_t count) {
+  std::mt19937_64 rng{42};
+  std::vector<SortEntry> entries(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    entries[i] = {rng(), i};
+  }
+  return entries;
+}
+
+static void BM_RadixSort(benchmark::State &state) {
+  const auto input = randomEntries(static_cast<size_t>(state.range(0)));
+  auto entries = input;
+  std::vector<SortEntry> scratch(input.size());
+  for (auto _ : state) {
+    std::copy(input.begin(), input.end(), entries.begin());
+    radixSort(entries, scratch);
+    benchmark::DoNotOptimize(entries.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RadixSort)->Arg(1000)->Arg(100000);
+
+static void BM_StdSort(benchmark::State &state) {
+  const auto input = randomEntries(static_cast<size_t>(state.range(0)));
+  auto entries = input;
+  for (auto _ : state) {
+    std::copy(input.begin(), input.end(), entries.begin());
+    std::sort(entries.begin(), entries.end());
+    benchmark::DoNotOptimize(entries.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StdSort)->Arg(1000)->Arg(100000);
@@ -0,0 +1,183 @@
+#include <benchmark/benchmark.h>
+
+#include "render_thread.h"
+#include "sprite_batch.h"
+#include "triple_buffer.h"
+#include "window.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helper: a small particle simulation and the sprites that show it. Each
+// snapshot is stamped when published so the render side can measure the
+// publish-to-draw latency
+// ---------------------------------------------------------------------------
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kParticles = 20000;
+constexpr size_t kDrawn = 1000;
+constexpr float kDt = 1.0f / 120.0f;
+
+struct Simulation {
+  std::vector<float> x, y, vx, vy;
+
+  Simulation() : x(kParticles), y(kParticles), vx(kParticles), vy(kParticles) {
+    for (size_t i = 0; i < kParticles; ++i) {
+      x[i] = static_cast<float>(i % 312);
+      y[i] = static_cast<float>(i % 232);
+      vx[i] = static_cast<float>(i % 7) * 10.0f - 30.0f;
+      vy[i] = static_cast<float>(i % 5) * 10.0f - 20.0f;
+    }
+  }
+
+  void step() noexcept {
+    for (size_t i = 0; i < kParticles; ++i) {
+      x[i] += vx[i] * kDt;
+      y[i] += vy[i] * kDt;
+      if (x[i] < 0.0f || x[i] > 312.0f) {
+        vx[i] = -vx[i];
+      }
+      if (y[i] < 0.0f || y[i] > 232.0f) {
+        vy[i] = -vy[i];
+      }
+    }
+  }
+};
+
+struct Snapshot {
+  Clock::time_point published;
+  std::array<float, kDrawn * 2> positions;
+
+  void capture(const Simulation &sim) noexcept {
+    for (size_t i = 0; i < kDrawn; ++i) {
+      positions[i * 2] = sim.x[i];
+      positions[i * 2 + 1] = sim.y[i];
+    }
+    published = Clock::now();
+  }
+};
+
+/* Latency samples are recorded by whichever thread renders */
+struct LatencyLog {
+  std::vector<double> us;
+
+  LatencyLog() { us.reserve(1 << 20); }
+
+  void record(Clock::time_point published) noexcept {
+    if (us.size() < us.capacity()) {
+      us.push_back(std::chrono::duration<double, std::micro>(Clock::now() -
+                                                             published)
+                       .count());
+    }
+  }
+
+  void report(benchmark::State &state) {
+    if (us.empty()) {
+      return;
+    }
+    std::sort(us.begin(), us.end());
+    double sum = 0.0;
+    for (double v : us) {
+      sum += v;
+    }
+    state.counters["latency_mean_us"] = sum / static_cast<double>(us.size());
+    state.counters["latency_p99_us"] = us[us.size() * 99 / 100];
+  }
+};
+
+void drawSnapshot(SpriteBatch &batch, const Snapshot &s) noexcept {
+  glClear(GL_COLOR_BUFFER_BIT);
+  batch.begin(320.0f, 240.0f);
+  for (size_t i = 0; i < kDrawn; ++i) {
+    batch.draw({.x = s.positions[i * 2],
+                .y = s.positions[i * 2 + 1],
+                .width = 8,
+                .height = 8});
+  }
+  batch.end();
+}
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Baseline: simulate, then render, on one thread. Every step waits for the
+// frame to be submitted
+// ---------------------------------------------------------------------------
+static void BM_SingleThreadLoop(benchmark::State &state) {
+  std::unique_ptr<SpriteBatch> batch;
+  Simulation sim;
+  Snapshot snapshot{};
+  LatencyLog latency;
+
+  Window w{320,
+           240,
+           "Bench",
+           [&]() noexcept { batch = std::make_unique<SpriteBatch>(); },
+           [&]() noexcept {
+             drawSnapshot(*batch, snapshot);
+             latency.record(snapshot.published);
+           },
+           [&]() noexcept { batch.reset(); },
+           WindowOptions{.headless = true}};
+
+  for (auto _ : state) {
+    sim.step();
+    snapshot.capture(sim);
+    w.render();
+  }
+
+  w.offscreen()->flush();
+  latency.report(state);
+  state.counters["steps"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+  state.counters["frames"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SingleThreadLoop)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// ---------------------------------------------------------------------------
+// Render thread: the simulation publishes snapshots through a triple buffer
+// and never waits; the render thread draws the newest one it finds
+// ---------------------------------------------------------------------------
+static void BM_RenderThreadLoop(benchmark::State &state) {
+  std::unique_ptr<SpriteBatch> batch;
+  Simulation sim;
+  TripleBuffer<Snapshot> snapshots;
+  LatencyLog latency;
+
+  Window w{320,
+           240,
+           "Bench",
+           [&]() noexcept { batch = std::make_unique<SpriteBatch>(); },
+           [&]() noexcept {
+             const bool fresh = snapshots.update();
+             drawSnapshot(*batch, snapshots.front());
+             if (fresh) {
+               latency.record(snapshots.front().published);
+             }
+           },
+           [&]() noexcept { batch.reset(); },
+           WindowOptions{.headless = true}};
+
+  RenderThread renderer{w};
+  for (auto _ : state) {
+    sim.step();
+    snapshots.back().capture(sim);
+    snapshots.publish();
+  }
+  const auto frames = renderer.frames();
+  renderer.stop();
+
+  w.offscreen()->flush();
+  latency.report(state);
+  state.counters["steps"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+  state.counters["frames"] = benchmark::Counter(static_cast<double>(frames),
+                                                benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_RenderThreadLoop)->Unit(benchmark::kMicrosecond)->UseRealTime();
@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+
+#include "shader_cache.h"
+#include "window.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Startup with hundreds of fragment variants, cold vs. warm binary cache
+// ---------------------------------------------------------------------------
+namespace {
+const std::string kVertex = "#version 330 core\n"
+                            "layout (location = 0) in vec3 aPos;\n"
+                            "void main() { gl_Position = vec4(aPos, 1.0); }\n";
+
+std::vector<std::string> makeVariants(size_t count) {
+  std::vector<std::string> variants;
+  for (size_t i = 0; i < count; ++i) {
+    variants.push_back("#version 330 core\n"
+                       "out vec4 FragColor;\n"
+                       "void main()\n"
+                       "{\n"
+                       "  vec3 c = vec3(" +
+                       std::to_string(i) +
+                       ".0 / 255.0);\n"
+                       "  for (int i = 0; i < 4; ++i) c = fract(c * 1.7);\n"
+                       "  FragColor = vec4(c, 1.0);\n"
+                       "}\n");
+  }
+  return variants;
+}
+
+Window makeWindow() {
+  return Window{64,
+                64,
+                "Bench",
+                []() noexcept {},
+                []() noexcept {},
+                []() noexcept {},
+                WindowOptions{.headless = true}};
+}
+
+const std::filesystem::path kCacheDir =
+    std::filesystem::temp_directory_path() / "libretro_bench_shader_cache";
+} // namespace
+
+static void BM_ShaderStartupCold(benchmark::State &state) {
+  auto w = makeWindow();
+  const auto variants = makeVariants(static_cast<size_t>(state.range(0)));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::filesystem::remove_all(kCacheDir);
+    state.ResumeTiming();
+
+    ShaderCache cache{kCacheDir};
+    for (const auto &fragment : variants) {
+      benchmark::DoNotOptimize(cache.program(kVertex, fragment));
+    }
+    glFinish();
+  }
+
+  std::filesystem::remove_all(kCacheDir);
+}
+BENCHMARK(BM_ShaderStartupCold)->Arg(200)->Unit(benchmark::kMillisecond);
+
+static void BM_ShaderStartupWarm(benchmark::State &state) {
+  auto w = makeWindow();
+  const auto variants = makeVariants(static_cast<size_t>(state.range(0)));
+
+  std::filesystem::remove_all(kCacheDir);
+  {
+    ShaderCache cache{kCacheDir};
+    if (!cache.binarySupported()) {
+      state.SkipWithError("driver exposes no program binary formats");
+      return;
+    }
+    for (const auto &fragment : variants) {
+      cache.program(kVertex, fragment);
+    }
+  }
+
+  for (auto _ : state) {
+    ShaderCache cache{kCacheDir};
+    for (const auto &fragment : variants) {
+      benchmark::DoNotOptimize(cache.program(kVertex, fragment));
+    }
+    glFinish();
+  }
+
+  std::filesystem::remove_all(kCacheDir);
+}
+BENCHMARK(BM_ShaderStartupWarm)->Arg(200)->Unit(benchmark::kMillisecond);
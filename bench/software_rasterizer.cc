@@ -0,0 +1,210 @@
+#include <benchmark/benchmark.h>
+
+#include "software_rasterizer.h"
+#include "span_kernels.h"
+#include "sprite_batch.h"
+#include "window.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Span kernels: blend 4096 pixels with each instruction set the CPU has
+// (arg: 0 scalar, 1 sse2, 2 avx2)
+// ---------------------------------------------------------------------------
+static void BM_SpanBlend(benchmark::State &state) {
+  const auto requested = static_cast<SpanIsa>(state.range(0));
+  const SpanIsa saved = spanIsa();
+  if (setSpanIsa(requested) != requested) {
+    setSpanIsa(saved);
+    state.SkipWithError("instruction set not supported");
+    return;
+  }
+
+  std::vector<uint32_t> src(4096, Sprite::rgba(200, 100, 50, 128));
+  std::vector<uint32_t> dst(4096, Sprite::rgba(10, 20, 30));
+  for (auto _ : state) {
+    blendSpan(dst.data(), src.data(), dst.size());
+    benchmark::DoNotOptimize(dst.data());
+  }
+
+  setSpanIsa(saved);
+  state.SetLabel(spanIsaName(requested));
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(dst.size()));
+}
+BENCHMARK(BM_SpanBlend)->Arg(0)->Arg(1)->Arg(2);
+
+// ---------------------------------------------------------------------------
+// Whole frames at 320x240: translucent textured 16x16 sprites or random
+// triangles, across thread counts (args: threads, primitives)
+// ---------------------------------------------------------------------------
+namespace {
+constexpr size_t kWidth = 320;
+constexpr size_t kHeight = 240;
+
+std::vector<Sprite> makeSprites(size_t count) {
+  std::mt19937 rng{1};
+  std::uniform_real_distribution<float> x{-8.0f, kWidth};
+  std::uniform_real_distribution<float> y{-8.0f, kHeight};
+  std::vector<Sprite> sprites;
+  for (size_t i = 0; i < count; ++i) {
+    sprites.push_back({.x = x(rng),
+                       .y = y(rng),
+                       .width = 16,
+                       .height = 16,
+                       .color = Sprite::rgba(255, 255, 255, 192),
+                       .texture = 1});
+  }
+  return sprites;
+}
+
+uint32_t makeTexture(SoftwareRasterizer &raster) {
+  std::vector<uint32_t> texels(16 * 16);
+  for (size_t i = 0; i < texels.size(); ++i) {
+    texels[i] = Sprite::rgba(static_cast<uint8_t>(i), 128,
+                             static_cast<uint8_t>(255 - i), 255);
+  }
+  return raster.createTexture(16, 16, texels);
+}
+} // namespace
+
+static void BM_SoftwareSprites(benchmark::State &state) {
+  const auto threads = static_cast<size_t>(state.range(0));
+  const auto sprites = makeSprites(static_cast<size_t>(state.range(1)));
+
+  SoftwareRasterizer raster{kWidth, kHeight, threads};
+  makeTexture(raster);
+  for (auto _ : state) {
+    raster.clear(Sprite::rgba(0, 0, 0));
+    for (const Sprite &s : sprites) {
+      raster.draw(s);
+    }
+    raster.finish();
+    benchmark::DoNotOptimize(raster.pixels().data());
+  }
+
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_SoftwareSprites)
+    ->ArgsProduct({{1, 2, 4}, {1000, 10000}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_SoftwareTriangles(benchmark::State &state) {
+  const auto threads = static_cast<size_t>(state.range(0));
+  const auto count = static_cast<size_t>(state.range(1));
+
+  std::mt19937 rng{2};
+  std::uniform_real_distribution<float> x{0.0f, kWidth};
+  std::uniform_real_distribution<float> y{0.0f, kHeight};
+  std::uniform_real_distribution<float> d{-24.0f, 24.0f};
+  std::vector<SoftwareRasterizer::Point> points;
+  for (size_t i = 0; i < count; ++i) {
+    const float cx = x(rng), cy = y(rng);
+    for (int v = 0; v < 3; ++v) {
+      points.push_back({cx + d(rng), cy + d(rng)});
+    }
+  }
+
+  SoftwareRasterizer raster{kWidth, kHeight, threads};
+  for (auto _ : state) {
+    raster.clear(Sprite::rgba(0, 0, 0));
+    for (size_t i = 0; i < points.size(); i += 3) {
+      raster.drawTriangle(points[i], points[i + 1], points[i + 2],
+                          Sprite::rgba(64, 128, 255, 160));
+    }
+    raster.finish();
+    benchmark::DoNotOptimize(raster.pixels().data());
+  }
+
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_SoftwareTriangles)
+    ->ArgsProduct({{1, 2, 4}, {1000, 10000}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// ---------------------------------------------------------------------------
+// Presentation: the per-frame texture upload of a software window, against
+// drawing the same sprites with SpriteBatch on the GPU
+// ---------------------------------------------------------------------------
+static void BM_SoftwarePresent(benchmark::State &state) {
+  const auto sprites = makeSprites(static_cast<size_t>(state.range(0)));
+
+  SoftwareRasterizer *raster = nullptr;
+  Window w{kWidth,
+           kHeight,
+           "Bench",
+           []() noexcept {},
+           [&raster, &sprites]() noexcept {
+             raster->clear(Sprite::rgba(0, 0, 0));
+             for (const Sprite &s : sprites) {
+               raster->draw(s);
+             }
+           },
+           []() noexcept {},
+           WindowOptions{.logical_width = kWidth,
+                         .logical_height = kHeight,
+                         .software = true}};
+  raster = w.software();
+  makeTexture(*raster);
+
+  for (auto _ : state) {
+    w.render();
+  }
+
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SoftwarePresent)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+static void BM_GlSprites(benchmark::State &state) {
+  auto sprites = makeSprites(static_cast<size_t>(state.range(0)));
+
+  std::unique_ptr<SpriteBatch> batch;
+  GLuint texture = 0;
+  Window w{kWidth,
+           kHeight,
+           "Bench",
+           [&batch, &texture]() noexcept {
+             batch = std::make_unique<SpriteBatch>();
+             std::vector<uint32_t> texels(16 * 16, Sprite::rgba(255, 128, 0));
+             glGenTextures(1, &texture);
+             glBindTexture(GL_TEXTURE_2D, texture);
+             glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 16, 16, 0, GL_RGBA,
+                          GL_UNSIGNED_BYTE, texels.data());
+             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+           },
+           [&batch, &sprites]() noexcept {
+             glClear(GL_COLOR_BUFFER_BIT);
+             batch->begin(kWidth, kHeight);
+             for (const Sprite &s : sprites) {
+               batch->draw(s);
+             }
+             batch->end();
+           },
+           [&batch, &texture]() noexcept {
+             batch.reset();
+             glDeleteTextures(1, &texture);
+           },
+           WindowOptions{.logical_width = kWidth, .logical_height = kHeight}};
+  for (Sprite &s : sprites) {
+    s.texture = texture;
+  }
+
+  for (auto _ : state) {
+    w.render();
+  }
+
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_GlSprites)->Arg(1000)->Unit(benchmark::kMillisecond);
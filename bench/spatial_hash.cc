@@ -0,0 +1,193 @@
+#include <benchmark/benchmark.h>
+
+#include "spatial_hash.h"
+#include "sprite_batch.h"
+#include "window.h"
+#include "work_stealing_pool.h"
+
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// 100k 8x8 objects drifting around a 4096x4096 world with 32-pixel cells
+// ---------------------------------------------------------------------------
+namespace {
+constexpr size_t kObjects = 100'000;
+constexpr float kWorld = 4096.0f;
+constexpr float kSize = 8.0f;
+constexpr float kCell = 32.0f;
+constexpr size_t kBuckets = 1 << 16;
+
+struct Movers {
+  std::vector<Aabb> boxes;
+  std::vector<std::pair<float, float>> velocities;
+
+  explicit Movers(size_t count) {
+    std::mt19937 rng{11};
+    std::uniform_real_distribution<float> pos{0.0f, kWorld - kSize},
+        v{-2.0f, 2.0f};
+    for (size_t i = 0; i < count; ++i) {
+      const float x = pos(rng), y = pos(rng);
+      boxes.push_back({x, y, x + kSize, y + kSize});
+      velocities.emplace_back(v(rng), v(rng));
+    }
+  }
+
+  /* One frame of movement, bouncing off the world's edges */
+  void step() noexcept {
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      auto &[vx, vy] = velocities[i];
+      Aabb &b = boxes[i];
+      if (b.min_x + vx < 0.0f || b.max_x + vx > kWorld) {
+        vx = -vx;
+      }
+      if (b.min_y + vy < 0.0f || b.max_y + vy > kWorld) {
+        vy = -vy;
+      }
+      b = {b.min_x + vx, b.min_y + vy, b.max_x + vx, b.max_y + vy};
+    }
+  }
+};
+
+SpatialHash build(const Movers &movers) {
+  SpatialHash hash{kCell, kBuckets};
+  for (uint32_t i = 0; i < movers.boxes.size(); ++i) {
+    hash.update(i, movers.boxes[i]);
+  }
+  return hash;
+}
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Moving every object and updating the index, as a frame would
+// ---------------------------------------------------------------------------
+static void BM_SpatialHashUpdate(benchmark::State &state) {
+  Movers movers{kObjects};
+  SpatialHash hash = build(movers);
+  const uint64_t relinks = hash.stats().relinks;
+
+  for (auto _ : state) {
+    movers.step();
+    for (uint32_t i = 0; i < kObjects; ++i) {
+      hash.update(i, movers.boxes[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kObjects);
+  state.counters["relinks_per_frame"] =
+      static_cast<double>(hash.stats().relinks - relinks) /
+      static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_SpatialHashUpdate)->Unit(benchmark::kMillisecond);
+
+// ---------------------------------------------------------------------------
+// 10k 64x64 box queries and 10k radius-32 range queries per iteration, on
+// the calling thread (threads = 1) or a pool of the given size
+// ---------------------------------------------------------------------------
+template <typename Shape>
+static void queryBatch(benchmark::State &state, std::vector<Shape> shapes) {
+  const Movers movers{kObjects};
+  const SpatialHash hash = build(movers);
+  const auto threads = static_cast<size_t>(state.range(0));
+  std::unique_ptr<WorkStealingPool> pool;
+  if (threads > 1) {
+    pool = std::make_unique<WorkStealingPool>(threads);
+  }
+
+  SpatialQueryResults results;
+  for (auto _ : state) {
+    hash.query(std::span<const Shape>{shapes}, results, pool.get());
+    benchmark::DoNotOptimize(results.ids.data());
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(shapes.size()));
+  state.counters["hits_per_query"] = static_cast<double>(results.ids.size()) /
+                                     static_cast<double>(shapes.size());
+}
+
+static void BM_SpatialHashBoxQueries(benchmark::State &state) {
+  std::mt19937 rng{12};
+  std::uniform_real_distribution<float> pos{0.0f, kWorld - 64.0f};
+  std::vector<Aabb> boxes(10'000);
+  for (Aabb &b : boxes) {
+    const float x = pos(rng), y = pos(rng);
+    b = {x, y, x + 64.0f, y + 64.0f};
+  }
+  queryBatch(state, std::move(boxes));
+}
+BENCHMARK(BM_SpatialHashBoxQueries)
+    ->Arg(1)
+    ->Arg(4)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+static void BM_SpatialHashRangeQueries(benchmark::State &state) {
+  std::mt19937 rng{13};
+  std::uniform_real_distribution<float> pos{0.0f, kWorld};
+  std::vector<Circle> circles(10'000);
+  for (Circle &c : circles) {
+    c = {pos(rng), pos(rng), 32.0f};
+  }
+  queryBatch(state, std::move(circles));
+}
+BENCHMARK(BM_SpatialHashRangeQueries)
+    ->Arg(1)
+    ->Arg(4)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+// ---------------------------------------------------------------------------
+// Broadphase: every overlapping pair among the 100k objects
+// ---------------------------------------------------------------------------
+static void BM_SpatialHashPairs(benchmark::State &state) {
+  const Movers movers{kObjects};
+  const SpatialHash hash = build(movers);
+  std::vector<std::pair<uint32_t, uint32_t>> pairs;
+
+  for (auto _ : state) {
+    hash.pairs(pairs);
+    benchmark::DoNotOptimize(pairs.data());
+  }
+  state.counters["pairs"] = static_cast<double>(pairs.size());
+}
+BENCHMARK(BM_SpatialHashPairs)->Unit(benchmark::kMillisecond);
+
+// ---------------------------------------------------------------------------
+// Submitting the 100k objects as sprites to a 320x240 view of the world,
+// with culling = 1 through the index and culling = 0 submitting them all
+// ---------------------------------------------------------------------------
+static void BM_SpriteBatchCulled(benchmark::State &state) {
+  const bool cull = state.range(0) != 0;
+  const Movers movers{kObjects};
+  const SpatialHash hash = build(movers);
+  std::vector<Sprite> sprites;
+  for (const Aabb &b : movers.boxes) {
+    sprites.push_back({.x = b.min_x, .y = b.min_y, .width = kSize,
+                       .height = kSize});
+  }
+
+  std::unique_ptr<SpriteBatch> batch;
+  Window w{320,
+           240,
+           "Bench",
+           [&]() noexcept { batch = std::make_unique<SpriteBatch>(); },
+           [&]() noexcept {
+             glClear(GL_COLOR_BUFFER_BIT);
+             batch->begin(320.0f, 240.0f);
+             if (cull) {
+               batch->draw(sprites, hash);
+             } else {
+               batch->draw(sprites);
+             }
+             batch->end();
+           },
+           [&]() noexcept { batch.reset(); },
+           WindowOptions{.headless = true}};
+
+  for (auto _ : state) {
+    w.render();
+  }
+  state.counters["submitted"] = static_cast<double>(batch->stats().sprites);
+}
+BENCHMARK(BM_SpriteBatchCulled)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,127 @@
+#include <benchmark/benchmark.h>
+
+#include "atlas_packer.h"
+#include "texture_atlas.h"
+#include "tilemap.h"
+#include "window.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Packing a few thousand sprite-sized rectangles, one at a time and as a
+// known set
+// ---------------------------------------------------------------------------
+static std::vector<AtlasPacker::Size> randomSizes(size_t count) {
+  std::mt19937 rng{3};
+  std::uniform_int_distribution<uint32_t> side{4, 32};
+  std::vector<AtlasPacker::Size> sizes(count);
+  for (auto &size : sizes) {
+    size = {side(rng), side(rng)};
+  }
+  return sizes;
+}
+
+static void BM_AtlasPackOnline(benchmark::State &state) {
+  const auto sizes = randomSizes(static_cast<size_t>(state.range(0)));
+  double pages = 0.0;
+  for (auto _ : state) {
+    AtlasPacker packer{1024, 1024, 16};
+    for (const auto &size : sizes) {
+      benchmark::DoNotOptimize(packer.insert(size));
+    }
+    pages = packer.pages();
+  }
+  state.counters["pages"] = pages;
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AtlasPackOnline)->Arg(4000)->Unit(benchmark::kMillisecond);
+
+static void BM_AtlasPackOffline(benchmark::State &state) {
+  const auto sizes = randomSizes(static_cast<size_t>(state.range(0)));
+  double pages = 0.0;
+  for (auto _ : state) {
+    AtlasPacker packer{1024, 1024, 16};
+    benchmark::DoNotOptimize(packer.insertAll(sizes));
+    pages = packer.pages();
+  }
+  state.counters["pages"] = pages;
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AtlasPackOffline)->Arg(4000)->Unit(benchmark::kMillisecond);
+
+// ---------------------------------------------------------------------------
+// Scrolling a 1024x1024 map of 16x16 tiles across a 4:3 view of the given
+// width. With edits > 0, that many random tiles change every frame
+// ---------------------------------------------------------------------------
+static void BM_TilemapScroll(benchmark::State &state) {
+  constexpr size_t kMap = 1024;
+  constexpr size_t kTileTypes = 64;
+  const auto edits = static_cast<size_t>(state.range(0));
+  const auto width = static_cast<size_t>(state.range(1));
+  const size_t height = width * 3 / 4;
+  const auto view_width = static_cast<float>(width);
+  const auto view_height = static_cast<float>(height);
+
+  std::unique_ptr<TextureAtlas> atlas;
+  std::unique_ptr<Tilemap> map;
+  float camera_x = 0.0f, camera_y = 0.0f;
+
+  Window w{width,
+           height,
+           "Bench",
+           [&]() noexcept {
+             atlas = std::make_unique<TextureAtlas>(256, 256);
+             map = std::make_unique<Tilemap>(kMap, kMap, 16.0f, 16.0f);
+           },
+           [&]() noexcept {
+             glClear(GL_COLOR_BUFFER_BIT);
+             map->draw(*atlas, camera_x, camera_y, view_width, view_height);
+           },
+           [&]() noexcept {
+             map.reset();
+             atlas.reset();
+           },
+           WindowOptions{.headless = true}};
+
+  std::vector<uint32_t> pixels(16 * 16);
+  for (uint32_t t = 0; t < kTileTypes; ++t) {
+    std::fill(pixels.begin(), pixels.end(), 0xFF000000 | t * 0x030507);
+    atlas->add({.pixels = pixels, .width = 16, .height = 16});
+  }
+
+  std::mt19937 rng{5};
+  std::uniform_int_distribution<size_t> cell{0, kMap - 1};
+  std::uniform_int_distribution<uint16_t> type{1, kTileTypes};
+  for (size_t y = 0; y < kMap; ++y) {
+    for (size_t x = 0; x < kMap; ++x) {
+      map->setTile(x, y, type(rng));
+    }
+  }
+
+  /* Diagonal pan over the whole map */
+  const float extent = static_cast<float>(kMap) * 16.0f - view_width;
+  float t = 0.0f;
+  for (auto _ : state) {
+    for (size_t i = 0; i < edits; ++i) {
+      map->setTile(cell(rng), cell(rng), type(rng));
+    }
+    t += 3.0f;
+    camera_x = std::fmod(t, extent);
+    camera_y = std::fmod(t * 0.7f, extent);
+    w.render();
+  }
+  w.offscreen()->flush();
+
+  state.counters["chunks_drawn"] =
+      static_cast<double>(map->stats().chunks_drawn);
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TilemapScroll)
+    ->Args({0, 320})
+    ->Args({1000, 320})
+    ->Args({0, 1920})
+    ->Unit(benchmark::kMillisecond);
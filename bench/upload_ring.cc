@@ -0,0 +1,134 @@
+#include <benchmark/benchmark.h>
+
+#include "gl_extensions.h"
+#include "upload_ring.h"
+#include "window.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+constexpr const char *kStreamVertex = R"(#version 330 core
+layout (location = 0) in vec2 aPos;
+void main() { gl_Position = vec4(aPos, 0.0, 1.0); }
+)";
+
+constexpr const char *kStreamFragment = R"(#version 330 core
+out vec4 FragColor;
+void main() { FragColor = vec4(1.0, 0.5, 0.2, 1.0); }
+)";
+
+// ---------------------------------------------------------------------------
+// Streaming vertices for 256 small draws a frame, each in its own chunk of
+// the given size. 0 uploads each with glBufferData (orphaning), 1 streams
+// through an unsynchronized ring and 2 through a persistent one
+// ---------------------------------------------------------------------------
+static void BM_StreamFrame(benchmark::State &state) {
+  constexpr size_t kDraws = 256;
+  const auto method = state.range(0);
+  const auto chunk = static_cast<size_t>(state.range(1));
+
+  /* Triangles stacked in the bottom-left pixel, so fill rate stays out of
+   * the measurement */
+  std::vector<float> vertices(chunk / sizeof(float));
+  for (size_t i = 0; i + 1 < vertices.size(); i += 2) {
+    vertices[i] = i % 3 ? -0.999f : -1.0f;
+    vertices[i + 1] = i % 5 ? -0.999f : -1.0f;
+  }
+  const auto count = static_cast<GLsizei>(vertices.size() / 2 / 3 * 3);
+
+  std::unique_ptr<UploadRing> ring;
+  GLuint program = 0, vao = 0, vbo = 0;
+  bool supported = true;
+  Window w{64,
+           64,
+           "Bench",
+           [&]() noexcept {
+             const GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+             glShaderSource(vertex, 1, &kStreamVertex, nullptr);
+             glCompileShader(vertex);
+             const GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
+             glShaderSource(fragment, 1, &kStreamFragment, nullptr);
+             glCompileShader(fragment);
+             program = glCreateProgram();
+             glAttachShader(program, vertex);
+             glAttachShader(program, fragment);
+             glLinkProgram(program);
+             glDeleteShader(vertex);
+             glDeleteShader(fragment);
+             glGenVertexArrays(1, &vao);
+             glGenBuffers(1, &vbo);
+
+             if (method == 2 && !gl_extensions.buffer_storage) {
+               supported = false;
+             } else if (method != 0) {
+               ring = std::make_unique<UploadRing>(
+                   kDraws * (chunk + 16), 3,
+                   method == 1 ? UploadRing::Mode::Unsynchronized
+                               : UploadRing::Mode::Persistent);
+             }
+           },
+           [&]() noexcept {
+             glClear(GL_COLOR_BUFFER_BIT);
+             glUseProgram(program);
+             glBindVertexArray(vao);
+             glEnableVertexAttribArray(0);
+
+             if (!ring) {
+               glBindBuffer(GL_ARRAY_BUFFER, vbo);
+               glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+               for (size_t d = 0; d < kDraws; ++d) {
+                 glBufferData(GL_ARRAY_BUFFER,
+                              static_cast<GLsizeiptr>(chunk), vertices.data(),
+                              GL_STREAM_DRAW);
+                 glDrawArrays(GL_TRIANGLES, 0, count);
+               }
+               return;
+             }
+
+             /* Write the whole frame, flush once, then draw it */
+             GLintptr offsets[kDraws];
+             for (size_t d = 0; d < kDraws; ++d) {
+               const auto a = ring->allocate(UploadKind::Vertex, chunk);
+               std::memcpy(a.data, vertices.data(), chunk);
+               offsets[d] = a.offset;
+             }
+             ring->flush();
+             glBindBuffer(GL_ARRAY_BUFFER, ring->buffer());
+             for (size_t d = 0; d < kDraws; ++d) {
+               glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0,
+                                     reinterpret_cast<void *>(offsets[d]));
+               glDrawArrays(GL_TRIANGLES, 0, count);
+             }
+             ring->endFrame();
+           },
+           [&]() noexcept {
+             ring.reset();
+             glDeleteBuffers(1, &vbo);
+             glDeleteVertexArrays(1, &vao);
+             glDeleteProgram(program);
+           },
+           WindowOptions{.headless = true}};
+
+  if (!supported) {
+    state.SkipWithError("driver lacks ARB_buffer_storage");
+    return;
+  }
+
+  for (auto _ : state) {
+    w.render();
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(kDraws * chunk));
+  if (ring) {
+    const auto &stats = ring->stats();
+    state.counters["stalls"] = static_cast<double>(stats.stalls);
+    state.counters["stall_ms"] = static_cast<double>(stats.stall_ns) / 1e6;
+    state.counters["maps_per_frame"] =
+        static_cast<double>(stats.maps) /
+        static_cast<double>(state.iterations());
+  }
+}
+BENCHMARK(BM_StreamFrame)
+    ->ArgsProduct({{0, 1, 2}, {1 << 10, 16 << 10}})
+    ->Unit(benchmark::kMicrosecond);
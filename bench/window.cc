@@ -0,0 +1,256 @@
+#include <benchmark/benchmark.h>
+
+#include "sprite_batch.h"
+#include "window.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helper: create a window with vsync disabled so swaps don't cap the loop
+// ---------------------------------------------------------------------------
+static Window makeWindow(std::string_view title = "Bench") {
+  return Window{
+      64, 64, title, []() noexcept { glfwSwapInterval(0); },
+      []() noexcept {}, []() noexcept {}};
+}
+
+/* Reproduces the per-frame cost render() used to pay before the context
+ * and GLAD function tables were cached */
+static void legacyLoadContext(GLFWwindow *window) {
+  glfwMakeContextCurrent(window);
+  benchmark::DoNotOptimize(
+      gladLoadGLLoader((GLADloadproc)glfwGetProcAddress));
+}
+
+// ---------------------------------------------------------------------------
+// Context switching
+// ---------------------------------------------------------------------------
+static void BM_LegacyRenderOneWindow(benchmark::State &state) {
+  auto w = makeWindow();
+  GLFWwindow *handle = glfwGetCurrentContext();
+
+  for (auto _ : state) {
+    legacyLoadContext(handle);
+    glfwSwapBuffers(handle);
+  }
+
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_LegacyRenderOneWindow);
+
+static void BM_RenderOneWindow(benchmark::State &state) {
+  auto w = makeWindow();
+
+  for (auto _ : state) {
+    w.render();
+  }
+
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_RenderOneWindow);
+
+static void BM_LegacyRenderManyWindows(benchmark::State &state) {
+  std::vector<Window> windows;
+  std::vector<GLFWwindow *> handles;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    windows.push_back(makeWindow());
+    handles.push_back(glfwGetCurrentContext());
+  }
+
+  for (auto _ : state) {
+    for (auto *handle : handles) {
+      legacyLoadContext(handle);
+      glfwSwapBuffers(handle);
+    }
+  }
+
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_LegacyRenderManyWindows)->Arg(2)->Arg(4)->Arg(8);
+
+static void BM_RenderManyWindows(benchmark::State &state) {
+  std::vector<Window> windows;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    windows.push_back(makeWindow());
+  }
+
+  for (auto _ : state) {
+    for (auto &w : windows) {
+      w.render();
+    }
+  }
+
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_RenderManyWindows)->Arg(2)->Arg(4)->Arg(8);
+
+// ---------------------------------------------------------------------------
+// Lifecycle
+// ---------------------------------------------------------------------------
+/* Includes glfwInit/glfwTerminate since no other window is alive */
+static void BM_ConstructDestroyFirstWindow(benchmark::State &state) {
+  for (auto _ : state) {
+    Window w{64,
+             64,
+             "Bench",
+             []() noexcept {},
+             []() noexcept {},
+             []() noexcept {},
+             WindowOptions{.headless = true}};
+    benchmark::DoNotOptimize(w);
+  }
+}
+BENCHMARK(BM_ConstructDestroyFirstWindow)->Unit(benchmark::kMicrosecond);
+
+/* Keeps GLFW alive so only the window and context are created */
+static void BM_ConstructDestroyWindow(benchmark::State &state) {
+  auto keep_alive = makeWindow("KeepAlive");
+
+  for (auto _ : state) {
+    Window w{64,
+             64,
+             "Bench",
+             []() noexcept {},
+             []() noexcept {},
+             []() noexcept {},
+             WindowOptions{.headless = true}};
+    benchmark::DoNotOptimize(w);
+  }
+}
+BENCHMARK(BM_ConstructDestroyWindow)->Unit(benchmark::kMicrosecond);
+
+// ---------------------------------------------------------------------------
+// Empty frames
+// ---------------------------------------------------------------------------
+static void BM_EmptyFrameSwap(benchmark::State &state) {
+  auto w = makeWindow();
+
+  for (auto _ : state) {
+    w.render();
+  }
+
+  glFinish();
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_EmptyFrameSwap);
+
+/* Headless render + asynchronous readback of a 320x240 frame */
+static void BM_EmptyFrameHeadless(benchmark::State &state) {
+  Window w{320,
+           240,
+           "Bench",
+           []() noexcept {},
+           []() noexcept { glClear(GL_COLOR_BUFFER_BIT); },
+           []() noexcept {},
+           WindowOptions{.headless = true}};
+
+  for (auto _ : state) {
+    w.render();
+  }
+
+  w.offscreen()->flush();
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_EmptyFrameHeadless);
+
+// ---------------------------------------------------------------------------
+// On-demand rendering: a fill-heavy 640x480 scene (400 overlapping 128x128
+// translucent sprites) updated while idle, while animating, and with only a
+// small region damaged
+// ---------------------------------------------------------------------------
+struct FillScene {
+  std::unique_ptr<SpriteBatch> batch;
+  std::vector<Sprite> sprites;
+
+  void draw() noexcept {
+    glClear(GL_COLOR_BUFFER_BIT);
+    batch->begin(640.0f, 480.0f);
+    batch->draw(sprites);
+    batch->end();
+  }
+};
+
+static Window makeFillWindow(FillScene &scene, bool on_demand) {
+  std::mt19937 rng{7};
+  std::uniform_real_distribution<float> x{0.0f, 512.0f}, y{0.0f, 352.0f};
+  for (int i = 0; i < 400; ++i) {
+    scene.sprites.push_back({.x = x(rng),
+                             .y = y(rng),
+                             .width = 128,
+                             .height = 128,
+                             .color = Sprite::rgba(255, 255, 255, 64)});
+  }
+
+  return Window{640,
+                480,
+                "Bench",
+                [&scene]() noexcept {
+                  scene.batch = std::make_unique<SpriteBatch>(512);
+                },
+                [&scene]() noexcept { scene.draw(); },
+                [&scene]() noexcept { scene.batch.reset(); },
+                WindowOptions{.headless = true, .on_demand = on_demand}};
+}
+
+static void BM_UpdateContinuous(benchmark::State &state) {
+  FillScene scene;
+  auto w = makeFillWindow(scene, false);
+
+  for (auto _ : state) {
+    w.update();
+  }
+
+  w.offscreen()->flush();
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_UpdateContinuous)->Unit(benchmark::kMillisecond);
+
+/* The empty event stands in for the input that would wake a real loop */
+static void BM_UpdateOnDemandIdle(benchmark::State &state) {
+  FillScene scene;
+  auto w = makeFillWindow(scene, true);
+  w.update();
+
+  size_t frames = 0;
+  for (auto _ : state) {
+    glfwPostEmptyEvent();
+    frames += w.update();
+  }
+
+  state.counters["frames"] = static_cast<double>(frames);
+}
+BENCHMARK(BM_UpdateOnDemandIdle)->Unit(benchmark::kMicrosecond);
+
+/* Arg: side of the damaged square in pixels (0 = whole frame) */
+static void BM_UpdateOnDemandDamage(benchmark::State &state) {
+  const auto side = static_cast<int>(state.range(0));
+  FillScene scene;
+  auto w = makeFillWindow(scene, true);
+  w.update();
+
+  for (auto _ : state) {
+    if (side) {
+      w.invalidate(Window::Rect{288, 208, side, side});
+    } else {
+      w.invalidate();
+    }
+    w.update();
+  }
+
+  w.offscreen()->flush();
+  state.counters["fps"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_UpdateOnDemandDamage)
+    ->Arg(0)
+    ->Arg(64)
+    ->Unit(benchmark::kMillisecond);
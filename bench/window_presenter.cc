@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+
+#include "window_presenter.h"
+
+#include <memory>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helper: a plain window whose frame is a clear
+// ---------------------------------------------------------------------------
+static Window makeWindow() {
+  return Window{128,
+                128,
+                "Bench",
+                []() noexcept {},
+                []() noexcept {
+                  glClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+                  glClear(GL_COLOR_BUFFER_BIT);
+                },
+                []() noexcept {}};
+}
+
+static void reportFrames(benchmark::State &state) {
+  state.counters["fps"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+// ---------------------------------------------------------------------------
+// Baseline: every window renders with vsync on, back to back, so each swap
+// waits for its own vertical blank
+// ---------------------------------------------------------------------------
+static void BM_MultiWindowNaive(benchmark::State &state) {
+  std::vector<Window> windows;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    windows.push_back(makeWindow());
+    windows.back().setSwapInterval(1);
+  }
+
+  for (auto _ : state) {
+    for (auto &w : windows) {
+      w.render();
+    }
+  }
+  reportFrames(state);
+}
+BENCHMARK(BM_MultiWindowNaive)
+    ->ArgName("windows")
+    ->DenseRange(1, 8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// ---------------------------------------------------------------------------
+// Presenter: only the leader waits for vsync, on one thread or with each
+// window's context on its own thread
+// ---------------------------------------------------------------------------
+static void BM_MultiWindowPresenter(benchmark::State &state) {
+  const auto threading = state.range(1) ? WindowPresenter::Threading::PerWindow
+                                        : WindowPresenter::Threading::SingleThread;
+  WindowPresenter presenter{threading};
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    presenter.add(makeWindow());
+  }
+
+  for (auto _ : state) {
+    presenter.present();
+  }
+  reportFrames(state);
+}
+BENCHMARK(BM_MultiWindowPresenter)
+    ->ArgNames({"windows", "threaded"})
+    ->ArgsProduct({benchmark::CreateDenseRange(1, 8, 1), {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
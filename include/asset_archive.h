@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+/* Read-only view of a packed asset archive (.pak).
+ * The file is memory-mapped and never copied: opening it checks the header
+ * and the extent of the index, and find() binary-searches the index by
+ * name hash and returns a span straight into the mapping. Asset data is
+ * only paged in when something reads it.
+ *
+ * Layout (little-endian):
+ *   Header      magic "LRPK", version, entry count, index and name offsets
+ *   Data        each entry starts on a kAlignment boundary
+ *   Index       Entry records sorted by (name hash, name)
+ *   Names       entry names, concatenated
+ *
+ * Spans stay valid for the archive's lifetime. */
+class AssetArchive {
+public:
+  static constexpr size_t kAlignment = 16;
+
+  explicit AssetArchive(const std::filesystem::path &path);
+  ~AssetArchive();
+
+  AssetArchive(const AssetArchive &) = delete;
+  AssetArchive &operator=(const AssetArchive &) = delete;
+  AssetArchive(AssetArchive &&) = delete;
+  AssetArchive &operator=(AssetArchive &&) = delete;
+
+  /* Contents of the named entry, or nullopt if there is none (or the entry
+   * points outside the file) */
+  std::optional<std::span<const uint8_t>>
+  find(std::string_view name) const noexcept;
+
+  bool contains(std::string_view name) const noexcept;
+
+  /* Entry names in index order */
+  size_t size() const noexcept;
+  std::string_view name(size_t index) const noexcept;
+
+private:
+  struct Header;
+  struct Entry;
+
+  const uint8_t *data_{};
+  size_t length_{};
+  const Entry *entries_{};
+  size_t count_{};
+  const char *names_{};
+  size_t names_length_{};
+#ifdef _WIN32
+  void *file_{};
+  void *mapping_{};
+#endif
+
+  std::span<const uint8_t> bytes(const Entry &entry) const noexcept;
+  void unmap() noexcept;
+
+  friend class AssetArchiveBuilder;
+};
+
+/* Collects named blobs and writes them as an AssetArchive */
+class AssetArchiveBuilder {
+public:
+  /* Throws std::invalid_argument for an empty or duplicate name */
+  void add(std::string name, std::span<const uint8_t> data);
+
+  /* Read a file into the archive. Throws std::runtime_error if it can't be
+   * read */
+  void addFile(std::string name, const std::filesystem::path &path);
+
+  size_t size() const noexcept;
+
+  /* Write the archive (via a temporary file, renamed into place). Throws
+   * std::runtime_error on I/O failure */
+  void write(const std::filesystem::path &path) const;
+
+private:
+  struct Pending {
+    std::string name;
+    std::vector<uint8_t> data;
+  };
+
+  std::vector<Pending> entries_;
+  std::unordered_set<std::string> names_;
+};
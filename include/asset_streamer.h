@@ -0,0 +1,129 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include "thread_pool.h"
+#include "window.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Loads textures and buffers without stalling the render loop.
+ * File reads and decoding run on a ThreadPool. Decoded data goes to an
+ * upload thread that owns a context shared with the window; it copies the
+ * data into one of a fixed ring of pixel buffer objects (allocated once,
+ * reused for the streamer's lifetime), sources the texture or buffer from
+ * it, and fences the upload. status() polls that fence without blocking,
+ * so an asset becomes usable on the render side only once the GPU has the
+ * data. Assets too large for a ring slot upload straight from client
+ * memory, still on the upload thread.
+ * Construct and destroy on the thread that owns the window, with the
+ * window's context current (before starting or after stopping a
+ * RenderThread). load*(), status() and name() belong to the thread that
+ * renders with the window's context. */
+class AssetStreamer {
+public:
+  using Id = uint32_t;
+
+  enum class Status : uint8_t { Loading, Ready, Failed };
+
+  struct Stats {
+    uint64_t pbo_uploads{};
+    uint64_t direct_uploads{};
+    uint64_t bytes_uploaded{};
+    uint64_t failed{};
+  };
+
+  static constexpr size_t kPboCount = 4;
+  static constexpr size_t kPboSize = 4 << 20;
+
+  /* io_threads = 0 uses one reader per hardware thread */
+  explicit AssetStreamer(const Window &window, size_t io_threads = 2,
+                         size_t capacity = 4096);
+  ~AssetStreamer();
+
+  AssetStreamer(const AssetStreamer &) = delete;
+  AssetStreamer &operator=(const AssetStreamer &) = delete;
+  AssetStreamer(AssetStreamer &&) = delete;
+  AssetStreamer &operator=(AssetStreamer &&) = delete;
+
+  /* Queue a binary PPM (P6, 8-bit) image as an RGBA8 texture with nearest
+   * filtering. Rows keep file order, so the first row is at t = 0 */
+  Id loadTexture(std::filesystem::path path);
+
+  /* Queue a file's raw contents as a GL_STATIC_DRAW buffer object */
+  Id loadBuffer(std::filesystem::path path);
+
+  /* Never blocks. Loading becomes Ready once the upload's fence has
+   * signaled */
+  Status status(Id id) noexcept;
+
+  /* GL name, or 0 until status() has returned Ready */
+  GLuint name(Id id) const noexcept;
+
+  /* Texture size in pixels (0 for buffers) and uploaded size in bytes */
+  size_t width(Id id) const noexcept;
+  size_t height(Id id) const noexcept;
+  size_t bytes(Id id) const noexcept;
+
+  /* Block until every queued asset has been uploaded or has failed */
+  void finish();
+
+  Stats stats() const noexcept;
+
+private:
+  enum class State : uint8_t { Reading, Uploading, Fenced, Ready, Failed };
+  enum class Kind : uint8_t { Texture, Buffer };
+
+  struct Asset {
+    Kind kind{};
+    std::filesystem::path path;
+    std::vector<uint8_t> data;
+    size_t width{};
+    size_t height{};
+    size_t bytes{};
+    GLuint name{};
+    GLsync fence{};
+    std::atomic<State> state{State::Reading};
+  };
+
+  std::unique_ptr<Asset[]> assets_;
+  size_t capacity_;
+  size_t count_{};
+
+  Window::SharedContext context_;
+  std::array<GLuint, kPboCount> pbos_{};
+  std::array<GLsync, kPboCount> pbo_fences_{};
+  size_t next_pbo_{};
+
+  std::mutex mutex_;
+  std::condition_variable pending_;
+  std::condition_variable idle_;
+  std::deque<Id> uploads_;
+  size_t in_flight_{};
+  bool stopping_{};
+
+  std::atomic<uint64_t> pbo_uploads_{};
+  std::atomic<uint64_t> direct_uploads_{};
+  std::atomic<uint64_t> bytes_uploaded_{};
+  std::atomic<uint64_t> failed_{};
+
+  std::thread uploader_;
+  std::unique_ptr<ThreadPool> io_;
+
+  Id enqueue(Kind kind, std::filesystem::path path);
+  void read(Id id) noexcept;
+  void uploadLoop() noexcept;
+  void upload(Asset &asset) noexcept;
+  void complete(Asset &asset, State state) noexcept;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+/* Skyline bottom-left rectangle packer over a stack of equally sized
+ * pages, e.g. the layers of a texture array.
+ * Each page keeps its skyline: the top edge of everything placed so far,
+ * as a list of horizontal segments. A rectangle goes wherever its top ends
+ * up lowest (ties to the leftmost spot) across the open pages, and a new
+ * page opens only when none of them has room. insert() packs online, one
+ * rectangle at a time; insertAll() packs a known set offline, tallest
+ * first, which wastes less space. Purely CPU-side. */
+class AtlasPacker {
+public:
+  struct Size {
+    uint32_t width{};
+    uint32_t height{};
+  };
+
+  struct Placement {
+    uint32_t x{};
+    uint32_t y{};
+    uint32_t page{};
+  };
+
+  /* Throws std::invalid_argument if any dimension is zero */
+  AtlasPacker(uint32_t page_width, uint32_t page_height,
+              uint32_t max_pages = 1);
+
+  /* Nothing if the rectangle is empty, larger than a page, or there is no
+   * room left in max_pages pages */
+  std::optional<Placement> insert(Size size);
+
+  /* Placements in input order */
+  std::vector<std::optional<Placement>> insertAll(std::span<const Size> sizes);
+
+  uint32_t pageWidth() const noexcept;
+  uint32_t pageHeight() const noexcept;
+  uint32_t maxPages() const noexcept;
+  uint32_t pages() const noexcept;
+
+  /* Fraction of the open pages' area covered by placed rectangles */
+  double occupancy() const noexcept;
+
+private:
+  struct Segment {
+    uint32_t x{};
+    uint32_t y{};
+    uint32_t width{};
+  };
+
+  uint32_t page_width_;
+  uint32_t page_height_;
+  uint32_t max_pages_;
+  uint64_t used_area_{};
+  std::vector<std::vector<Segment>> skylines_;
+
+  /* Top of a rectangle of `width` resting on the skyline at segment
+   * `index`, or nothing if it would leave the page */
+  std::optional<uint32_t> fit(const std::vector<Segment> &skyline,
+                              size_t index, Size size) const noexcept;
+  void place(std::vector<Segment> &skyline, size_t index, Placement at,
+             Size size);
+};
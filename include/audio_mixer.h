@@ -0,0 +1,233 @@
+#pragma once
+
+#include "mpsc_queue.h"
+#include "span_kernels.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <span>
+#include <thread>
+#include <vector>
+
+/* Output format. Audio is always interleaved stereo float in [-1, 1]; a
+ * period is the block the mixer produces per write, and the device buffers
+ * `periods` of them (so output latency is periods * period_frames) */
+struct AudioFormat {
+  uint32_t sample_rate{48000};
+  uint32_t period_frames{256};
+  uint32_t periods{3};
+};
+
+/* Where mixed periods go. write() is called from the mixer thread with one
+ * period of interleaved stereo frames and may block until the device wants
+ * more, which is what paces the mixer. It must not allocate */
+class AudioSink {
+public:
+  virtual ~AudioSink() = default;
+
+  virtual AudioFormat format() const noexcept = 0;
+  virtual void write(std::span<const float> frames) noexcept = 0;
+
+  /* Periods that arrived after the device needed them */
+  virtual uint64_t underruns() const noexcept { return 0; }
+};
+
+/* Discards audio. Paced, it behaves like a device buffering
+ * format.periods periods: write() blocks until a period frees up, and a
+ * period written after it should have started playing counts as an
+ * underrun (the clock then restarts from the late period). Unpaced,
+ * write() returns at once */
+class NullAudioSink final : public AudioSink {
+public:
+  explicit NullAudioSink(AudioFormat format = {}, bool paced = false);
+
+  AudioFormat format() const noexcept override;
+  void write(std::span<const float> frames) noexcept override;
+  uint64_t underruns() const noexcept override;
+
+  uint64_t periods() const noexcept;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  AudioFormat format_;
+  bool paced_;
+  Clock::duration period_{};
+  Clock::time_point start_{};
+  uint64_t written_{};
+  std::atomic<uint64_t> periods_{};
+  std::atomic<uint64_t> underruns_{};
+};
+
+/* Writes 16-bit PCM stereo to a WAV file as fast as the mixer produces it,
+ * for offline renders and tests. The header's sizes are patched when the
+ * sink is destroyed */
+class WavFileSink final : public AudioSink {
+public:
+  /* Throws std::runtime_error if the file can't be created */
+  WavFileSink(const std::filesystem::path &path, AudioFormat format = {});
+  ~WavFileSink() override;
+
+  WavFileSink(const WavFileSink &) = delete;
+  WavFileSink &operator=(const WavFileSink &) = delete;
+  WavFileSink(WavFileSink &&) = delete;
+  WavFileSink &operator=(WavFileSink &&) = delete;
+
+  AudioFormat format() const noexcept override;
+  void write(std::span<const float> frames) noexcept override;
+
+private:
+  AudioFormat format_;
+  std::FILE *file_{};
+  uint64_t data_bytes_{};
+  std::vector<int16_t> pcm_;
+};
+
+/* Mono sample data at its own rate. The samples are not copied: they must
+ * outlive every voice playing them */
+struct AudioClip {
+  std::span<const float> samples;
+  uint32_t sample_rate{48000};
+};
+
+/* Pan is -1 (left) to 1 (right) with a constant-power law; pitch scales
+ * the playback rate */
+struct VoiceParams {
+  float volume{1.0f};
+  float pan{0.0f};
+  float pitch{1.0f};
+  bool loop{false};
+};
+
+/* Handle to a playing voice; 0 is never a valid voice */
+using VoiceId = uint32_t;
+
+struct AudioStats {
+  uint64_t periods{};
+  uint64_t underruns{};
+
+  /* Commands lost to a full ring, and voices cut off to make room */
+  uint64_t dropped_commands{};
+  uint64_t stolen_voices{};
+
+  double last_mix_us{};
+  double max_mix_us{};
+};
+
+/* Mixes voices into an AudioSink on a real-time thread.
+ * Game threads send play/stop/set commands through a fixed MpscQueue,
+ * so sending never blocks or allocates; the mixer applies everything
+ * pending at the start of each period. Voice storage, the mix buffer and
+ * the command ring are all allocated up front, so mixing a period never
+ * allocates. Each voice is resampled with linear interpolation, scaled by
+ * its pan gains and accumulated into the period by SIMD kernels (AVX2 when
+ * the CPU has it, like span_kernels.h); every instruction set gives
+ * bit-identical output.
+ * Any number of threads may send commands. Commands from one thread are
+ * applied in the order sent. The mixer's drain is wait-free; sending is
+ * lock-free, since senders claim ring slots with a compare-exchange and
+ * may retry under contention (a bounded ring that rejects sends when full
+ * can't hand out fetch_add tickets). */
+class AudioMixer {
+public:
+  static constexpr size_t kCommandCapacity = 1024;
+
+  /* The sink must outlive the mixer. Throws std::invalid_argument for zero
+   * voices or an empty period */
+  explicit AudioMixer(AudioSink &sink, size_t max_voices = 64);
+
+  /* Stops the thread */
+  ~AudioMixer();
+
+  AudioMixer(const AudioMixer &) = delete;
+  AudioMixer &operator=(const AudioMixer &) = delete;
+  AudioMixer(AudioMixer &&) = delete;
+  AudioMixer &operator=(AudioMixer &&) = delete;
+
+  /* Mix and write periods on a dedicated thread until stop(). The thread
+   * asks for real-time scheduling and carries on without it if refused */
+  void start();
+  void stop() noexcept;
+  bool running() const noexcept;
+
+  /* Mix out.size() / 2 frames on the calling thread, for offline use while
+   * the thread isn't running. Doesn't write to the sink */
+  void mix(std::span<float> out) noexcept;
+
+  /* Command side. play() returns 0 if the command was dropped; commands
+   * for voices that already ended are ignored */
+  VoiceId play(const AudioClip &clip, const VoiceParams &params = {}) noexcept;
+  bool stop(VoiceId voice) noexcept;
+  bool set(VoiceId voice, const VoiceParams &params) noexcept;
+  bool setMasterVolume(float volume) noexcept;
+
+  /* Voices playing as of the last mixed period; safe from any thread */
+  size_t activeVoices() const noexcept;
+  size_t maxVoices() const noexcept;
+  AudioStats stats() const noexcept;
+
+  /* Kernel instruction set. Requests the CPU can't run fall back to the
+   * best supported one, which is returned. Not thread-safe: call while the
+   * thread is stopped */
+  SpanIsa isa() const noexcept;
+  SpanIsa setIsa(SpanIsa isa) noexcept;
+
+private:
+  struct Command {
+    enum class Type : uint8_t { Play, Stop, Set, Master };
+
+    Type type{};
+    VoiceId voice{};
+    AudioClip clip{};
+    VoiceParams params{};
+  };
+
+  struct Voice {
+    VoiceId id{};
+    AudioClip clip{};
+    VoiceParams params{};
+    double position{};
+    double step{};
+    float left{};
+    float right{};
+  };
+
+  using Resample = void (*)(float *out, const float *src, size_t readable,
+                            size_t count, float frac, float step, float left,
+                            float right) noexcept;
+  using Finish = void (*)(float *out, size_t count, float gain) noexcept;
+
+  AudioSink &sink_;
+  AudioFormat format_;
+  std::vector<Voice> voices_;
+  size_t active_{};
+  float master_{1.0f};
+  std::vector<float> period_;
+  SpanIsa isa_{};
+  Resample resample_{};
+  Finish finish_{};
+
+  /* Producer side, shared by every sending thread */
+  std::atomic<VoiceId> next_id_{1};
+  MpscQueue<Command, kCommandCapacity> commands_;
+
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> running_{false};
+  std::atomic<size_t> active_snapshot_{};
+  std::atomic<uint64_t> periods_{};
+  std::atomic<uint64_t> dropped_{};
+  std::atomic<uint64_t> stolen_{};
+  std::atomic<int64_t> last_mix_ns_{};
+  std::atomic<int64_t> max_mix_ns_{};
+  std::thread thread_;
+
+  bool send(const Command &command) noexcept;
+  void apply(const Command &command) noexcept;
+  /* False once a one-shot voice has played to the end */
+  bool mixVoice(Voice &voice, float *out, size_t frames) noexcept;
+  void run() noexcept;
+};
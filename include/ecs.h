@@ -0,0 +1,245 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/* Handle to an entity. The generation changes whenever an index is
+ * reused, so handles to destroyed entities stay invalid */
+struct Entity {
+  uint32_t index{};
+  uint32_t generation{};
+
+  friend bool operator==(Entity, Entity) = default;
+};
+
+/* Bit i set = component type with id i */
+using ComponentMask = uint64_t;
+
+/* Components are plain data: they are moved between chunks with memcpy
+ * and never destroyed */
+template <typename T>
+concept Component =
+    std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>;
+
+namespace ecs_detail {
+constexpr size_t kMaxComponents = 64;
+
+struct ComponentInfo {
+  size_t size{};
+  size_t alignment{};
+};
+
+/* Throws std::length_error past kMaxComponents types */
+uint32_t registerComponent(size_t size, size_t alignment);
+const ComponentInfo &componentInfo(uint32_t id) noexcept;
+} // namespace ecs_detail
+
+/* Process-wide id of a component type, assigned on first use */
+template <Component T> uint32_t componentId() {
+  static const uint32_t id =
+      ecs_detail::registerComponent(sizeof(T), alignof(T));
+  return id;
+}
+
+template <typename... C> ComponentMask componentMask() {
+  return (ComponentMask{0} | ... |
+          (ComponentMask{1} << componentId<std::remove_const_t<C>>()));
+}
+
+/* Entities with exactly the same component types, stored in fixed-size
+ * chunks. Inside a chunk every component type is one contiguous,
+ * cache-line aligned array (structure of arrays), so systems stream
+ * through exactly the columns they touch */
+class Archetype {
+public:
+  static constexpr size_t kChunkBytes = 16 * 1024;
+
+  explicit Archetype(ComponentMask mask);
+  ~Archetype();
+
+  Archetype(const Archetype &) = delete;
+  Archetype &operator=(const Archetype &) = delete;
+  Archetype(Archetype &&) = delete;
+  Archetype &operator=(Archetype &&) = delete;
+
+  ComponentMask mask() const noexcept;
+  size_t size() const noexcept;
+  size_t chunkCapacity() const noexcept;
+  size_t chunkCount() const noexcept;
+
+  /* Live entities in chunk i */
+  size_t chunkSize(size_t chunk) const noexcept;
+
+  /* Column of component `id` in chunk i (the id must be in the mask) */
+  std::byte *column(size_t chunk, uint32_t id) const noexcept;
+  Entity *entities(size_t chunk) const noexcept;
+
+  /* Row of a new entity; its components are left uninitialized */
+  size_t push(Entity entity);
+
+  /* Swap-remove: the last row moves into `row`. Returns the entity that
+   * was last, which now lives at `row` unless it was the one erased */
+  Entity erase(size_t row) noexcept;
+
+  /* Address of component `id` at `row` */
+  std::byte *at(size_t row, uint32_t id) const noexcept;
+
+private:
+  ComponentMask mask_;
+  size_t capacity_{};
+  size_t chunk_bytes_{};
+  size_t size_{};
+  std::array<uint32_t, ecs_detail::kMaxComponents> offsets_{};
+  std::vector<std::byte *> chunks_;
+};
+
+/* One chunk of an archetype, as handed to systems */
+struct ChunkView {
+  Archetype *archetype{};
+  size_t chunk{};
+
+  size_t size() const noexcept { return archetype->chunkSize(chunk); }
+
+  template <typename T> T *column() const {
+    return reinterpret_cast<T *>(
+        archetype->column(chunk, componentId<std::remove_const_t<T>>()));
+  }
+};
+
+/* Entity-component store.
+ * Each distinct set of component types gets an Archetype; adding or
+ * removing a component moves the entity's data to the matching one.
+ * Queries visit whole chunks, handing the callback one pointer per
+ * requested component, which is the layout SIMD loops want. Structural
+ * changes (create, destroy, add, remove) must not happen while a query or
+ * SystemSchedule::run() is iterating. */
+class World {
+public:
+  World() = default;
+  ~World() = default;
+
+  World(const World &) = delete;
+  World &operator=(const World &) = delete;
+  World(World &&) = delete;
+  World &operator=(World &&) = delete;
+
+  template <Component... C> Entity create(const C &...components) {
+    const ComponentMask mask = componentMask<C...>();
+    if (std::popcount(mask) != static_cast<int>(sizeof...(C))) {
+      throwDuplicate();
+    }
+    const Entity entity = allocate(mask);
+    const Record &record = records_[entity.index];
+    Archetype &archetype = *archetypes_[record.archetype];
+    ((new (archetype.at(record.row, componentId<C>())) C(components)), ...);
+    return entity;
+  }
+
+  /* Destroying a dead handle does nothing */
+  void destroy(Entity entity) noexcept;
+
+  bool alive(Entity entity) const noexcept;
+
+  /* Live entities */
+  size_t size() const noexcept;
+
+  /* nullptr if the entity is dead or lacks the component */
+  template <Component T> T *get(Entity entity) {
+    if (!alive(entity)) {
+      return nullptr;
+    }
+    const Record &record = records_[entity.index];
+    Archetype &archetype = *archetypes_[record.archetype];
+    const uint32_t id = componentId<T>();
+    if (!(archetype.mask() & (ComponentMask{1} << id))) {
+      return nullptr;
+    }
+    return reinterpret_cast<T *>(archetype.at(record.row, id));
+  }
+
+  template <Component T> bool has(Entity entity) const {
+    return maskOf(entity) & (ComponentMask{1} << componentId<T>());
+  }
+
+  /* Add or overwrite a component. Throws std::invalid_argument for a dead
+   * entity */
+  template <Component T> void add(Entity entity, const T &value) {
+    if (T *existing = get<T>(entity)) {
+      *existing = value;
+      return;
+    }
+    if (!alive(entity)) {
+      throwDead();
+    }
+    move(entity, maskOf(entity) | (ComponentMask{1} << componentId<T>()));
+    new (get<T>(entity)) T(value);
+  }
+
+  /* Removing a missing component does nothing */
+  template <Component T> void remove(Entity entity) {
+    if (!get<T>(entity)) {
+      return;
+    }
+    move(entity, maskOf(entity) & ~(ComponentMask{1} << componentId<T>()));
+  }
+
+  /* f(count, C *...) once per non-empty chunk holding every C. Const
+   * components come in as const pointers */
+  template <typename... C, typename F> void eachChunk(F &&f) {
+    const ComponentMask mask = componentMask<C...>();
+    for (const auto &archetype : archetypes_) {
+      if ((archetype->mask() & mask) != mask) {
+        continue;
+      }
+      for (size_t chunk = 0; chunk < archetype->chunkCount(); ++chunk) {
+        const ChunkView view{archetype.get(), chunk};
+        if (const size_t count = view.size()) {
+          f(count, view.column<C>()...);
+        }
+      }
+    }
+  }
+
+  /* f(C &...) once per entity holding every C */
+  template <typename... C, typename F> void each(F &&f) {
+    eachChunk<C...>([&f](size_t count, C *...columns) {
+      for (size_t i = 0; i < count; ++i) {
+        f(columns[i]...);
+      }
+    });
+  }
+
+  /* Append every non-empty chunk whose archetype holds all of `mask` */
+  void chunks(ComponentMask mask, std::vector<ChunkView> &out) const;
+
+  size_t archetypeCount() const noexcept;
+
+private:
+  struct Record {
+    uint32_t archetype{};
+    uint32_t generation{};
+    size_t row{};
+    bool alive{};
+  };
+
+  std::vector<std::unique_ptr<Archetype>> archetypes_;
+  std::unordered_map<ComponentMask, uint32_t> archetype_index_;
+  std::vector<Record> records_;
+  std::vector<uint32_t> free_;
+  size_t alive_{};
+
+  ComponentMask maskOf(Entity entity) const noexcept;
+  uint32_t archetype(ComponentMask mask);
+  Entity allocate(ComponentMask mask);
+  void move(Entity entity, ComponentMask mask);
+  void relocate(Entity moved, size_t row) noexcept;
+  [[noreturn]] static void throwDuplicate();
+  [[noreturn]] static void throwDead();
+};
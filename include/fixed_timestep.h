@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* Fixed-timestep clock for simulation loops.
+ * advance() turns elapsed wall time into a whole number of simulation
+ * steps and carries the remainder to the next call, so the simulation
+ * always integrates with the same dt no matter how irregular the loop is.
+ * Times are monotonic seconds, e.g. glfwGetTime(). */
+class FixedTimestep {
+public:
+  /* A stall longer than max_steps steps is dropped instead of being
+   * caught up in one burst */
+  explicit FixedTimestep(double step_seconds, size_t max_steps = 8);
+
+  /* Number of steps due at `now`. The first call only starts the clock */
+  size_t advance(double now) noexcept;
+
+  /* Seconds until the next step is due at `now` (0 if already due) */
+  double untilNext(double now) const noexcept;
+
+  /* Fraction of a step accumulated but not yet simulated, for
+   * interpolating between the last two simulated states */
+  double alpha() const noexcept;
+
+  double step() const noexcept;
+  uint64_t steps() const noexcept;
+
+private:
+  double step_;
+  size_t max_steps_;
+  double last_{};
+  double accumulator_{};
+  uint64_t steps_{};
+  bool started_{};
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+/* Bump allocator over one fixed block. Individual allocations are never
+ * freed; reset() releases everything at once */
+class LinearArena {
+public:
+  explicit LinearArena(size_t capacity);
+
+  /* nullptr when the block can't fit the request */
+  void *allocate(size_t bytes, size_t alignment) noexcept;
+  void reset() noexcept;
+
+  size_t used() const noexcept;
+  size_t capacity() const noexcept;
+
+private:
+  std::unique_ptr<std::byte[]> buffer_;
+  size_t capacity_;
+  size_t offset_{};
+};
+
+/* Memory resource for transient per-frame data, e.g.
+ *   std::pmr::vector<Sprite> sprites{window.frameArena()};
+ * Allocations come from one of two LinearArenas. endFrame() switches
+ * arenas and resets the one being switched to, so memory allocated during
+ * frame N stays valid through frame N + 1 (long enough for the GPU to
+ * consume it) and is reclaimed at the end of frame N + 1. Requests the
+ * current arena can't fit fall back to the upstream resource and are freed
+ * when their arena resets; lastFrame().overflows reports them so the arena
+ * can be sized up. deallocate() is a no-op.
+ * Not thread-safe: use it from the thread that renders. */
+class FrameArena : public std::pmr::memory_resource {
+public:
+  struct Stats {
+    uint64_t allocations{};
+    uint64_t bytes{};
+    uint64_t overflows{};
+
+    /* Heap allocations made by the thread calling endFrame() since the
+     * previous endFrame(). Only counted with LIBRETRO_COUNT_ALLOCATIONS */
+    uint64_t heap_allocations{};
+  };
+
+  explicit FrameArena(
+      size_t bytes_per_frame,
+      std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+  ~FrameArena() override;
+
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+  FrameArena(FrameArena &&) = delete;
+  FrameArena &operator=(FrameArena &&) = delete;
+
+  /* O(1) unless the incoming arena holds overflow blocks */
+  void endFrame() noexcept;
+
+  /* Counters for the frame most recently ended */
+  const Stats &lastFrame() const noexcept;
+
+  size_t bytesPerFrame() const noexcept;
+
+private:
+  /* Header of a block taken from upstream, freed on its arena's reset */
+  struct Overflow {
+    Overflow *next;
+    size_t bytes;
+    size_t alignment;
+  };
+
+  LinearArena arenas_[2];
+  Overflow *overflows_[2]{};
+  size_t current_{};
+  std::pmr::memory_resource *upstream_;
+  Stats frame_{};
+  Stats last_frame_{};
+  uint64_t heap_mark_{};
+
+  void *do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override;
+
+  void release(size_t arena) noexcept;
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Opt-in per-frame timing for Window::render().
+ * CPU time is sampled around each stage of a frame, GPU time is measured
+ * with GL_TIME_ELAPSED queries. Queries live in a small ring and are only
+ * read back once the driver reports them available, so profiling never
+ * stalls the pipeline. All GL work must happen with the owning window's
+ * context current. */
+class FrameProfiler {
+public:
+  enum class Stage : size_t { Context, Render, Swap, Count };
+
+  struct Percentiles {
+    double p50{};
+    double p95{};
+    double p99{};
+  };
+
+  struct ScopeStats {
+    std::string name;
+    Percentiles ms;
+  };
+
+  struct Stats {
+    size_t frames{};
+    Percentiles cpu_ms;
+    Percentiles gpu_ms;
+    std::array<Percentiles, static_cast<size_t>(Stage::Count)> stage_ms;
+    std::vector<ScopeStats> scopes;
+  };
+
+  static constexpr size_t kQueryRingSize = 4;
+
+  explicit FrameProfiler(size_t history = 1024);
+  ~FrameProfiler();
+
+  FrameProfiler(const FrameProfiler &) = delete;
+  FrameProfiler &operator=(const FrameProfiler &) = delete;
+  FrameProfiler(FrameProfiler &&) = delete;
+  FrameProfiler &operator=(FrameProfiler &&) = delete;
+
+  /* Frame bracketing, driven by Window::render() */
+  void beginFrame() noexcept;
+  void mark(Stage stage) noexcept;
+  void beginGpu() noexcept;
+  void endGpu() noexcept;
+  void endFrame() noexcept;
+
+  /* Named user scopes, e.g. around a subsystem inside the render callback.
+   * Scopes may nest; each records its CPU duration per call */
+  void beginScope(std::string_view name);
+  void endScope() noexcept;
+
+  Stats stats() const;
+  size_t frameCount() const noexcept;
+
+  /* One row per recorded frame (CSV) or a summary of stats() (JSON) */
+  void writeCsv(std::ostream &out) const;
+  void writeJson(std::ostream &out) const;
+
+  class Scope {
+  public:
+    Scope(FrameProfiler *profiler, std::string_view name)
+        : profiler_{profiler} {
+      if (profiler_) {
+        profiler_->beginScope(name);
+      }
+    }
+    ~Scope() {
+      if (profiler_) {
+        profiler_->endScope();
+      }
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    FrameProfiler *profiler_;
+  };
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct FrameRecord {
+    uint64_t frame{};
+    double cpu_ms{};
+    double gpu_ms{-1.0};
+    std::array<double, static_cast<size_t>(Stage::Count)> stage_ms{};
+  };
+
+  struct ScopeSamples {
+    std::string name;
+    std::vector<double> ms;
+    size_t count{};
+  };
+
+  struct PendingQuery {
+    GLuint id{};
+    uint64_t frame{};
+  };
+
+  size_t history_;
+  std::vector<FrameRecord> records_;
+  uint64_t frame_{};
+  Clock::time_point frame_start_{};
+  Clock::time_point last_mark_{};
+
+  std::array<PendingQuery, kQueryRingSize> queries_{};
+  uint64_t query_head_{};
+  uint64_t query_tail_{};
+  bool query_active_{};
+
+  std::vector<ScopeSamples> scopes_;
+  std::vector<std::pair<size_t, Clock::time_point>> scope_stack_;
+
+  void collectQueries() noexcept;
+  size_t recordedFrames() const noexcept;
+  static Percentiles percentiles(std::vector<double> samples);
+};
@@ -0,0 +1,173 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+/* Records GL calls into a compact binary stream for GLReplay.
+ * While a capture exists, the GLAD entry points the engine uses point at
+ * hooks that append the call (opcode, arguments, and any client memory it
+ * reads: buffer and texture uploads, mapped writes, shader sources) and
+ * then forward to the driver. Calls are recorded from one thread at a
+ * time: the one that created the capture, until another thread attach()es.
+ * Calls from any other thread pass straight through. RenderThread and
+ * WindowPresenter's render threads attach when they start, so the
+ * recording follows the context onto them.
+ * Window::render() brackets every frame with beginFrame()/endFrame(), so
+ * the stream splits into setup (everything before the first frame) and
+ * frames. Create the capture before the window to record the window's own
+ * objects too; objects created before the capture replay as unresolved.
+ *
+ * Stream layout (little-endian):
+ *   Header      magic "LRGC", version
+ *   Records     opcode (u16), payload length (u32), payload
+ *
+ * Only one capture may exist at a time. Create and destroy it while no
+ * other thread is issuing GL calls, since installing the hooks rewrites
+ * process-wide function pointers. */
+class GLCapture {
+public:
+  struct Stats {
+    size_t calls{};
+    size_t frames{};
+    size_t upload_bytes{};
+  };
+
+  /* Throws std::logic_error if another capture exists. Hooks go in now if
+   * GL is loaded, otherwise when the first window loads it */
+  GLCapture();
+  ~GLCapture();
+
+  GLCapture(const GLCapture &) = delete;
+  GLCapture &operator=(const GLCapture &) = delete;
+  GLCapture(GLCapture &&) = delete;
+  GLCapture &operator=(GLCapture &&) = delete;
+
+  /* Restore the driver entry points. The recorded stream stays available */
+  void stop() noexcept;
+  bool recording() const noexcept;
+
+  const Stats &stats() const noexcept;
+  std::span<const uint8_t> data() const noexcept;
+
+  /* Throws std::runtime_error if the file can't be written */
+  void save(const std::filesystem::path &path) const;
+
+  /* Record the calling thread's GL calls into the active capture instead of
+   * the thread's that recorded so far; a no-op without one. With several
+   * render threads, the last to attach records. detach() stops recording
+   * this thread's calls */
+  static void attach() noexcept;
+  static void detach() noexcept;
+
+  /* Frame markers. No-ops unless a capture is recording on this thread */
+  static void beginFrame() noexcept;
+  static void endFrame() noexcept;
+
+  /* Point the entry points back at the hooks after GLAD reloaded them */
+  static void reattach() noexcept;
+
+private:
+  std::vector<uint8_t> data_;
+  Stats stats_{};
+  bool recording_{};
+
+  /* Identifies the thread recording into this capture */
+  std::atomic<const void *> owner_{};
+
+  /* Writable buffer mappings by target. Explicitly flushed mappings are
+   * copied into the stream a flushed range at a time, the rest on unmap */
+  struct Mapping {
+    std::span<const uint8_t> bytes;
+    bool flush_explicit{};
+  };
+  std::unordered_map<GLenum, Mapping> mapped_;
+
+  friend struct GLCallTable;
+};
+
+/* Re-executes a GLCapture stream on the current context.
+ * Object names, uniform locations and syncs are remapped to the ones the
+ * replay creates. Names the stream never created resolve to 0, except
+ * framebuffers, which resolve to framebuffer(): a capture that started
+ * after its window existed draws into whatever target the replay host
+ * chooses. Uploads and mapped writes are replayed from the recorded bytes,
+ * so a frame costs the same GL work it did live without any of the CPU
+ * work that produced it.
+ * Construct, replay and destroy with the same context current. */
+class GLReplay {
+public:
+  struct Stats {
+    size_t calls{};
+    size_t unresolved{};
+  };
+
+  /* Throws std::invalid_argument if the stream is malformed or from another
+   * version */
+  explicit GLReplay(std::vector<uint8_t> data);
+
+  /* Also throws std::runtime_error if the file can't be read */
+  explicit GLReplay(const std::filesystem::path &path);
+
+  /* Deletes every object the replay created */
+  ~GLReplay();
+
+  GLReplay(const GLReplay &) = delete;
+  GLReplay &operator=(const GLReplay &) = delete;
+  GLReplay(GLReplay &&) = delete;
+  GLReplay &operator=(GLReplay &&) = delete;
+
+  /* Target for framebuffer 0 and framebuffers created before the capture */
+  void setFramebuffer(GLuint framebuffer) noexcept;
+  GLuint framebuffer() const noexcept;
+
+  /* Run everything recorded before the first frame. Call once */
+  void setup() noexcept;
+
+  /* Frames can be replayed any number of times, in any order. Calls made
+   * between two frames belong to the later one; calls after the last frame
+   * are dropped. Throws std::out_of_range for a bad index */
+  size_t frameCount() const noexcept;
+  void replayFrame(size_t index);
+
+  const Stats &stats() const noexcept;
+
+private:
+  struct Range {
+    size_t begin{};
+    size_t end{};
+  };
+
+  /* Object types that have their own name spaces */
+  static constexpr size_t kNameSpaces = 8;
+
+  std::vector<uint8_t> data_;
+  Range setup_{};
+  std::vector<Range> frames_;
+  GLuint framebuffer_{};
+  Stats stats_{};
+
+  /* Captured -> replayed names, per object type */
+  std::array<std::unordered_map<GLuint, GLuint>, kNameSpaces> names_{};
+  std::unordered_map<uint64_t, GLsync> syncs_;
+
+  /* (captured program, captured location) -> replayed location */
+  std::unordered_map<uint64_t, GLint> locations_;
+  GLuint program_{};
+
+  std::unordered_map<GLenum, std::span<uint8_t>> mapped_;
+  std::vector<uint8_t> scratch_;
+
+  void index();
+  void run(Range range) noexcept;
+
+  friend struct GLCallTable;
+};
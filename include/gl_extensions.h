@@ -0,0 +1,53 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include <string_view>
+
+/* Entry points beyond the GL 3.3 core profile GLAD was generated for.
+ * Window resolves these alongside the GLAD tables; each feature flag is
+ * false (and its pointers null) when the driver lacks it */
+
+/* ARB_get_program_binary (core in 4.1) */
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+
+typedef void(APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program,
+                                                  GLsizei bufSize,
+                                                  GLsizei *length,
+                                                  GLenum *binaryFormat,
+                                                  void *binary);
+typedef void(APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program,
+                                               GLenum binaryFormat,
+                                               const void *binary,
+                                               GLsizei length);
+typedef void(APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program,
+                                                   GLenum pname, GLint value);
+
+/* ARB_buffer_storage (core in 4.4) */
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+
+typedef void(APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size,
+                                               const void *data,
+                                               GLbitfield flags);
+
+struct GLExtensions {
+  bool program_binary{};
+  PFNGLGETPROGRAMBINARYPROC GetProgramBinary{};
+  PFNGLPROGRAMBINARYPROC ProgramBinary{};
+  PFNGLPROGRAMPARAMETERIPROC ProgramParameteri{};
+
+  bool buffer_storage{};
+  PFNGLBUFFERSTORAGEPROC BufferStorage{};
+};
+
+extern GLExtensions gl_extensions;
+
+/* Requires a current context. Returns false only if loader is null */
+bool loadGLExtensions(GLADloadproc loader) noexcept;
+
+/* Whether the current context advertises the named extension */
+bool hasGLExtension(std::string_view name) noexcept;
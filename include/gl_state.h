@@ -0,0 +1,47 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* Shadow copy of the binding state draws depend on.
+ * Each bind is forwarded to GL only when it differs from what the cache
+ * last saw, and counted as issued or skipped. The cache can't see GL calls
+ * made around it, so invalidate() after any code that binds directly
+ * (Window's own targets, other renderers, user callbacks). */
+class GLStateCache {
+public:
+  static constexpr size_t kTextureUnits = 16;
+
+  struct Counters {
+    uint64_t binds_issued{};
+    uint64_t binds_skipped{};
+  };
+
+  GLStateCache() noexcept;
+
+  void useProgram(GLuint program) noexcept;
+  void bindVertexArray(GLuint vao) noexcept;
+  void bindTexture2D(size_t unit, GLuint texture) noexcept;
+
+  /* Forget everything; the next bind of each kind is always issued */
+  void invalidate() noexcept;
+
+  const Counters &counters() const noexcept;
+  void resetCounters() noexcept;
+
+private:
+  /* Sentinel that no real GL name matches, so unknown state always binds */
+  static constexpr GLuint kUnknown = ~GLuint{0};
+
+  GLuint program_{kUnknown};
+  GLuint vao_{kUnknown};
+  size_t active_unit_{kTextureUnits};
+  std::array<GLuint, kTextureUnits> textures_{};
+  Counters counters_{};
+
+  bool changed(GLuint &current, GLuint next) noexcept;
+};
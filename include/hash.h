@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+/* 64-bit FNV-1a. Pass a previous result as `hash` to continue hashing
+ * across several pieces. Stable across runs and platforms, so it is safe to
+ * store on disk */
+constexpr uint64_t fnv1a(std::string_view data,
+                         uint64_t hash = 0xcbf29ce484222325ULL) noexcept {
+  for (char c : data) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+  }
+  return hash;
+}
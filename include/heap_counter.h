@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+/* Heap allocation counters for the calling thread.
+ * Counting is a debug mode: it replaces the global operator new/delete and
+ * is only compiled in with LIBRETRO_COUNT_ALLOCATIONS defined (CMake option
+ * of the same name; always on for the tests). Otherwise the counters stay
+ * at zero. */
+struct HeapCounters {
+  uint64_t allocations{};
+  uint64_t deallocations{};
+  uint64_t bytes{};
+};
+
+HeapCounters heapCounters() noexcept;
+bool heapCountingEnabled() noexcept;
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/* Move-only type-erased callable with fixed inline storage.
+ * Unlike std::function it never allocates: the target is constructed
+ * directly in an internal buffer of Capacity bytes, and targets that don't
+ * fit fail to compile. Dispatch is a single indirect call through a static
+ * operation table; an empty InplaceFunction points at a table whose invoke
+ * returns R{}, so calling it needs no null check. */
+template <typename Signature, size_t Capacity = 64,
+          size_t Alignment = alignof(std::max_align_t)>
+class InplaceFunction;
+
+template <typename R, typename... Args, size_t Capacity, size_t Alignment>
+class InplaceFunction<R(Args...), Capacity, Alignment> {
+  static_assert(std::is_void_v<R> || std::is_default_constructible_v<R>,
+                "R must be default constructible (or void) so an empty "
+                "InplaceFunction can return a value");
+
+  struct Ops {
+    R (*invoke)(void *, Args &&...) noexcept;
+    void (*relocate)(void *dst, void *src) noexcept;
+    void (*destroy)(void *) noexcept;
+  };
+
+  template <typename F> static constexpr Ops kOpsFor{
+      [](void *self, Args &&...args) noexcept -> R {
+        return (*static_cast<F *>(self))(std::forward<Args>(args)...);
+      },
+      [](void *dst, void *src) noexcept {
+        ::new (dst) F{std::move(*static_cast<F *>(src))};
+        static_cast<F *>(src)->~F();
+      },
+      [](void *self) noexcept { static_cast<F *>(self)->~F(); }};
+
+  static constexpr Ops kEmptyOps{
+      [](void *, Args &&...) noexcept -> R {
+        if constexpr (!std::is_void_v<R>) {
+          return R{};
+        }
+      },
+      [](void *, void *) noexcept {}, [](void *) noexcept {}};
+
+public:
+  static constexpr size_t capacity = Capacity;
+
+  InplaceFunction() noexcept = default;
+
+  /* The is_same_v check keeps this from hijacking move construction */
+  template <typename F>
+    requires(!std::is_same_v<std::decay_t<F>, InplaceFunction>) &&
+            std::is_nothrow_invocable_r_v<R, std::decay_t<F> &, Args...>
+  InplaceFunction(F &&f) noexcept(
+      std::is_nothrow_constructible_v<std::decay_t<F>, F>) {
+    using Target = std::decay_t<F>;
+    static_assert(sizeof(Target) <= Capacity,
+                  "Callable is too large for InplaceFunction storage; "
+                  "capture less or raise Capacity");
+    static_assert(Alignment % alignof(Target) == 0,
+                  "Callable is over-aligned for InplaceFunction storage");
+    static_assert(std::is_nothrow_move_constructible_v<Target>,
+                  "Callable must be nothrow move constructible");
+
+    ::new (static_cast<void *>(storage_)) Target{std::forward<F>(f)};
+    ops_ = &kOpsFor<Target>;
+  }
+
+  ~InplaceFunction() { ops_->destroy(storage_); }
+
+  InplaceFunction(const InplaceFunction &) = delete;
+  InplaceFunction &operator=(const InplaceFunction &) = delete;
+
+  InplaceFunction(InplaceFunction &&other) noexcept
+      : ops_{std::exchange(other.ops_, &kEmptyOps)} {
+    ops_->relocate(storage_, other.storage_);
+  }
+
+  InplaceFunction &operator=(InplaceFunction &&other) noexcept {
+    if (this != &other) {
+      ops_->destroy(storage_);
+      ops_ = std::exchange(other.ops_, &kEmptyOps);
+      ops_->relocate(storage_, other.storage_);
+    }
+    return *this;
+  }
+
+  explicit operator bool() const noexcept { return ops_ != &kEmptyOps; }
+
+  /* Like std::function, the target is invoked as non-const */
+  R operator()(Args... args) const noexcept {
+    return ops_->invoke(const_cast<std::byte *>(storage_),
+                        std::forward<Args>(args)...);
+  }
+
+private:
+  const Ops *ops_{&kEmptyOps};
+  alignas(Alignment) std::byte storage_[Capacity];
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "spsc_queue.h"
+
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/* One input callback from GLFW, stamped when it was delivered */
+struct InputEvent {
+  enum class Type : uint8_t { Key, Char, MouseButton, CursorPos, Scroll };
+
+  Type type{};
+
+  /* GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT for keys and mouse buttons */
+  int action{};
+  int mods{};
+
+  /* GLFW key, mouse button, or Unicode codepoint for Char */
+  int code{};
+  int scancode{};
+
+  /* Cursor position in screen coordinates, or scroll offset */
+  double x{};
+  double y{};
+
+  /* InputQueue::now() when the callback ran */
+  int64_t time{};
+};
+
+/* Input-to-photon latency: from an event's timestamp to the end of the
+ * first swap (or headless readback) after it was consumed */
+struct InputLatency {
+  uint64_t samples{};
+  double last_ms{};
+  double mean_ms{};
+  double max_ms{};
+};
+
+/* Timestamped input events, handed from the thread that polls GLFW events
+ * to the thread that simulates.
+ * Window pushes from its GLFW callbacks; the simulation thread drains once
+ * per step, as close to the step as it can. Events are stored in a fixed
+ * SpscQueue, so nothing allocates; if the consumer falls a whole queue
+ * behind, new events are dropped and counted.
+ * Consuming an event also marks it for latency measurement: the window
+ * calls presented() after each swap, which turns the oldest event consumed
+ * since the previous swap into an input-to-photon sample.
+ * That is only right when the frame renders what was just simulated. When
+ * rendering runs behind on another thread, the simulation takes the stamp
+ * with takeConsumed() and publishes it with its snapshot, and the render
+ * callback hands it back through rendered(); the sample then closes when
+ * the frame that drew that snapshot is presented. */
+class InputQueue {
+public:
+  static constexpr size_t kCapacity = 1024;
+
+  InputQueue() = default;
+
+  InputQueue(const InputQueue &) = delete;
+  InputQueue &operator=(const InputQueue &) = delete;
+  InputQueue(InputQueue &&) = delete;
+  InputQueue &operator=(InputQueue &&) = delete;
+
+  /* Steady clock nanoseconds, comparable across threads */
+  static int64_t now() noexcept;
+
+  /* Producer side */
+  void push(const InputEvent &event) noexcept;
+
+  /* Events lost to a full queue */
+  uint64_t dropped() const noexcept;
+
+  /* Consumer side. drain() calls f(const InputEvent &) for every pending
+   * event in order and returns how many there were */
+  bool pop(InputEvent &event) noexcept;
+
+  template <typename F>
+    requires std::is_nothrow_invocable_v<F &, const InputEvent &>
+  size_t drain(F &&f) noexcept {
+    int64_t oldest = 0;
+    const size_t count = events_.drain([&](const InputEvent &event) noexcept {
+      if (!oldest) {
+        oldest = event.time;
+      }
+      f(event);
+    });
+    if (count) {
+      consumed(oldest);
+    }
+    return count;
+  }
+
+  /* Consumer side, for pipelined rendering: the oldest event consumed
+   * since the last call, or 0 if none. From the first call on, presented()
+   * only closes samples for stamps passed to rendered() */
+  int64_t takeConsumed() noexcept;
+
+  /* Renderer side: the frame being rendered shows the snapshot that
+   * carried this takeConsumed() stamp. Frames that show the same stamp
+   * again add no sample */
+  void rendered(int64_t consumed) noexcept;
+
+  /* Renderer side: a frame finished presenting at `time` (from now()) */
+  void presented(int64_t time) noexcept;
+
+  /* Safe from any thread */
+  InputLatency latency() const noexcept;
+  void resetLatency() noexcept;
+
+private:
+  SpscQueue<InputEvent, kCapacity> events_;
+  alignas(64) std::atomic<uint64_t> dropped_{};
+
+  /* Oldest event consumed since the last presented(), 0 if none */
+  alignas(64) std::atomic<int64_t> pending_{};
+
+  /* Set once takeConsumed() is in use; stamps come from rendered() */
+  std::atomic<bool> stamped_{};
+  std::atomic<int64_t> rendered_{};
+
+  /* Written by presented() only */
+  int64_t last_stamp_{};
+  std::atomic<uint64_t> samples_{};
+  std::atomic<int64_t> last_ns_{};
+  std::atomic<int64_t> total_ns_{};
+  std::atomic<int64_t> max_ns_{};
+
+  void consumed(int64_t time) noexcept;
+  void sample(int64_t latency) noexcept;
+};
+
+/* Current keyboard and mouse state, rebuilt from drained events.
+ * Keys and buttons outside GLFW's ranges are ignored */
+class InputState {
+public:
+  void apply(const InputEvent &event) noexcept;
+
+  bool keyDown(int key) const noexcept;
+  bool buttonDown(int button) const noexcept;
+  double cursorX() const noexcept;
+  double cursorY() const noexcept;
+
+private:
+  /* GLFW_KEY_LAST and GLFW_MOUSE_BUTTON_LAST, rounded up */
+  static constexpr size_t kKeys = 512;
+  static constexpr size_t kButtons = 8;
+
+  std::bitset<kKeys> keys_{};
+  std::bitset<kButtons> buttons_{};
+  double cursor_x_{};
+  double cursor_y_{};
+};
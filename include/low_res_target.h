@@ -0,0 +1,70 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/* Fixed-size logical framebuffer for retro-resolution rendering.
+ * The scene renders into a small color texture, which present() scales up
+ * to the destination by the largest integer factor that fits, centred with
+ * black letterbox bars. Without a palette this is a single nearest-neighbour
+ * glBlitFramebuffer; with one, a single fullscreen pass samples the texture
+ * and snaps each pixel to the nearest palette entry in the same pass.
+ * If the destination is smaller than the logical size the image is fitted
+ * with a fractional scale instead. All methods must be called with the
+ * owning context current. */
+class LowResTarget {
+public:
+  static constexpr size_t kMaxPaletteSize = 256;
+
+  struct Viewport {
+    int x{};
+    int y{};
+    int width{};
+    int height{};
+  };
+
+  LowResTarget(size_t width, size_t height);
+  ~LowResTarget();
+
+  LowResTarget(const LowResTarget &) = delete;
+  LowResTarget &operator=(const LowResTarget &) = delete;
+  LowResTarget(LowResTarget &&) = delete;
+  LowResTarget &operator=(LowResTarget &&) = delete;
+
+  /* Bind the logical framebuffer and set the viewport to cover it */
+  void bind() const noexcept;
+
+  /* Scale the logical frame into dst_fbo (0 for the default framebuffer)
+   * of the given size. Scissor, depth test, blending, the clear color and
+   * the viewport are restored */
+  void present(GLuint dst_fbo, size_t dst_width, size_t dst_height) noexcept;
+
+  /* RGBA8 colors (red in the lowest byte); an empty span disables
+   * quantization. Throws if more than kMaxPaletteSize colors are given */
+  void setPalette(std::span<const uint32_t> colors);
+  size_t paletteSize() const noexcept;
+
+  /* Where the logical frame lands in a destination of the given size */
+  Viewport presentViewport(size_t dst_width, size_t dst_height) const noexcept;
+
+  GLuint framebuffer() const noexcept;
+  GLuint texture() const noexcept;
+  size_t width() const noexcept;
+  size_t height() const noexcept;
+
+private:
+  size_t width_;
+  size_t height_;
+  GLuint fbo_{};
+  GLuint color_{};
+  GLuint depth_stencil_{};
+  GLuint palette_texture_{};
+  GLuint program_{};
+  GLuint vao_{};
+  GLint palette_size_location_{};
+  size_t palette_size_{};
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/* Bounded lock-free multi-producer single-consumer FIFO.
+ * Storage is a fixed ring allocated with the queue, so pushing and popping
+ * never allocate. Each slot carries a sequence number that says whose turn
+ * it is: producers claim a slot by advancing the shared tail with a CAS,
+ * fill it, then publish it by bumping its sequence; the consumer reads a
+ * slot once its sequence says it is full and hands it back by bumping the
+ * sequence a lap ahead. A producer preempted between claiming and
+ * publishing holds up the consumer at that slot until it finishes, but
+ * never blocks other producers.
+ * Popping is wait-free. Pushing is lock-free but not wait-free: a producer
+ * whose CAS loses to another retries, so under contention one thread can
+ * retry indefinitely while others make progress. A fetch_add ticket would
+ * be wait-free, but a ticket can't be handed back when the ring is full.
+ * Any number of threads may push; exactly one thread may pop at a time. */
+template <typename T, size_t Capacity> class MpscQueue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "MpscQueue capacity must be a power of two");
+  static_assert(std::is_nothrow_copy_assignable_v<T>,
+                "MpscQueue elements must be nothrow copy assignable");
+
+public:
+  MpscQueue() noexcept {
+    for (size_t i = 0; i < Capacity; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+  MpscQueue(MpscQueue &&) = delete;
+  MpscQueue &operator=(MpscQueue &&) = delete;
+
+  static constexpr size_t capacity() noexcept { return Capacity; }
+
+  /* Producer side, from any thread. Returns false (and drops value) if the
+   * ring is full */
+  bool tryPush(const T &value) noexcept {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot &slot = slots_[tail & kMask];
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto lag =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(tail);
+      if (lag == 0) {
+        /* The slot is free on this lap; claim it. A failed CAS reloads
+         * tail and retries */
+        if (tail_.compare_exchange_weak(tail, tail + 1,
+                                        std::memory_order_relaxed)) {
+          slot.value = value;
+
+          /* Release publishes the slot to the consumer's acquire */
+          slot.sequence.store(tail + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (lag < 0) {
+        /* The consumer hasn't freed this slot from the previous lap */
+        return false;
+      } else {
+        tail = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /* Consumer side. Returns false if the ring is empty */
+  bool tryPop(T &value) noexcept {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    Slot &slot = slots_[head & kMask];
+    if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+      return false;
+    }
+    value = slot.value;
+    release(slot, head);
+    return true;
+  }
+
+  /* Consumer side. Calls f(const T &) for everything published so far, in
+   * order, stopping at the first slot a producer hasn't finished. Returns
+   * the count */
+  template <typename F>
+    requires std::is_nothrow_invocable_v<F &, const T &>
+  size_t drain(F &&f) noexcept {
+    const size_t first = head_.load(std::memory_order_relaxed);
+    size_t head = first;
+    for (;;) {
+      Slot &slot = slots_[head & kMask];
+      if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+        break;
+      }
+      f(slot.value);
+      release(slot, head);
+      ++head;
+    }
+    return head - first;
+  }
+
+  /* A snapshot; counts claimed slots, including ones still being filled */
+  size_t size() const noexcept {
+    const size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+  }
+
+  bool empty() const noexcept { return size() == 0; }
+
+private:
+  static constexpr size_t kMask = Capacity - 1;
+
+  struct Slot {
+    std::atomic<size_t> sequence;
+    T value{};
+  };
+
+  /* Shared by the producers */
+  alignas(64) std::atomic<size_t> tail_{0};
+
+  /* Consumer's line */
+  alignas(64) std::atomic<size_t> head_{0};
+
+  alignas(64) std::array<Slot, Capacity> slots_{};
+
+  /* Hand the slot to the producer one lap ahead */
+  void release(Slot &slot, size_t head) noexcept {
+    slot.sequence.store(head + Capacity, std::memory_order_release);
+    head_.store(head + 1, std::memory_order_release);
+  }
+};
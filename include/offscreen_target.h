@@ -0,0 +1,61 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/* Framebuffer object that a headless Window renders into, plus a pair of
+ * pixel pack buffers for asynchronous readback.
+ * Each frame's glReadPixels goes into one PBO while the other, filled a
+ * frame earlier, is mapped and copied out. The GPU therefore has a whole
+ * frame to finish the transfer and mapping never waits on the frame that
+ * was just submitted. Pixels are RGBA8, rows ordered bottom to top.
+ * All methods must be called with the owning context current. */
+class OffscreenTarget {
+public:
+  OffscreenTarget(size_t width, size_t height);
+  ~OffscreenTarget();
+
+  OffscreenTarget(const OffscreenTarget &) = delete;
+  OffscreenTarget &operator=(const OffscreenTarget &) = delete;
+  OffscreenTarget(OffscreenTarget &&) = delete;
+  OffscreenTarget &operator=(OffscreenTarget &&) = delete;
+
+  /* Bind the framebuffer as the draw and read target */
+  void bind() const noexcept;
+
+  /* Queue a readback of the current frame and collect the previous one */
+  void readback() noexcept;
+
+  /* Block until the queued readback (if any) is available in pixels() */
+  void flush() noexcept;
+
+  GLuint framebuffer() const noexcept;
+  size_t width() const noexcept;
+  size_t height() const noexcept;
+
+  /* Most recently collected frame; empty until the first readback lands */
+  std::span<const std::uint8_t> pixels() const noexcept;
+
+  /* Number of frames collected into pixels() so far */
+  uint64_t framesRead() const noexcept;
+
+private:
+  size_t width_;
+  size_t height_;
+  GLuint fbo_{};
+  GLuint color_{};
+  GLuint depth_stencil_{};
+  std::array<GLuint, 2> pbos_{};
+  size_t write_index_{};
+  bool pending_{};
+  uint64_t frames_read_{};
+  std::vector<std::uint8_t> pixels_;
+
+  void collect(GLuint pbo) noexcept;
+};
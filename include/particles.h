@@ -0,0 +1,152 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include "software_rasterizer.h"
+#include "span_kernels.h"
+#include "sprite_batch.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/* A particle as emitted. Positions and sizes are in pixels, velocities in
+ * pixels per second, life in seconds. Particles are squares centred on
+ * (x, y) and disappear once their life runs out */
+struct ParticleSpawn {
+  float x{};
+  float y{};
+  float vx{};
+  float vy{};
+  float life{};
+  float size{1.0f};
+  uint32_t color{0xFFFFFFFF}; // RGBA8, red in the lowest byte
+};
+
+/* Applied to every particle on each update: acceleration in pixels per
+ * second squared, and drag as the fraction of velocity lost per second */
+struct ParticleForces {
+  float gravity_x{};
+  float gravity_y{};
+  float drag{};
+};
+
+/* Both particle systems share the same model.
+ * Storage is a fixed ring: emitting past capacity overwrites the oldest
+ * particles, so nothing is allocated, compacted or read back per frame.
+ * Every slot is integrated each update, dead or alive, with
+ *   v = (v + g * dt) * max(1 - drag * dt, 0)
+ *   p += v * dt
+ *   life -= dt
+ * and dead slots are simply not drawn. */
+
+/* Particles simulated on the CPU, for headless and software setups.
+ * State is structure-of-arrays so update() streams five float arrays
+ * through SIMD kernels (AVX2 when the CPU has it, like span_kernels.h). */
+class CpuParticles {
+public:
+  /* Throws std::invalid_argument for zero capacity */
+  explicit CpuParticles(size_t capacity);
+
+  void emit(std::span<const ParticleSpawn> particles) noexcept;
+  void update(float dt, const ParticleForces &forces) noexcept;
+
+  /* Submit every live particle as an untextured sprite */
+  void draw(SoftwareRasterizer &rasterizer) const;
+  void draw(SpriteBatch &batch) const;
+
+  /* Live particles; scans the whole ring */
+  size_t alive() const noexcept;
+  size_t capacity() const noexcept;
+
+  std::span<const float> x() const noexcept;
+  std::span<const float> y() const noexcept;
+  std::span<const float> vx() const noexcept;
+  std::span<const float> vy() const noexcept;
+  std::span<const float> life() const noexcept;
+
+  /* Kernel instruction set. Requests the CPU can't run fall back to the
+   * best supported one, which is returned */
+  SpanIsa isa() const noexcept;
+  SpanIsa setIsa(SpanIsa isa) noexcept;
+
+private:
+  using Integrate = void (*)(float *x, float *y, float *vx, float *vy,
+                             float *life, size_t count, float dt, float gx,
+                             float gy, float damp) noexcept;
+
+  size_t capacity_;
+  size_t next_{};
+  std::vector<float> x_, y_, vx_, vy_, life_, size_;
+  std::vector<uint32_t> color_;
+  SpanIsa isa_{};
+  Integrate integrate_{};
+
+  Sprite sprite(size_t i) const noexcept;
+};
+
+/* Particles simulated and drawn entirely on the GPU.
+ * update() runs a vertex-only transform feedback pass (rasterizer
+ * discarded) from one state buffer into the other and swaps them; draw()
+ * renders one instanced quad per slot straight from the current state
+ * buffer. The CPU only writes newly emitted particles, so there are no
+ * readbacks or per-frame uploads of particle state.
+ * State is interleaved as (x, y, vx, vy, life); size and color live in a
+ * separate buffer that only emit() writes.
+ * Construct, use and destroy with the owning context current. */
+class GpuParticles {
+public:
+  /* Floats of simulated state per particle */
+  static constexpr size_t kStateFloats = 5;
+
+  /* Throws std::invalid_argument for zero capacity and ShaderError if the
+   * shaders fail to build */
+  explicit GpuParticles(size_t capacity);
+  ~GpuParticles();
+
+  GpuParticles(const GpuParticles &) = delete;
+  GpuParticles &operator=(const GpuParticles &) = delete;
+  GpuParticles(GpuParticles &&) = delete;
+  GpuParticles &operator=(GpuParticles &&) = delete;
+
+  void emit(std::span<const ParticleSpawn> particles) noexcept;
+  void update(float dt, const ParticleForces &forces) noexcept;
+
+  /* Draw into the current framebuffer and viewport, which is
+   * viewport_width x viewport_height pixels, with alpha blending */
+  void draw(float viewport_width, float viewport_height) noexcept;
+
+  size_t capacity() const noexcept;
+
+  /* Buffer holding the current state, e.g. to read it back in tests */
+  GLuint stateBuffer() const noexcept;
+
+private:
+  size_t capacity_;
+  size_t next_{};
+  size_t current_{};
+  GLuint state_[2]{};
+  GLuint static_{};
+  GLuint update_vao_[2]{};
+  GLuint draw_vao_[2]{};
+  GLuint update_program_{};
+  GLuint draw_program_{};
+  GLint dt_location_{-1};
+  GLint gravity_location_{-1};
+  GLint damp_location_{-1};
+  GLint viewport_location_{-1};
+  /* Emitted particles are repacked into the two layouts in batches */
+  static constexpr size_t kStagingParticles = 1024;
+
+  struct Static {
+    float size;
+    uint32_t color;
+  };
+
+  std::vector<float> staging_;
+  std::vector<Static> staging_static_;
+
+  void upload(size_t first, std::span<const ParticleSpawn> particles) noexcept;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+
+/* 64-bit sort key paired with the index of the item it orders */
+using SortEntry = std::pair<uint64_t, uint32_t>;
+
+/* Stable LSD radix sort on SortEntry::first, 8 bits per pass.
+ * Passes where every key shares the same byte are skipped, so keys that
+ * only use a few bits cost only a few passes. scratch must be at least as
+ * large as entries; the result always ends up in entries */
+void radixSort(std::span<SortEntry> entries,
+               std::span<SortEntry> scratch) noexcept;
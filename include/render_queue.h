@@ -0,0 +1,53 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include "gl_state.h"
+#include "radix_sort.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* One recorded draw. Indexed draws (index_type != 0) read count indices
+ * starting at byte `offset` of the VAO's element buffer; otherwise count
+ * vertices starting at vertex `first` */
+struct DrawCommand {
+  GLuint program{};
+  GLuint vao{};
+  GLuint texture{}; // bound to unit 0, or none when 0
+  float depth{};    // [0, 1], nearer first among otherwise equal state
+  GLenum mode{GL_TRIANGLES};
+  GLsizei count{};
+  GLenum index_type{GL_UNSIGNED_INT};
+  uintptr_t offset{};
+  GLint first{};
+};
+
+/* Records draws for a frame and submits them in state order.
+ * Each command gets a packed 64-bit key
+ *   program:16 | vao:16 | texture:16 | depth:16
+ * (most significant first), the keys are radix sorted, and the sorted
+ * draws go through a GLStateCache so consecutive draws sharing state skip
+ * their binds. GL names wider than 16 bits only weaken grouping; each draw
+ * still binds its own names. Equal keys keep submission order. */
+class RenderQueue {
+public:
+  void reserve(size_t commands);
+  void push(const DrawCommand &command);
+
+  /* Sort, execute and clear. The state cache is invalidated first since
+   * anything may have been bound since the last submit */
+  void submit(GLStateCache &state) noexcept;
+
+  void clear() noexcept;
+  size_t size() const noexcept;
+
+  static uint64_t sortKey(const DrawCommand &command) noexcept;
+
+private:
+  std::vector<DrawCommand> commands_;
+  std::vector<SortEntry> order_;
+  std::vector<SortEntry> scratch_;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "window.h"
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <thread>
+
+/* Runs Window::render() in a loop on a dedicated thread.
+ * The constructor releases the window's context from the calling thread and
+ * the render thread makes it current on its first frame, so every GL call
+ * (including the render callback) then happens on the render thread. The
+ * calling thread is left free to poll events and simulate; pair it with a
+ * TripleBuffer so neither side waits on the other.
+ * While the thread runs, the only Window methods the caller may use are
+ * shouldClose(), input() and the static event functions. Don't move the window or
+ * create other windows until stop() returns. */
+class RenderThread {
+public:
+  explicit RenderThread(Window &window);
+
+  /* Stops and joins; the window's destructor reclaims the context */
+  ~RenderThread();
+
+  RenderThread(const RenderThread &) = delete;
+  RenderThread &operator=(const RenderThread &) = delete;
+  RenderThread(RenderThread &&) = delete;
+  RenderThread &operator=(RenderThread &&) = delete;
+
+  /* Finish the current frame, join, and make the context current on the
+   * calling thread again. Rethrows anything Window::render() threw */
+  void stop();
+
+  /* False once the thread has stopped, on request or because render threw */
+  bool running() const noexcept;
+
+  /* Frames rendered so far */
+  uint64_t frames() const noexcept;
+
+private:
+  Window &window_;
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> running_{true};
+  std::atomic<uint64_t> frames_{};
+  std::exception_ptr error_{};
+  std::thread thread_;
+
+  void run() noexcept;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+/* Thrown when a shader fails to compile or a program fails to link. The
+ * message carries the stage and the driver's info log */
+class ShaderError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+/* Compile (type, source) stages and link them into a program the caller
+ * owns; the shaders are deleted once linked. Varyings, if given, are
+ * captured interleaved for transform feedback. For one-off programs that
+ * don't need a ShaderCache. Throws ShaderError */
+GLuint buildProgram(
+    std::initializer_list<std::pair<GLenum, const char *>> stages,
+    std::span<const char *const> varyings = {});
+
+/* Owns every shader and program built through it.
+ * Identical sources are compiled once and identical (vertex, fragment)
+ * pairs are linked once. With a cache directory and a driver that supports
+ * ARB_get_program_binary, linked programs are also written to disk keyed by
+ * a hash of their sources and the driver strings; a later run with a warm
+ * cache loads the binary and skips compilation entirely. A stale or corrupt
+ * binary falls back to compiling from source.
+ * Construct, use and destroy with the owning context current. */
+class ShaderCache {
+public:
+  struct Stats {
+    size_t shaders_compiled{};
+    size_t programs_linked{};
+    size_t dedup_hits{};
+    size_t binary_loads{};
+    size_t binary_stores{};
+  };
+
+  /* An empty directory keeps the cache in memory only */
+  explicit ShaderCache(std::filesystem::path cache_dir = {});
+  ~ShaderCache();
+
+  ShaderCache(const ShaderCache &) = delete;
+  ShaderCache &operator=(const ShaderCache &) = delete;
+  ShaderCache(ShaderCache &&) = delete;
+  ShaderCache &operator=(ShaderCache &&) = delete;
+
+  /* Linked program for the given sources. Throws ShaderError */
+  GLuint program(std::string_view vertex_source,
+                 std::string_view fragment_source);
+
+  /* Delete cached shader objects once startup has linked everything.
+   * Programs stay valid; later misses simply recompile */
+  void releaseShaders() noexcept;
+
+  bool binarySupported() const noexcept;
+  const Stats &stats() const noexcept;
+
+private:
+  std::filesystem::path cache_dir_;
+  std::string driver_;
+  bool binary_supported_{};
+  std::unordered_map<std::string, GLuint> shaders_;
+  std::unordered_map<std::string, GLuint> programs_;
+  Stats stats_{};
+
+  GLuint shader(GLenum type, std::string_view source);
+  GLuint link(std::string_view vertex_source, std::string_view fragment_source);
+  GLuint loadBinary(const std::filesystem::path &path,
+                    uint64_t key) noexcept;
+  void storeBinary(const std::filesystem::path &path, uint64_t key,
+                   GLuint program) noexcept;
+  uint64_t programKey(std::string_view vertex_source,
+                      std::string_view fragment_source) const noexcept;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include "sprite_batch.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+/* CPU render backend for retro resolutions.
+ * Draws are recorded into a command list and binned into kTileSize square
+ * tiles; finish() rasterizes the tiles in parallel, each tile replaying its
+ * commands in submission order, so the result never depends on the thread
+ * count. Rows are filled with the SIMD kernels from span_kernels.h.
+ * Coverage follows GL's rules (pixel centres, top-left fill convention),
+ * textures are sampled nearest with GL_REPEAT and blending matches
+ * glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA), so frames are pixel
+ * for pixel what SpriteBatch draws on the GPU for the same input.
+ * Pixels are RGBA8 (red in the lowest byte), rows ordered top to bottom.
+ * Recording and finish() belong to one thread. Only present() touches GL:
+ * its texture is created on first use and deleted by the destructor, which
+ * then needs the same context current. */
+class SoftwareRasterizer {
+public:
+  static constexpr size_t kTileSize = 64;
+
+  struct Point {
+    float x{};
+    float y{};
+  };
+
+  struct Stats {
+    size_t commands{};
+    size_t tiles{};
+    size_t uploads{};
+  };
+
+  /* 0 threads picks one per hardware thread */
+  SoftwareRasterizer(size_t width, size_t height, size_t threads = 0);
+  ~SoftwareRasterizer();
+
+  SoftwareRasterizer(const SoftwareRasterizer &) = delete;
+  SoftwareRasterizer &operator=(const SoftwareRasterizer &) = delete;
+  SoftwareRasterizer(SoftwareRasterizer &&) = delete;
+  SoftwareRasterizer &operator=(SoftwareRasterizer &&) = delete;
+
+  /* RGBA8 image, rows top to bottom; sprites refer to it by the returned
+   * id in Sprite::texture (0 stays untextured). Throws if the size doesn't
+   * match the pixel count */
+  uint32_t createTexture(size_t width, size_t height,
+                         std::span<const uint32_t> pixels);
+
+  void clear(uint32_t color);
+
+  /* Sprites are drawn in submission order; layer and program are ignored */
+  void draw(const Sprite &sprite);
+
+  /* Flat-colored triangle in pixel coordinates, either winding */
+  void drawTriangle(Point a, Point b, Point c, uint32_t color);
+
+  /* Rasterize everything recorded since the last finish() */
+  void finish();
+
+  /* Upload the frame into one texture and blit it over dst_fbo (0 for the
+   * default framebuffer) of the given size, nearest-neighbour. Scissor test
+   * is restored and dst_fbo is left bound */
+  void present(GLuint dst_fbo, size_t dst_width, size_t dst_height) noexcept;
+
+  std::span<const uint32_t> pixels() const noexcept;
+  size_t width() const noexcept;
+  size_t height() const noexcept;
+  size_t threads() const noexcept;
+
+  /* Counters for the most recent finish() (uploads are cumulative) */
+  const Stats &stats() const noexcept;
+
+private:
+  enum class Kind : uint8_t { Clear, Sprite, Triangle };
+
+  struct Command {
+    Kind kind{};
+    uint32_t color{};
+    uint32_t texture{};
+    int x0{}, y0{}, x1{}, y1{}; // pixel bounds, max exclusive
+    Point p[3]{};  // sprite: top-left, bottom-right; triangle: vertices
+    Point uv[2]{}; // sprite texture coordinates at p[0] and p[1]
+  };
+
+  struct Texture {
+    size_t width{};
+    size_t height{};
+    bool opaque{};
+    std::vector<uint32_t> pixels;
+  };
+
+  size_t width_;
+  size_t height_;
+  size_t tiles_x_;
+  size_t tiles_y_;
+  std::vector<uint32_t> pixels_;
+  std::vector<Texture> textures_;
+  std::vector<Command> commands_;
+  std::vector<std::vector<uint32_t>> bins_;
+  std::vector<uint32_t> busy_tiles_;
+  std::unique_ptr<ThreadPool> pool_{};
+  GLuint texture_{};
+  GLuint fbo_{};
+  Stats stats_{};
+
+  void bin(const Command &command);
+  void rasterizeTile(size_t tile) noexcept;
+  void fillSprite(const Command &command, int x0, int y0, int x1,
+                  int y1) noexcept;
+  void fillTriangle(const Command &command, int x0, int y0, int x1,
+                    int y1) noexcept;
+};
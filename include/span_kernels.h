@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* Pixel span kernels for SoftwareRasterizer.
+ * Pixels are RGBA8 packed into uint32_t with red in the lowest byte (the
+ * same layout as Sprite::color). Products of two 8-bit values are divided
+ * by 255 with exact rounding, so every instruction set produces identical
+ * results. The widest set the CPU supports is picked on first use. */
+enum class SpanIsa { Scalar, Sse2, Avx2 };
+
+/* Instruction set the kernels currently use */
+SpanIsa spanIsa() noexcept;
+
+/* Switch kernels, e.g. to compare instruction sets. Requests the CPU can't
+ * run fall back to the best supported one, which is returned. Not
+ * thread-safe: call while nothing is rasterizing */
+SpanIsa setSpanIsa(SpanIsa isa) noexcept;
+
+const char *spanIsaName(SpanIsa isa) noexcept;
+
+/* dst[i] = color */
+void fillSpan(uint32_t *dst, size_t count, uint32_t color) noexcept;
+
+/* dst[i] = src[i] * color, per channel */
+void modulateSpan(uint32_t *dst, const uint32_t *src, size_t count,
+                  uint32_t color) noexcept;
+
+/* dst[i] = src[i] * src_alpha + dst[i] * (1 - src_alpha), per channel
+ * (alpha included), i.e. glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA).
+ * Each product is rounded to 8 bits before the sum, as GL blenders do on
+ * RGBA8 targets */
+void blendSpan(uint32_t *dst, const uint32_t *src, size_t count) noexcept;
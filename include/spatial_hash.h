@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+class WorkStealingPool;
+
+/* Axis-aligned box. Boxes that only touch along an edge don't overlap */
+struct Aabb {
+  float min_x{};
+  float min_y{};
+  float max_x{};
+  float max_y{};
+
+  constexpr bool overlaps(const Aabb &other) const noexcept {
+    return min_x < other.max_x && other.min_x < max_x &&
+           min_y < other.max_y && other.min_y < max_y;
+  }
+};
+
+/* Circle for range queries */
+struct Circle {
+  float x{};
+  float y{};
+  float radius{};
+
+  /* True if the box has a point within radius of the centre */
+  constexpr bool overlaps(const Aabb &box) const noexcept {
+    const float dx = x - std::clamp(x, box.min_x, box.max_x);
+    const float dy = y - std::clamp(y, box.min_y, box.max_y);
+    return dx * dx + dy * dy <= radius * radius;
+  }
+};
+
+/* Hits of a batch of queries: query i found ids[offsets[i]] up to
+ * ids[offsets[i + 1]]. Reusing one across frames doesn't allocate once it
+ * has grown */
+struct SpatialQueryResults {
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> ids;
+
+  size_t size() const noexcept {
+    return offsets.empty() ? 0 : offsets.size() - 1;
+  }
+
+  std::span<const uint32_t> operator[](size_t query) const noexcept {
+    return std::span{ids}.subspan(offsets[query],
+                                  offsets[query + 1] - offsets[query]);
+  }
+};
+
+/* Uniform-grid spatial hash for 2D broadphase and culling.
+ * Space is cut into square cells and each object is linked into every cell
+ * its box touches. Cells hash into a fixed bucket array, and the links live
+ * in one flat pool of entries threaded into per-bucket lists (and a
+ * per-object list), with freed entries recycled, so nothing is allocated
+ * per object once the pool has grown.
+ * Objects are identified by dense caller-chosen ids, e.g. sprite or entity
+ * indices. update() re-links an object only when the set of cells it
+ * touches changes; moves within the same cells just store the new box.
+ * Queries report each overlapping id exactly once, without marking
+ * anything, so any number of them can run concurrently with each other
+ * (but not with updates). Objects should be roughly a cell in size: an
+ * object costs one entry per cell it touches. */
+class SpatialHash {
+public:
+  struct Stats {
+    size_t objects{};
+    size_t entries{};
+
+    /* update() calls since construction that changed an object's cells */
+    uint64_t relinks{};
+  };
+
+  /* Buckets are rounded up to a power of two. Throws std::invalid_argument
+   * for a non-positive cell size or zero buckets */
+  explicit SpatialHash(float cell_size, size_t buckets = 4096);
+
+  /* Insert the object, or move it if it is already present. Throws
+   * std::invalid_argument, leaving the hash unchanged, for a box whose max
+   * lies below its min, and std::length_error if it covers too many cells */
+  void update(uint32_t id, const Aabb &box);
+  void remove(uint32_t id) noexcept;
+  bool contains(uint32_t id) const noexcept;
+  void clear() noexcept;
+
+  /* Box of a present object */
+  const Aabb &bounds(uint32_t id) const noexcept;
+
+  /* Call f(id) for every object overlapping the box or circle */
+  template <typename F>
+    requires std::invocable<F &, uint32_t>
+  void query(const Aabb &box, F &&f) const {
+    visit(box, [&](uint32_t id, const Aabb &bounds) {
+      if (bounds.overlaps(box)) {
+        f(id);
+      }
+    });
+  }
+
+  template <typename F>
+    requires std::invocable<F &, uint32_t>
+  void query(const Circle &circle, F &&f) const {
+    const Aabb box{circle.x - circle.radius, circle.y - circle.radius,
+                   circle.x + circle.radius, circle.y + circle.radius};
+    visit(box, [&](uint32_t id, const Aabb &bounds) {
+      if (circle.overlaps(bounds)) {
+        f(id);
+      }
+    });
+  }
+
+  /* Run a batch of queries, spread over the pool when one is given. Hits
+   * for each query come out in the same order as the single query's */
+  void query(std::span<const Aabb> boxes, SpatialQueryResults &results,
+             WorkStealingPool *pool = nullptr) const;
+  void query(std::span<const Circle> circles, SpatialQueryResults &results,
+             WorkStealingPool *pool = nullptr) const;
+
+  /* Every pair of overlapping objects once, as (lower id, higher id).
+   * Replaces the contents of out */
+  void pairs(std::vector<std::pair<uint32_t, uint32_t>> &out) const;
+
+  float cellSize() const noexcept;
+  size_t buckets() const noexcept;
+  size_t size() const noexcept;
+  Stats stats() const noexcept;
+
+private:
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+  struct Cells {
+    int32_t x0, y0, x1, y1;
+
+    bool operator==(const Cells &) const = default;
+  };
+
+  struct Object {
+    Aabb box{};
+    Cells cells{};
+    uint32_t first{kNone}; // entry chain, kNone if absent
+  };
+
+  struct Entry {
+    int32_t cx{};
+    int32_t cy{};
+    uint32_t id{};
+    uint32_t prev{kNone};
+    uint32_t next{kNone};
+    uint32_t owner_next{kNone};
+  };
+
+  float cell_size_;
+  float inverse_cell_;
+  uint32_t mask_;
+  std::vector<uint32_t> heads_;
+  std::vector<Object> objects_;
+  std::vector<Entry> entries_;
+  uint32_t free_{kNone};
+  size_t size_{};
+  size_t live_entries_{};
+  uint64_t relinks_{};
+
+  int32_t cell(float v) const noexcept {
+    /* Clamped so far-off and infinite coordinates stay representable. NaN
+     * survives the clamp and can't be converted, so it maps to cell 0 */
+    const float c = std::floor(v * inverse_cell_);
+    if (c != c) {
+      return 0;
+    }
+    return static_cast<int32_t>(std::clamp(c, -1e9f, 1e9f));
+  }
+
+  Cells cells(const Aabb &box) const noexcept {
+    return {cell(box.min_x), cell(box.min_y), cell(box.max_x),
+            cell(box.max_y)};
+  }
+
+  uint32_t bucket(int32_t cx, int32_t cy) const noexcept {
+    uint32_t h = static_cast<uint32_t>(cx) * 0x9E3779B1u ^
+                 static_cast<uint32_t>(cy) * 0x85EBCA77u;
+    h ^= h >> 15;
+    return h & mask_;
+  }
+
+  /* Calls f(id, box) once for every object sharing a cell with the box.
+   * An object is reported from the first cell (lowest x and y) that both
+   * cover, so it is seen once however many cells they share */
+  template <typename F> void visit(const Aabb &box, F &&f) const {
+    const Cells r = cells(box);
+    for (int32_t cy = r.y0; cy <= r.y1; ++cy) {
+      for (int32_t cx = r.x0; cx <= r.x1; ++cx) {
+        for (uint32_t e = heads_[bucket(cx, cy)]; e != kNone;
+             e = entries_[e].next) {
+          const Entry &entry = entries_[e];
+          if (entry.cx != cx || entry.cy != cy) {
+            continue;
+          }
+          const Object &object = objects_[entry.id];
+          if (cx == std::max(object.cells.x0, r.x0) &&
+              cy == std::max(object.cells.y0, r.y0)) {
+            f(entry.id, object.box);
+          }
+        }
+      }
+    }
+  }
+
+  template <typename Shape>
+  void batch(std::span<const Shape> shapes, SpatialQueryResults &results,
+             WorkStealingPool *pool) const;
+
+  /* Link into every cell of the object's range. update() reserves the
+   * entries first */
+  void link(uint32_t id) noexcept;
+  void unlink(uint32_t id) noexcept;
+  uint32_t allocateEntry() noexcept;
+};
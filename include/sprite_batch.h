@@ -0,0 +1,120 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include "radix_sort.h"
+#include "spatial_hash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/* Axis-aligned textured quad in pixel coordinates (origin top-left) */
+struct Sprite {
+  float x{};
+  float y{};
+  float width{};
+  float height{};
+  float u0{0.0f};
+  float v0{0.0f};
+  float u1{1.0f};
+  float v1{1.0f};
+  uint32_t color{0xFFFFFFFF}; // RGBA8, red in the lowest byte
+  GLuint texture{};           // 0 draws untextured (white)
+  GLuint program{};           // 0 uses the built-in sprite program
+  uint16_t layer{};           // lower layers are drawn first
+
+  static constexpr uint32_t rgba(uint8_t r, uint8_t g, uint8_t b,
+                                 uint8_t a = 255) noexcept {
+    return uint32_t{r} | uint32_t{g} << 8 | uint32_t{b} << 16 |
+           uint32_t{a} << 24;
+  }
+};
+
+/* Collects sprites for a frame and submits them with as few draw calls as
+ * possible. end() sorts by (layer, program, texture), writes all vertices
+ * into one streaming VBO that is orphaned on every map, and issues one
+ * glDrawElements per run of sprites that share state. Sprites that share
+ * state keep their submission order.
+ * Custom programs must use the built-in attribute layout
+ * (0: vec2 position, 1: vec2 uv, 2: vec4 color) and may read the
+ * uViewport (vec2, pixels) and uTexture (sampler2D) uniforms.
+ * Construct, use and destroy with the owning context current. */
+class SpriteBatch {
+public:
+  struct Stats {
+    size_t sprites{};
+    size_t draw_calls{};
+    size_t uploads{};
+
+    /* Sprites the spatial index left out of the batch */
+    size_t culled{};
+  };
+
+  explicit SpriteBatch(size_t capacity = 65536);
+  ~SpriteBatch();
+
+  SpriteBatch(const SpriteBatch &) = delete;
+  SpriteBatch &operator=(const SpriteBatch &) = delete;
+  SpriteBatch(SpriteBatch &&) = delete;
+  SpriteBatch &operator=(SpriteBatch &&) = delete;
+
+  /* Start a batch for a viewport of the given size in pixels */
+  void begin(float viewport_width, float viewport_height) noexcept;
+  void draw(const Sprite &sprite);
+
+  /* Append a contiguous run, e.g. the Sprite column of a World chunk */
+  void draw(std::span<const Sprite> sprites);
+
+  /* Append only the sprites that index places inside the viewport given to
+   * begin(); its ids are indices into sprites. Visible sprites keep their
+   * order, so this draws exactly what draw(sprites) would */
+  void draw(std::span<const Sprite> sprites, const SpatialHash &index);
+  void end() noexcept;
+
+  /* Counters for the most recent end() */
+  const Stats &stats() const noexcept;
+
+  size_t capacity() const noexcept;
+  GLuint program() const noexcept;
+
+private:
+  struct Vertex {
+    float x, y;
+    float u, v;
+    uint32_t color;
+  };
+
+  /* Where a program keeps the uniforms the batch sets */
+  struct Uniforms {
+    GLuint program{};
+    GLint viewport{-1};
+    GLint texture{-1};
+  };
+
+  size_t capacity_;
+  float viewport_width_{};
+  float viewport_height_{};
+  GLuint vao_{};
+  GLuint vbo_{};
+  GLuint ebo_{};
+  GLuint program_{};
+  GLuint white_texture_{};
+  Uniforms builtin_uniforms_{};
+
+  /* Custom programs seen this batch. Looked up again after every begin(),
+   * since a deleted program's name may come back with another layout */
+  std::vector<Uniforms> custom_uniforms_;
+  std::vector<Sprite> sprites_;
+  std::vector<SortEntry> order_;
+  std::vector<SortEntry> scratch_;
+  std::vector<uint32_t> visible_;
+  Stats stats_{};
+
+  void submit(size_t first, size_t count) noexcept;
+  void bindState(GLuint program, GLuint texture) noexcept;
+  Uniforms uniforms(GLuint program) noexcept;
+  static uint64_t sortKey(const Sprite &sprite) noexcept;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/* Bounded lock-free single-producer single-consumer FIFO.
+ * Storage is a fixed ring allocated with the queue, so pushing and popping
+ * never allocate. Head and tail are free-running counters on their own
+ * cache lines; each side also keeps a cached copy of the other side's
+ * counter and only re-reads the shared one when the cache says the ring is
+ * full (producer) or empty (consumer), so in steady state neither side
+ * touches the other's cache line.
+ * Exactly one thread may push and exactly one (possibly different) thread
+ * may pop at a time. */
+template <typename T, size_t Capacity> class SpscQueue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "SpscQueue capacity must be a power of two");
+  static_assert(std::is_nothrow_copy_assignable_v<T>,
+                "SpscQueue elements must be nothrow copy assignable");
+
+public:
+  SpscQueue() = default;
+
+  SpscQueue(const SpscQueue &) = delete;
+  SpscQueue &operator=(const SpscQueue &) = delete;
+  SpscQueue(SpscQueue &&) = delete;
+  SpscQueue &operator=(SpscQueue &&) = delete;
+
+  static constexpr size_t capacity() noexcept { return Capacity; }
+
+  /* Producer side. Returns false (and drops value) if the ring is full */
+  bool tryPush(const T &value) noexcept {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ == Capacity) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail - head_cache_ == Capacity) {
+        return false;
+      }
+    }
+
+    /* Release publishes the slot to the consumer's acquire of tail_ */
+    slots_[tail & kMask] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /* Consumer side. Returns false if the ring is empty */
+  bool tryPop(T &value) noexcept {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head == tail_cache_) {
+        return false;
+      }
+    }
+
+    /* Release hands the slot back to the producer's acquire of head_ */
+    value = slots_[head & kMask];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /* Consumer side. Calls f(const T &) for everything pushed so far and
+   * frees the slots with a single store at the end. Returns the count */
+  template <typename F>
+    requires std::is_nothrow_invocable_v<F &, const T &>
+  size_t drain(F &&f) noexcept {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    tail_cache_ = tail_.load(std::memory_order_acquire);
+    for (size_t i = head; i != tail_cache_; ++i) {
+      f(slots_[i & kMask]);
+    }
+    head_.store(tail_cache_, std::memory_order_release);
+    return tail_cache_ - head;
+  }
+
+  /* A snapshot; exact only when called from one of the two sides while the
+   * other is idle */
+  size_t size() const noexcept {
+    const size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+  }
+
+  bool empty() const noexcept { return size() == 0; }
+
+private:
+  static constexpr size_t kMask = Capacity - 1;
+
+  /* Producer's line */
+  alignas(64) std::atomic<size_t> tail_{0};
+  size_t head_cache_{0};
+
+  /* Consumer's line */
+  alignas(64) std::atomic<size_t> head_{0};
+  size_t tail_cache_{0};
+
+  alignas(64) std::array<T, Capacity> slots_{};
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "ecs.h"
+#include "inplace_function.h"
+#include "work_stealing_pool.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/* Runs systems over a World in parallel.
+ * A system names the components it touches: const ones are only read,
+ * the rest are written. Systems are grouped into phases in registration
+ * order; a system joins the current phase unless it writes something a
+ * system there reads or writes (or reads something one writes), in which
+ * case it starts a new phase. Within a phase every (system, chunk) pair
+ * is an independent job on a WorkStealingPool, so one system over many
+ * chunks and many systems over few chunks both spread across threads. */
+class SystemSchedule {
+public:
+  using Body = InplaceFunction<void(const ChunkView &), 64>;
+
+  /* 0 threads picks one per hardware thread */
+  explicit SystemSchedule(size_t threads = 0);
+
+  /* fn(count, C *...) is called once per chunk holding all of C, on any
+   * thread and concurrently for different chunks. Captures must fit
+   * Body's inline storage */
+  template <typename... C, typename F> void add(std::string_view name, F fn) {
+    static_assert(sizeof...(C) > 0, "Systems need at least one component");
+    static_assert(std::is_nothrow_invocable_v<F &, size_t, C *...>,
+                  "Systems must be noexcept and take (count, C *...)");
+    constexpr auto bit = [](auto id) { return ComponentMask{1} << id; };
+    insert(name, (ComponentMask{0} | ... |
+                  (std::is_const_v<C> ? bit(componentId<std::remove_const_t<C>>())
+                                      : 0)),
+           (ComponentMask{0} | ... |
+            (std::is_const_v<C> ? 0
+                                : bit(componentId<std::remove_const_t<C>>()))),
+           Body{[fn = std::move(fn)](const ChunkView &chunk) noexcept {
+             fn(chunk.size(), chunk.column<C>()...);
+           }});
+  }
+
+  /* Run every system once; returns when all phases are done */
+  void run(World &world);
+
+  size_t systemCount() const noexcept;
+  size_t phaseCount() const noexcept;
+
+  /* Phase of the i-th registered system */
+  size_t phase(size_t system) const noexcept;
+
+  /* Jobs in the most recent run() */
+  size_t lastJobs() const noexcept;
+
+  WorkStealingPool &pool() noexcept;
+
+private:
+  struct System {
+    std::string name;
+    ComponentMask reads{};
+    ComponentMask writes{};
+    size_t phase{};
+    Body body;
+  };
+
+  struct Job {
+    const System *system;
+    ChunkView chunk;
+  };
+
+  WorkStealingPool pool_;
+  std::vector<System> systems_;
+  size_t phases_{};
+  std::vector<Job> jobs_;
+  std::vector<ChunkView> chunks_;
+  size_t last_jobs_{};
+
+  void insert(std::string_view name, ComponentMask reads, ComponentMask writes,
+              Body body);
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include "atlas_packer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/* Images packed into the layers of one RGBA8 GL_TEXTURE_2D_ARRAY.
+ * An AtlasPacker places each image on a layer; the array's storage for all
+ * layers is allocated up front, so adding an image is one sub-image upload.
+ * Every image gets a region: its normalized rectangle and layer. Regions
+ * are mirrored into a texture buffer (two RGBA32F texels each: u0 v0 u1 v1,
+ * then layer) so shaders can look them up by index; Tilemap does.
+ * Sample with nearest filtering: images are packed without gutters.
+ * Construct, use and destroy with the owning context current. */
+class TextureAtlas {
+public:
+  /* Regions fit in a 16-bit tile index with 0 reserved for "empty" */
+  static constexpr size_t kMaxRegions = 65535;
+
+  struct Region {
+    float u0{};
+    float v0{};
+    float u1{};
+    float v1{};
+    uint32_t layer{};
+  };
+
+  /* RGBA8 pixels (red in the lowest byte), rows top to bottom */
+  struct Image {
+    std::span<const uint32_t> pixels;
+    uint32_t width{};
+    uint32_t height{};
+  };
+
+  /* Throws std::invalid_argument if any dimension is zero or too large for
+   * the driver */
+  TextureAtlas(uint32_t width, uint32_t height, uint32_t layers = 1);
+  ~TextureAtlas();
+
+  TextureAtlas(const TextureAtlas &) = delete;
+  TextureAtlas &operator=(const TextureAtlas &) = delete;
+  TextureAtlas(TextureAtlas &&) = delete;
+  TextureAtlas &operator=(TextureAtlas &&) = delete;
+
+  /* Pack one image and return its region index. Throws
+   * std::invalid_argument if the pixels don't match the size, and
+   * std::runtime_error if it doesn't fit in the remaining space */
+  uint32_t add(const Image &image);
+
+  /* Pack a known set together (tallest first, which packs tighter).
+   * Indices are in input order. Nothing is added if any image fails */
+  std::vector<uint32_t> addAll(std::span<const Image> images);
+
+  const Region &region(uint32_t index) const noexcept;
+  size_t regionCount() const noexcept;
+
+  GLuint texture() const noexcept;
+  GLuint regionTexture() const noexcept;
+  const AtlasPacker &packer() const noexcept;
+
+private:
+  AtlasPacker packer_;
+  GLuint texture_{};
+  GLuint region_buffer_{};
+  GLuint region_texture_{};
+  size_t region_capacity_{};
+  std::vector<Region> regions_;
+
+  void validate(const Image &image) const;
+  uint32_t store(const Image &image, AtlasPacker::Placement at);
+  void uploadRegions(size_t first);
+};
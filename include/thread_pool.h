@@ -0,0 +1,42 @@
+#pragma once
+
+#include "inplace_function.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Fixed set of worker threads draining a FIFO task queue.
+ * Tasks are noexcept and stored inline, like Window callbacks, so
+ * submitting one only allocates when the queue itself grows. The
+ * destructor runs every task already queued before joining. */
+class ThreadPool {
+public:
+  using Task = InplaceFunction<void(), 64>;
+
+  /* 0 threads picks one per hardware thread */
+  explicit ThreadPool(size_t threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ThreadPool(ThreadPool &&) = delete;
+  ThreadPool &operator=(ThreadPool &&) = delete;
+
+  void submit(Task task);
+
+  size_t size() const noexcept;
+
+private:
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<Task> tasks_;
+  bool stopping_{};
+  std::vector<std::thread> workers_;
+
+  void stop() noexcept;
+  void run() noexcept;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include "texture_atlas.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Grid of tiles drawn from a TextureAtlas, for maps far larger than the
+ * screen.
+ * Tiles are 16-bit indices: 0 is empty and n draws atlas region n - 1.
+ * The map is split into kChunkSize x kChunkSize chunks, stored chunk by
+ * chunk in one GL buffer. Editing a tile only marks its chunk dirty; draw()
+ * re-uploads the dirty chunks it is about to show, culls every chunk
+ * outside the viewport, skips empty ones, and draws each remaining chunk
+ * with a single instanced call (one instance per cell, positioned from
+ * gl_InstanceID, so the buffer holds nothing but tile indices).
+ * Construct, use and destroy with the owning context current. */
+class Tilemap {
+public:
+  static constexpr size_t kChunkSize = 32;
+  static constexpr size_t kChunkTiles = kChunkSize * kChunkSize;
+
+  struct Stats {
+    size_t chunks_drawn{};
+    size_t chunks_culled{};
+    size_t chunks_uploaded{};
+    size_t draw_calls{};
+  };
+
+  /* Size in tiles; tiles are drawn tile_width x tile_height pixels. Throws
+   * std::invalid_argument for an empty map or non-positive tile size, and
+   * ShaderError if the shaders fail to build */
+  Tilemap(size_t width, size_t height, float tile_width, float tile_height);
+  ~Tilemap();
+
+  Tilemap(const Tilemap &) = delete;
+  Tilemap &operator=(const Tilemap &) = delete;
+  Tilemap(Tilemap &&) = delete;
+  Tilemap &operator=(Tilemap &&) = delete;
+
+  /* Writes outside the map are ignored and reads return 0 */
+  void setTile(size_t x, size_t y, uint16_t tile) noexcept;
+  uint16_t tile(size_t x, size_t y) const noexcept;
+  void fill(uint16_t tile) noexcept;
+
+  /* Draw the part of the map seen by a viewport_width x viewport_height
+   * pixel view whose top-left corner sits at (camera_x, camera_y) in map
+   * pixels. Draws into the current framebuffer and viewport with
+   * alpha blending */
+  void draw(const TextureAtlas &atlas, float camera_x, float camera_y,
+            float viewport_width, float viewport_height) noexcept;
+
+  /* Counters for the most recent draw() */
+  const Stats &stats() const noexcept;
+
+  size_t width() const noexcept;
+  size_t height() const noexcept;
+  size_t chunksX() const noexcept;
+  size_t chunksY() const noexcept;
+
+private:
+  size_t width_;
+  size_t height_;
+  float tile_width_;
+  float tile_height_;
+  size_t chunks_x_;
+  size_t chunks_y_;
+
+  /* Chunk-major, so each chunk is one contiguous upload */
+  std::vector<uint16_t> tiles_;
+  std::vector<uint8_t> dirty_;
+
+  /* Non-empty tiles per chunk; chunks with none are never drawn */
+  std::vector<uint16_t> filled_;
+
+  GLuint vao_{};
+  GLuint vbo_{};
+  GLuint program_{};
+  GLint viewport_location_{-1};
+  GLint origin_location_{-1};
+  GLint tile_size_location_{-1};
+  Stats stats_{};
+
+  size_t index(size_t x, size_t y) const noexcept;
+  void upload(size_t chunk) noexcept;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/* Lock-free single-producer single-consumer triple buffer.
+ * The producer fills back() and publishes it; the consumer calls update()
+ * and reads front(). Publishing swaps the back slot with the shared middle
+ * slot, updating swaps the middle slot with the front slot, and each swap
+ * is a single atomic exchange. Neither side ever waits: the producer may
+ * publish faster than the consumer reads (intermediate snapshots are
+ * dropped), and the consumer keeps its current front() until something
+ * newer arrives.
+ * After publish() the new back() holds an older snapshot, so producers that
+ * build state incrementally should keep their own copy and use
+ * publish(value). */
+template <typename T> class TripleBuffer {
+public:
+  TripleBuffer() = default;
+
+  TripleBuffer(const TripleBuffer &) = delete;
+  TripleBuffer &operator=(const TripleBuffer &) = delete;
+  TripleBuffer(TripleBuffer &&) = delete;
+  TripleBuffer &operator=(TripleBuffer &&) = delete;
+
+  /* Producer side */
+  T &back() noexcept { return slots_[back_].value; }
+
+  void publish() noexcept {
+    /* Release makes the back slot's contents visible to the consumer's
+     * acquire in update() */
+    const uint8_t previous =
+        middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+    back_ = previous & kIndexMask;
+  }
+
+  template <typename U> void publish(U &&value) {
+    back() = std::forward<U>(value);
+    publish();
+  }
+
+  /* Consumer side. Returns true if front() changed */
+  bool update() noexcept {
+    if (!(middle_.load(std::memory_order_relaxed) & kFresh)) {
+      return false;
+    }
+    const uint8_t previous =
+        middle_.exchange(front_, std::memory_order_acq_rel);
+    front_ = previous & kIndexMask;
+    return true;
+  }
+
+  const T &front() const noexcept { return slots_[front_].value; }
+
+private:
+  static constexpr uint8_t kIndexMask = 0x3;
+  static constexpr uint8_t kFresh = 0x4;
+
+  /* Slots on separate cache lines so the two sides never false-share */
+  struct alignas(64) Slot {
+    T value{};
+  };
+
+  std::array<Slot, 3> slots_{};
+  alignas(64) std::atomic<uint8_t> middle_{1};
+  alignas(64) uint8_t back_{2};
+  alignas(64) uint8_t front_{0};
+};
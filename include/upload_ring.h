@@ -0,0 +1,112 @@
+#pragma once
+
+// clang-format off
+#include <glad/glad.h>
+// clang-format on
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* What a sub-allocation will be read as, which sets its alignment */
+enum class UploadKind : uint8_t { Vertex, Index, Uniform };
+
+/* A slice of the ring: write through data, then have GL read it from
+ * buffer at offset. Empty (false) when the allocation failed */
+struct UploadAllocation {
+  void *data{};
+  GLuint buffer{};
+  GLintptr offset{};
+  GLsizeiptr size{};
+
+  explicit operator bool() const noexcept { return data != nullptr; }
+};
+
+/* Streams per-frame vertex, index and uniform data without glBufferData.
+ * One buffer is split into regions (three by default), and each frame
+ * sub-allocates from the next region in turn. endFrame() fences the region
+ * behind the frame's draws, and the first allocation that comes back to a
+ * region waits on its fence. Unless the GPU runs more than regions - 1
+ * frames behind, the fence has already signalled and nothing stalls.
+ * The buffer is mapped with ARB_buffer_storage's persistent, coherent
+ * mapping where the driver has it: mapped once, written directly, never
+ * unmapped. Plain GL 3.3 maps the rest of the region unsynchronized on the
+ * first allocation after a flush and unmaps it in flush(), so draws must
+ * come after flush(). GLCapture can't see writes through a persistent
+ * mapping; use Mode::Unsynchronized to capture.
+ * A frame gets one region: allocations that don't fit in what is left of
+ * it fail (and are counted) rather than wait on a region still in flight.
+ * Construct, use and destroy with the owning context current. */
+class UploadRing {
+public:
+  enum class Mode : uint8_t { Auto, Unsynchronized, Persistent };
+
+  /* Totals since construction */
+  struct Stats {
+    uint64_t bytes_streamed{};
+    uint64_t allocations{};
+
+    /* Allocations that didn't fit in the frame's region */
+    uint64_t failures{};
+
+    /* Waits on a region the GPU was still reading, and their total time */
+    uint64_t stalls{};
+    uint64_t stall_ns{};
+
+    /* glMapBufferRange calls; a persistent ring maps once */
+    uint64_t maps{};
+  };
+
+  /* Auto picks Persistent when ARB_buffer_storage is available. Throws
+   * std::invalid_argument for zero sizes, and std::runtime_error when
+   * Persistent is asked for without ARB_buffer_storage or mapping fails */
+  explicit UploadRing(size_t region_bytes = 4 << 20, size_t regions = 3,
+                      Mode mode = Mode::Auto);
+  ~UploadRing();
+
+  UploadRing(const UploadRing &) = delete;
+  UploadRing &operator=(const UploadRing &) = delete;
+  UploadRing(UploadRing &&) = delete;
+  UploadRing &operator=(UploadRing &&) = delete;
+
+  /* Vertex data is 16-byte aligned, indices 4-byte aligned and uniforms
+   * to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT */
+  UploadAllocation allocate(UploadKind kind, size_t bytes) noexcept;
+
+  /* Offset is a multiple of alignment. data stays valid until flush() */
+  UploadAllocation allocate(size_t bytes, size_t alignment) noexcept;
+
+  /* Hand everything written since the last flush to GL. Call before the
+   * draws that read it */
+  void flush() noexcept;
+
+  /* Call after the frame's draws: flushes, fences the region and moves on
+   * to the next. A frame that allocated nothing keeps its region */
+  void endFrame() noexcept;
+
+  /* The mode in use, never Auto */
+  Mode mode() const noexcept;
+  GLuint buffer() const noexcept;
+  size_t regionBytes() const noexcept;
+  size_t regions() const noexcept;
+  const Stats &stats() const noexcept;
+
+private:
+  size_t region_bytes_;
+  Mode mode_;
+  size_t uniform_alignment_{};
+  GLuint buffer_{};
+  std::vector<GLsync> fences_;
+  size_t region_{};
+  size_t head_{};
+  bool waited_{};
+
+  /* Mapped bytes start at map_offset_ in the buffer. Persistent rings map
+   * the whole buffer; unsynchronized ones map from the first allocation
+   * after a flush to the end of the region */
+  uint8_t *mapped_{};
+  size_t map_offset_{};
+  Stats stats_{};
+
+  void waitForRegion() noexcept;
+  void release() noexcept;
+};
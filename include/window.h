@@ -4,15 +4,76 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 // clang-format on
-#include <functional>
+#include "frame_arena.h"
+#include "frame_profiler.h"
+#include "inplace_function.h"
+#include "input.h"
+#include "low_res_target.h"
+#include "offscreen_target.h"
+#include "software_rasterizer.h"
+#include <memory>
 #include <string>
 #include <string_view>
 #include <type_traits>
 #include <utility>
 
+/* Per-window creation options */
+struct WindowOptions {
+  /* Create a hidden window and render into an OffscreenTarget instead of
+   * the default framebuffer. Frames are read back asynchronously rather than
+   * swapped, so this works without a visible surface (e.g. Xvfb + llvmpipe) */
+  bool headless = false;
+
+  /* Fixed logical resolution (0 = render at window resolution). Callbacks
+   * draw into a LowResTarget of this size, which is integer-scaled and
+   * letterboxed onto the window every frame */
+  size_t logical_width = 0;
+  size_t logical_height = 0;
+
+  /* Bytes per frame for a double-buffered FrameArena (0 = none). The arena
+   * flips at the end of every render() */
+  size_t frame_arena_bytes = 0;
+
+  /* Draw with a SoftwareRasterizer instead of the GPU. It covers the
+   * logical resolution (or the window) and its frame is uploaded into
+   * framebuffer() after the render callback. Headless software windows
+   * skip GL output entirely: read frames from software()->pixels() */
+  bool software = false;
+
+  /* Rasterizer threads (0 = one per hardware thread) */
+  size_t software_threads = 0;
+
+  /* Render only when something changed: Window::update() sleeps in
+   * glfwWaitEvents until input, a resize, an expose, a timer or
+   * invalidate() gives it something to draw */
+  bool on_demand = false;
+
+  /* Whether input events invalidate the whole frame in on-demand mode.
+   * Turn off to invalidate exactly what the input changed instead */
+  bool redraw_on_input = true;
+
+  /* Queue every key, character, mouse button, cursor and scroll callback
+   * as a timestamped InputEvent for input(), and measure input-to-photon
+   * latency against each swap */
+  bool input_events = false;
+};
+
 class Window {
-  // TODO: have callbacks be std::move_only_function once clang supports it
-  // https://github.com/llvm/llvm-project/pull/94670
+public:
+  /* Pixel rectangle in framebuffer() coordinates, origin top-left */
+  struct Rect {
+    int x{};
+    int y{};
+    int width{};
+    int height{};
+
+    friend bool operator==(const Rect &, const Rect &) = default;
+  };
+
+  /* Inline storage for callback captures. Callbacks never allocate; a
+   * lambda whose captures don't fit fails to compile */
+  static constexpr size_t kCallbackCapacity = 64;
+
   template <typename> struct NoExceptFunctor;
 
   template <typename R, typename... Args> struct NoExceptFunctor<R(Args...)> {
@@ -41,24 +102,41 @@ class Window {
       return static_cast<bool>(functor_);
     }
 
+    /* An empty InplaceFunction already returns R{}, so no null check */
     R operator()(Args... args) const noexcept {
-      if constexpr (std::is_void_v<R>) {
-        if (functor_) {
-          functor_(std::forward<Args>(args)...);
-        }
-      } else {
-        return functor_ ? functor_(std::forward<Args>(args)...) : R{};
-      }
+      return functor_(std::forward<Args>(args)...);
     }
 
   private:
-    std::function<R(Args...)> functor_{};
+    InplaceFunction<R(Args...), kCallbackCapacity> functor_{};
+  };
+
+  /* Hidden context in this window's share group, for creating GL objects on
+   * another thread (textures, buffers, programs and syncs are shared; VAOs
+   * and FBOs are not). Create and destroy it on the thread that owns the
+   * windows; make it current on exactly one other thread. It keeps GLFW
+   * alive like a window does */
+  class SharedContext {
+  public:
+    explicit SharedContext(const Window &window);
+    ~SharedContext();
+
+    SharedContext(const SharedContext &) = delete;
+    SharedContext &operator=(const SharedContext &) = delete;
+    SharedContext(SharedContext &&) = delete;
+    SharedContext &operator=(SharedContext &&) = delete;
+
+    /* GL functions are already loaded by the window */
+    void makeCurrent() const noexcept;
+
+  private:
+    GLFWwindow *context_{};
   };
 
-public:
   Window(size_t width, size_t height, std::string_view title,
          const NoExceptFunctor<void()> &init_cb,
-         NoExceptFunctor<void()> render_cb, NoExceptFunctor<void()> cleanup_cb);
+         NoExceptFunctor<void()> render_cb, NoExceptFunctor<void()> cleanup_cb,
+         const WindowOptions &options = {});
 
   ~Window();
 
@@ -70,16 +148,94 @@ public:
 
   void render();
 
+  /* One iteration of an event loop. Continuous windows poll events and
+   * render. On-demand windows wait for events while there is nothing to
+   * draw, then render if there is. Returns whether a frame was rendered */
+  bool update();
+
+  /* Whether update() renders without waiting */
+  bool needsRender() const noexcept;
+
+  /* Redraw the whole frame. Safe to call from any thread; wakes update() */
+  void invalidate() noexcept;
+
+  /* Redraw part of the frame. Damage accumulates as a bounding box until
+   * the next render(). Windows that draw straight into the default
+   * framebuffer redraw everything, since its contents don't survive a swap */
+  void invalidate(Rect rect) noexcept;
+
+  /* Redraw the whole frame `seconds` from now, e.g. for a blinking cursor.
+   * The earliest pending timer wins */
+  void invalidateAfter(double seconds) noexcept;
+
+  /* Render on every update() while set, e.g. during an animation */
+  void setAnimating(bool animating) noexcept;
+
+  /* The area the current frame redraws (the whole frame unless on-demand
+   * damage is partial). render() restricts drawing to it with the scissor
+   * test, so callbacks may skip anything outside but must leave
+   * GL_SCISSOR_TEST and the scissor box alone */
+  Rect damage() const noexcept;
+
   bool shouldClose() const noexcept;
 
   void destroy() noexcept;
 
   static void pollEvents() noexcept;
 
+  /* Sleep until an event arrives or `timeout` seconds pass, then process
+   * pending events */
+  static void waitEvents(double timeout) noexcept;
+
+  /* Make this window's context current on the calling thread, e.g. after a
+   * RenderThread has been using it */
+  void makeCurrent();
+
+  /* Detach whatever context is current on the calling thread so another
+   * thread can make it current */
+  static void releaseContext() noexcept;
+
+  /* Screen updates to wait for in each swap (0 = don't wait for vsync).
+   * Makes the context current on the calling thread */
+  void setSwapInterval(int interval);
+
   size_t width() const noexcept;
   size_t height() const noexcept;
   std::string_view title() const noexcept;
 
+  /* Opt-in frame timing. The profiler is created/destroyed on this window's
+   * context; profiler() returns nullptr while profiling is disabled */
+  void setProfiling(bool enabled);
+  FrameProfiler *profiler() const noexcept;
+
+  /* Headless rendering. offscreen() returns nullptr unless the window was
+   * created headless without a software rasterizer */
+  bool headless() const noexcept;
+  OffscreenTarget *offscreen() const noexcept;
+
+  /* Logical resolution. lowRes() returns nullptr unless a logical size was
+   * requested */
+  LowResTarget *lowRes() const noexcept;
+
+  /* Transient per-frame allocations. frameArena() returns nullptr unless
+   * an arena size was requested */
+  FrameArena *frameArena() const noexcept;
+
+  /* CPU rendering. software() returns nullptr unless the window was
+   * created with the software option; callbacks record into it and
+   * render() finishes and presents the frame */
+  SoftwareRasterizer *software() const noexcept;
+
+  /* Input events. input() returns nullptr unless the window was created
+   * with the input_events option. GLFW pushes from whichever thread polls
+   * events; one other thread (or the same one) drains. The queue stays put
+   * while the window moves */
+  InputQueue *input() const noexcept;
+
+  /* The FBO callbacks should treat as the default target: the logical
+   * framebuffer, the headless framebuffer, or 0 for a plain window */
+  GLuint framebuffer() const noexcept;
+
 private:
   GLFWwindow *window_{};
   size_t width_{};
@@ -87,9 +243,36 @@ private:
   std::string title_;
   NoExceptFunctor<void()> render_cb_{};
   NoExceptFunctor<void()> cleanup_cb_{};
+  std::unique_ptr<FrameProfiler> profiler_{};
+  std::unique_ptr<OffscreenTarget> offscreen_{};
+  std::unique_ptr<LowResTarget> low_res_{};
+  std::unique_ptr<FrameArena> frame_arena_{};
+  std::unique_ptr<SoftwareRasterizer> software_{};
+  bool headless_{};
+
+  std::unique_ptr<InputQueue> input_{};
+
+  /* On-demand state */
+  struct Redraw;
+  std::unique_ptr<Redraw> redraw_{};
+
+  /* What the GLFW callbacks reach through the window user pointer.
+   * Heap-allocated so it stays put while the Window moves */
+  struct Events;
+  std::unique_ptr<Events> events_{};
 
   static size_t window_count_;
+  static bool gl_loaded_;
+
+  static void release_glfw() noexcept;
 
   void swap(Window &other);
   bool load_context() noexcept;
+  void bind_target() const noexcept;
+  void present() const noexcept;
+  void present_software() const noexcept;
+  Rect target_rect() const noexcept;
+  Rect framebuffer_rect() const noexcept;
+  bool take_damage() noexcept;
+  void install_callbacks() noexcept;
 };
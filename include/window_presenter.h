@@ -0,0 +1,74 @@
+#pragma once
+
+#include "window.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Owns a set of windows and renders one frame of each per present().
+ * Rendering N windows back to back with vsync on waits for N vertical
+ * blanks per frame. The presenter makes the first window added the vsync
+ * leader (swap interval 1) and gives every other window interval 0, so a
+ * frame waits for at most one blank however many windows there are.
+ * With Threading::PerWindow each window's context lives on its own thread.
+ * present() starts a frame on all of them and returns once every window
+ * has rendered, so the swaps overlap instead of queuing. Windows are
+ * destroyed on the thread that destroys the presenter. */
+class WindowPresenter {
+public:
+  enum class Threading { SingleThread, PerWindow };
+
+  explicit WindowPresenter(Threading threading = Threading::SingleThread,
+                           bool vsync = true);
+  ~WindowPresenter();
+
+  WindowPresenter(const WindowPresenter &) = delete;
+  WindowPresenter &operator=(const WindowPresenter &) = delete;
+  WindowPresenter(WindowPresenter &&) = delete;
+  WindowPresenter &operator=(WindowPresenter &&) = delete;
+
+  /* Take ownership of a window; returns its index. With PerWindow the
+   * window's context moves to its thread, so afterwards only its
+   * shouldClose() may be used from other threads */
+  size_t add(Window window);
+
+  /* Render one frame of every window. Rethrows the first exception any
+   * window's render() threw */
+  void present();
+
+  /* True once any window has been asked to close */
+  bool shouldClose() const noexcept;
+
+  Window &window(size_t index) noexcept;
+  size_t size() const noexcept;
+  uint64_t frames() const noexcept;
+
+private:
+  struct Slot {
+    explicit Slot(Window &&w) : window{std::move(w)} {}
+
+    Window window;
+    std::thread thread{};
+    std::exception_ptr error{};
+  };
+
+  Threading threading_;
+  bool vsync_;
+  std::vector<std::unique_ptr<Slot>> slots_;
+  uint64_t frames_{};
+
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  uint64_t generation_{};
+  size_t pending_{};
+  bool stopping_{};
+
+  void run(Slot &slot, uint64_t generation) noexcept;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/* Worker threads for data-parallel loops.
+ * parallelFor() deals the indices out as contiguous blocks, one deque per
+ * thread (the caller included). Each thread drains its own block front to
+ * back, then steals from the back of the others, so uneven jobs balance
+ * out without a shared queue. Only one parallelFor() may run at a time. */
+class WorkStealingPool {
+public:
+  /* 0 threads picks one per hardware thread; the caller counts as one */
+  explicit WorkStealingPool(size_t threads = 0);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+  WorkStealingPool(WorkStealingPool &&) = delete;
+  WorkStealingPool &operator=(WorkStealingPool &&) = delete;
+
+  /* Call fn(i) for every i in [0, count) and return once all calls have */
+  template <typename F> void parallelFor(size_t count, F &&fn) {
+    static_assert(std::is_nothrow_invocable_v<F &, size_t>,
+                  "parallelFor bodies must be noexcept");
+    using Fn = std::remove_reference_t<F>;
+    run(count, const_cast<void *>(static_cast<const void *>(&fn)),
+        [](void *context, size_t i) noexcept {
+          (*static_cast<Fn *>(context))(i);
+        });
+  }
+
+  size_t size() const noexcept;
+
+  /* Jobs taken from another thread's deque since construction */
+  uint64_t steals() const noexcept;
+
+private:
+  using Call = void (*)(void *, size_t) noexcept;
+
+  struct alignas(64) Queue {
+    std::mutex mutex;
+    std::deque<size_t> jobs;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  uint64_t epoch_{};
+  bool stopping_{};
+  void *context_{};
+  Call call_{};
+  std::atomic<size_t> remaining_{};
+  std::atomic<uint64_t> steals_{};
+
+  void run(size_t count, void *context, Call call);
+  void work(size_t self) noexcept;
+  bool take(size_t self, size_t &job) noexcept;
+  void stop() noexcept;
+  void loop(size_t self) noexcept;
+};
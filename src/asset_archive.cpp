@@ -0,0 +1,278 @@
+#include "asset_archive.h"
+#include "hash.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Archives are written and mapped in native byte order */
+static_assert(std::endian::native == std::endian::little,
+              "AssetArchive assumes a little-endian host");
+
+namespace {
+constexpr char kMagic[4] = {'L', 'R', 'P', 'K'};
+constexpr uint32_t kVersion = 1;
+
+size_t alignUp(size_t value) noexcept {
+  return (value + AssetArchive::kAlignment - 1) &
+         ~(AssetArchive::kAlignment - 1);
+}
+} // namespace
+
+struct AssetArchive::Header {
+  char magic[4];
+  uint32_t version;
+  uint64_t count;
+  uint64_t index_offset;
+  uint64_t names_offset;
+  uint64_t names_length;
+};
+
+struct AssetArchive::Entry {
+  uint64_t hash;
+  uint64_t offset;
+  uint64_t size;
+  uint32_t name_offset;
+  uint32_t name_length;
+};
+
+AssetArchive::AssetArchive(const std::filesystem::path &path) {
+#ifdef _WIN32
+  file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    file_ = nullptr;
+    throw std::runtime_error("Unable to open archive " + path.string());
+  }
+  LARGE_INTEGER size{};
+  GetFileSizeEx(file_, &size);
+  length_ = static_cast<size_t>(size.QuadPart);
+  if (length_ > 0) {
+    mapping_ =
+        CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    data_ = mapping_ ? static_cast<const uint8_t *>(
+                           MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0))
+                     : nullptr;
+  }
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error("Unable to open archive " + path.string());
+  }
+  struct stat st{};
+  if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+    length_ = static_cast<size_t>(st.st_size);
+    void *mapped = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+    data_ = mapped == MAP_FAILED ? nullptr : static_cast<uint8_t *>(mapped);
+  }
+  /* The mapping keeps the file alive */
+  ::close(fd);
+#endif
+
+  if (!data_) {
+    unmap();
+    throw std::runtime_error("Unable to map archive " + path.string());
+  }
+
+  /* Only the header and the extent of the index are checked here; entry
+   * bounds are checked when an entry is looked up */
+  Header header{};
+  bool valid = length_ >= sizeof(Header);
+  if (valid) {
+    std::memcpy(&header, data_, sizeof(Header));
+    valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+            header.version == kVersion &&
+            header.index_offset % alignof(Entry) == 0 &&
+            header.index_offset <= length_ &&
+            header.count <= (length_ - header.index_offset) / sizeof(Entry) &&
+            header.names_offset <= length_ &&
+            header.names_length <= length_ - header.names_offset;
+  }
+  if (!valid) {
+    unmap();
+    throw std::runtime_error("Invalid archive " + path.string());
+  }
+
+  entries_ = reinterpret_cast<const Entry *>(data_ + header.index_offset);
+  count_ = static_cast<size_t>(header.count);
+  names_ = reinterpret_cast<const char *>(data_ + header.names_offset);
+  names_length_ = static_cast<size_t>(header.names_length);
+}
+
+AssetArchive::~AssetArchive() { unmap(); }
+
+std::optional<std::span<const uint8_t>>
+AssetArchive::find(std::string_view name) const noexcept {
+  const uint64_t hash = fnv1a(name);
+  const Entry *end = entries_ + count_;
+  const Entry *it =
+      std::lower_bound(entries_, end, hash, [](const Entry &e, uint64_t h) {
+        return e.hash < h;
+      });
+
+  /* Colliding hashes are adjacent; tell them apart by name */
+  for (; it != end && it->hash == hash; ++it) {
+    if (this->name(static_cast<size_t>(it - entries_)) == name) {
+      if (it->offset > length_ || it->size > length_ - it->offset) {
+        return std::nullopt;
+      }
+      return bytes(*it);
+    }
+  }
+  return std::nullopt;
+}
+
+bool AssetArchive::contains(std::string_view name) const noexcept {
+  return find(name).has_value();
+}
+
+size_t AssetArchive::size() const noexcept { return count_; }
+
+std::string_view AssetArchive::name(size_t index) const noexcept {
+  if (index >= count_) {
+    return {};
+  }
+  const Entry &entry = entries_[index];
+  if (entry.name_offset > names_length_ ||
+      entry.name_length > names_length_ - entry.name_offset) {
+    return {};
+  }
+  return {names_ + entry.name_offset, entry.name_length};
+}
+
+std::span<const uint8_t> AssetArchive::bytes(const Entry &entry) const
+    noexcept {
+  return {data_ + entry.offset, static_cast<size_t>(entry.size)};
+}
+
+void AssetArchive::unmap() noexcept {
+#ifdef _WIN32
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_) {
+    CloseHandle(mapping_);
+  }
+  if (file_) {
+    CloseHandle(file_);
+  }
+  mapping_ = file_ = nullptr;
+#else
+  if (data_) {
+    ::munmap(const_cast<uint8_t *>(data_), length_);
+  }
+#endif
+  data_ = nullptr;
+}
+
+void AssetArchiveBuilder::add(std::string name,
+                              std::span<const uint8_t> data) {
+  if (name.empty() || name.size() > UINT32_MAX) {
+    throw std::invalid_argument("Archive entry name is empty or too long");
+  }
+  if (!names_.insert(name).second) {
+    throw std::invalid_argument("Duplicate archive entry " + name);
+  }
+  entries_.push_back({std::move(name), {data.begin(), data.end()}});
+}
+
+void AssetArchiveBuilder::addFile(std::string name,
+                                  const std::filesystem::path &path) {
+  std::ifstream in{path, std::ios::binary | std::ios::ate};
+  if (!in) {
+    throw std::runtime_error("Unable to read " + path.string());
+  }
+  std::vector<uint8_t> data(static_cast<size_t>(in.tellg()));
+  in.seekg(0);
+  if (!in.read(reinterpret_cast<char *>(data.data()),
+               static_cast<std::streamsize>(data.size()))) {
+    throw std::runtime_error("Unable to read " + path.string());
+  }
+  add(std::move(name), data);
+}
+
+size_t AssetArchiveBuilder::size() const noexcept { return entries_.size(); }
+
+void AssetArchiveBuilder::write(const std::filesystem::path &path) const {
+  using Entry = AssetArchive::Entry;
+  using Header = AssetArchive::Header;
+
+  /* Lay out the data, then the index, then the names */
+  std::vector<Entry> index;
+  index.reserve(entries_.size());
+  std::string names;
+  size_t offset = alignUp(sizeof(Header));
+  for (const auto &pending : entries_) {
+    if (names.size() + pending.name.size() > UINT32_MAX) {
+      throw std::runtime_error("Archive name table too large");
+    }
+    index.push_back({fnv1a(pending.name), offset, pending.data.size(),
+                     static_cast<uint32_t>(names.size()),
+                     static_cast<uint32_t>(pending.name.size())});
+    names += pending.name;
+    offset = alignUp(offset + pending.data.size());
+  }
+
+  /* Sorted by hash for binary search, ties broken by name */
+  const auto nameOf = [&names](const Entry &e) {
+    return std::string_view{names}.substr(e.name_offset, e.name_length);
+  };
+  std::sort(index.begin(), index.end(),
+            [&nameOf](const Entry &a, const Entry &b) {
+              return a.hash != b.hash ? a.hash < b.hash : nameOf(a) < nameOf(b);
+            });
+
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.count = index.size();
+  header.index_offset = offset;
+  header.names_offset = offset + index.size() * sizeof(Entry);
+  header.names_length = names.size();
+
+  /* Write then rename so readers never map a half-written archive */
+  auto tmp = path;
+  tmp += ".tmp";
+  {
+    std::ofstream out{tmp, std::ios::binary | std::ios::trunc};
+    const char padding[AssetArchive::kAlignment]{};
+    const auto put = [&out](const void *data, size_t size) {
+      out.write(static_cast<const char *>(data),
+                static_cast<std::streamsize>(size));
+    };
+
+    put(&header, sizeof(header));
+    size_t written = sizeof(header);
+    for (const auto &pending : entries_) {
+      put(padding, alignUp(written) - written);
+      written = alignUp(written);
+      put(pending.data.data(), pending.data.size());
+      written += pending.data.size();
+    }
+    put(padding, alignUp(written) - written);
+    put(index.data(), index.size() * sizeof(Entry));
+    put(names.data(), names.size());
+
+    if (!out.flush()) {
+      out.close();
+      std::error_code ec;
+      std::filesystem::remove(tmp, ec);
+      throw std::runtime_error("Unable to write " + tmp.string());
+    }
+  }
+
+  std::filesystem::rename(tmp, path);
+}
@@ -0,0 +1,355 @@
+#include "asset_streamer.h"
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+bool readFile(const std::filesystem::path &path, std::vector<uint8_t> &out) {
+  std::ifstream in{path, std::ios::binary | std::ios::ate};
+  if (!in) {
+    return false;
+  }
+
+  const auto size = in.tellg();
+  if (size < 0) {
+    return false;
+  }
+  out.resize(static_cast<size_t>(size));
+  in.seekg(0);
+  return static_cast<bool>(
+      in.read(reinterpret_cast<char *>(out.data()), size));
+}
+
+/* Next unsigned integer in a PPM header, skipping whitespace and comments */
+bool ppmToken(const std::vector<uint8_t> &file, size_t &pos, size_t &value) {
+  while (pos < file.size()) {
+    if (file[pos] == '#') {
+      while (pos < file.size() && file[pos] != '\n') {
+        ++pos;
+      }
+    } else if (std::isspace(file[pos])) {
+      ++pos;
+    } else {
+      break;
+    }
+  }
+
+  value = 0;
+  const size_t start = pos;
+  while (pos < file.size() && std::isdigit(file[pos]) && pos - start < 9) {
+    value = value * 10 + (file[pos++] - '0');
+  }
+  return pos > start;
+}
+
+/* Binary PPM (P6, maxval 255) to RGBA8 with opaque alpha */
+bool decodePpm(const std::vector<uint8_t> &file, std::vector<uint8_t> &rgba,
+               size_t &width, size_t &height) {
+  size_t pos = 2;
+  size_t maxval = 0;
+  if (file.size() < 2 || file[0] != 'P' || file[1] != '6' ||
+      !ppmToken(file, pos, width) || !ppmToken(file, pos, height) ||
+      !ppmToken(file, pos, maxval) || maxval != 255 || width == 0 ||
+      height == 0 || pos >= file.size() || !std::isspace(file[pos])) {
+    return false;
+  }
+
+  /* Exactly one whitespace byte separates the header from the pixels */
+  ++pos;
+  const size_t pixels = width * height;
+  if (file.size() - pos < pixels * 3) {
+    return false;
+  }
+
+  rgba.resize(pixels * 4);
+  const uint8_t *src = file.data() + pos;
+  for (size_t i = 0; i < pixels; ++i) {
+    rgba[i * 4] = src[i * 3];
+    rgba[i * 4 + 1] = src[i * 3 + 1];
+    rgba[i * 4 + 2] = src[i * 3 + 2];
+    rgba[i * 4 + 3] = 255;
+  }
+  return true;
+}
+} // namespace
+
+AssetStreamer::AssetStreamer(const Window &window, size_t io_threads,
+                             size_t capacity)
+    : capacity_{capacity}, context_{window} {
+  if (capacity_ == 0 || capacity_ > UINT32_MAX) {
+    throw std::invalid_argument("AssetStreamer capacity out of range");
+  }
+
+  assets_ = std::make_unique<Asset[]>(capacity_);
+  io_ = std::make_unique<ThreadPool>(io_threads);
+  uploader_ = std::thread{&AssetStreamer::uploadLoop, this};
+}
+
+AssetStreamer::~AssetStreamer() {
+  /* Readers may still hand work to the uploader, so they stop first */
+  io_.reset();
+  {
+    std::lock_guard lock{mutex_};
+    stopping_ = true;
+  }
+  pending_.notify_all();
+  uploader_.join();
+
+  for (size_t i = 0; i < count_; ++i) {
+    Asset &asset = assets_[i];
+    if (asset.fence) {
+      glDeleteSync(asset.fence);
+    }
+    if (asset.kind == Kind::Texture) {
+      glDeleteTextures(1, &asset.name);
+    } else {
+      glDeleteBuffers(1, &asset.name);
+    }
+  }
+}
+
+AssetStreamer::Id AssetStreamer::loadTexture(std::filesystem::path path) {
+  return enqueue(Kind::Texture, std::move(path));
+}
+
+AssetStreamer::Id AssetStreamer::loadBuffer(std::filesystem::path path) {
+  return enqueue(Kind::Buffer, std::move(path));
+}
+
+AssetStreamer::Status AssetStreamer::status(Id id) noexcept {
+  if (id >= count_) {
+    return Status::Failed;
+  }
+
+  Asset &asset = assets_[id];
+  switch (asset.state.load(std::memory_order_acquire)) {
+  case State::Ready:
+    return Status::Ready;
+  case State::Failed:
+    return Status::Failed;
+  case State::Fenced:
+    break;
+  default:
+    return Status::Loading;
+  }
+
+  /* A zero timeout polls the fence without flushing or waiting */
+  const GLenum result = glClientWaitSync(asset.fence, 0, 0);
+  if (result == GL_TIMEOUT_EXPIRED) {
+    return Status::Loading;
+  }
+
+  glDeleteSync(asset.fence);
+  asset.fence = nullptr;
+  if (result == GL_WAIT_FAILED) {
+    asset.state.store(State::Failed, std::memory_order_relaxed);
+    ++failed_;
+    return Status::Failed;
+  }
+
+  asset.state.store(State::Ready, std::memory_order_relaxed);
+  return Status::Ready;
+}
+
+GLuint AssetStreamer::name(Id id) const noexcept {
+  return id < count_ && assets_[id].state.load(std::memory_order_acquire) ==
+                            State::Ready
+             ? assets_[id].name
+             : 0;
+}
+
+size_t AssetStreamer::width(Id id) const noexcept {
+  return name(id) ? assets_[id].width : 0;
+}
+
+size_t AssetStreamer::height(Id id) const noexcept {
+  return name(id) ? assets_[id].height : 0;
+}
+
+size_t AssetStreamer::bytes(Id id) const noexcept {
+  return name(id) ? assets_[id].bytes : 0;
+}
+
+void AssetStreamer::finish() {
+  std::unique_lock lock{mutex_};
+  idle_.wait(lock, [this] { return in_flight_ == 0; });
+}
+
+AssetStreamer::Stats AssetStreamer::stats() const noexcept {
+  return {pbo_uploads_.load(), direct_uploads_.load(), bytes_uploaded_.load(),
+          failed_.load()};
+}
+
+AssetStreamer::Id AssetStreamer::enqueue(Kind kind,
+                                         std::filesystem::path path) {
+  if (count_ == capacity_) {
+    throw std::runtime_error("AssetStreamer is full");
+  }
+
+  const auto id = static_cast<Id>(count_++);
+  Asset &asset = assets_[id];
+  asset.kind = kind;
+  asset.path = std::move(path);
+
+  {
+    std::lock_guard lock{mutex_};
+    ++in_flight_;
+  }
+  io_->submit([this, id]() noexcept { read(id); });
+  return id;
+}
+
+void AssetStreamer::read(Id id) noexcept {
+  Asset &asset = assets_[id];
+
+  try {
+    std::vector<uint8_t> file;
+    bool ok = readFile(asset.path, file);
+    if (ok && asset.kind == Kind::Texture) {
+      ok = decodePpm(file, asset.data, asset.width, asset.height);
+    } else if (ok) {
+      asset.data = std::move(file);
+    }
+
+    if (!ok) {
+      complete(asset, State::Failed);
+      return;
+    }
+  } catch (...) {
+    complete(asset, State::Failed);
+    return;
+  }
+
+  asset.bytes = asset.data.size();
+  asset.state.store(State::Uploading, std::memory_order_relaxed);
+  {
+    std::lock_guard lock{mutex_};
+    uploads_.push_back(id);
+  }
+  pending_.notify_one();
+}
+
+void AssetStreamer::uploadLoop() noexcept {
+  context_.makeCurrent();
+
+  /* The ring is allocated once; every upload reuses one of its slots */
+  glGenBuffers(kPboCount, pbos_.data());
+  for (GLuint pbo : pbos_) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, kPboSize, nullptr, GL_STREAM_DRAW);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  for (;;) {
+    Id id;
+    {
+      std::unique_lock lock{mutex_};
+      pending_.wait(lock, [this] { return stopping_ || !uploads_.empty(); });
+      if (uploads_.empty()) {
+        break;
+      }
+      id = uploads_.front();
+      uploads_.pop_front();
+    }
+    upload(assets_[id]);
+  }
+
+  for (GLsync fence : pbo_fences_) {
+    if (fence) {
+      glDeleteSync(fence);
+    }
+  }
+  glDeleteBuffers(kPboCount, pbos_.data());
+  glFlush();
+
+  Window::releaseContext();
+}
+
+void AssetStreamer::upload(Asset &asset) noexcept {
+  const size_t bytes = asset.data.size();
+  const GLenum staging = asset.kind == Kind::Texture ? GL_PIXEL_UNPACK_BUFFER
+                                                     : GL_COPY_READ_BUFFER;
+
+  /* Stage through the next ring slot, once the GPU is done with it. The
+   * slot's fence makes an unsynchronized map safe */
+  size_t slot = kPboCount;
+  if (bytes > 0 && bytes <= kPboSize) {
+    slot = next_pbo_;
+    next_pbo_ = (next_pbo_ + 1) % kPboCount;
+
+    if (GLsync &fence = pbo_fences_[slot]) {
+      glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+
+    glBindBuffer(staging, pbos_[slot]);
+    void *dst = glMapBufferRange(staging, 0, static_cast<GLsizeiptr>(bytes),
+                                 GL_MAP_WRITE_BIT |
+                                     GL_MAP_INVALIDATE_RANGE_BIT |
+                                     GL_MAP_UNSYNCHRONIZED_BIT);
+    if (dst) {
+      std::memcpy(dst, asset.data.data(), bytes);
+    }
+    if (!dst || !glUnmapBuffer(staging)) {
+      glBindBuffer(staging, 0);
+      slot = kPboCount;
+    }
+  }
+
+  const bool staged = slot < kPboCount;
+  const void *source = staged ? nullptr : asset.data.data();
+
+  if (asset.kind == Kind::Texture) {
+    glGenTextures(1, &asset.name);
+    glBindTexture(GL_TEXTURE_2D, asset.name);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8,
+                 static_cast<GLsizei>(asset.width),
+                 static_cast<GLsizei>(asset.height), 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, source);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  } else {
+    glGenBuffers(1, &asset.name);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, asset.name);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(bytes), source,
+                 GL_STATIC_DRAW);
+    if (staged) {
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                          static_cast<GLsizeiptr>(bytes));
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  }
+
+  if (staged) {
+    glBindBuffer(staging, 0);
+    pbo_fences_[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++pbo_uploads_;
+  } else {
+    ++direct_uploads_;
+  }
+
+  /* Other contexts only see the fence once it has reached the GPU */
+  asset.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush();
+
+  bytes_uploaded_ += bytes;
+  std::vector<uint8_t>{}.swap(asset.data);
+  complete(asset, State::Fenced);
+}
+
+void AssetStreamer::complete(Asset &asset, State state) noexcept {
+  if (state == State::Failed) {
+    ++failed_;
+  }
+  asset.state.store(state, std::memory_order_release);
+
+  {
+    std::lock_guard lock{mutex_};
+    --in_flight_;
+  }
+  idle_.notify_all();
+}
@@ -0,0 +1,142 @@
+#include "atlas_packer.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+AtlasPacker::AtlasPacker(uint32_t page_width, uint32_t page_height,
+                         uint32_t max_pages)
+    : page_width_{page_width}, page_height_{page_height},
+      max_pages_{max_pages} {
+  if (page_width_ == 0 || page_height_ == 0 || max_pages_ == 0) {
+    throw std::invalid_argument("AtlasPacker dimensions must be non-zero");
+  }
+  skylines_.push_back({{0, 0, page_width_}});
+}
+
+std::optional<AtlasPacker::Placement> AtlasPacker::insert(Size size) {
+  if (size.width == 0 || size.height == 0 || size.width > page_width_ ||
+      size.height > page_height_) {
+    return std::nullopt;
+  }
+
+  /* Lowest top edge wins, then the leftmost spot, then the earliest page */
+  uint32_t best_top = std::numeric_limits<uint32_t>::max();
+  uint32_t best_x = 0;
+  size_t best_page = 0;
+  size_t best_index = 0;
+  for (size_t page = 0; page < skylines_.size(); ++page) {
+    const auto &skyline = skylines_[page];
+    for (size_t i = 0; i < skyline.size(); ++i) {
+      const auto y = fit(skyline, i, size);
+      if (!y) {
+        continue;
+      }
+      const uint32_t top = *y + size.height;
+      if (top < best_top || (top == best_top && skyline[i].x < best_x)) {
+        best_top = top;
+        best_x = skyline[i].x;
+        best_page = page;
+        best_index = i;
+      }
+    }
+  }
+
+  if (best_top == std::numeric_limits<uint32_t>::max()) {
+    if (skylines_.size() == max_pages_) {
+      return std::nullopt;
+    }
+    skylines_.push_back({{0, 0, page_width_}});
+    best_page = skylines_.size() - 1;
+    best_index = 0;
+    best_top = size.height;
+  }
+
+  const Placement at{skylines_[best_page][best_index].x,
+                     best_top - size.height, static_cast<uint32_t>(best_page)};
+  place(skylines_[best_page], best_index, at, size);
+  used_area_ += uint64_t{size.width} * size.height;
+  return at;
+}
+
+std::vector<std::optional<AtlasPacker::Placement>>
+AtlasPacker::insertAll(std::span<const Size> sizes) {
+  std::vector<size_t> order(sizes.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return sizes[a].height != sizes[b].height
+               ? sizes[a].height > sizes[b].height
+               : sizes[a].width > sizes[b].width;
+  });
+
+  std::vector<std::optional<Placement>> placements(sizes.size());
+  for (size_t i : order) {
+    placements[i] = insert(sizes[i]);
+  }
+  return placements;
+}
+
+uint32_t AtlasPacker::pageWidth() const noexcept { return page_width_; }
+uint32_t AtlasPacker::pageHeight() const noexcept { return page_height_; }
+uint32_t AtlasPacker::maxPages() const noexcept { return max_pages_; }
+
+uint32_t AtlasPacker::pages() const noexcept {
+  return static_cast<uint32_t>(skylines_.size());
+}
+
+double AtlasPacker::occupancy() const noexcept {
+  return static_cast<double>(used_area_) /
+         (static_cast<double>(page_width_) * page_height_ *
+          static_cast<double>(skylines_.size()));
+}
+
+std::optional<uint32_t>
+AtlasPacker::fit(const std::vector<Segment> &skyline, size_t index,
+                 Size size) const noexcept {
+  if (skyline[index].x + size.width > page_width_) {
+    return std::nullopt;
+  }
+
+  /* The rectangle rests on the highest segment it spans */
+  uint32_t y = 0;
+  uint32_t remaining = size.width;
+  for (size_t i = index; remaining > 0; ++i) {
+    y = std::max(y, skyline[i].y);
+    if (y + size.height > page_height_) {
+      return std::nullopt;
+    }
+    remaining -= std::min(remaining, skyline[i].width);
+  }
+  return y;
+}
+
+void AtlasPacker::place(std::vector<Segment> &skyline, size_t index,
+                        Placement at, Size size) {
+  /* The new segment replaces everything under the rectangle; a segment
+   * that sticks out past it is trimmed */
+  const uint32_t right = at.x + size.width;
+  size_t end = index;
+  while (end < skyline.size() &&
+         skyline[end].x + skyline[end].width <= right) {
+    ++end;
+  }
+  if (end < skyline.size() && skyline[end].x < right) {
+    skyline[end].width -= right - skyline[end].x;
+    skyline[end].x = right;
+  }
+  skyline.erase(skyline.begin() + static_cast<ptrdiff_t>(index),
+                skyline.begin() + static_cast<ptrdiff_t>(end));
+  skyline.insert(skyline.begin() + static_cast<ptrdiff_t>(index),
+                 {at.x, at.y + size.height, size.width});
+
+  /* Merge neighbours at the same height */
+  for (size_t i = 0; i + 1 < skyline.size();) {
+    if (skyline[i].y == skyline[i + 1].y) {
+      skyline[i].width += skyline[i + 1].width;
+      skyline.erase(skyline.begin() + static_cast<ptrdiff_t>(i) + 1);
+    } else {
+      ++i;
+    }
+  }
+}
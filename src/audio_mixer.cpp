@@ -0,0 +1,551 @@
+#include "audio_mixer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIBRETRO_AUDIO_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LIBRETRO_AUDIO_PTHREAD 1
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/* Keeps the resampling step positive and the kernels' offsets small */
+constexpr float kMinPitch = 1.0f / 64.0f;
+constexpr float kMaxPitch = 16.0f;
+
+// ---------------------------------------------------------------------------
+// Mixing kernels. Frame i of a run reads the source at
+//   f = frac + float(i) * step
+// and interpolates src[int(f)] and src[int(f) + 1]; src has `readable`
+// samples, which the caller guarantees covers every frame. All instruction sets
+// evaluate the same expressions in the same order without fused
+// multiply-adds, so they agree bit for bit
+// ---------------------------------------------------------------------------
+void resampleScalarFrom(size_t first, float *out, const float *src,
+                        size_t count, float frac, float step, float left,
+                        float right) noexcept {
+  for (size_t i = first; i < count; ++i) {
+    const float f = frac + static_cast<float>(i) * step;
+    const auto k = static_cast<int32_t>(f);
+    const float t = f - static_cast<float>(k);
+    const float s = src[k] + (src[k + 1] - src[k]) * t;
+    out[2 * i] += s * left;
+    out[2 * i + 1] += s * right;
+  }
+}
+
+void resampleScalar(float *out, const float *src, size_t, size_t count,
+                    float frac, float step, float left, float right) noexcept {
+  resampleScalarFrom(0, out, src, count, frac, step, left, right);
+}
+
+void finishScalarFrom(size_t first, float *out, size_t count,
+                      float gain) noexcept {
+  for (size_t i = first; i < count; ++i) {
+    out[i] = std::min(std::max(out[i] * gain, -1.0f), 1.0f);
+  }
+}
+
+void finishScalar(float *out, size_t count, float gain) noexcept {
+  finishScalarFrom(0, out, count, gain);
+}
+
+#ifdef LIBRETRO_AUDIO_X86
+// ---------------------------------------------------------------------------
+// SSE2: 4 frames per step. There is no gather, so indices go through memory
+// ---------------------------------------------------------------------------
+__attribute__((target("sse2"))) void
+resampleSse2(float *out, const float *src, size_t, size_t count, float frac,
+             float step, float left, float right) noexcept {
+  const __m128 f0 = _mm_set1_ps(frac);
+  const __m128 s0 = _mm_set1_ps(step);
+  const __m128 l = _mm_set1_ps(left);
+  const __m128 r = _mm_set1_ps(right);
+  const __m128 iota = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 n = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), iota);
+    const __m128 f = _mm_add_ps(f0, _mm_mul_ps(n, s0));
+    const __m128i k = _mm_cvttps_epi32(f);
+    const __m128 t = _mm_sub_ps(f, _mm_cvtepi32_ps(k));
+
+    alignas(16) int32_t idx[4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(idx), k);
+    const __m128 a =
+        _mm_setr_ps(src[idx[0]], src[idx[1]], src[idx[2]], src[idx[3]]);
+    const __m128 b = _mm_setr_ps(src[idx[0] + 1], src[idx[1] + 1],
+                                 src[idx[2] + 1], src[idx[3] + 1]);
+    const __m128 s = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+    const __m128 sl = _mm_mul_ps(s, l);
+    const __m128 sr = _mm_mul_ps(s, r);
+
+    float *dst = out + 2 * i;
+    _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_unpacklo_ps(sl, sr)));
+    _mm_storeu_ps(dst + 4,
+                  _mm_add_ps(_mm_loadu_ps(dst + 4), _mm_unpackhi_ps(sl, sr)));
+  }
+  resampleScalarFrom(i, out, src, count, frac, step, left, right);
+}
+
+__attribute__((target("sse2"))) void finishSse2(float *out, size_t count,
+                                                float gain) noexcept {
+  const __m128 g = _mm_set1_ps(gain);
+  const __m128 lo = _mm_set1_ps(-1.0f);
+  const __m128 hi = _mm_set1_ps(1.0f);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 x = _mm_mul_ps(_mm_loadu_ps(out + i), g);
+    _mm_storeu_ps(out + i, _mm_min_ps(_mm_max_ps(x, lo), hi));
+  }
+  finishScalarFrom(i, out, count, gain);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2: 8 frames per step
+// ---------------------------------------------------------------------------
+__attribute__((target("avx2"))) void
+resampleAvx2(float *out, const float *src, size_t readable, size_t count,
+             float frac, float step, float left, float right) noexcept {
+  const __m256 f0 = _mm256_set1_ps(frac);
+  const __m256 s0 = _mm256_set1_ps(step);
+  const __m256 l = _mm256_set1_ps(left);
+  const __m256 r = _mm256_set1_ps(right);
+  const __m256 iota =
+      _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 n =
+        _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), iota);
+    const __m256 f = _mm256_add_ps(f0, _mm256_mul_ps(n, s0));
+    const __m256i k = _mm256_cvttps_epi32(f);
+    const __m256 t = _mm256_sub_ps(f, _mm256_cvtepi32_ps(k));
+
+    /* When the 8 frames read no more than 9 neighbouring samples, load them
+     * and permute instead of gathering */
+    const int32_t k0 = _mm256_cvtsi256_si32(k);
+    const int32_t k7 = _mm256_extract_epi32(k, 7);
+    __m256 a, b;
+    if (k7 - k0 < 8 && static_cast<size_t>(k0) + 9 <= readable) {
+      const __m256i lane = _mm256_sub_epi32(k, _mm256_set1_epi32(k0));
+      a = _mm256_permutevar8x32_ps(_mm256_loadu_ps(src + k0), lane);
+      b = _mm256_permutevar8x32_ps(_mm256_loadu_ps(src + k0 + 1), lane);
+    } else {
+      a = _mm256_i32gather_ps(src, k, 4);
+      b = _mm256_i32gather_ps(src + 1, k, 4);
+    }
+    const __m256 s = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t));
+    const __m256 sl = _mm256_mul_ps(s, l);
+    const __m256 sr = _mm256_mul_ps(s, r);
+
+    /* Unpacking works per 128-bit lane: lo holds frames 0-1 and 4-5, hi
+     * frames 2-3 and 6-7 */
+    const __m256 lo = _mm256_unpacklo_ps(sl, sr);
+    const __m256 hi = _mm256_unpackhi_ps(sl, sr);
+    float *dst = out + 2 * i;
+    _mm256_storeu_ps(dst, _mm256_add_ps(_mm256_loadu_ps(dst),
+                                        _mm256_permute2f128_ps(lo, hi, 0x20)));
+    _mm256_storeu_ps(dst + 8,
+                     _mm256_add_ps(_mm256_loadu_ps(dst + 8),
+                                   _mm256_permute2f128_ps(lo, hi, 0x31)));
+  }
+  resampleScalarFrom(i, out, src, count, frac, step, left, right);
+}
+
+__attribute__((target("avx2"))) void finishAvx2(float *out, size_t count,
+                                                float gain) noexcept {
+  const __m256 g = _mm256_set1_ps(gain);
+  const __m256 lo = _mm256_set1_ps(-1.0f);
+  const __m256 hi = _mm256_set1_ps(1.0f);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 x = _mm256_mul_ps(_mm256_loadu_ps(out + i), g);
+    _mm256_storeu_ps(out + i, _mm256_min_ps(_mm256_max_ps(x, lo), hi));
+  }
+  finishScalarFrom(i, out, count, gain);
+}
+#endif
+
+/* Frames, up to limit, that a kernel run starting at src[index] + frac can
+ * produce without interpolating past the last sample */
+size_t safeFrames(size_t index, float frac, float step, size_t length,
+                  size_t limit) noexcept {
+  if (index + 1 >= length) {
+    return 0;
+  }
+  const size_t room = length - 1 - index;
+  const auto offset = [&](size_t i) {
+    return static_cast<size_t>(frac + static_cast<float>(i) * step);
+  };
+
+  /* Estimate, then settle it with the kernels' own arithmetic */
+  const double estimate = (static_cast<double>(room) - frac) / step + 1.0;
+  size_t n = std::min(limit, static_cast<size_t>(std::max(estimate, 0.0)));
+  while (n > 0 && offset(n - 1) >= room) {
+    --n;
+  }
+  while (n < limit && offset(n) < room) {
+    ++n;
+  }
+  return n;
+}
+
+void writeLe(std::FILE *file, uint32_t value, size_t bytes) noexcept {
+  for (size_t i = 0; i < bytes; ++i) {
+    std::fputc(static_cast<int>((value >> (i * 8)) & 0xFF), file);
+  }
+}
+} // namespace
+
+// ---------------------------------------------------------------------------
+// NullAudioSink
+// ---------------------------------------------------------------------------
+NullAudioSink::NullAudioSink(AudioFormat format, bool paced)
+    : format_{format}, paced_{paced},
+      period_{std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(
+              static_cast<double>(format.period_frames) /
+              std::max(format.sample_rate, 1u)))} {}
+
+AudioFormat NullAudioSink::format() const noexcept { return format_; }
+
+void NullAudioSink::write(std::span<const float>) noexcept {
+  periods_.fetch_add(1, std::memory_order_relaxed);
+  if (!paced_) {
+    return;
+  }
+
+  /* Period k plays from start_ + k * period_ and must arrive before then */
+  const auto now = Clock::now();
+  const auto k = static_cast<Clock::rep>(written_);
+  if (written_ == 0) {
+    start_ = now;
+  } else if (now > start_ + period_ * k) {
+    underruns_.fetch_add(1, std::memory_order_relaxed);
+    start_ = now - period_ * k;
+  }
+  ++written_;
+
+  /* The next write waits for room: until period k + 1 - periods ends */
+  const auto depth = static_cast<Clock::rep>(std::max(format_.periods, 1u));
+  std::this_thread::sleep_until(start_ + period_ * (k + 2 - depth));
+}
+
+uint64_t NullAudioSink::underruns() const noexcept {
+  return underruns_.load(std::memory_order_relaxed);
+}
+
+uint64_t NullAudioSink::periods() const noexcept {
+  return periods_.load(std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// WavFileSink
+// ---------------------------------------------------------------------------
+WavFileSink::WavFileSink(const std::filesystem::path &path, AudioFormat format)
+    : format_{format}, pcm_(size_t{format.period_frames} * 2) {
+  file_ = std::fopen(path.string().c_str(), "wb");
+  if (!file_) {
+    throw std::runtime_error("Unable to create " + path.string());
+  }
+
+  /* RIFF and data sizes are patched by the destructor */
+  constexpr uint32_t kChannels = 2;
+  constexpr uint32_t kBits = 16;
+  std::fputs("RIFF", file_);
+  writeLe(file_, 0, 4);
+  std::fputs("WAVEfmt ", file_);
+  writeLe(file_, 16, 4);
+  writeLe(file_, 1, 2); // PCM
+  writeLe(file_, kChannels, 2);
+  writeLe(file_, format_.sample_rate, 4);
+  writeLe(file_, format_.sample_rate * kChannels * kBits / 8, 4);
+  writeLe(file_, kChannels * kBits / 8, 2);
+  writeLe(file_, kBits, 2);
+  std::fputs("data", file_);
+  writeLe(file_, 0, 4);
+}
+
+WavFileSink::~WavFileSink() {
+  const auto data = static_cast<uint32_t>(data_bytes_);
+  std::fseek(file_, 4, SEEK_SET);
+  writeLe(file_, 36 + data, 4);
+  std::fseek(file_, 40, SEEK_SET);
+  writeLe(file_, data, 4);
+  std::fclose(file_);
+}
+
+AudioFormat WavFileSink::format() const noexcept { return format_; }
+
+void WavFileSink::write(std::span<const float> frames) noexcept {
+  while (!frames.empty()) {
+    const size_t count = std::min(frames.size(), pcm_.size());
+    for (size_t i = 0; i < count; ++i) {
+      const float s = std::min(std::max(frames[i], -1.0f), 1.0f);
+      pcm_[i] = static_cast<int16_t>(std::lrint(s * 32767.0f));
+    }
+    /* WAV is little-endian, as is every platform this builds for */
+    std::fwrite(pcm_.data(), sizeof(int16_t), count, file_);
+    data_bytes_ += count * sizeof(int16_t);
+    frames = frames.subspan(count);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// AudioMixer
+// ---------------------------------------------------------------------------
+AudioMixer::AudioMixer(AudioSink &sink, size_t max_voices)
+    : sink_{sink}, format_{sink.format()}, voices_(max_voices),
+      period_(size_t{format_.period_frames} * 2) {
+  if (max_voices == 0 || format_.period_frames == 0 ||
+      format_.sample_rate == 0) {
+    throw std::invalid_argument(
+        "AudioMixer needs at least one voice and a non-empty period");
+  }
+  setIsa(SpanIsa::Avx2);
+}
+
+AudioMixer::~AudioMixer() { stop(); }
+
+void AudioMixer::start() {
+  if (thread_.joinable()) {
+    return;
+  }
+  stop_.store(false, std::memory_order_relaxed);
+  running_.store(true, std::memory_order_release);
+  thread_ = std::thread{&AudioMixer::run, this};
+}
+
+void AudioMixer::stop() noexcept {
+  stop_.store(true, std::memory_order_relaxed);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+bool AudioMixer::running() const noexcept {
+  return running_.load(std::memory_order_acquire);
+}
+
+void AudioMixer::mix(std::span<float> out) noexcept {
+  commands_.drain([this](const Command &command) noexcept { apply(command); });
+
+  std::fill(out.begin(), out.end(), 0.0f);
+  const size_t frames = out.size() / 2;
+  for (size_t i = 0; i < active_;) {
+    if (mixVoice(voices_[i], out.data(), frames)) {
+      ++i;
+    } else {
+      voices_[i] = voices_[--active_];
+    }
+  }
+  finish_(out.data(), frames * 2, master_);
+  active_snapshot_.store(active_, std::memory_order_relaxed);
+}
+
+VoiceId AudioMixer::play(const AudioClip &clip,
+                         const VoiceParams &params) noexcept {
+  /* 0 means dropped, so it is skipped when the counter wraps */
+  VoiceId id = next_id_.fetch_add(1, std::memory_order_relaxed);
+  if (id == 0) {
+    id = next_id_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return send({.type = Command::Type::Play,
+               .voice = id,
+               .clip = clip,
+               .params = params})
+             ? id
+             : 0;
+}
+
+bool AudioMixer::stop(VoiceId voice) noexcept {
+  return send({.type = Command::Type::Stop, .voice = voice});
+}
+
+bool AudioMixer::set(VoiceId voice, const VoiceParams &params) noexcept {
+  return send({.type = Command::Type::Set, .voice = voice, .params = params});
+}
+
+bool AudioMixer::setMasterVolume(float volume) noexcept {
+  return send({.type = Command::Type::Master, .params = {.volume = volume}});
+}
+
+size_t AudioMixer::activeVoices() const noexcept {
+  return active_snapshot_.load(std::memory_order_relaxed);
+}
+
+size_t AudioMixer::maxVoices() const noexcept { return voices_.size(); }
+
+AudioStats AudioMixer::stats() const noexcept {
+  return {.periods = periods_.load(std::memory_order_relaxed),
+          .underruns = sink_.underruns(),
+          .dropped_commands = dropped_.load(std::memory_order_relaxed),
+          .stolen_voices = stolen_.load(std::memory_order_relaxed),
+          .last_mix_us =
+              static_cast<double>(
+                  last_mix_ns_.load(std::memory_order_relaxed)) /
+              1e3,
+          .max_mix_us =
+              static_cast<double>(max_mix_ns_.load(std::memory_order_relaxed)) /
+              1e3};
+}
+
+SpanIsa AudioMixer::isa() const noexcept { return isa_; }
+
+SpanIsa AudioMixer::setIsa(SpanIsa isa) noexcept {
+  isa_ = SpanIsa::Scalar;
+  resample_ = resampleScalar;
+  finish_ = finishScalar;
+#ifdef LIBRETRO_AUDIO_X86
+  __builtin_cpu_init();
+  if (isa == SpanIsa::Avx2 && __builtin_cpu_supports("avx2")) {
+    isa_ = SpanIsa::Avx2;
+    resample_ = resampleAvx2;
+    finish_ = finishAvx2;
+  } else if (isa != SpanIsa::Scalar && __builtin_cpu_supports("sse2")) {
+    isa_ = SpanIsa::Sse2;
+    resample_ = resampleSse2;
+    finish_ = finishSse2;
+  }
+#else
+  (void)isa;
+#endif
+  return isa_;
+}
+
+bool AudioMixer::send(const Command &command) noexcept {
+  if (!commands_.tryPush(command)) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void AudioMixer::apply(const Command &command) noexcept {
+  const auto configure = [this](Voice &voice, const VoiceParams &params) {
+    voice.params = params;
+    const float pitch = std::clamp(params.pitch, kMinPitch, kMaxPitch);
+    voice.step = static_cast<double>(pitch) * voice.clip.sample_rate /
+                 format_.sample_rate;
+    const float pan = std::clamp(params.pan, -1.0f, 1.0f);
+    voice.left = params.volume * std::sqrt((1.0f - pan) * 0.5f);
+    voice.right = params.volume * std::sqrt((1.0f + pan) * 0.5f);
+  };
+  const auto find = [this](VoiceId id) -> Voice * {
+    for (size_t i = 0; i < active_; ++i) {
+      if (voices_[i].id == id) {
+        return &voices_[i];
+      }
+    }
+    return nullptr;
+  };
+
+  switch (command.type) {
+  case Command::Type::Play: {
+    if (command.clip.samples.empty() || command.clip.sample_rate == 0) {
+      return;
+    }
+    Voice *voice = nullptr;
+    if (active_ < voices_.size()) {
+      voice = &voices_[active_++];
+    } else {
+      /* Cut off the oldest voice */
+      voice = &*std::min_element(
+          voices_.begin(), voices_.end(),
+          [](const Voice &a, const Voice &b) { return a.id < b.id; });
+      stolen_.fetch_add(1, std::memory_order_relaxed);
+    }
+    *voice = {.id = command.voice, .clip = command.clip};
+    configure(*voice, command.params);
+    break;
+  }
+  case Command::Type::Stop:
+    if (Voice *voice = find(command.voice)) {
+      *voice = voices_[--active_];
+    }
+    break;
+  case Command::Type::Set:
+    if (Voice *voice = find(command.voice)) {
+      configure(*voice, command.params);
+    }
+    break;
+  case Command::Type::Master:
+    master_ = command.params.volume;
+    break;
+  }
+}
+
+bool AudioMixer::mixVoice(Voice &voice, float *out, size_t frames) noexcept {
+  const float *samples = voice.clip.samples.data();
+  const size_t length = voice.clip.samples.size();
+  const auto step = static_cast<float>(voice.step);
+
+  size_t done = 0;
+  while (done < frames) {
+    if (voice.position >= static_cast<double>(length)) {
+      if (!voice.params.loop) {
+        return false;
+      }
+      voice.position = std::fmod(voice.position, static_cast<double>(length));
+    }
+
+    const double base = std::floor(voice.position);
+    const auto index = static_cast<size_t>(base);
+    const auto frac = static_cast<float>(voice.position - base);
+    const size_t count = safeFrames(index, frac, step, length, frames - done);
+    if (count) {
+      resample_(out + 2 * done, samples + index, length - index, count, frac,
+                step, voice.left, voice.right);
+      done += count;
+      voice.position =
+          base + static_cast<double>(frac + static_cast<float>(count) * step);
+      continue;
+    }
+
+    /* This frame interpolates towards the loop start, or silence */
+    const float a = samples[index];
+    const float b = voice.params.loop ? samples[0] : 0.0f;
+    const float s = a + (b - a) * frac;
+    out[2 * done] += s * voice.left;
+    out[2 * done + 1] += s * voice.right;
+    ++done;
+    voice.position += voice.step;
+  }
+  return true;
+}
+
+void AudioMixer::run() noexcept {
+#ifdef LIBRETRO_AUDIO_PTHREAD
+  sched_param param{};
+  param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+  pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+
+  while (!stop_.load(std::memory_order_relaxed)) {
+    const auto begin = Clock::now();
+    mix(period_);
+    const int64_t ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                             begin)
+            .count();
+    last_mix_ns_.store(ns, std::memory_order_relaxed);
+    if (ns > max_mix_ns_.load(std::memory_order_relaxed)) {
+      max_mix_ns_.store(ns, std::memory_order_relaxed);
+    }
+
+    sink_.write(period_);
+    periods_.fetch_add(1, std::memory_order_relaxed);
+  }
+  running_.store(false, std::memory_order_release);
+}
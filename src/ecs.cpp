@@ -0,0 +1,259 @@
+#include "ecs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+constexpr size_t kColumnAlignment = 64;
+
+std::array<ecs_detail::ComponentInfo, ecs_detail::kMaxComponents>
+    component_info;
+std::atomic<uint32_t> component_count{0};
+
+constexpr size_t alignUp(size_t value, size_t alignment) noexcept {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+/* Calls f(id) for every component id in the mask, lowest first */
+template <typename F> void forEachId(ComponentMask mask, F &&f) {
+  while (mask) {
+    f(static_cast<uint32_t>(std::countr_zero(mask)));
+    mask &= mask - 1;
+  }
+}
+} // namespace
+
+uint32_t ecs_detail::registerComponent(size_t size, size_t alignment) {
+  const uint32_t id = component_count.fetch_add(1);
+  if (id >= kMaxComponents) {
+    throw std::length_error("Too many component types");
+  }
+  component_info[id] = {size, alignment};
+  return id;
+}
+
+const ecs_detail::ComponentInfo &
+ecs_detail::componentInfo(uint32_t id) noexcept {
+  return component_info[id];
+}
+
+// ---------------------------------------------------------------------------
+// Archetype
+// ---------------------------------------------------------------------------
+Archetype::Archetype(ComponentMask mask) : mask_{mask} {
+  size_t row_bytes = sizeof(Entity);
+  forEachId(mask_, [&row_bytes](uint32_t id) {
+    row_bytes += ecs_detail::componentInfo(id).size;
+  });
+
+  /* Largest capacity whose aligned columns still fit a chunk. Components
+   * too big for that get chunks of a single row */
+  const auto layout = [this](size_t capacity) {
+    size_t offset = capacity * sizeof(Entity);
+    forEachId(mask_, [this, &offset, capacity](uint32_t id) {
+      offset = alignUp(offset, kColumnAlignment);
+      offsets_[id] = static_cast<uint32_t>(offset);
+      offset += capacity * ecs_detail::componentInfo(id).size;
+    });
+    return offset;
+  };
+
+  capacity_ = std::max<size_t>(kChunkBytes / row_bytes, 1);
+  while (capacity_ > 1 && layout(capacity_) > kChunkBytes) {
+    --capacity_;
+  }
+  chunk_bytes_ = std::max(kChunkBytes, layout(capacity_));
+}
+
+Archetype::~Archetype() {
+  for (std::byte *chunk : chunks_) {
+    ::operator delete(chunk, std::align_val_t{kColumnAlignment});
+  }
+}
+
+ComponentMask Archetype::mask() const noexcept { return mask_; }
+size_t Archetype::size() const noexcept { return size_; }
+size_t Archetype::chunkCapacity() const noexcept { return capacity_; }
+size_t Archetype::chunkCount() const noexcept { return chunks_.size(); }
+
+size_t Archetype::chunkSize(size_t chunk) const noexcept {
+  const size_t first = chunk * capacity_;
+  return size_ > first ? std::min(size_ - first, capacity_) : 0;
+}
+
+std::byte *Archetype::column(size_t chunk, uint32_t id) const noexcept {
+  return chunks_[chunk] + offsets_[id];
+}
+
+Entity *Archetype::entities(size_t chunk) const noexcept {
+  return reinterpret_cast<Entity *>(chunks_[chunk]);
+}
+
+size_t Archetype::push(Entity entity) {
+  if (size_ == chunks_.size() * capacity_) {
+    auto *chunk = static_cast<std::byte *>(
+        ::operator new(chunk_bytes_, std::align_val_t{kColumnAlignment}));
+    try {
+      chunks_.push_back(chunk);
+    } catch (...) {
+      ::operator delete(chunk, std::align_val_t{kColumnAlignment});
+      throw;
+    }
+  }
+
+  const size_t row = size_++;
+  entities(row / capacity_)[row % capacity_] = entity;
+  return row;
+}
+
+Entity Archetype::erase(size_t row) noexcept {
+  const size_t last = size_ - 1;
+  const Entity moved = entities(last / capacity_)[last % capacity_];
+  if (row != last) {
+    forEachId(mask_, [this, row, last](uint32_t id) {
+      std::memcpy(at(row, id), at(last, id),
+                  ecs_detail::componentInfo(id).size);
+    });
+    entities(row / capacity_)[row % capacity_] = moved;
+  }
+  --size_;
+
+  /* Keep one spare chunk so an entity bouncing across a chunk boundary
+   * doesn't allocate every time */
+  if (chunks_.size() * capacity_ - size_ >= 2 * capacity_) {
+    ::operator delete(chunks_.back(), std::align_val_t{kColumnAlignment});
+    chunks_.pop_back();
+  }
+  return moved;
+}
+
+std::byte *Archetype::at(size_t row, uint32_t id) const noexcept {
+  return column(row / capacity_, id) +
+         row % capacity_ * ecs_detail::componentInfo(id).size;
+}
+
+// ---------------------------------------------------------------------------
+// World
+// ---------------------------------------------------------------------------
+void World::destroy(Entity entity) noexcept {
+  if (!alive(entity)) {
+    return;
+  }
+
+  Record &record = records_[entity.index];
+  const Entity moved = archetypes_[record.archetype]->erase(record.row);
+  if (moved != entity) {
+    records_[moved.index].row = record.row;
+  }
+
+  /* Capacity was reserved when the record was created */
+  ++record.generation;
+  record.alive = false;
+  free_.push_back(entity.index);
+  --alive_;
+}
+
+bool World::alive(Entity entity) const noexcept {
+  return entity.index < records_.size() && records_[entity.index].alive &&
+         records_[entity.index].generation == entity.generation;
+}
+
+size_t World::size() const noexcept { return alive_; }
+
+void World::chunks(ComponentMask mask, std::vector<ChunkView> &out) const {
+  for (const auto &archetype : archetypes_) {
+    if ((archetype->mask() & mask) != mask) {
+      continue;
+    }
+    for (size_t chunk = 0; chunk < archetype->chunkCount(); ++chunk) {
+      if (archetype->chunkSize(chunk)) {
+        out.push_back({archetype.get(), chunk});
+      }
+    }
+  }
+}
+
+size_t World::archetypeCount() const noexcept { return archetypes_.size(); }
+
+ComponentMask World::maskOf(Entity entity) const noexcept {
+  return alive(entity) ? archetypes_[records_[entity.index].archetype]->mask()
+                       : 0;
+}
+
+uint32_t World::archetype(ComponentMask mask) {
+  if (const auto it = archetype_index_.find(mask);
+      it != archetype_index_.end()) {
+    return it->second;
+  }
+
+  const auto index = static_cast<uint32_t>(archetypes_.size());
+  archetypes_.push_back(std::make_unique<Archetype>(mask));
+  try {
+    archetype_index_.emplace(mask, index);
+  } catch (...) {
+    archetypes_.pop_back();
+    throw;
+  }
+  return index;
+}
+
+Entity World::allocate(ComponentMask mask) {
+  const uint32_t archetype_index = archetype(mask);
+  Archetype &target = *archetypes_[archetype_index];
+
+  if (!free_.empty()) {
+    const uint32_t index = free_.back();
+    Record &record = records_[index];
+    const Entity entity{index, record.generation};
+    record.row = target.push(entity);
+    record.archetype = archetype_index;
+    record.alive = true;
+    free_.pop_back();
+    ++alive_;
+    return entity;
+  }
+
+  /* destroy() is noexcept, so the free list always has room for every
+   * record */
+  free_.reserve(records_.size() + 1);
+  const Entity entity{static_cast<uint32_t>(records_.size()), 0};
+  records_.push_back({archetype_index, 0, 0, true});
+  try {
+    records_.back().row = target.push(entity);
+  } catch (...) {
+    records_.pop_back();
+    throw;
+  }
+  ++alive_;
+  return entity;
+}
+
+void World::move(Entity entity, ComponentMask mask) {
+  const uint32_t to_index = archetype(mask);
+  Record &record = records_[entity.index];
+  Archetype &from = *archetypes_[record.archetype];
+  Archetype &to = *archetypes_[to_index];
+
+  const size_t row = to.push(entity);
+  forEachId(from.mask() & to.mask(), [&](uint32_t id) {
+    std::memcpy(to.at(row, id), from.at(record.row, id),
+                ecs_detail::componentInfo(id).size);
+  });
+
+  const Entity moved = from.erase(record.row);
+  if (moved != entity) {
+    records_[moved.index].row = record.row;
+  }
+  record.archetype = to_index;
+  record.row = row;
+}
+
+void World::throwDuplicate() {
+  throw std::invalid_argument("Entity created with a component type twice");
+}
+
+void World::throwDead() {
+  throw std::invalid_argument("Entity is not alive");
+}
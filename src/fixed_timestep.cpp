@@ -0,0 +1,45 @@
+#include "fixed_timestep.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+FixedTimestep::FixedTimestep(double step_seconds, size_t max_steps)
+    : step_{step_seconds}, max_steps_{max_steps} {
+  if (!(step_ > 0.0) || max_steps_ == 0) {
+    throw std::invalid_argument("FixedTimestep step out of range");
+  }
+}
+
+size_t FixedTimestep::advance(double now) noexcept {
+  if (!started_) {
+    started_ = true;
+    last_ = now;
+    return 0;
+  }
+
+  /* A clock that goes backwards contributes nothing */
+  accumulator_ += std::max(now - last_, 0.0);
+  last_ = now;
+
+  auto due = static_cast<size_t>(accumulator_ / step_);
+  if (due > max_steps_) {
+    due = max_steps_;
+    accumulator_ = 0.0;
+  } else {
+    accumulator_ -= static_cast<double>(due) * step_;
+  }
+
+  steps_ += due;
+  return due;
+}
+
+double FixedTimestep::untilNext(double now) const noexcept {
+  if (!started_) {
+    return 0.0;
+  }
+  return std::max(step_ - accumulator_ - (now - last_), 0.0);
+}
+
+double FixedTimestep::alpha() const noexcept { return accumulator_ / step_; }
+double FixedTimestep::step() const noexcept { return step_; }
+uint64_t FixedTimestep::steps() const noexcept { return steps_; }
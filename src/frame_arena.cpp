@@ -0,0 +1,103 @@
+#include "frame_arena.h"
+#include "heap_counter.h"
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+LinearArena::LinearArena(size_t capacity) : capacity_{capacity} {
+  if (capacity_ == 0) {
+    throw std::invalid_argument("LinearArena capacity must be non-zero");
+  }
+  buffer_ = std::make_unique_for_overwrite<std::byte[]>(capacity_);
+}
+
+void *LinearArena::allocate(size_t bytes, size_t alignment) noexcept {
+  /* Align the address, not the offset, since the block itself is only
+   * aligned to max_align_t */
+  const auto base = reinterpret_cast<uintptr_t>(buffer_.get());
+  const uintptr_t start = (base + offset_ + alignment - 1) & ~(alignment - 1);
+  const size_t offset = start - base;
+  if (offset > capacity_ || bytes > capacity_ - offset) {
+    return nullptr;
+  }
+
+  offset_ = offset + bytes;
+  return buffer_.get() + offset;
+}
+
+void LinearArena::reset() noexcept { offset_ = 0; }
+size_t LinearArena::used() const noexcept { return offset_; }
+size_t LinearArena::capacity() const noexcept { return capacity_; }
+
+FrameArena::FrameArena(size_t bytes_per_frame,
+                       std::pmr::memory_resource *upstream)
+    : arenas_{LinearArena{bytes_per_frame}, LinearArena{bytes_per_frame}},
+      upstream_{upstream} {
+  heap_mark_ = heapCounters().allocations;
+}
+
+FrameArena::~FrameArena() {
+  release(0);
+  release(1);
+}
+
+void FrameArena::endFrame() noexcept {
+  /* Everything the frame asked for is in the counters, overflow included */
+  const uint64_t heap = heapCounters().allocations;
+  frame_.heap_allocations = heap - heap_mark_;
+  last_frame_ = frame_;
+  frame_ = {};
+
+  current_ ^= 1;
+  arenas_[current_].reset();
+  release(current_);
+
+  /* Measured after the reset so freeing overflow isn't charged to the next
+   * frame either */
+  heap_mark_ = heapCounters().allocations;
+}
+
+const FrameArena::Stats &FrameArena::lastFrame() const noexcept {
+  return last_frame_;
+}
+
+size_t FrameArena::bytesPerFrame() const noexcept {
+  return arenas_[0].capacity();
+}
+
+void *FrameArena::do_allocate(size_t bytes, size_t alignment) {
+  ++frame_.allocations;
+  frame_.bytes += bytes;
+
+  if (void *p = arenas_[current_].allocate(bytes, alignment)) {
+    return p;
+  }
+
+  /* Prefix the block with its header, padded to keep the payload aligned */
+  ++frame_.overflows;
+  alignment = std::max(alignment, alignof(Overflow));
+  const size_t header = (sizeof(Overflow) + alignment - 1) & ~(alignment - 1);
+  auto *block = static_cast<std::byte *>(
+      upstream_->allocate(header + bytes, alignment));
+  overflows_[current_] = ::new (block)
+      Overflow{overflows_[current_], header + bytes, alignment};
+  return block + header;
+}
+
+void FrameArena::do_deallocate(void *, size_t, size_t) {}
+
+bool FrameArena::do_is_equal(const std::pmr::memory_resource &other) const
+    noexcept {
+  return this == &other;
+}
+
+void FrameArena::release(size_t arena) noexcept {
+  Overflow *block = std::exchange(overflows_[arena], nullptr);
+  while (block) {
+    Overflow *next = block->next;
+    upstream_->deallocate(block, block->bytes, block->alignment);
+    block = next;
+  }
+}
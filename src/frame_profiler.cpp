@@ -0,0 +1,231 @@
+#include "frame_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+double elapsedMs(std::chrono::steady_clock::time_point from,
+                 std::chrono::steady_clock::time_point to) {
+  return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+constexpr std::string_view kStageNames[] = {"context", "render", "swap"};
+
+void writePercentiles(std::ostream &out, const FrameProfiler::Percentiles &p) {
+  out << "{\"p50\": " << p.p50 << ", \"p95\": " << p.p95
+      << ", \"p99\": " << p.p99 << "}";
+}
+} // namespace
+
+FrameProfiler::FrameProfiler(size_t history)
+    : history_{history}, records_(history) {
+  if (history_ == 0) {
+    throw std::invalid_argument("FrameProfiler history must be non-zero");
+  }
+
+  for (auto &query : queries_) {
+    glGenQueries(1, &query.id);
+  }
+
+  scope_stack_.reserve(16);
+}
+
+FrameProfiler::~FrameProfiler() {
+  for (auto &query : queries_) {
+    glDeleteQueries(1, &query.id);
+  }
+}
+
+void FrameProfiler::beginFrame() noexcept {
+  frame_start_ = last_mark_ = Clock::now();
+
+  auto &record = records_[frame_ % history_];
+  record = FrameRecord{};
+  record.frame = frame_;
+}
+
+void FrameProfiler::mark(Stage stage) noexcept {
+  const auto now = Clock::now();
+  records_[frame_ % history_].stage_ms[static_cast<size_t>(stage)] +=
+      elapsedMs(last_mark_, now);
+  last_mark_ = now;
+}
+
+void FrameProfiler::beginGpu() noexcept {
+  /* Drop the GPU sample rather than wait on a query still in flight */
+  if (query_head_ - query_tail_ == kQueryRingSize) {
+    return;
+  }
+
+  auto &query = queries_[query_head_ % kQueryRingSize];
+  query.frame = frame_;
+  glBeginQuery(GL_TIME_ELAPSED, query.id);
+  query_active_ = true;
+}
+
+void FrameProfiler::endGpu() noexcept {
+  if (!query_active_) {
+    return;
+  }
+
+  glEndQuery(GL_TIME_ELAPSED);
+  query_active_ = false;
+  ++query_head_;
+}
+
+void FrameProfiler::endFrame() noexcept {
+  records_[frame_ % history_].cpu_ms = elapsedMs(frame_start_, Clock::now());
+  ++frame_;
+
+  collectQueries();
+}
+
+void FrameProfiler::beginScope(std::string_view name) {
+  auto it = std::find_if(scopes_.begin(), scopes_.end(),
+                         [name](const auto &s) { return s.name == name; });
+  if (it == scopes_.end()) {
+    scopes_.push_back(ScopeSamples{std::string{name}, {}, 0});
+    scopes_.back().ms.resize(history_);
+    it = std::prev(scopes_.end());
+  }
+
+  scope_stack_.emplace_back(
+      static_cast<size_t>(std::distance(scopes_.begin(), it)), Clock::now());
+}
+
+void FrameProfiler::endScope() noexcept {
+  if (scope_stack_.empty()) {
+    return;
+  }
+
+  const auto [index, start] = scope_stack_.back();
+  scope_stack_.pop_back();
+
+  auto &scope = scopes_[index];
+  scope.ms[scope.count % history_] = elapsedMs(start, Clock::now());
+  ++scope.count;
+}
+
+FrameProfiler::Stats FrameProfiler::stats() const {
+  const size_t frames = recordedFrames();
+
+  Stats stats{};
+  stats.frames = frames;
+
+  std::vector<double> cpu, gpu;
+  std::array<std::vector<double>, static_cast<size_t>(Stage::Count)> stage;
+  cpu.reserve(frames);
+  gpu.reserve(frames);
+
+  for (size_t i = 0; i < frames; ++i) {
+    const auto &record = records_[i];
+    cpu.push_back(record.cpu_ms);
+    if (record.gpu_ms >= 0.0) {
+      gpu.push_back(record.gpu_ms);
+    }
+    for (size_t s = 0; s < stage.size(); ++s) {
+      stage[s].push_back(record.stage_ms[s]);
+    }
+  }
+
+  stats.cpu_ms = percentiles(std::move(cpu));
+  stats.gpu_ms = percentiles(std::move(gpu));
+  for (size_t s = 0; s < stage.size(); ++s) {
+    stats.stage_ms[s] = percentiles(std::move(stage[s]));
+  }
+
+  for (const auto &scope : scopes_) {
+    const size_t n = std::min(scope.count, history_);
+    stats.scopes.push_back(
+        {scope.name, percentiles({scope.ms.begin(), scope.ms.begin() + n})});
+  }
+
+  return stats;
+}
+
+size_t FrameProfiler::frameCount() const noexcept { return frame_; }
+
+void FrameProfiler::writeCsv(std::ostream &out) const {
+  out << "frame,cpu_ms,context_ms,render_ms,swap_ms,gpu_ms\n";
+
+  /* Oldest frame first so dumps from different builds line up */
+  const size_t frames = recordedFrames();
+  const uint64_t first = frame_ - frames;
+  for (uint64_t f = first; f < frame_; ++f) {
+    const auto &record = records_[f % history_];
+    out << record.frame << ',' << record.cpu_ms;
+    for (double ms : record.stage_ms) {
+      out << ',' << ms;
+    }
+    out << ',';
+    if (record.gpu_ms >= 0.0) {
+      out << record.gpu_ms;
+    }
+    out << '\n';
+  }
+}
+
+void FrameProfiler::writeJson(std::ostream &out) const {
+  const auto s = stats();
+
+  out << "{\n  \"frames\": " << s.frames << ",\n  \"cpu_ms\": ";
+  writePercentiles(out, s.cpu_ms);
+  out << ",\n  \"gpu_ms\": ";
+  writePercentiles(out, s.gpu_ms);
+  out << ",\n  \"stages\": {";
+  for (size_t i = 0; i < s.stage_ms.size(); ++i) {
+    out << (i ? ", " : "") << '"' << kStageNames[i] << "\": ";
+    writePercentiles(out, s.stage_ms[i]);
+  }
+  out << "},\n  \"scopes\": {";
+  for (size_t i = 0; i < s.scopes.size(); ++i) {
+    out << (i ? ", " : "") << '"' << s.scopes[i].name << "\": ";
+    writePercentiles(out, s.scopes[i].ms);
+  }
+  out << "}\n}\n";
+}
+
+void FrameProfiler::collectQueries() noexcept {
+  /* Queries complete in order, so stop at the first one still pending */
+  while (query_tail_ != query_head_) {
+    auto &query = queries_[query_tail_ % kQueryRingSize];
+
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+      break;
+    }
+
+    GLuint64 ns = 0;
+    glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &ns);
+
+    /* The frame may have already fallen out of the history window */
+    if (frame_ - query.frame <= history_) {
+      records_[query.frame % history_].gpu_ms = static_cast<double>(ns) / 1e6;
+    }
+
+    ++query_tail_;
+  }
+}
+
+size_t FrameProfiler::recordedFrames() const noexcept {
+  return static_cast<size_t>(std::min<uint64_t>(frame_, history_));
+}
+
+FrameProfiler::Percentiles
+FrameProfiler::percentiles(std::vector<double> samples) {
+  if (samples.empty()) {
+    return {};
+  }
+
+  const auto at = [&samples](double p) {
+    const auto rank = static_cast<size_t>(
+        std::ceil(p * static_cast<double>(samples.size())) - 1.0);
+    const auto nth = samples.begin() + std::min(rank, samples.size() - 1);
+    std::nth_element(samples.begin(), nth, samples.end());
+    return *nth;
+  };
+
+  return {at(0.50), at(0.95), at(0.99)};
+}
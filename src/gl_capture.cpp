@@ -0,0 +1,1429 @@
+#include "gl_capture.h"
+#include "gl_extensions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace {
+constexpr char kMagic[4] = {'L', 'R', 'G', 'C'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderBytes = sizeof(kMagic) + sizeof(kVersion);
+constexpr size_t kRecordHeaderBytes = sizeof(uint16_t) + sizeof(uint32_t);
+
+/* Frame markers come first, then the GL calls in call table order */
+constexpr uint16_t kBeginFrame = 0;
+constexpr uint16_t kEndFrame = 1;
+constexpr uint16_t kFirstCall = 2;
+
+std::atomic<GLCapture *> active_capture{nullptr};
+thread_local GLCapture *thread_capture = nullptr;
+
+/* What an argument means on replay. Names are remapped per object type */
+enum class Kind : uint8_t {
+  Value,
+  Buffer,
+  Texture,
+  VertexArray,
+  Framebuffer,
+  Renderbuffer,
+  Program,
+  Shader,
+  Query,
+  Location,
+  Sync
+};
+
+constexpr size_t nameSpace(Kind kind) noexcept {
+  return static_cast<size_t>(kind) - static_cast<size_t>(Kind::Buffer);
+}
+
+/* Where the pixels of an upload come from */
+enum class Source : uint8_t { None, Client, Buffer };
+
+/* Cursor over one record's payload. Reads past the end yield zeros, so a
+ * malformed record can't read outside the stream */
+class Reader {
+public:
+  Reader(const uint8_t *data, size_t size) noexcept
+      : data_{data}, size_{size} {}
+
+  template <typename T> T get() noexcept {
+    T value{};
+    if (size_ - offset_ >= sizeof(T)) {
+      std::memcpy(&value, data_ + offset_, sizeof(T));
+      offset_ += sizeof(T);
+    } else {
+      offset_ = size_;
+    }
+    return value;
+  }
+
+  std::span<const uint8_t> blob() noexcept {
+    const size_t size = std::min<size_t>(get<uint32_t>(), size_ - offset_);
+    const std::span<const uint8_t> bytes{data_ + offset_, size};
+    offset_ += size;
+    return bytes;
+  }
+
+  size_t remaining() const noexcept { return size_ - offset_; }
+
+private:
+  const uint8_t *data_;
+  size_t size_;
+  size_t offset_{};
+};
+
+GLint integer(GLenum name) noexcept {
+  GLint value = 0;
+  glGetIntegerv(name, &value);
+  return value;
+}
+
+size_t pixelBytes(GLenum format, GLenum type) noexcept {
+  switch (type) {
+  case GL_UNSIGNED_BYTE_3_3_2:
+  case GL_UNSIGNED_BYTE_2_3_3_REV:
+    return 1;
+  case GL_UNSIGNED_SHORT_5_6_5:
+  case GL_UNSIGNED_SHORT_5_6_5_REV:
+  case GL_UNSIGNED_SHORT_4_4_4_4:
+  case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+  case GL_UNSIGNED_SHORT_5_5_5_1:
+  case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+    return 2;
+  case GL_UNSIGNED_INT_8_8_8_8:
+  case GL_UNSIGNED_INT_8_8_8_8_REV:
+  case GL_UNSIGNED_INT_10_10_10_2:
+  case GL_UNSIGNED_INT_2_10_10_10_REV:
+  case GL_UNSIGNED_INT_24_8:
+  case GL_UNSIGNED_INT_10F_11F_11F_REV:
+  case GL_UNSIGNED_INT_5_9_9_9_REV:
+    return 4;
+  case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+    return 8;
+  default:
+    break;
+  }
+
+  size_t components = 4;
+  switch (format) {
+  case GL_RED:
+  case GL_GREEN:
+  case GL_BLUE:
+  case GL_RED_INTEGER:
+  case GL_GREEN_INTEGER:
+  case GL_BLUE_INTEGER:
+  case GL_DEPTH_COMPONENT:
+  case GL_STENCIL_INDEX:
+    components = 1;
+    break;
+  case GL_RG:
+  case GL_RG_INTEGER:
+    components = 2;
+    break;
+  case GL_RGB:
+  case GL_BGR:
+  case GL_RGB_INTEGER:
+  case GL_BGR_INTEGER:
+    components = 3;
+    break;
+  default:
+    break;
+  }
+
+  switch (type) {
+  case GL_UNSIGNED_SHORT:
+  case GL_SHORT:
+  case GL_HALF_FLOAT:
+    return components * 2;
+  case GL_UNSIGNED_INT:
+  case GL_INT:
+  case GL_FLOAT:
+    return components * 4;
+  default:
+    return components;
+  }
+}
+
+/* Client memory a pixel transfer touches under the given pack/unpack
+ * alignment and row length (skip rows/pixels are not supported) */
+size_t imageBytes(GLsizei width, GLsizei height, GLenum format, GLenum type,
+                  GLint alignment, GLint row_length) noexcept {
+  if (width <= 0 || height <= 0) {
+    return 0;
+  }
+  const size_t pixel = pixelBytes(format, type);
+  const size_t align = alignment > 0 ? static_cast<size_t>(alignment) : 1;
+  const size_t row =
+      static_cast<size_t>(row_length > 0 ? row_length : width) * pixel;
+  const size_t stride = (row + align - 1) / align * align;
+  return stride * static_cast<size_t>(height - 1) +
+         static_cast<size_t>(width) * pixel;
+}
+
+void deleteObject(Kind kind, GLuint name) noexcept {
+  switch (kind) {
+  case Kind::Buffer:
+    glDeleteBuffers(1, &name);
+    break;
+  case Kind::Texture:
+    glDeleteTextures(1, &name);
+    break;
+  case Kind::VertexArray:
+    glDeleteVertexArrays(1, &name);
+    break;
+  case Kind::Framebuffer:
+    glDeleteFramebuffers(1, &name);
+    break;
+  case Kind::Renderbuffer:
+    glDeleteRenderbuffers(1, &name);
+    break;
+  case Kind::Program:
+    glDeleteProgram(name);
+    break;
+  case Kind::Shader:
+    glDeleteShader(name);
+    break;
+  case Kind::Query:
+    glDeleteQueries(1, &name);
+    break;
+  default:
+    break;
+  }
+}
+} // namespace
+
+/* The hooks' way into GLCapture and GLReplay */
+struct GLCallTable {
+  static_assert(nameSpace(Kind::Query) + 1 == GLReplay::kNameSpaces);
+
+  static std::vector<uint8_t> &data(GLCapture &capture) noexcept {
+    return capture.data_;
+  }
+
+  static GLCapture::Stats &stats(GLCapture &capture) noexcept {
+    return capture.stats_;
+  }
+
+  static std::atomic<const void *> &owner(GLCapture &capture) noexcept {
+    return capture.owner_;
+  }
+
+  static auto &mapped(GLCapture &capture) noexcept { return capture.mapped_; }
+  static auto &mapped(GLReplay &replay) noexcept { return replay.mapped_; }
+
+  static std::vector<uint8_t> &scratch(GLReplay &replay) noexcept {
+    return replay.scratch_;
+  }
+
+  static void unresolved(GLReplay &replay) noexcept {
+    ++replay.stats_.unresolved;
+  }
+
+  static GLuint name(GLReplay &replay, Kind kind, GLuint captured) noexcept {
+    const auto &names = replay.names_[nameSpace(kind)];
+    if (const auto it = names.find(captured); it != names.end()) {
+      return it->second;
+    }
+    if (captured != 0) {
+      ++replay.stats_.unresolved;
+    }
+    return kind == Kind::Framebuffer ? replay.framebuffer_ : 0;
+  }
+
+  static void bind(GLReplay &replay, Kind kind, GLuint captured,
+                   GLuint name) {
+    replay.names_[nameSpace(kind)][captured] = name;
+  }
+
+  /* The replayed name, forgotten; 0 if the stream never created it */
+  static GLuint unbind(GLReplay &replay, Kind kind, GLuint captured) noexcept {
+    auto &names = replay.names_[nameSpace(kind)];
+    const auto it = names.find(captured);
+    if (it == names.end()) {
+      replay.stats_.unresolved += captured != 0;
+      return 0;
+    }
+    const GLuint name = it->second;
+    names.erase(it);
+    return name;
+  }
+
+  static GLuint useProgram(GLReplay &replay, GLuint captured) noexcept {
+    replay.program_ = captured;
+    return name(replay, Kind::Program, captured);
+  }
+
+  static uint64_t locationKey(GLuint program, GLint location) noexcept {
+    return uint64_t{program} << 32 | static_cast<uint32_t>(location);
+  }
+
+  static void bindLocation(GLReplay &replay, GLuint program, GLint captured,
+                           GLint location) {
+    replay.locations_[locationKey(program, captured)] = location;
+  }
+
+  /* Locations belong to the program in use, as in GL itself */
+  static GLint location(GLReplay &replay, GLint captured) noexcept {
+    if (captured < 0) {
+      return captured;
+    }
+    const auto it =
+        replay.locations_.find(locationKey(replay.program_, captured));
+    if (it == replay.locations_.end()) {
+      ++replay.stats_.unresolved;
+      return -1;
+    }
+    return it->second;
+  }
+
+  static void bindSync(GLReplay &replay, uint64_t captured, GLsync sync) {
+    replay.syncs_[captured] = sync;
+  }
+
+  static GLsync sync(GLReplay &replay, uint64_t captured) noexcept {
+    if (const auto it = replay.syncs_.find(captured);
+        it != replay.syncs_.end()) {
+      return it->second;
+    }
+    ++replay.stats_.unresolved;
+    return nullptr;
+  }
+
+  static GLsync unbindSync(GLReplay &replay, uint64_t captured) noexcept {
+    const GLsync sync = GLCallTable::sync(replay, captured);
+    replay.syncs_.erase(captured);
+    return sync;
+  }
+};
+
+namespace {
+/* This thread's capture, if it is still the active one and this is still
+ * the thread recording into it. The pointer is only followed once it
+ * matches active_capture, so a capture stopped elsewhere is never touched */
+GLCapture *recorder() noexcept {
+  GLCapture *capture = thread_capture;
+  if (!capture || capture != active_capture.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  const void *owner =
+      GLCallTable::owner(*capture).load(std::memory_order_relaxed);
+  return owner == &thread_capture ? capture : nullptr;
+}
+
+/* Appends one call to a capture. The payload length is filled in when the
+ * record goes out of scope */
+class Record {
+public:
+  Record(GLCapture &capture, uint16_t op)
+      : capture_{capture}, data_{GLCallTable::data(capture)},
+        start_{data_.size()}, op_{op} {
+    put(op);
+    put(uint32_t{});
+  }
+
+  ~Record() {
+    const auto length =
+        static_cast<uint32_t>(data_.size() - start_ - kRecordHeaderBytes);
+    std::memcpy(data_.data() + start_ + sizeof(uint16_t), &length,
+                sizeof(length));
+    if (op_ >= kFirstCall) {
+      ++GLCallTable::stats(capture_).calls;
+    }
+  }
+
+  Record(const Record &) = delete;
+  Record &operator=(const Record &) = delete;
+
+  /* Pointers are stored as integers: buffer offsets and syncs */
+  template <typename T> void put(T value) {
+    if constexpr (std::is_pointer_v<T>) {
+      put(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+    } else {
+      const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+      data_.insert(data_.end(), bytes, bytes + sizeof(T));
+    }
+  }
+
+  void blob(const void *bytes, size_t size) {
+    put(static_cast<uint32_t>(size));
+    const auto *begin = static_cast<const uint8_t *>(bytes);
+    data_.insert(data_.end(), begin, begin + size);
+    GLCallTable::stats(capture_).upload_bytes += size;
+  }
+
+private:
+  GLCapture &capture_;
+  std::vector<uint8_t> &data_;
+  size_t start_;
+  uint16_t op_;
+};
+
+/* Saved driver entry point and opcode of one hooked function */
+template <auto &Pointer> struct Hooked {
+  using Fn = std::remove_reference_t<decltype(Pointer)>;
+
+  static inline Fn original{};
+  static inline uint16_t op{};
+
+  static void install(Fn hook, uint16_t id) noexcept {
+    op = id;
+    if (Pointer && Pointer != hook) {
+      original = Pointer;
+      Pointer = hook;
+    }
+  }
+
+  static void uninstall(Fn hook) noexcept {
+    if (Pointer == hook) {
+      Pointer = original;
+    }
+  }
+};
+
+template <typename A, Kind K> A decode(GLReplay &replay, Reader &in) {
+  if constexpr (std::is_pointer_v<A>) {
+    const auto raw = in.get<uint64_t>();
+    if constexpr (K == Kind::Sync) {
+      return GLCallTable::sync(replay, raw);
+    } else {
+      return reinterpret_cast<A>(static_cast<uintptr_t>(raw));
+    }
+  } else {
+    const auto value = in.get<A>();
+    if constexpr (K == Kind::Value) {
+      return value;
+    } else if constexpr (K == Kind::Location) {
+      return GLCallTable::location(replay, value);
+    } else {
+      return GLCallTable::name(replay, K, value);
+    }
+  }
+}
+
+template <Kind... K> struct Kinds {};
+
+/* A call whose arguments are all plain values, object names, uniform
+ * locations, syncs or buffer offsets: recorded verbatim, remapped on
+ * replay. No kinds means every argument is a plain value */
+template <auto &Pointer, typename Fn, typename Names> struct Generic;
+
+template <auto &Pointer, typename R, typename... A, Kind... K>
+struct Generic<Pointer, R(APIENTRYP)(A...), Kinds<K...>> : Hooked<Pointer> {
+  using Base = Hooked<Pointer>;
+
+  static_assert(sizeof...(K) == 0 || sizeof...(K) == sizeof...(A));
+  static constexpr std::array<Kind, sizeof...(A)> kKinds{K...};
+
+  static R APIENTRY hook(A... args) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, Base::op};
+      (record.put(args), ...);
+    }
+    return Base::original(args...);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    replayWith(replay, in, std::index_sequence_for<A...>{});
+  }
+
+  template <size_t... I>
+  static void replayWith([[maybe_unused]] GLReplay &replay,
+                         [[maybe_unused]] Reader &in,
+                         std::index_sequence<I...>) {
+    /* Braced initialization decodes the arguments in order */
+    std::tuple<A...> args{decode<A, kKinds[I]>(replay, in)...};
+    if (!Pointer) {
+      GLCallTable::unresolved(replay);
+      return;
+    }
+    std::apply(Pointer, args);
+  }
+};
+
+template <auto &Pointer, Kind... K>
+using Call =
+    Generic<Pointer, std::remove_reference_t<decltype(Pointer)>, Kinds<K...>>;
+
+/* glGen*: the names the driver returned become the stream's names */
+template <auto &Pointer, Kind K> struct Gen : Hooked<Pointer> {
+  using Base = Hooked<Pointer>;
+
+  static void APIENTRY hook(GLsizei n, GLuint *names) {
+    Base::original(n, names);
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, Base::op};
+      record.put(n);
+      for (GLsizei i = 0; i < n; ++i) {
+        record.put(names[i]);
+      }
+    }
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto n = in.get<GLsizei>();
+    for (GLsizei i = 0; i < n && in.remaining() >= sizeof(GLuint); ++i) {
+      const auto captured = in.get<GLuint>();
+      GLuint name = 0;
+      Pointer(1, &name);
+      GLCallTable::bind(replay, K, captured, name);
+    }
+  }
+};
+
+/* glDelete* for arrays of names */
+template <auto &Pointer, Kind K> struct Delete : Hooked<Pointer> {
+  using Base = Hooked<Pointer>;
+
+  static void APIENTRY hook(GLsizei n, const GLuint *names) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, Base::op};
+      record.put(n);
+      for (GLsizei i = 0; i < n; ++i) {
+        record.put(names[i]);
+      }
+    }
+    Base::original(n, names);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto n = in.get<GLsizei>();
+    for (GLsizei i = 0; i < n && in.remaining() >= sizeof(GLuint); ++i) {
+      if (const GLuint name =
+              GLCallTable::unbind(replay, K, in.get<GLuint>())) {
+        Pointer(1, &name);
+      }
+    }
+  }
+};
+
+/* glCreateProgram / glCreateShader: the result is the stream's name */
+template <auto &Pointer, Kind K,
+          typename Fn = std::remove_reference_t<decltype(Pointer)>>
+struct Create;
+
+template <auto &Pointer, Kind K, typename... A>
+struct Create<Pointer, K, GLuint(APIENTRYP)(A...)> : Hooked<Pointer> {
+  using Base = Hooked<Pointer>;
+
+  static GLuint APIENTRY hook(A... args) {
+    const GLuint name = Base::original(args...);
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, Base::op};
+      (record.put(args), ...);
+      record.put(name);
+    }
+    return name;
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    std::tuple<A...> args{in.get<A>()...};
+    const auto captured = in.get<GLuint>();
+    GLCallTable::bind(replay, K, captured, std::apply(Pointer, args));
+  }
+};
+
+/* glDeleteProgram / glDeleteShader */
+template <auto &Pointer, Kind K> struct Destroy : Hooked<Pointer> {
+  using Base = Hooked<Pointer>;
+
+  static void APIENTRY hook(GLuint name) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, Base::op};
+      record.put(name);
+    }
+    Base::original(name);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    if (const GLuint name = GLCallTable::unbind(replay, K, in.get<GLuint>())) {
+      Pointer(name);
+    }
+  }
+};
+
+struct UseProgram : Hooked<glad_glUseProgram> {
+  static void APIENTRY hook(GLuint program) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(program);
+    }
+    original(program);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    glUseProgram(GLCallTable::useProgram(replay, in.get<GLuint>()));
+  }
+};
+
+struct GetUniformLocation : Hooked<glad_glGetUniformLocation> {
+  static GLint APIENTRY hook(GLuint program, const GLchar *name) {
+    const GLint location = original(program, name);
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(program);
+      record.blob(name, std::strlen(name));
+      record.put(location);
+    }
+    return location;
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto program = in.get<GLuint>();
+    const auto bytes = in.blob();
+    const auto captured = in.get<GLint>();
+    const std::string name(bytes.begin(), bytes.end());
+    GLCallTable::bindLocation(
+        replay, program, captured,
+        glGetUniformLocation(GLCallTable::name(replay, Kind::Program, program),
+                             name.c_str()));
+  }
+};
+
+struct ShaderSource : Hooked<glad_glShaderSource> {
+  static void APIENTRY hook(GLuint shader, GLsizei count,
+                            const GLchar *const *strings,
+                            const GLint *lengths) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(shader);
+      record.put(count);
+      for (GLsizei i = 0; i < count; ++i) {
+        record.blob(strings[i], lengths && lengths[i] >= 0
+                                    ? static_cast<size_t>(lengths[i])
+                                    : std::strlen(strings[i]));
+      }
+    }
+    original(shader, count, strings, lengths);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const GLuint shader =
+        GLCallTable::name(replay, Kind::Shader, in.get<GLuint>());
+    const auto count = in.get<GLsizei>();
+    std::vector<const GLchar *> strings;
+    std::vector<GLint> lengths;
+    for (GLsizei i = 0; i < count && in.remaining(); ++i) {
+      const auto bytes = in.blob();
+      strings.push_back(reinterpret_cast<const GLchar *>(bytes.data()));
+      lengths.push_back(static_cast<GLint>(bytes.size()));
+    }
+    glShaderSource(shader, static_cast<GLsizei>(strings.size()),
+                   strings.data(), lengths.data());
+  }
+};
+
+/* Names are stored as null-terminated blobs so replay can pass them on */
+struct TransformFeedbackVaryings
+    : Hooked<glad_glTransformFeedbackVaryings> {
+  static void APIENTRY hook(GLuint program, GLsizei count,
+                            const GLchar *const *varyings, GLenum mode) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(program);
+      record.put(count);
+      for (GLsizei i = 0; i < count; ++i) {
+        record.blob(varyings[i], std::strlen(varyings[i]) + 1);
+      }
+      record.put(mode);
+    }
+    original(program, count, varyings, mode);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const GLuint program =
+        GLCallTable::name(replay, Kind::Program, in.get<GLuint>());
+    const auto count = in.get<GLsizei>();
+    std::vector<const GLchar *> varyings;
+    for (GLsizei i = 0; i < count && in.remaining(); ++i) {
+      const auto bytes = in.blob();
+      if (bytes.empty() || bytes.back() != 0) {
+        GLCallTable::unresolved(replay);
+        return;
+      }
+      varyings.push_back(reinterpret_cast<const GLchar *>(bytes.data()));
+    }
+    const auto mode = in.get<GLenum>();
+    glTransformFeedbackVaryings(program,
+                                static_cast<GLsizei>(varyings.size()),
+                                varyings.data(), mode);
+  }
+};
+
+struct ProgramBinary : Hooked<gl_extensions.ProgramBinary> {
+  static void APIENTRY hook(GLuint program, GLenum format, const void *binary,
+                            GLsizei length) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(program);
+      record.put(format);
+      record.blob(binary, static_cast<size_t>(std::max(length, 0)));
+    }
+    original(program, format, binary, length);
+  }
+
+  /* Only loads on the driver that produced the binary */
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto program = in.get<GLuint>();
+    const auto format = in.get<GLenum>();
+    const auto bytes = in.blob();
+    if (!gl_extensions.ProgramBinary) {
+      GLCallTable::unresolved(replay);
+      return;
+    }
+    gl_extensions.ProgramBinary(
+        GLCallTable::name(replay, Kind::Program, program), format,
+        bytes.data(), static_cast<GLsizei>(bytes.size()));
+  }
+};
+
+struct BufferData : Hooked<glad_glBufferData> {
+  static void APIENTRY hook(GLenum target, GLsizeiptr size, const void *data,
+                            GLenum usage) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(target);
+      record.put(size);
+      record.put(usage);
+      record.put(static_cast<uint8_t>(data != nullptr));
+      record.blob(data, data ? static_cast<size_t>(size) : 0);
+    }
+    original(target, size, data, usage);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto target = in.get<GLenum>();
+    const auto size = in.get<GLsizeiptr>();
+    const auto usage = in.get<GLenum>();
+    const bool has_data = in.get<uint8_t>();
+    const auto bytes = in.blob();
+    if (has_data && bytes.size() != static_cast<size_t>(size)) {
+      GLCallTable::unresolved(replay);
+      return;
+    }
+    glBufferData(target, size, has_data ? bytes.data() : nullptr, usage);
+  }
+};
+
+struct BufferSubData : Hooked<glad_glBufferSubData> {
+  static void APIENTRY hook(GLenum target, GLintptr offset, GLsizeiptr size,
+                            const void *data) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(target);
+      record.put(offset);
+      record.blob(data, static_cast<size_t>(size));
+    }
+    original(target, offset, size, data);
+  }
+
+  static void replay(GLReplay &, Reader &in) {
+    const auto target = in.get<GLenum>();
+    const auto offset = in.get<GLintptr>();
+    const auto bytes = in.blob();
+    glBufferSubData(target, offset, static_cast<GLsizeiptr>(bytes.size()),
+                    bytes.data());
+  }
+};
+
+struct MapBufferRange : Hooked<glad_glMapBufferRange> {
+  static void *APIENTRY hook(GLenum target, GLintptr offset,
+                             GLsizeiptr length, GLbitfield access) {
+    void *pointer = original(target, offset, length, access);
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(target);
+      record.put(offset);
+      record.put(length);
+      record.put(access);
+      if (pointer && (access & GL_MAP_WRITE_BIT)) {
+        GLCallTable::mapped(*capture)[target] = {
+            .bytes = {static_cast<const uint8_t *>(pointer),
+                      static_cast<size_t>(length)},
+            .flush_explicit = (access & GL_MAP_FLUSH_EXPLICIT_BIT) != 0};
+      }
+    }
+    return pointer;
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto target = in.get<GLenum>();
+    const auto offset = in.get<GLintptr>();
+    const auto length = in.get<GLsizeiptr>();
+    const auto access = in.get<GLbitfield>();
+    if (void *pointer = glMapBufferRange(target, offset, length, access)) {
+      GLCallTable::mapped(replay)[target] = {static_cast<uint8_t *>(pointer),
+                                             static_cast<size_t>(length)};
+    }
+  }
+};
+
+/* Explicitly flushed mappings record just the flushed bytes, so streaming
+ * a few bytes through a large mapping doesn't record all of it */
+struct FlushMappedBufferRange : Hooked<glad_glFlushMappedBufferRange> {
+  static void APIENTRY hook(GLenum target, GLintptr offset,
+                            GLsizeiptr length) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(target);
+      record.put(offset);
+      const auto &mapped = GLCallTable::mapped(*capture);
+      const auto it = mapped.find(target);
+      if (it != mapped.end() && offset >= 0 && length >= 0 &&
+          static_cast<size_t>(offset) + static_cast<size_t>(length) <=
+              it->second.bytes.size()) {
+        record.blob(it->second.bytes.data() + offset,
+                    static_cast<size_t>(length));
+      } else {
+        record.blob(nullptr, 0);
+      }
+    }
+    original(target, offset, length);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto target = in.get<GLenum>();
+    const auto offset = in.get<GLintptr>();
+    const auto bytes = in.blob();
+    auto &mapped = GLCallTable::mapped(replay);
+    const auto it = mapped.find(target);
+    if (it == mapped.end() || offset < 0 ||
+        static_cast<size_t>(offset) + bytes.size() > it->second.size()) {
+      return;
+    }
+    std::memcpy(it->second.data() + offset, bytes.data(), bytes.size());
+    glFlushMappedBufferRange(target, offset,
+                             static_cast<GLsizeiptr>(bytes.size()));
+  }
+};
+
+/* Whatever was written through a mapping is recorded when it is unmapped
+ * and written through the replay's own mapping. Explicitly flushed
+ * mappings were recorded as they were flushed, and unmap with no bytes */
+struct UnmapBuffer : Hooked<glad_glUnmapBuffer> {
+  static GLboolean APIENTRY hook(GLenum target) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(target);
+      auto &mapped = GLCallTable::mapped(*capture);
+      if (const auto it = mapped.find(target);
+          it != mapped.end() && !it->second.flush_explicit) {
+        record.blob(it->second.bytes.data(), it->second.bytes.size());
+      } else {
+        record.blob(nullptr, 0);
+      }
+      mapped.erase(target);
+    }
+    return original(target);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto target = in.get<GLenum>();
+    const auto bytes = in.blob();
+    auto &mapped = GLCallTable::mapped(replay);
+    const auto it = mapped.find(target);
+    if (it == mapped.end()) {
+      return;
+    }
+    std::memcpy(it->second.data(), bytes.data(),
+                std::min(bytes.size(), it->second.size()));
+    mapped.erase(it);
+    glUnmapBuffer(target);
+  }
+};
+
+/* Texture uploads read client memory or, with an unpack buffer bound, an
+ * offset into it. The unpack alignment and row length travel with the call
+ * so the replay reads the recorded bytes the same way */
+void putPixels(Record &record, const void *pixels, GLsizei width,
+               GLsizei height, GLenum format, GLenum type) {
+  const GLint alignment = integer(GL_UNPACK_ALIGNMENT);
+  const GLint row_length = integer(GL_UNPACK_ROW_LENGTH);
+  record.put(alignment);
+  record.put(row_length);
+  if (integer(GL_PIXEL_UNPACK_BUFFER_BINDING)) {
+    record.put(Source::Buffer);
+    record.put(pixels);
+  } else if (pixels) {
+    record.put(Source::Client);
+    record.blob(pixels, imageBytes(width, height, format, type, alignment,
+                                   row_length));
+  } else {
+    record.put(Source::None);
+  }
+}
+
+/* False if the pixels can't be reproduced (an unpack buffer the stream
+ * never created, or a short blob); `pixels` is then null */
+bool getPixels(Reader &in, GLsizei width, GLsizei height, GLenum format,
+               GLenum type, const void *&pixels) {
+  const auto alignment = in.get<GLint>();
+  const auto row_length = in.get<GLint>();
+  glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+
+  pixels = nullptr;
+  switch (in.get<Source>()) {
+  case Source::Buffer: {
+    const auto offset = in.get<uint64_t>();
+    if (!integer(GL_PIXEL_UNPACK_BUFFER_BINDING)) {
+      return false;
+    }
+    pixels = reinterpret_cast<const void *>(static_cast<uintptr_t>(offset));
+    return true;
+  }
+  case Source::Client: {
+    const auto bytes = in.blob();
+    if (bytes.size() !=
+        imageBytes(width, height, format, type, alignment, row_length)) {
+      return false;
+    }
+    pixels = bytes.data();
+    return true;
+  }
+  default:
+    return true;
+  }
+}
+
+struct TexImage2D : Hooked<glad_glTexImage2D> {
+  static void APIENTRY hook(GLenum target, GLint level, GLint internal_format,
+                            GLsizei width, GLsizei height, GLint border,
+                            GLenum format, GLenum type, const void *pixels) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(target);
+      record.put(level);
+      record.put(internal_format);
+      record.put(width);
+      record.put(height);
+      record.put(border);
+      record.put(format);
+      record.put(type);
+      putPixels(record, pixels, width, height, format, type);
+    }
+    original(target, level, internal_format, width, height, border, format,
+             type, pixels);
+  }
+
+  /* Unreproducible pixels still allocate the storage */
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto target = in.get<GLenum>();
+    const auto level = in.get<GLint>();
+    const auto internal_format = in.get<GLint>();
+    const auto width = in.get<GLsizei>();
+    const auto height = in.get<GLsizei>();
+    const auto border = in.get<GLint>();
+    const auto format = in.get<GLenum>();
+    const auto type = in.get<GLenum>();
+    const void *pixels = nullptr;
+    if (!getPixels(in, width, height, format, type, pixels)) {
+      GLCallTable::unresolved(replay);
+    }
+    glTexImage2D(target, level, internal_format, width, height, border, format,
+                 type, pixels);
+  }
+};
+
+struct TexSubImage2D : Hooked<glad_glTexSubImage2D> {
+  static void APIENTRY hook(GLenum target, GLint level, GLint x, GLint y,
+                            GLsizei width, GLsizei height, GLenum format,
+                            GLenum type, const void *pixels) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(target);
+      record.put(level);
+      record.put(x);
+      record.put(y);
+      record.put(width);
+      record.put(height);
+      record.put(format);
+      record.put(type);
+      putPixels(record, pixels, width, height, format, type);
+    }
+    original(target, level, x, y, width, height, format, type, pixels);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto target = in.get<GLenum>();
+    const auto level = in.get<GLint>();
+    const auto x = in.get<GLint>();
+    const auto y = in.get<GLint>();
+    const auto width = in.get<GLsizei>();
+    const auto height = in.get<GLsizei>();
+    const auto format = in.get<GLenum>();
+    const auto type = in.get<GLenum>();
+    const void *pixels = nullptr;
+    if (!getPixels(in, width, height, format, type, pixels) || !pixels) {
+      GLCallTable::unresolved(replay);
+      return;
+    }
+    glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+  }
+};
+
+/* Array layers are stacked images, so their pixels travel as one image
+ * depth times as tall */
+struct TexImage3D : Hooked<glad_glTexImage3D> {
+  static void APIENTRY hook(GLenum target, GLint level, GLint internal_format,
+                            GLsizei width, GLsizei height, GLsizei depth,
+                            GLint border, GLenum format, GLenum type,
+                            const void *pixels) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(target);
+      record.put(level);
+      record.put(internal_format);
+      record.put(width);
+      record.put(height);
+      record.put(depth);
+      record.put(border);
+      record.put(format);
+      record.put(type);
+      putPixels(record, pixels, width, height * depth, format, type);
+    }
+    original(target, level, internal_format, width, height, depth, border,
+             format, type, pixels);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto target = in.get<GLenum>();
+    const auto level = in.get<GLint>();
+    const auto internal_format = in.get<GLint>();
+    const auto width = in.get<GLsizei>();
+    const auto height = in.get<GLsizei>();
+    const auto depth = in.get<GLsizei>();
+    const auto border = in.get<GLint>();
+    const auto format = in.get<GLenum>();
+    const auto type = in.get<GLenum>();
+    const void *pixels = nullptr;
+    if (!getPixels(in, width, height * depth, format, type, pixels)) {
+      GLCallTable::unresolved(replay);
+    }
+    glTexImage3D(target, level, internal_format, width, height, depth, border,
+                 format, type, pixels);
+  }
+};
+
+struct TexSubImage3D : Hooked<glad_glTexSubImage3D> {
+  static void APIENTRY hook(GLenum target, GLint level, GLint x, GLint y,
+                            GLint z, GLsizei width, GLsizei height,
+                            GLsizei depth, GLenum format, GLenum type,
+                            const void *pixels) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(target);
+      record.put(level);
+      record.put(x);
+      record.put(y);
+      record.put(z);
+      record.put(width);
+      record.put(height);
+      record.put(depth);
+      record.put(format);
+      record.put(type);
+      putPixels(record, pixels, width, height * depth, format, type);
+    }
+    original(target, level, x, y, z, width, height, depth, format, type,
+             pixels);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto target = in.get<GLenum>();
+    const auto level = in.get<GLint>();
+    const auto x = in.get<GLint>();
+    const auto y = in.get<GLint>();
+    const auto z = in.get<GLint>();
+    const auto width = in.get<GLsizei>();
+    const auto height = in.get<GLsizei>();
+    const auto depth = in.get<GLsizei>();
+    const auto format = in.get<GLenum>();
+    const auto type = in.get<GLenum>();
+    const void *pixels = nullptr;
+    if (!getPixels(in, width, height * depth, format, type, pixels) ||
+        !pixels) {
+      GLCallTable::unresolved(replay);
+      return;
+    }
+    glTexSubImage3D(target, level, x, y, z, width, height, depth, format, type,
+                    pixels);
+  }
+};
+
+/* Readbacks are replayed for their cost; client reads land in scratch */
+struct ReadPixels : Hooked<glad_glReadPixels> {
+  static void APIENTRY hook(GLint x, GLint y, GLsizei width, GLsizei height,
+                            GLenum format, GLenum type, void *pixels) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(x);
+      record.put(y);
+      record.put(width);
+      record.put(height);
+      record.put(format);
+      record.put(type);
+      record.put(integer(GL_PIXEL_PACK_BUFFER_BINDING) ? Source::Buffer
+                                                       : Source::Client);
+      record.put(pixels);
+    }
+    original(x, y, width, height, format, type, pixels);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto x = in.get<GLint>();
+    const auto y = in.get<GLint>();
+    const auto width = in.get<GLsizei>();
+    const auto height = in.get<GLsizei>();
+    const auto format = in.get<GLenum>();
+    const auto type = in.get<GLenum>();
+    const auto source = in.get<Source>();
+    const auto offset = in.get<uint64_t>();
+
+    const bool pack_buffer = integer(GL_PIXEL_PACK_BUFFER_BINDING) != 0;
+    if (source == Source::Buffer) {
+      if (!pack_buffer) {
+        GLCallTable::unresolved(replay);
+        return;
+      }
+      glReadPixels(x, y, width, height, format, type,
+                   reinterpret_cast<void *>(static_cast<uintptr_t>(offset)));
+      return;
+    }
+    if (pack_buffer) {
+      GLCallTable::unresolved(replay);
+      return;
+    }
+
+    auto &scratch = GLCallTable::scratch(replay);
+    scratch.resize(imageBytes(width, height, format, type,
+                              integer(GL_PACK_ALIGNMENT),
+                              integer(GL_PACK_ROW_LENGTH)));
+    glReadPixels(x, y, width, height, format, type, scratch.data());
+  }
+};
+
+struct FenceSync : Hooked<glad_glFenceSync> {
+  static GLsync APIENTRY hook(GLenum condition, GLbitfield flags) {
+    const GLsync sync = original(condition, flags);
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(condition);
+      record.put(flags);
+      record.put(sync);
+    }
+    return sync;
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    const auto condition = in.get<GLenum>();
+    const auto flags = in.get<GLbitfield>();
+    GLCallTable::bindSync(replay, in.get<uint64_t>(),
+                          glFenceSync(condition, flags));
+  }
+};
+
+struct DeleteSync : Hooked<glad_glDeleteSync> {
+  static void APIENTRY hook(GLsync sync) {
+    if (GLCapture *capture = recorder()) {
+      Record record{*capture, op};
+      record.put(sync);
+    }
+    original(sync);
+  }
+
+  static void replay(GLReplay &replay, Reader &in) {
+    if (const GLsync sync =
+            GLCallTable::unbindSync(replay, in.get<uint64_t>())) {
+      glDeleteSync(sync);
+    }
+  }
+};
+
+using enum Kind;
+
+/* Everything the engine issues. Opcodes are positions in this list, so
+ * append new calls at the end and bump kVersion when reordering */
+using Calls = std::tuple<
+    Call<glad_glActiveTexture>, Call<glad_glAttachShader, Program, Shader>,
+    Call<glad_glBeginQuery, Value, Query>, Call<glad_glBindBuffer, Value, Buffer>,
+    Call<glad_glBindFramebuffer, Value, Framebuffer>,
+    Call<glad_glBindRenderbuffer, Value, Renderbuffer>,
+    Call<glad_glBindTexture, Value, Texture>,
+    Call<glad_glBindVertexArray, VertexArray>, Call<glad_glBlendFunc>,
+    Call<glad_glBlendFuncSeparate>, Call<glad_glBlitFramebuffer>, BufferData,
+    BufferSubData, Call<glad_glClear>, Call<glad_glClearColor>,
+    Call<glad_glClientWaitSync, Sync, Value, Value>, Call<glad_glColorMask>,
+    Call<glad_glCompileShader, Shader>, Call<glad_glCopyBufferSubData>,
+    Create<glad_glCreateProgram, Program>, Create<glad_glCreateShader, Shader>,
+    Delete<glad_glDeleteBuffers, Buffer>,
+    Delete<glad_glDeleteFramebuffers, Framebuffer>,
+    Destroy<glad_glDeleteProgram, Program>, Delete<glad_glDeleteQueries, Query>,
+    Delete<glad_glDeleteRenderbuffers, Renderbuffer>,
+    Destroy<glad_glDeleteShader, Shader>, DeleteSync,
+    Delete<glad_glDeleteTextures, Texture>,
+    Delete<glad_glDeleteVertexArrays, VertexArray>,
+    Call<glad_glDetachShader, Program, Shader>, Call<glad_glDisable>,
+    Call<glad_glDisableVertexAttribArray>, Call<glad_glDrawArrays>,
+    Call<glad_glDrawArraysInstanced>, Call<glad_glDrawElements>,
+    Call<glad_glDrawElementsInstanced>, Call<glad_glEnable>,
+    Call<glad_glEnableVertexAttribArray>, Call<glad_glEndQuery>, FenceSync,
+    Call<glad_glFinish>, Call<glad_glFlush>,
+    Call<glad_glFramebufferRenderbuffer, Value, Value, Value, Renderbuffer>,
+    Call<glad_glFramebufferTexture2D, Value, Value, Value, Texture, Value>,
+    Gen<glad_glGenBuffers, Buffer>, Gen<glad_glGenFramebuffers, Framebuffer>,
+    Gen<glad_glGenQueries, Query>, Gen<glad_glGenRenderbuffers, Renderbuffer>,
+    Gen<glad_glGenTextures, Texture>, Gen<glad_glGenVertexArrays, VertexArray>,
+    Call<glad_glGenerateMipmap>, GetUniformLocation,
+    Call<glad_glLinkProgram, Program>, MapBufferRange, Call<glad_glPixelStorei>,
+    ProgramBinary,
+    Call<gl_extensions.ProgramParameteri, Program, Value, Value>,
+    Call<glad_glQueryCounter, Query, Value>, ReadPixels,
+    Call<glad_glRenderbufferStorage>, Call<glad_glScissor>, ShaderSource,
+    TexImage2D, Call<glad_glTexParameteri>, TexSubImage2D,
+    Call<glad_glUniform1f, Location, Value>,
+    Call<glad_glUniform1i, Location, Value>,
+    Call<glad_glUniform2f, Location, Value, Value>,
+    Call<glad_glUniform3f, Location, Value, Value, Value>,
+    Call<glad_glUniform4f, Location, Value, Value, Value, Value>, UnmapBuffer,
+    UseProgram, Call<glad_glVertexAttribDivisor>,
+    Call<glad_glVertexAttribIPointer>, Call<glad_glVertexAttribPointer>,
+    Call<glad_glViewport>, Call<glad_glWaitSync, Sync, Value, Value>,
+    TexImage3D, TexSubImage3D, Call<glad_glTexBuffer, Value, Value, Buffer>,
+    Call<glad_glBeginTransformFeedback>,
+    Call<glad_glBindBufferBase, Value, Value, Buffer>,
+    Call<glad_glEndTransformFeedback>, TransformFeedbackVaryings,
+    FlushMappedBufferRange>;
+
+constexpr size_t kCallCount = std::tuple_size_v<Calls>;
+
+template <size_t I> using Entry = std::tuple_element_t<I, Calls>;
+
+template <size_t... I> void installHooks(std::index_sequence<I...>) noexcept {
+  (Entry<I>::install(&Entry<I>::hook, static_cast<uint16_t>(kFirstCall + I)),
+   ...);
+}
+
+template <size_t... I>
+void uninstallHooks(std::index_sequence<I...>) noexcept {
+  (Entry<I>::uninstall(&Entry<I>::hook), ...);
+}
+
+using ReplayFn = void (*)(GLReplay &, Reader &);
+
+template <size_t... I>
+constexpr std::array<ReplayFn, kCallCount>
+replayTable(std::index_sequence<I...>) {
+  return {&Entry<I>::replay...};
+}
+
+constexpr auto kReplay = replayTable(std::make_index_sequence<kCallCount>{});
+
+void installHooks() noexcept {
+  installHooks(std::make_index_sequence<kCallCount>{});
+}
+
+void uninstallHooks() noexcept {
+  uninstallHooks(std::make_index_sequence<kCallCount>{});
+}
+
+std::vector<uint8_t> readFile(const std::filesystem::path &path) {
+  std::ifstream in{path, std::ios::binary};
+  if (!in) {
+    throw std::runtime_error("Unable to read GL capture " + path.string());
+  }
+  return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+} // namespace
+
+GLCapture::GLCapture() {
+  GLCapture *expected = nullptr;
+  if (!active_capture.compare_exchange_strong(expected, this)) {
+    throw std::logic_error("Another GLCapture is already recording");
+  }
+
+  data_.insert(data_.end(), std::begin(kMagic), std::end(kMagic));
+  const auto *version = reinterpret_cast<const uint8_t *>(&kVersion);
+  data_.insert(data_.end(), version, version + sizeof(kVersion));
+
+  recording_ = true;
+  thread_capture = this;
+  owner_.store(&thread_capture, std::memory_order_relaxed);
+  installHooks();
+}
+
+GLCapture::~GLCapture() { stop(); }
+
+void GLCapture::stop() noexcept {
+  if (!recording_) {
+    return;
+  }
+
+  /* Other threads still pointing here stop recording as soon as this is
+   * no longer the active capture */
+  active_capture.store(nullptr, std::memory_order_release);
+  uninstallHooks();
+  if (thread_capture == this) {
+    thread_capture = nullptr;
+  }
+  owner_.store(nullptr, std::memory_order_relaxed);
+  mapped_.clear();
+  recording_ = false;
+}
+
+bool GLCapture::recording() const noexcept { return recording_; }
+
+const GLCapture::Stats &GLCapture::stats() const noexcept { return stats_; }
+
+std::span<const uint8_t> GLCapture::data() const noexcept { return data_; }
+
+void GLCapture::save(const std::filesystem::path &path) const {
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  if (!out.write(reinterpret_cast<const char *>(data_.data()),
+                 static_cast<std::streamsize>(data_.size()))) {
+    throw std::runtime_error("Unable to write GL capture " + path.string());
+  }
+}
+
+void GLCapture::beginFrame() noexcept {
+  if (GLCapture *capture = recorder()) {
+    Record record{*capture, kBeginFrame};
+  }
+}
+
+void GLCapture::endFrame() noexcept {
+  if (GLCapture *capture = recorder()) {
+    Record record{*capture, kEndFrame};
+    ++capture->stats_.frames;
+  }
+}
+
+void GLCapture::attach() noexcept {
+  GLCapture *capture = active_capture.load(std::memory_order_acquire);
+  thread_capture = capture;
+  if (capture) {
+    capture->owner_.store(&thread_capture, std::memory_order_relaxed);
+  }
+}
+
+void GLCapture::detach() noexcept {
+  if (GLCapture *capture = recorder()) {
+    capture->owner_.store(nullptr, std::memory_order_relaxed);
+  }
+  thread_capture = nullptr;
+}
+
+void GLCapture::reattach() noexcept {
+  if (active_capture.load()) {
+    installHooks();
+  }
+}
+
+GLReplay::GLReplay(std::vector<uint8_t> data) : data_{std::move(data)} {
+  index();
+}
+
+GLReplay::GLReplay(const std::filesystem::path &path)
+    : GLReplay{readFile(path)} {}
+
+GLReplay::~GLReplay() {
+  for (const auto &[captured, sync] : syncs_) {
+    glDeleteSync(sync);
+  }
+  for (size_t space = 0; space < kNameSpaces; ++space) {
+    const auto kind =
+        static_cast<Kind>(space + static_cast<size_t>(Kind::Buffer));
+    for (const auto &[captured, name] : names_[space]) {
+      deleteObject(kind, name);
+    }
+  }
+}
+
+void GLReplay::setFramebuffer(GLuint framebuffer) noexcept {
+  framebuffer_ = framebuffer;
+}
+
+GLuint GLReplay::framebuffer() const noexcept { return framebuffer_; }
+
+void GLReplay::setup() noexcept { run(setup_); }
+
+size_t GLReplay::frameCount() const noexcept { return frames_.size(); }
+
+void GLReplay::replayFrame(size_t index) {
+  if (index >= frames_.size()) {
+    throw std::out_of_range("GL capture frame out of range");
+  }
+  run(frames_[index]);
+}
+
+const GLReplay::Stats &GLReplay::stats() const noexcept { return stats_; }
+
+void GLReplay::index() {
+  uint32_t version = 0;
+  if (data_.size() < kHeaderBytes ||
+      std::memcmp(data_.data(), kMagic, sizeof(kMagic)) != 0) {
+    throw std::invalid_argument("Not a GL capture stream");
+  }
+  std::memcpy(&version, data_.data() + sizeof(kMagic), sizeof(version));
+  if (version != kVersion) {
+    throw std::invalid_argument("Unsupported GL capture version");
+  }
+
+  /* Frames run from the end of the previous frame (or the first frame
+   * marker) up to their end marker */
+  setup_ = {kHeaderBytes, data_.size()};
+  bool started = false;
+  size_t frame_begin = 0;
+  size_t at = kHeaderBytes;
+  while (at < data_.size()) {
+    uint16_t op = 0;
+    uint32_t length = 0;
+    if (data_.size() - at < kRecordHeaderBytes) {
+      throw std::invalid_argument("Truncated GL capture record");
+    }
+    std::memcpy(&op, data_.data() + at, sizeof(op));
+    std::memcpy(&length, data_.data() + at + sizeof(op), sizeof(length));
+    if (length > data_.size() - at - kRecordHeaderBytes) {
+      throw std::invalid_argument("Truncated GL capture record");
+    }
+    if (op >= kFirstCall + kCallCount) {
+      throw std::invalid_argument("Unknown GL capture opcode");
+    }
+
+    const size_t end = at + kRecordHeaderBytes + length;
+    if (op == kBeginFrame && !started) {
+      started = true;
+      setup_.end = at;
+      frame_begin = at;
+    } else if (op == kEndFrame && started) {
+      frames_.push_back({frame_begin, at});
+      frame_begin = end;
+    }
+    at = end;
+  }
+}
+
+void GLReplay::run(Range range) noexcept {
+  size_t at = range.begin;
+  while (at < range.end) {
+    uint16_t op = 0;
+    uint32_t length = 0;
+    std::memcpy(&op, data_.data() + at, sizeof(op));
+    std::memcpy(&length, data_.data() + at + sizeof(op), sizeof(length));
+    at += kRecordHeaderBytes;
+
+    if (op >= kFirstCall) {
+      Reader in{data_.data() + at, length};
+      kReplay[op - kFirstCall](*this, in);
+      ++stats_.calls;
+    }
+    at += length;
+  }
+}
@@ -0,0 +1,51 @@
+#include "gl_extensions.h"
+
+GLExtensions gl_extensions{};
+
+namespace {
+bool versionAtLeast(int major, int minor) noexcept {
+  return GLVersion.major > major ||
+         (GLVersion.major == major && GLVersion.minor >= minor);
+}
+} // namespace
+
+bool loadGLExtensions(GLADloadproc loader) noexcept {
+  gl_extensions = {};
+  if (!loader) {
+    return false;
+  }
+
+  if (versionAtLeast(4, 1) || hasGLExtension("GL_ARB_get_program_binary")) {
+    auto &ext = gl_extensions;
+    ext.GetProgramBinary =
+        reinterpret_cast<PFNGLGETPROGRAMBINARYPROC>(loader("glGetProgramBinary"));
+    ext.ProgramBinary =
+        reinterpret_cast<PFNGLPROGRAMBINARYPROC>(loader("glProgramBinary"));
+    ext.ProgramParameteri = reinterpret_cast<PFNGLPROGRAMPARAMETERIPROC>(
+        loader("glProgramParameteri"));
+    ext.program_binary =
+        ext.GetProgramBinary && ext.ProgramBinary && ext.ProgramParameteri;
+  }
+
+  if (versionAtLeast(4, 4) || hasGLExtension("GL_ARB_buffer_storage")) {
+    auto &ext = gl_extensions;
+    ext.BufferStorage =
+        reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(loader("glBufferStorage"));
+    ext.buffer_storage = ext.BufferStorage != nullptr;
+  }
+
+  return true;
+}
+
+bool hasGLExtension(std::string_view name) noexcept {
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; ++i) {
+    const auto *ext = reinterpret_cast<const char *>(
+        glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+    if (ext && name == ext) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,52 @@
+#include "gl_state.h"
+
+GLStateCache::GLStateCache() noexcept { invalidate(); }
+
+void GLStateCache::useProgram(GLuint program) noexcept {
+  if (changed(program_, program)) {
+    glUseProgram(program);
+  }
+}
+
+void GLStateCache::bindVertexArray(GLuint vao) noexcept {
+  if (changed(vao_, vao)) {
+    glBindVertexArray(vao);
+  }
+}
+
+void GLStateCache::bindTexture2D(size_t unit, GLuint texture) noexcept {
+  if (unit >= kTextureUnits || !changed(textures_[unit], texture)) {
+    return;
+  }
+
+  /* The active unit is tracked too, but isn't counted as a separate bind */
+  if (active_unit_ != unit) {
+    glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(unit));
+    active_unit_ = unit;
+  }
+  glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLStateCache::invalidate() noexcept {
+  program_ = kUnknown;
+  vao_ = kUnknown;
+  active_unit_ = kTextureUnits;
+  textures_.fill(kUnknown);
+}
+
+const GLStateCache::Counters &GLStateCache::counters() const noexcept {
+  return counters_;
+}
+
+void GLStateCache::resetCounters() noexcept { counters_ = {}; }
+
+bool GLStateCache::changed(GLuint &current, GLuint next) noexcept {
+  if (current == next) {
+    ++counters_.binds_skipped;
+    return false;
+  }
+
+  current = next;
+  ++counters_.binds_issued;
+  return true;
+}
@@ -0,0 +1,76 @@
+#include "heap_counter.h"
+
+#ifdef LIBRETRO_COUNT_ALLOCATIONS
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+/* Per thread, so a frame's count isn't polluted by loader threads */
+thread_local HeapCounters counters;
+
+void *allocate(size_t size, size_t alignment) {
+  ++counters.allocations;
+  counters.bytes += size;
+
+  size = size ? size : 1;
+  void *p = nullptr;
+  if (alignment <= alignof(std::max_align_t)) {
+    p = std::malloc(size);
+  } else {
+#ifdef _WIN32
+    p = _aligned_malloc(size, alignment);
+#else
+    /* aligned_alloc wants a size that is a multiple of the alignment */
+    p = std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#endif
+  }
+  if (!p) {
+    throw std::bad_alloc{};
+  }
+  return p;
+}
+
+void release(void *p, size_t alignment) noexcept {
+  if (!p) {
+    return;
+  }
+  ++counters.deallocations;
+#ifdef _WIN32
+  if (alignment > alignof(std::max_align_t)) {
+    _aligned_free(p);
+    return;
+  }
+#else
+  (void)alignment;
+#endif
+  std::free(p);
+}
+} // namespace
+
+/* The array and nothrow forms forward to these */
+void *operator new(size_t size) {
+  return allocate(size, alignof(std::max_align_t));
+}
+void *operator new(size_t size, std::align_val_t alignment) {
+  return allocate(size, static_cast<size_t>(alignment));
+}
+void operator delete(void *p) noexcept {
+  release(p, alignof(std::max_align_t));
+}
+void operator delete(void *p, size_t) noexcept {
+  release(p, alignof(std::max_align_t));
+}
+void operator delete(void *p, std::align_val_t alignment) noexcept {
+  release(p, static_cast<size_t>(alignment));
+}
+void operator delete(void *p, size_t, std::align_val_t alignment) noexcept {
+  release(p, static_cast<size_t>(alignment));
+}
+
+HeapCounters heapCounters() noexcept { return counters; }
+bool heapCountingEnabled() noexcept { return true; }
+#else
+HeapCounters heapCounters() noexcept { return {}; }
+bool heapCountingEnabled() noexcept { return false; }
+#endif
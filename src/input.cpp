@@ -0,0 +1,142 @@
+#include "input.h"
+// clang-format off
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+// clang-format on
+#include <chrono>
+
+int64_t InputQueue::now() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void InputQueue::push(const InputEvent &event) noexcept {
+  if (!events_.tryPush(event)) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+uint64_t InputQueue::dropped() const noexcept {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+bool InputQueue::pop(InputEvent &event) noexcept {
+  if (!events_.tryPop(event)) {
+    return false;
+  }
+  consumed(event.time);
+  return true;
+}
+
+void InputQueue::consumed(int64_t time) noexcept {
+  /* Only the first event since the last frame counts; later ones are
+   * younger. presented() or takeConsumed() clears it */
+  int64_t expected = 0;
+  pending_.compare_exchange_strong(expected, time, std::memory_order_release,
+                                   std::memory_order_relaxed);
+}
+
+int64_t InputQueue::takeConsumed() noexcept {
+  stamped_.store(true, std::memory_order_relaxed);
+  return pending_.exchange(0, std::memory_order_acquire);
+}
+
+void InputQueue::rendered(int64_t consumed) noexcept {
+  rendered_.store(consumed, std::memory_order_relaxed);
+}
+
+void InputQueue::presented(int64_t time) noexcept {
+  if (stamped_.load(std::memory_order_relaxed)) {
+    /* Snapshots outlive a frame, so a stamp is sampled the first time a
+     * frame showing it is presented */
+    const int64_t stamp = rendered_.exchange(0, std::memory_order_relaxed);
+    if (stamp > last_stamp_ && stamp <= time) {
+      last_stamp_ = stamp;
+      sample(time - stamp);
+    }
+    return;
+  }
+
+  /* An event consumed after `time` was taken waits for the next frame. The
+   * exchange only clears what was read, so nothing that replaced it in
+   * between is lost */
+  int64_t oldest = pending_.load(std::memory_order_acquire);
+  if (!oldest || oldest > time ||
+      !pending_.compare_exchange_strong(oldest, 0,
+                                        std::memory_order_relaxed)) {
+    return;
+  }
+  sample(time - oldest);
+}
+
+void InputQueue::sample(int64_t latency) noexcept {
+  last_ns_.store(latency, std::memory_order_relaxed);
+  total_ns_.fetch_add(latency, std::memory_order_relaxed);
+  if (latency > max_ns_.load(std::memory_order_relaxed)) {
+    max_ns_.store(latency, std::memory_order_relaxed);
+  }
+  samples_.fetch_add(1, std::memory_order_release);
+}
+
+InputLatency InputQueue::latency() const noexcept {
+  constexpr double kMs = 1e-6;
+  const uint64_t samples = samples_.load(std::memory_order_acquire);
+  if (!samples) {
+    return {};
+  }
+  return {.samples = samples,
+          .last_ms = static_cast<double>(last_ns_.load(
+                         std::memory_order_relaxed)) *
+                     kMs,
+          .mean_ms = static_cast<double>(total_ns_.load(
+                         std::memory_order_relaxed)) *
+                     kMs / static_cast<double>(samples),
+          .max_ms = static_cast<double>(max_ns_.load(
+                        std::memory_order_relaxed)) *
+                    kMs};
+}
+
+void InputQueue::resetLatency() noexcept {
+  samples_.store(0, std::memory_order_relaxed);
+  last_ns_.store(0, std::memory_order_relaxed);
+  total_ns_.store(0, std::memory_order_relaxed);
+  max_ns_.store(0, std::memory_order_relaxed);
+}
+
+void InputState::apply(const InputEvent &event) noexcept {
+  switch (event.type) {
+  case InputEvent::Type::Key:
+    if (event.code >= 0 && static_cast<size_t>(event.code) < kKeys) {
+      keys_[static_cast<size_t>(event.code)] = event.action != GLFW_RELEASE;
+    }
+    break;
+  case InputEvent::Type::MouseButton:
+    if (event.code >= 0 && static_cast<size_t>(event.code) < kButtons) {
+      buttons_[static_cast<size_t>(event.code)] =
+          event.action != GLFW_RELEASE;
+    }
+    break;
+  case InputEvent::Type::CursorPos:
+    cursor_x_ = event.x;
+    cursor_y_ = event.y;
+    break;
+  case InputEvent::Type::Char:
+  case InputEvent::Type::Scroll:
+    break;
+  }
+}
+
+bool InputState::keyDown(int key) const noexcept {
+  return key >= 0 && static_cast<size_t>(key) < kKeys &&
+         keys_[static_cast<size_t>(key)];
+}
+
+bool InputState::buttonDown(int button) const noexcept {
+  return button >= 0 && static_cast<size_t>(button) < kButtons &&
+         buttons_[static_cast<size_t>(button)];
+}
+
+double InputState::cursorX() const noexcept { return cursor_x_; }
+
+double InputState::cursorY() const noexcept { return cursor_y_; }
@@ -0,0 +1,256 @@
+#include "low_res_target.h"
+#include "shader_cache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+/* Fullscreen triangle generated from gl_VertexID, no vertex buffer needed */
+const char *kVertexSource =
+    "#version 330 core\n"
+    "out vec2 vUv;\n"
+    "void main()\n"
+    "{\n"
+    "  vec2 p = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));\n"
+    "  vUv = p;\n"
+    "  gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);\n"
+    "}\n";
+
+/* Nearest-neighbour sample + nearest palette color (RGB distance) */
+const char *kFragmentSource =
+    "#version 330 core\n"
+    "in vec2 vUv;\n"
+    "uniform sampler2D uFrame;\n"
+    "uniform sampler2D uPalette;\n"
+    "uniform int uPaletteSize;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "  vec4 c = texture(uFrame, vUv);\n"
+    "  vec4 best = c;\n"
+    "  float bestDist = 4.0;\n"
+    "  for (int i = 0; i < uPaletteSize; ++i) {\n"
+    "    vec4 p = texelFetch(uPalette, ivec2(i, 0), 0);\n"
+    "    vec3 d = p.rgb - c.rgb;\n"
+    "    float dist = dot(d, d);\n"
+    "    if (dist < bestDist) {\n"
+    "      bestDist = dist;\n"
+    "      best = p;\n"
+    "    }\n"
+    "  }\n"
+    "  FragColor = best;\n"
+    "}\n";
+
+/* RAII guard for the capabilities present() has to switch off */
+class CapabilityGuard {
+public:
+  explicit CapabilityGuard(GLenum cap) noexcept
+      : cap_{cap}, enabled_{glIsEnabled(cap) == GL_TRUE} {
+    if (enabled_) {
+      glDisable(cap_);
+    }
+  }
+  ~CapabilityGuard() {
+    if (enabled_) {
+      glEnable(cap_);
+    }
+  }
+  CapabilityGuard(const CapabilityGuard &) = delete;
+  CapabilityGuard &operator=(const CapabilityGuard &) = delete;
+
+private:
+  GLenum cap_;
+  bool enabled_;
+};
+
+/* Same for the clear color and viewport present() overwrites */
+class ClearColorGuard {
+public:
+  ClearColorGuard() noexcept { glGetFloatv(GL_COLOR_CLEAR_VALUE, color_); }
+  ~ClearColorGuard() {
+    glClearColor(color_[0], color_[1], color_[2], color_[3]);
+  }
+  ClearColorGuard(const ClearColorGuard &) = delete;
+  ClearColorGuard &operator=(const ClearColorGuard &) = delete;
+
+private:
+  GLfloat color_[4]{};
+};
+
+class ViewportGuard {
+public:
+  ViewportGuard() noexcept { glGetIntegerv(GL_VIEWPORT, viewport_); }
+  ~ViewportGuard() {
+    glViewport(viewport_[0], viewport_[1], viewport_[2], viewport_[3]);
+  }
+  ViewportGuard(const ViewportGuard &) = delete;
+  ViewportGuard &operator=(const ViewportGuard &) = delete;
+
+private:
+  GLint viewport_[4]{};
+};
+} // namespace
+
+LowResTarget::LowResTarget(size_t width, size_t height)
+    : width_{width}, height_{height} {
+  if (width_ == 0 || height_ == 0) {
+    throw std::invalid_argument("LowResTarget size must be non-zero");
+  }
+
+  const auto w = static_cast<GLsizei>(width_);
+  const auto h = static_cast<GLsizei>(height_);
+
+  glGenTextures(1, &color_);
+  glBindTexture(GL_TEXTURE_2D, color_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+               nullptr);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  glGenTextures(1, &palette_texture_);
+  glBindTexture(GL_TEXTURE_2D, palette_texture_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, kMaxPaletteSize, 1, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glGenRenderbuffers(1, &depth_stencil_);
+  glBindRenderbuffer(GL_RENDERBUFFER, depth_stencil_);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glGenFramebuffers(1, &fbo_);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         color_, 0);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                            GL_RENDERBUFFER, depth_stencil_);
+
+  const bool complete =
+      glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  try {
+    if (!complete) {
+      throw std::runtime_error("Low resolution framebuffer is incomplete");
+    }
+    program_ = buildProgram({{GL_VERTEX_SHADER, kVertexSource},
+                             {GL_FRAGMENT_SHADER, kFragmentSource}});
+  } catch (...) {
+    glDeleteFramebuffers(1, &fbo_);
+    glDeleteRenderbuffers(1, &depth_stencil_);
+    glDeleteTextures(1, &color_);
+    glDeleteTextures(1, &palette_texture_);
+    throw;
+  }
+
+  glUseProgram(program_);
+  glUniform1i(glGetUniformLocation(program_, "uFrame"), 0);
+  glUniform1i(glGetUniformLocation(program_, "uPalette"), 1);
+  palette_size_location_ = glGetUniformLocation(program_, "uPaletteSize");
+  glUseProgram(0);
+
+  /* Core profile needs a VAO bound even for attribute-less draws */
+  glGenVertexArrays(1, &vao_);
+}
+
+LowResTarget::~LowResTarget() {
+  glDeleteVertexArrays(1, &vao_);
+  glDeleteProgram(program_);
+  glDeleteFramebuffers(1, &fbo_);
+  glDeleteRenderbuffers(1, &depth_stencil_);
+  glDeleteTextures(1, &color_);
+  glDeleteTextures(1, &palette_texture_);
+}
+
+void LowResTarget::bind() const noexcept {
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+  glViewport(0, 0, static_cast<GLsizei>(width_), static_cast<GLsizei>(height_));
+}
+
+void LowResTarget::present(GLuint dst_fbo, size_t dst_width,
+                           size_t dst_height) noexcept {
+  const Viewport vp = presentViewport(dst_width, dst_height);
+
+  const CapabilityGuard scissor{GL_SCISSOR_TEST};
+  const CapabilityGuard depth{GL_DEPTH_TEST};
+  const CapabilityGuard blend{GL_BLEND};
+  const ClearColorGuard clear_color;
+  const ViewportGuard viewport;
+
+  /* Letterbox bars */
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dst_fbo);
+  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  if (palette_size_ == 0) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_);
+    glBlitFramebuffer(0, 0, static_cast<GLint>(width_),
+                      static_cast<GLint>(height_), vp.x, vp.y,
+                      vp.x + vp.width, vp.y + vp.height, GL_COLOR_BUFFER_BIT,
+                      GL_NEAREST);
+  } else {
+    glViewport(vp.x, vp.y, vp.width, vp.height);
+    glUseProgram(program_);
+    glUniform1i(palette_size_location_, static_cast<GLint>(palette_size_));
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, palette_texture_);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, color_);
+    glBindVertexArray(vao_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glUseProgram(0);
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, dst_fbo);
+}
+
+void LowResTarget::setPalette(std::span<const uint32_t> colors) {
+  if (colors.size() > kMaxPaletteSize) {
+    throw std::invalid_argument("Palette has too many colors");
+  }
+
+  if (!colors.empty()) {
+    glBindTexture(GL_TEXTURE_2D, palette_texture_);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
+                    static_cast<GLsizei>(colors.size()), 1, GL_RGBA,
+                    GL_UNSIGNED_BYTE, colors.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  palette_size_ = colors.size();
+}
+
+size_t LowResTarget::paletteSize() const noexcept { return palette_size_; }
+
+LowResTarget::Viewport
+LowResTarget::presentViewport(size_t dst_width,
+                              size_t dst_height) const noexcept {
+  size_t w = 0, h = 0;
+
+  if (const size_t scale = std::min(dst_width / width_, dst_height / height_);
+      scale >= 1) {
+    w = width_ * scale;
+    h = height_ * scale;
+  } else if (dst_width * height_ < dst_height * width_) {
+    /* Destination smaller than the logical frame: fit by the limiting axis */
+    w = dst_width;
+    h = height_ * dst_width / width_;
+  } else {
+    w = width_ * dst_height / height_;
+    h = dst_height;
+  }
+
+  return {static_cast<int>((dst_width - w) / 2),
+          static_cast<int>((dst_height - h) / 2), static_cast<int>(w),
+          static_cast<int>(h)};
+}
+
+GLuint LowResTarget::framebuffer() const noexcept { return fbo_; }
+GLuint LowResTarget::texture() const noexcept { return color_; }
+size_t LowResTarget::width() const noexcept { return width_; }
+size_t LowResTarget::height() const noexcept { return height_; }
@@ -1,4 +1,11 @@
+#include "fixed_timestep.h"
+#include "render_thread.h"
+#include "shader_cache.h"
+#include "triple_buffer.h"
 #include "window.h"
+#include <cmath>
+#include <cstdlib>
+#include <memory>
 #include <print>
 
 float vertices[] = {
@@ -37,9 +44,26 @@ const char *fragmentShaderSource2 =
     "  FragColor = vec4(0.5f, 0.5f, 0.9f, 1.0f);\n"
     "}\0";
 
+/* Compiled program binaries persist here between runs */
+const char *shaderCacheDir = "shader_cache";
+
+/* Simulation state handed from the main thread to the render thread */
+struct Scene {
+  double time = 0.0;
+
+  /* Oldest input this snapshot reflects, for input-to-photon latency */
+  int64_t input_time = 0;
+};
+
+/* Simulation rate, independent of the display's refresh rate */
+constexpr double simulationStep = 1.0 / 120.0;
+
 int main(void) {
-  unsigned int VAO, VBO, EBO, vertexShader, fragmentShader1, fragmentShader2,
-      shaderProgram1, shaderProgram2;
+  unsigned int VAO, VBO, EBO, shaderProgram1, shaderProgram2;
+  std::unique_ptr<ShaderCache> shaders;
+  bool initFailed = false;
+  TripleBuffer<Scene> scenes;
+  InputQueue *inputQueue = nullptr;
 
   const auto init_cb = [&]() noexcept {
     glGenVertexArrays(1, &VAO);
@@ -69,39 +93,28 @@ int main(void) {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     glDisableVertexAttribArray(0);
 
-    /* Create vertex shader */
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-
-    /* Create fragment shader */
-    fragmentShader1 = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader1, 1, &fragmentShaderSource1, nullptr);
-    glCompileShader(fragmentShader1);
-
-    fragmentShader2 = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader2, 1, &fragmentShaderSource2, nullptr);
-    glCompileShader(fragmentShader2);
-
-    /* Link shaders into program */
-    shaderProgram1 = glCreateProgram();
-    glAttachShader(shaderProgram1, vertexShader);
-    glAttachShader(shaderProgram1, fragmentShader1);
-    glLinkProgram(shaderProgram1);
-
-    shaderProgram2 = glCreateProgram();
-    glAttachShader(shaderProgram2, vertexShader);
-    glAttachShader(shaderProgram2, fragmentShader2);
-    glLinkProgram(shaderProgram2);
-
-    /* Delete shaders for cleanup */
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader1);
-    glDeleteShader(fragmentShader2);
+    /* Compile and link shaders (or load them from the on-disk cache) */
+    try {
+      shaders = std::make_unique<ShaderCache>(shaderCacheDir);
+      shaderProgram1 =
+          shaders->program(vertexShaderSource, fragmentShaderSource1);
+      shaderProgram2 =
+          shaders->program(vertexShaderSource, fragmentShaderSource2);
+      shaders->releaseShaders();
+    } catch (const std::exception &e) {
+      std::println("Shader failure: {}", e.what());
+      initFailed = true;
+    }
   };
 
   const auto render_cb = [&]() noexcept {
-    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    /* Draw the newest scene the simulation has published */
+    scenes.update();
+    inputQueue->rendered(scenes.front().input_time);
+    const auto pulse =
+        static_cast<float>(0.5 + 0.5 * std::sin(scenes.front().time));
+
+    glClearColor(0.2f, 0.3f * pulse, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     glBindVertexArray(VAO);
@@ -117,19 +130,64 @@ int main(void) {
   const auto cleanup_cb = [&]() noexcept {
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
-    glDeleteProgram(shaderProgram1);
-    glDeleteProgram(shaderProgram2);
+    glDeleteBuffers(1, &EBO);
+
+    /* Programs are owned by the cache */
+    shaders.reset();
   };
 
   try {
-    Window win{640, 480, "Hello World", init_cb, render_cb, cleanup_cb};
+    Window win{640,
+               480,
+               "Hello World",
+               init_cb,
+               render_cb,
+               cleanup_cb,
+               WindowOptions{.input_events = true}};
+    if (initFailed) {
+      return EXIT_FAILURE;
+    }
+    inputQueue = win.input();
+
+    /* Render on a dedicated thread; this thread handles events and runs the
+     * simulation at a fixed rate, so neither waits on vsync or the other */
+    RenderThread renderer{win};
+    FixedTimestep clock{simulationStep};
+    Scene scene;
+    InputState input;
+
+    while (renderer.running() && !win.shouldClose()) {
+      Window::waitEvents(clock.untilNext(glfwGetTime()));
+
+      /* Sample input right before stepping, after the wait, so the step
+       * sees everything that arrived while this thread slept */
+      if (size_t steps = clock.advance(glfwGetTime())) {
+        win.input()->drain(
+            [&input](const InputEvent &e) noexcept { input.apply(e); });
+
+        /* Frames are rendered from an older snapshot than the one being
+         * stepped, so the latency stamp travels with the snapshot */
+        if (const int64_t consumed = win.input()->takeConsumed()) {
+          scene.input_time = consumed;
+        }
+
+        /* Holding space pauses the pulse */
+        if (!input.keyDown(GLFW_KEY_SPACE)) {
+          scene.time += static_cast<double>(steps) * clock.step();
+        }
+        scenes.publish(scene);
+      }
+    }
+
+    renderer.stop();
 
-    while (!win.shouldClose()) {
-      Window::pollEvents();
-      win.render();
+    if (const InputLatency latency = win.input()->latency(); latency.samples) {
+      std::println("Input to photon: {:.2f} ms mean, {:.2f} ms max",
+                   latency.mean_ms, latency.max_ms);
     }
   } catch (const std::exception &e) {
     std::println("Window failure: {}", e.what());
+    return EXIT_FAILURE;
   }
 
   return 0;
@@ -0,0 +1,111 @@
+#include "offscreen_target.h"
+
+#include <cstring>
+#include <stdexcept>
+
+OffscreenTarget::OffscreenTarget(size_t width, size_t height)
+    : width_{width}, height_{height}, pixels_(width * height * 4) {
+  const auto w = static_cast<GLsizei>(width_);
+  const auto h = static_cast<GLsizei>(height_);
+
+  glGenRenderbuffers(1, &color_);
+  glBindRenderbuffer(GL_RENDERBUFFER, color_);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+
+  glGenRenderbuffers(1, &depth_stencil_);
+  glBindRenderbuffer(GL_RENDERBUFFER, depth_stencil_);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glGenFramebuffers(1, &fbo_);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, color_);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                            GL_RENDERBUFFER, depth_stencil_);
+
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo_);
+    glDeleteRenderbuffers(1, &color_);
+    glDeleteRenderbuffers(1, &depth_stencil_);
+    throw std::runtime_error("Offscreen framebuffer is incomplete");
+  }
+
+  glViewport(0, 0, w, h);
+
+  /* GL_STREAM_READ: written by the GPU once, read by the CPU once */
+  glGenBuffers(static_cast<GLsizei>(pbos_.size()), pbos_.data());
+  for (GLuint pbo : pbos_) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(pixels_.size()),
+                 nullptr, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+OffscreenTarget::~OffscreenTarget() {
+  glDeleteBuffers(static_cast<GLsizei>(pbos_.size()), pbos_.data());
+  glDeleteFramebuffers(1, &fbo_);
+  glDeleteRenderbuffers(1, &color_);
+  glDeleteRenderbuffers(1, &depth_stencil_);
+}
+
+void OffscreenTarget::bind() const noexcept {
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+}
+
+void OffscreenTarget::readback() noexcept {
+  /* Start this frame's transfer into the PBO that isn't holding a result */
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos_[write_index_]);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, static_cast<GLsizei>(width_),
+               static_cast<GLsizei>(height_), GL_RGBA, GL_UNSIGNED_BYTE,
+               nullptr);
+
+  /* Then drain last frame's, which has had a full frame to complete */
+  write_index_ ^= 1;
+  if (pending_) {
+    collect(pbos_[write_index_]);
+  }
+  pending_ = true;
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void OffscreenTarget::flush() noexcept {
+  if (!pending_) {
+    return;
+  }
+
+  /* The most recent transfer went into the buffer before write_index_ */
+  collect(pbos_[write_index_ ^ 1]);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  pending_ = false;
+}
+
+GLuint OffscreenTarget::framebuffer() const noexcept { return fbo_; }
+size_t OffscreenTarget::width() const noexcept { return width_; }
+size_t OffscreenTarget::height() const noexcept { return height_; }
+
+std::span<const std::uint8_t> OffscreenTarget::pixels() const noexcept {
+  if (frames_read_ == 0) {
+    return {};
+  }
+  return pixels_;
+}
+
+uint64_t OffscreenTarget::framesRead() const noexcept { return frames_read_; }
+
+void OffscreenTarget::collect(GLuint pbo) noexcept {
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+  const void *data =
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                       static_cast<GLsizeiptr>(pixels_.size()), GL_MAP_READ_BIT);
+  if (data) {
+    std::memcpy(pixels_.data(), data, pixels_.size());
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    ++frames_read_;
+  }
+}
@@ -0,0 +1,390 @@
+#include "particles.h"
+#include "shader_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIBRETRO_PARTICLES_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+// ---------------------------------------------------------------------------
+// Integration kernels. All three evaluate the same expression in the same
+// order without fused multiply-adds, so they agree bit for bit
+// ---------------------------------------------------------------------------
+void integrateScalar(float *x, float *y, float *vx, float *vy, float *life,
+                     size_t count, float dt, float gx, float gy,
+                     float damp) noexcept {
+  for (size_t i = 0; i < count; ++i) {
+    vx[i] = (vx[i] + gx * dt) * damp;
+    vy[i] = (vy[i] + gy * dt) * damp;
+    x[i] += vx[i] * dt;
+    y[i] += vy[i] * dt;
+    life[i] -= dt;
+  }
+}
+
+#ifdef LIBRETRO_PARTICLES_X86
+void integrateSse2(float *x, float *y, float *vx, float *vy, float *life,
+                   size_t count, float dt, float gx, float gy,
+                   float damp) noexcept {
+  const __m128 t = _mm_set1_ps(dt);
+  const __m128 ax = _mm_set1_ps(gx * dt);
+  const __m128 ay = _mm_set1_ps(gy * dt);
+  const __m128 d = _mm_set1_ps(damp);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 nvx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vx + i), ax), d);
+    const __m128 nvy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vy + i), ay), d);
+    _mm_storeu_ps(vx + i, nvx);
+    _mm_storeu_ps(vy + i, nvy);
+    _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(nvx, t)));
+    _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(nvy, t)));
+    _mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), t));
+  }
+  integrateScalar(x + i, y + i, vx + i, vy + i, life + i, count - i, dt, gx,
+                  gy, damp);
+}
+
+__attribute__((target("avx2"))) void
+integrateAvx2(float *x, float *y, float *vx, float *vy, float *life,
+              size_t count, float dt, float gx, float gy,
+              float damp) noexcept {
+  const __m256 t = _mm256_set1_ps(dt);
+  const __m256 ax = _mm256_set1_ps(gx * dt);
+  const __m256 ay = _mm256_set1_ps(gy * dt);
+  const __m256 d = _mm256_set1_ps(damp);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 nvx =
+        _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(vx + i), ax), d);
+    const __m256 nvy =
+        _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(vy + i), ay), d);
+    _mm256_storeu_ps(vx + i, nvx);
+    _mm256_storeu_ps(vy + i, nvy);
+    _mm256_storeu_ps(
+        x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(nvx, t)));
+    _mm256_storeu_ps(
+        y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(nvy, t)));
+    _mm256_storeu_ps(life + i, _mm256_sub_ps(_mm256_loadu_ps(life + i), t));
+  }
+  integrateScalar(x + i, y + i, vx + i, vy + i, life + i, count - i, dt, gx,
+                  gy, damp);
+}
+#endif
+
+float damping(float drag, float dt) noexcept {
+  return std::max(1.0f - drag * dt, 0.0f);
+}
+
+// ---------------------------------------------------------------------------
+// GPU programs
+// ---------------------------------------------------------------------------
+const char *kUpdateSource = "#version 330 core\n"
+                            "layout (location = 0) in vec2 aPos;\n"
+                            "layout (location = 1) in vec2 aVel;\n"
+                            "layout (location = 2) in float aLife;\n"
+                            "uniform float uDt;\n"
+                            "uniform vec2 uGravity;\n"
+                            "uniform float uDamp;\n"
+                            "out vec2 outPos;\n"
+                            "out vec2 outVel;\n"
+                            "out float outLife;\n"
+                            "void main()\n"
+                            "{\n"
+                            "  outVel = (aVel + uGravity * uDt) * uDamp;\n"
+                            "  outPos = aPos + outVel * uDt;\n"
+                            "  outLife = aLife - uDt;\n"
+                            "}\n";
+
+const char *kVaryings[] = {"outPos", "outVel", "outLife"};
+
+/* One instance per slot; dead ones collapse to a point off screen */
+const char *kDrawVertexSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec2 aPos;\n"
+    "layout (location = 1) in float aLife;\n"
+    "layout (location = 2) in float aSize;\n"
+    "layout (location = 3) in vec4 aColor;\n"
+    "uniform vec2 uViewport;\n"
+    "out vec4 vColor;\n"
+    "void main()\n"
+    "{\n"
+    "  vColor = aColor;\n"
+    "  if (aLife <= 0.0) {\n"
+    "    gl_Position = vec4(-2.0, -2.0, 0.0, 1.0);\n"
+    "    return;\n"
+    "  }\n"
+    "  vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) - 0.5;\n"
+    "  vec2 pos = aPos + corner * aSize;\n"
+    "  vec2 ndc = pos / uViewport * 2.0 - 1.0;\n"
+    "  gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);\n"
+    "}\n";
+
+const char *kDrawFragmentSource = "#version 330 core\n"
+                                  "in vec4 vColor;\n"
+                                  "out vec4 FragColor;\n"
+                                  "void main()\n"
+                                  "{\n"
+                                  "  FragColor = vColor;\n"
+                                  "}\n";
+} // namespace
+
+// ---------------------------------------------------------------------------
+// CpuParticles
+// ---------------------------------------------------------------------------
+CpuParticles::CpuParticles(size_t capacity)
+    : capacity_{capacity}, x_(capacity), y_(capacity), vx_(capacity),
+      vy_(capacity), life_(capacity), size_(capacity), color_(capacity) {
+  if (capacity_ == 0) {
+    throw std::invalid_argument("CpuParticles capacity must be non-zero");
+  }
+  setIsa(SpanIsa::Avx2);
+}
+
+void CpuParticles::emit(std::span<const ParticleSpawn> particles) noexcept {
+  for (const ParticleSpawn &p : particles) {
+    x_[next_] = p.x;
+    y_[next_] = p.y;
+    vx_[next_] = p.vx;
+    vy_[next_] = p.vy;
+    life_[next_] = p.life;
+    size_[next_] = p.size;
+    color_[next_] = p.color;
+    next_ = next_ + 1 == capacity_ ? 0 : next_ + 1;
+  }
+}
+
+void CpuParticles::update(float dt, const ParticleForces &forces) noexcept {
+  integrate_(x_.data(), y_.data(), vx_.data(), vy_.data(), life_.data(),
+             capacity_, dt, forces.gravity_x, forces.gravity_y,
+             damping(forces.drag, dt));
+}
+
+void CpuParticles::draw(SoftwareRasterizer &rasterizer) const {
+  for (size_t i = 0; i < capacity_; ++i) {
+    if (life_[i] > 0.0f) {
+      rasterizer.draw(sprite(i));
+    }
+  }
+}
+
+void CpuParticles::draw(SpriteBatch &batch) const {
+  for (size_t i = 0; i < capacity_; ++i) {
+    if (life_[i] > 0.0f) {
+      batch.draw(sprite(i));
+    }
+  }
+}
+
+size_t CpuParticles::alive() const noexcept {
+  return static_cast<size_t>(
+      std::count_if(life_.begin(), life_.end(), [](float l) { return l > 0.0f; }));
+}
+
+size_t CpuParticles::capacity() const noexcept { return capacity_; }
+std::span<const float> CpuParticles::x() const noexcept { return x_; }
+std::span<const float> CpuParticles::y() const noexcept { return y_; }
+std::span<const float> CpuParticles::vx() const noexcept { return vx_; }
+std::span<const float> CpuParticles::vy() const noexcept { return vy_; }
+std::span<const float> CpuParticles::life() const noexcept { return life_; }
+SpanIsa CpuParticles::isa() const noexcept { return isa_; }
+
+SpanIsa CpuParticles::setIsa(SpanIsa isa) noexcept {
+  isa_ = SpanIsa::Scalar;
+  integrate_ = integrateScalar;
+#ifdef LIBRETRO_PARTICLES_X86
+  __builtin_cpu_init();
+  if (isa == SpanIsa::Avx2 && __builtin_cpu_supports("avx2")) {
+    isa_ = SpanIsa::Avx2;
+    integrate_ = integrateAvx2;
+  } else if (isa != SpanIsa::Scalar && __builtin_cpu_supports("sse2")) {
+    isa_ = SpanIsa::Sse2;
+    integrate_ = integrateSse2;
+  }
+#else
+  (void)isa;
+#endif
+  return isa_;
+}
+
+Sprite CpuParticles::sprite(size_t i) const noexcept {
+  const float half = size_[i] * 0.5f;
+  return {.x = x_[i] - half,
+          .y = y_[i] - half,
+          .width = size_[i],
+          .height = size_[i],
+          .color = color_[i]};
+}
+
+// ---------------------------------------------------------------------------
+// GpuParticles
+// ---------------------------------------------------------------------------
+GpuParticles::GpuParticles(size_t capacity) : capacity_{capacity} {
+  if (capacity_ == 0 || capacity_ > INT32_MAX) {
+    throw std::invalid_argument("GpuParticles capacity out of range");
+  }
+
+  update_program_ =
+      buildProgram({{GL_VERTEX_SHADER, kUpdateSource}}, kVaryings);
+  try {
+    draw_program_ = buildProgram({{GL_VERTEX_SHADER, kDrawVertexSource},
+                                  {GL_FRAGMENT_SHADER, kDrawFragmentSource}});
+  } catch (...) {
+    glDeleteProgram(update_program_);
+    throw;
+  }
+
+  dt_location_ = glGetUniformLocation(update_program_, "uDt");
+  gravity_location_ = glGetUniformLocation(update_program_, "uGravity");
+  damp_location_ = glGetUniformLocation(update_program_, "uDamp");
+  viewport_location_ = glGetUniformLocation(draw_program_, "uViewport");
+
+  /* Everything starts dead: zero life */
+  glGenBuffers(2, state_);
+  glGenBuffers(1, &static_);
+  const std::vector<float> zeros(capacity_ * kStateFloats);
+  for (GLuint buffer : state_) {
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(zeros.size() * sizeof(float)),
+                 zeros.data(), GL_DYNAMIC_COPY);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, static_);
+  glBufferData(GL_ARRAY_BUFFER,
+               static_cast<GLsizeiptr>(capacity_ * sizeof(Static)), nullptr,
+               GL_DYNAMIC_DRAW);
+
+  /* One update and one draw VAO per state buffer, so neither pass
+   * re-specifies attributes when the buffers swap */
+  constexpr GLsizei kStride = kStateFloats * sizeof(float);
+  const auto offset = [](size_t floats) {
+    return reinterpret_cast<void *>(floats * sizeof(float));
+  };
+  glGenVertexArrays(2, update_vao_);
+  glGenVertexArrays(2, draw_vao_);
+  for (size_t i = 0; i < 2; ++i) {
+    glBindVertexArray(update_vao_[i]);
+    glBindBuffer(GL_ARRAY_BUFFER, state_[i]);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, kStride, offset(0));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, kStride, offset(2));
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, kStride, offset(4));
+    for (GLuint a = 0; a < 3; ++a) {
+      glEnableVertexAttribArray(a);
+    }
+
+    glBindVertexArray(draw_vao_[i]);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, kStride, offset(0));
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, kStride, offset(4));
+    glBindBuffer(GL_ARRAY_BUFFER, static_);
+    glVertexAttribPointer(
+        2, 1, GL_FLOAT, GL_FALSE, sizeof(Static),
+        reinterpret_cast<void *>(offsetof(Static, size)));
+    glVertexAttribPointer(
+        3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Static),
+        reinterpret_cast<void *>(offsetof(Static, color)));
+    for (GLuint a = 0; a < 4; ++a) {
+      glEnableVertexAttribArray(a);
+      glVertexAttribDivisor(a, 1);
+    }
+  }
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  staging_.resize(kStagingParticles * kStateFloats);
+  staging_static_.resize(kStagingParticles);
+}
+
+GpuParticles::~GpuParticles() {
+  glDeleteVertexArrays(2, update_vao_);
+  glDeleteVertexArrays(2, draw_vao_);
+  glDeleteBuffers(2, state_);
+  glDeleteBuffers(1, &static_);
+  glDeleteProgram(update_program_);
+  glDeleteProgram(draw_program_);
+}
+
+void GpuParticles::emit(std::span<const ParticleSpawn> particles) noexcept {
+  /* Only the newest capacity_ particles would survive anyway */
+  if (particles.size() > capacity_) {
+    next_ = (next_ + particles.size() - capacity_) % capacity_;
+    particles = particles.last(capacity_);
+  }
+
+  while (!particles.empty()) {
+    const size_t count = std::min(
+        {particles.size(), capacity_ - next_, kStagingParticles});
+    upload(next_, particles.first(count));
+    particles = particles.subspan(count);
+    next_ = (next_ + count) % capacity_;
+  }
+}
+
+void GpuParticles::update(float dt, const ParticleForces &forces) noexcept {
+  const size_t next = current_ ^ 1;
+
+  glUseProgram(update_program_);
+  glUniform1f(dt_location_, dt);
+  glUniform2f(gravity_location_, forces.gravity_x, forces.gravity_y);
+  glUniform1f(damp_location_, damping(forces.drag, dt));
+
+  glEnable(GL_RASTERIZER_DISCARD);
+  glBindVertexArray(update_vao_[current_]);
+  glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, state_[next]);
+  glBeginTransformFeedback(GL_POINTS);
+  glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(capacity_));
+  glEndTransformFeedback();
+  glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+  glBindVertexArray(0);
+  glDisable(GL_RASTERIZER_DISCARD);
+
+  current_ = next;
+}
+
+void GpuParticles::draw(float viewport_width, float viewport_height) noexcept {
+  glUseProgram(draw_program_);
+  glUniform2f(viewport_location_, viewport_width, viewport_height);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glBindVertexArray(draw_vao_[current_]);
+  glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4,
+                        static_cast<GLsizei>(capacity_));
+  glBindVertexArray(0);
+  glDisable(GL_BLEND);
+}
+
+size_t GpuParticles::capacity() const noexcept { return capacity_; }
+GLuint GpuParticles::stateBuffer() const noexcept { return state_[current_]; }
+
+void GpuParticles::upload(size_t first,
+                          std::span<const ParticleSpawn> particles) noexcept {
+  for (size_t i = 0; i < particles.size(); ++i) {
+    const ParticleSpawn &p = particles[i];
+    float *state = staging_.data() + i * kStateFloats;
+    state[0] = p.x;
+    state[1] = p.y;
+    state[2] = p.vx;
+    state[3] = p.vy;
+    state[4] = p.life;
+    staging_static_[i] = {p.size, p.color};
+  }
+
+  /* New particles go into the buffer the next update reads */
+  glBindBuffer(GL_ARRAY_BUFFER, state_[current_]);
+  glBufferSubData(
+      GL_ARRAY_BUFFER,
+      static_cast<GLintptr>(first * kStateFloats * sizeof(float)),
+      static_cast<GLsizeiptr>(particles.size() * kStateFloats * sizeof(float)),
+      staging_.data());
+  glBindBuffer(GL_ARRAY_BUFFER, static_);
+  glBufferSubData(GL_ARRAY_BUFFER,
+                  static_cast<GLintptr>(first * sizeof(Static)),
+                  static_cast<GLsizeiptr>(particles.size() * sizeof(Static)),
+                  staging_static_.data());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
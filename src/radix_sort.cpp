@@ -0,0 +1,50 @@
+#include "radix_sort.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+void radixSort(std::span<SortEntry> entries,
+               std::span<SortEntry> scratch) noexcept {
+  const size_t n = entries.size();
+  if (n < 2 || scratch.size() < n) {
+    return;
+  }
+
+  /* One read of the keys builds the histograms for all eight passes */
+  std::array<std::array<uint32_t, 256>, 8> counts{};
+  for (const auto &entry : entries) {
+    for (size_t pass = 0; pass < 8; ++pass) {
+      ++counts[pass][(entry.first >> (pass * 8)) & 0xFF];
+    }
+  }
+
+  SortEntry *src = entries.data();
+  SortEntry *dst = scratch.data();
+
+  for (size_t pass = 0; pass < 8; ++pass) {
+    auto &count = counts[pass];
+
+    /* Every key has the same byte here: this pass wouldn't move anything */
+    const uint32_t first_byte = (src[0].first >> (pass * 8)) & 0xFF;
+    if (count[first_byte] == n) {
+      continue;
+    }
+
+    uint32_t offset = 0;
+    for (auto &c : count) {
+      const uint32_t bucket = c;
+      c = offset;
+      offset += bucket;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      dst[count[(src[i].first >> (pass * 8)) & 0xFF]++] = src[i];
+    }
+    std::swap(src, dst);
+  }
+
+  if (src != entries.data()) {
+    std::copy(src, src + n, entries.data());
+  }
+}
@@ -0,0 +1,60 @@
+#include "render_queue.h"
+
+#include <algorithm>
+
+void RenderQueue::reserve(size_t commands) {
+  commands_.reserve(commands);
+  order_.reserve(commands);
+  scratch_.reserve(commands);
+}
+
+void RenderQueue::push(const DrawCommand &command) {
+  order_.emplace_back(sortKey(command),
+                      static_cast<uint32_t>(commands_.size()));
+  commands_.push_back(command);
+
+  /* Grow the sort scratch here so submit() never allocates */
+  if (scratch_.size() < order_.size()) {
+    scratch_.resize(order_.capacity());
+  }
+}
+
+void RenderQueue::submit(GLStateCache &state) noexcept {
+  radixSort(order_, scratch_);
+
+  state.invalidate();
+  for (const auto &[key, index] : order_) {
+    const DrawCommand &cmd = commands_[index];
+
+    state.useProgram(cmd.program);
+    state.bindVertexArray(cmd.vao);
+    /* Texture 0 unbinds, so an untextured draw never samples the texture
+     * of the draw before it */
+    state.bindTexture2D(0, cmd.texture);
+
+    if (cmd.index_type) {
+      glDrawElements(cmd.mode, cmd.count, cmd.index_type,
+                     reinterpret_cast<const void *>(cmd.offset));
+    } else {
+      glDrawArrays(cmd.mode, cmd.first, cmd.count);
+    }
+  }
+
+  clear();
+}
+
+void RenderQueue::clear() noexcept {
+  commands_.clear();
+  order_.clear();
+}
+
+size_t RenderQueue::size() const noexcept { return commands_.size(); }
+
+uint64_t RenderQueue::sortKey(const DrawCommand &command) noexcept {
+  const float depth = std::clamp(command.depth, 0.0f, 1.0f);
+  const auto quantized = static_cast<uint64_t>(depth * 65535.0f + 0.5f);
+
+  return (uint64_t{command.program} & 0xFFFF) << 48 |
+         (uint64_t{command.vao} & 0xFFFF) << 32 |
+         (uint64_t{command.texture} & 0xFFFF) << 16 | quantized;
+}
@@ -0,0 +1,56 @@
+#include "render_thread.h"
+#include "gl_capture.h"
+
+RenderThread::RenderThread(Window &window) : window_{window} {
+  /* A context can only be current on one thread at a time */
+  Window::releaseContext();
+  thread_ = std::thread{&RenderThread::run, this};
+}
+
+RenderThread::~RenderThread() {
+  stop_.store(true, std::memory_order_relaxed);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void RenderThread::stop() {
+  stop_.store(true, std::memory_order_relaxed);
+  if (!thread_.joinable()) {
+    return;
+  }
+  thread_.join();
+
+  /* A capture follows the context back */
+  window_.makeCurrent();
+  GLCapture::attach();
+  if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+}
+
+bool RenderThread::running() const noexcept {
+  return running_.load(std::memory_order_acquire);
+}
+
+uint64_t RenderThread::frames() const noexcept {
+  return frames_.load(std::memory_order_relaxed);
+}
+
+void RenderThread::run() noexcept {
+  /* Record this thread's frames if a capture is running */
+  GLCapture::attach();
+  try {
+    while (!stop_.load(std::memory_order_relaxed)) {
+      window_.render();
+      frames_.fetch_add(1, std::memory_order_relaxed);
+    }
+  } catch (...) {
+    error_ = std::current_exception();
+  }
+
+  /* Hand the context back so stop() or the window can reclaim it */
+  GLCapture::detach();
+  Window::releaseContext();
+  running_.store(false, std::memory_order_release);
+}
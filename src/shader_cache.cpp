@@ -0,0 +1,297 @@
+#include "shader_cache.h"
+#include "gl_extensions.h"
+#include "hash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+constexpr char kMagic[4] = {'L', 'R', 'P', 'B'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kMaxBinaryLength = 64u << 20;
+
+struct BinaryHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t key;
+  uint32_t format;
+  uint32_t length;
+};
+
+std::string glString(GLenum name) {
+  const auto *s = reinterpret_cast<const char *>(glGetString(name));
+  return s ? s : "";
+}
+
+std::string stageName(GLenum type) {
+  return type == GL_VERTEX_SHADER ? "vertex" : "fragment";
+}
+
+GLuint compileShader(GLenum type, std::string_view source) {
+  const GLuint shader = glCreateShader(type);
+  const char *data = source.data();
+  const auto length = static_cast<GLint>(source.size());
+  glShaderSource(shader, 1, &data, &length);
+  glCompileShader(shader);
+
+  GLint ok = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+  if (!ok) {
+    GLint log_length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
+    std::string log(static_cast<size_t>(log_length), '\0');
+    glGetShaderInfoLog(shader, log_length, nullptr, log.data());
+    glDeleteShader(shader);
+    throw ShaderError{stageName(type) + " shader compile failed: " +
+                      log.c_str()};
+  }
+  return shader;
+}
+
+/* Deletes the program and throws if it didn't link */
+void checkLink(GLuint program) {
+  GLint ok = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &ok);
+  if (!ok) {
+    GLint log_length = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_length);
+    std::string log(static_cast<size_t>(log_length), '\0');
+    glGetProgramInfoLog(program, log_length, nullptr, log.data());
+    glDeleteProgram(program);
+    throw ShaderError{std::string{"program link failed: "} + log.c_str()};
+  }
+}
+} // namespace
+
+GLuint buildProgram(
+    std::initializer_list<std::pair<GLenum, const char *>> stages,
+    std::span<const char *const> varyings) {
+  std::vector<GLuint> shaders;
+  shaders.reserve(stages.size());
+  try {
+    for (const auto &[type, source] : stages) {
+      shaders.push_back(compileShader(type, source));
+    }
+  } catch (...) {
+    for (GLuint shader : shaders) {
+      glDeleteShader(shader);
+    }
+    throw;
+  }
+
+  const GLuint program = glCreateProgram();
+  for (GLuint shader : shaders) {
+    glAttachShader(program, shader);
+  }
+  if (!varyings.empty()) {
+    glTransformFeedbackVaryings(program,
+                                static_cast<GLsizei>(varyings.size()),
+                                varyings.data(), GL_INTERLEAVED_ATTRIBS);
+  }
+  glLinkProgram(program);
+  for (GLuint shader : shaders) {
+    glDeleteShader(shader);
+  }
+  checkLink(program);
+  return program;
+}
+
+ShaderCache::ShaderCache(std::filesystem::path cache_dir)
+    : cache_dir_{std::move(cache_dir)} {
+  /* Binaries are only valid for the exact driver that produced them */
+  driver_ = glString(GL_VENDOR) + '\n' + glString(GL_RENDERER) + '\n' +
+            glString(GL_VERSION);
+
+  GLint formats = 0;
+  if (gl_extensions.program_binary) {
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  }
+  binary_supported_ = formats > 0;
+
+  if (!cache_dir_.empty()) {
+    std::error_code ec;
+    std::filesystem::create_directories(cache_dir_, ec);
+  }
+}
+
+ShaderCache::~ShaderCache() {
+  releaseShaders();
+  for (const auto &[key, program] : programs_) {
+    glDeleteProgram(program);
+  }
+}
+
+GLuint ShaderCache::program(std::string_view vertex_source,
+                            std::string_view fragment_source) {
+  std::string key;
+  key.reserve(vertex_source.size() + fragment_source.size() + 1);
+  key.append(vertex_source).append(1, '\0').append(fragment_source);
+
+  if (const auto it = programs_.find(key); it != programs_.end()) {
+    ++stats_.dedup_hits;
+    return it->second;
+  }
+
+  const bool on_disk = binary_supported_ && !cache_dir_.empty();
+  const uint64_t hash = programKey(vertex_source, fragment_source);
+  std::filesystem::path path;
+  if (on_disk) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin",
+                  static_cast<unsigned long long>(hash));
+    path = cache_dir_ / name;
+
+    if (const GLuint program = loadBinary(path, hash)) {
+      ++stats_.binary_loads;
+      programs_.emplace(std::move(key), program);
+      return program;
+    }
+  }
+
+  const GLuint program = link(vertex_source, fragment_source);
+  if (on_disk) {
+    storeBinary(path, hash, program);
+  }
+
+  programs_.emplace(std::move(key), program);
+  return program;
+}
+
+void ShaderCache::releaseShaders() noexcept {
+  for (const auto &[source, shader] : shaders_) {
+    glDeleteShader(shader);
+  }
+  shaders_.clear();
+}
+
+bool ShaderCache::binarySupported() const noexcept { return binary_supported_; }
+
+const ShaderCache::Stats &ShaderCache::stats() const noexcept {
+  return stats_;
+}
+
+GLuint ShaderCache::shader(GLenum type, std::string_view source) {
+  /* The stage is part of the key so one source can serve as both */
+  std::string key;
+  key.reserve(source.size() + 1);
+  key.append(1, static_cast<char>(type == GL_VERTEX_SHADER)).append(source);
+
+  if (const auto it = shaders_.find(key); it != shaders_.end()) {
+    return it->second;
+  }
+
+  const GLuint shader = compileShader(type, source);
+  ++stats_.shaders_compiled;
+  shaders_.emplace(std::move(key), shader);
+  return shader;
+}
+
+GLuint ShaderCache::link(std::string_view vertex_source,
+                         std::string_view fragment_source) {
+  const GLuint vertex = shader(GL_VERTEX_SHADER, vertex_source);
+  const GLuint fragment = shader(GL_FRAGMENT_SHADER, fragment_source);
+
+  const GLuint program = glCreateProgram();
+  if (binary_supported_) {
+    gl_extensions.ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                                    GL_TRUE);
+  }
+  glAttachShader(program, vertex);
+  glAttachShader(program, fragment);
+  glLinkProgram(program);
+  glDetachShader(program, vertex);
+  glDetachShader(program, fragment);
+
+  checkLink(program);
+  ++stats_.programs_linked;
+  return program;
+}
+
+GLuint ShaderCache::loadBinary(const std::filesystem::path &path,
+                               uint64_t key) noexcept {
+  std::ifstream in{path, std::ios::binary};
+  if (!in) {
+    return 0;
+  }
+
+  BinaryHeader header{};
+  if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.key != key ||
+      header.length > kMaxBinaryLength) {
+    return 0;
+  }
+
+  std::vector<char> binary(header.length);
+  if (!in.read(binary.data(), static_cast<std::streamsize>(binary.size()))) {
+    return 0;
+  }
+
+  const GLuint program = glCreateProgram();
+  gl_extensions.ProgramBinary(program, header.format, binary.data(),
+                              static_cast<GLsizei>(binary.size()));
+
+  /* Drivers reject binaries from other versions by failing the link */
+  GLint ok = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &ok);
+  if (!ok) {
+    glDeleteProgram(program);
+    return 0;
+  }
+
+  return program;
+}
+
+void ShaderCache::storeBinary(const std::filesystem::path &path, uint64_t key,
+                              GLuint program) noexcept {
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) {
+    return;
+  }
+
+  std::vector<char> binary(static_cast<size_t>(length));
+  GLenum format = 0;
+  gl_extensions.GetProgramBinary(program, length, nullptr, &format,
+                                 binary.data());
+
+  BinaryHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.key = key;
+  header.format = format;
+  header.length = static_cast<uint32_t>(binary.size());
+
+  /* Write then rename so a crash never leaves a truncated binary behind */
+  auto tmp = path;
+  tmp += ".tmp";
+  bool written = false;
+  {
+    std::ofstream out{tmp, std::ios::binary | std::ios::trunc};
+    written =
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header)) &&
+        out.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+  }
+
+  std::error_code ec;
+  if (!written) {
+    std::filesystem::remove(tmp, ec);
+    return;
+  }
+  std::filesystem::rename(tmp, path, ec);
+  if (!ec) {
+    ++stats_.binary_stores;
+  }
+}
+
+uint64_t ShaderCache::programKey(std::string_view vertex_source,
+                                 std::string_view fragment_source) const
+    noexcept {
+  uint64_t hash = fnv1a(driver_);
+  hash = fnv1a(std::string_view{"\0", 1}, hash);
+  hash = fnv1a(vertex_source, hash);
+  hash = fnv1a(std::string_view{"\0", 1}, hash);
+  return fnv1a(fragment_source, hash);
+}
@@ -0,0 +1,417 @@
+#include "software_rasterizer.h"
+#include "span_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <latch>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+constexpr uint32_t kWhite = 0xFFFFFFFF;
+
+/* First pixel whose centre is at or past `edge`, clamped to [0, limit] */
+int firstPixel(float edge, size_t limit) noexcept {
+  const float first = std::ceil(edge - 0.5f);
+  return static_cast<int>(
+      std::clamp(first, 0.0f, static_cast<float>(limit)));
+}
+
+/* Texel index along one axis with GL_REPEAT wrapping */
+size_t wrapTexel(float coord, size_t size) noexcept {
+  const float fraction = coord - std::floor(coord);
+  const auto texel = static_cast<size_t>(fraction * static_cast<float>(size));
+  return std::min(texel, size - 1);
+}
+
+bool opaque(uint32_t color) noexcept { return (color >> 24) == 0xFF; }
+
+/* Edge from a to b of a triangle with positive area: inside is >= 0.
+ * Pixel centres exactly on an edge belong to it only if it is a top or
+ * left edge, so triangles sharing an edge never both cover a pixel */
+struct Edge {
+  float ax, ay, dx, dy;
+  bool top_left;
+
+  Edge(SoftwareRasterizer::Point a, SoftwareRasterizer::Point b) noexcept
+      : ax{a.x}, ay{a.y}, dx{b.x - a.x}, dy{b.y - a.y},
+        top_left{dy < 0.0f || (dy == 0.0f && dx > 0.0f)} {}
+
+  bool inside(float x, float y) const noexcept {
+    const float e = dx * (y - ay) - dy * (x - ax);
+    return e > 0.0f || (e == 0.0f && top_left);
+  }
+};
+} // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(size_t width, size_t height,
+                                       size_t threads)
+    : width_{width}, height_{height},
+      tiles_x_{(width + kTileSize - 1) / kTileSize},
+      tiles_y_{(height + kTileSize - 1) / kTileSize} {
+  if (width_ == 0 || height_ == 0 || width_ > (1u << 15) ||
+      height_ > (1u << 15)) {
+    throw std::invalid_argument("SoftwareRasterizer size out of range");
+  }
+
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  /* The thread calling finish() works too */
+  if (threads > 1) {
+    pool_ = std::make_unique<ThreadPool>(threads - 1);
+  }
+
+  pixels_.resize(width_ * height_);
+  bins_.resize(tiles_x_ * tiles_y_);
+  busy_tiles_.reserve(bins_.size());
+}
+
+SoftwareRasterizer::~SoftwareRasterizer() {
+  if (texture_) {
+    glDeleteFramebuffers(1, &fbo_);
+    glDeleteTextures(1, &texture_);
+  }
+}
+
+uint32_t SoftwareRasterizer::createTexture(size_t width, size_t height,
+                                           std::span<const uint32_t> pixels) {
+  if (width == 0 || height == 0 || pixels.size() != width * height) {
+    throw std::invalid_argument("Texture size does not match its pixels");
+  }
+
+  Texture texture{width, height, true, {pixels.begin(), pixels.end()}};
+  texture.opaque = std::all_of(pixels.begin(), pixels.end(), opaque);
+  textures_.push_back(std::move(texture));
+  return static_cast<uint32_t>(textures_.size());
+}
+
+void SoftwareRasterizer::clear(uint32_t color) {
+  /* Nothing recorded so far can show through a full clear */
+  for (const uint32_t tile : busy_tiles_) {
+    bins_[tile].clear();
+  }
+  busy_tiles_.clear();
+  commands_.clear();
+
+  bin({.kind = Kind::Clear,
+       .color = color,
+       .x1 = static_cast<int>(width_),
+       .y1 = static_cast<int>(height_)});
+}
+
+void SoftwareRasterizer::draw(const Sprite &sprite) {
+  if (sprite.texture > textures_.size()) {
+    throw std::invalid_argument("Unknown software texture");
+  }
+
+  Command command{.kind = Kind::Sprite,
+                  .color = sprite.color,
+                  .texture = sprite.texture,
+                  .p = {{sprite.x, sprite.y},
+                        {sprite.x + sprite.width, sprite.y + sprite.height}},
+                  .uv = {{sprite.u0, sprite.v0}, {sprite.u1, sprite.v1}}};
+
+  /* Mirrored quads cover the same pixels with flipped texture coordinates */
+  if (command.p[1].x < command.p[0].x) {
+    std::swap(command.p[0].x, command.p[1].x);
+    std::swap(command.uv[0].x, command.uv[1].x);
+  }
+  if (command.p[1].y < command.p[0].y) {
+    std::swap(command.p[0].y, command.p[1].y);
+    std::swap(command.uv[0].y, command.uv[1].y);
+  }
+
+  command.x0 = firstPixel(command.p[0].x, width_);
+  command.y0 = firstPixel(command.p[0].y, height_);
+  command.x1 = firstPixel(command.p[1].x, width_);
+  command.y1 = firstPixel(command.p[1].y, height_);
+  if (command.x0 < command.x1 && command.y0 < command.y1) {
+    bin(command);
+  }
+}
+
+void SoftwareRasterizer::drawTriangle(Point a, Point b, Point c,
+                                      uint32_t color) {
+  const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+  if (!(area != 0.0f) || !std::isfinite(area)) {
+    return;
+  }
+  if (area < 0.0f) {
+    std::swap(b, c);
+  }
+
+  Command command{.kind = Kind::Triangle, .color = color, .p = {a, b, c}};
+  command.x0 = firstPixel(std::min({a.x, b.x, c.x}), width_);
+  command.y0 = firstPixel(std::min({a.y, b.y, c.y}), height_);
+  /* One past the last pixel whose centre is not beyond the maximum */
+  command.x1 = firstPixel(std::max({a.x, b.x, c.x}) + 0.5f, width_);
+  command.y1 = firstPixel(std::max({a.y, b.y, c.y}) + 0.5f, height_);
+  if (command.x0 < command.x1 && command.y0 < command.y1) {
+    bin(command);
+  }
+}
+
+void SoftwareRasterizer::finish() {
+  stats_.commands = commands_.size();
+  stats_.tiles = busy_tiles_.size();
+
+  std::atomic<size_t> next{0};
+  const auto work = [this, &next]() noexcept {
+    for (size_t i = next.fetch_add(1, std::memory_order_relaxed);
+         i < busy_tiles_.size();
+         i = next.fetch_add(1, std::memory_order_relaxed)) {
+      rasterizeTile(busy_tiles_[i]);
+    }
+  };
+
+  if (pool_ && busy_tiles_.size() > 1) {
+    const size_t helpers = std::min(pool_->size(), busy_tiles_.size() - 1);
+    std::latch done{static_cast<std::ptrdiff_t>(helpers)};
+    for (size_t i = 0; i < helpers; ++i) {
+      pool_->submit([&work, &done]() noexcept {
+        work();
+        done.count_down();
+      });
+    }
+    work();
+    done.wait();
+  } else {
+    work();
+  }
+
+  for (const uint32_t tile : busy_tiles_) {
+    bins_[tile].clear();
+  }
+  busy_tiles_.clear();
+  commands_.clear();
+}
+
+void SoftwareRasterizer::present(GLuint dst_fbo, size_t dst_width,
+                                 size_t dst_height) noexcept {
+  const auto width = static_cast<GLsizei>(width_);
+  const auto height = static_cast<GLsizei>(height_);
+
+  if (!texture_) {
+    glGenTextures(1, &texture_);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenFramebuffers(1, &fbo_);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, texture_, 0);
+  }
+
+  glBindTexture(GL_TEXTURE_2D, texture_);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA,
+                  GL_UNSIGNED_BYTE, pixels_.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+  ++stats_.uploads;
+
+  /* Texture row 0 is the top row, so the blit flips it the right way up */
+  const bool scissor = glIsEnabled(GL_SCISSOR_TEST) == GL_TRUE;
+  if (scissor) {
+    glDisable(GL_SCISSOR_TEST);
+  }
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dst_fbo);
+  glBlitFramebuffer(0, 0, width, height, 0, static_cast<GLint>(dst_height),
+                    static_cast<GLint>(dst_width), 0, GL_COLOR_BUFFER_BIT,
+                    GL_NEAREST);
+  glBindFramebuffer(GL_FRAMEBUFFER, dst_fbo);
+  if (scissor) {
+    glEnable(GL_SCISSOR_TEST);
+  }
+}
+
+std::span<const uint32_t> SoftwareRasterizer::pixels() const noexcept {
+  return pixels_;
+}
+
+size_t SoftwareRasterizer::width() const noexcept { return width_; }
+size_t SoftwareRasterizer::height() const noexcept { return height_; }
+
+size_t SoftwareRasterizer::threads() const noexcept {
+  return pool_ ? pool_->size() + 1 : 1;
+}
+
+const SoftwareRasterizer::Stats &SoftwareRasterizer::stats() const noexcept {
+  return stats_;
+}
+
+void SoftwareRasterizer::bin(const Command &command) {
+  const auto index = static_cast<uint32_t>(commands_.size());
+  commands_.push_back(command);
+
+  const size_t tx0 = static_cast<size_t>(command.x0) / kTileSize;
+  const size_t ty0 = static_cast<size_t>(command.y0) / kTileSize;
+  const size_t tx1 = (static_cast<size_t>(command.x1) - 1) / kTileSize;
+  const size_t ty1 = (static_cast<size_t>(command.y1) - 1) / kTileSize;
+  for (size_t ty = ty0; ty <= ty1; ++ty) {
+    for (size_t tx = tx0; tx <= tx1; ++tx) {
+      const size_t tile = ty * tiles_x_ + tx;
+      if (bins_[tile].empty()) {
+        busy_tiles_.push_back(static_cast<uint32_t>(tile));
+      }
+      bins_[tile].push_back(index);
+    }
+  }
+}
+
+void SoftwareRasterizer::rasterizeTile(size_t tile) noexcept {
+  const int tx0 = static_cast<int>((tile % tiles_x_) * kTileSize);
+  const int ty0 = static_cast<int>((tile / tiles_x_) * kTileSize);
+  const int tx1 = std::min(tx0 + static_cast<int>(kTileSize),
+                           static_cast<int>(width_));
+  const int ty1 = std::min(ty0 + static_cast<int>(kTileSize),
+                           static_cast<int>(height_));
+
+  for (const uint32_t index : bins_[tile]) {
+    const Command &command = commands_[index];
+    const int x0 = std::max(command.x0, tx0);
+    const int y0 = std::max(command.y0, ty0);
+    const int x1 = std::min(command.x1, tx1);
+    const int y1 = std::min(command.y1, ty1);
+
+    switch (command.kind) {
+    case Kind::Clear:
+      for (int y = y0; y < y1; ++y) {
+        fillSpan(&pixels_[static_cast<size_t>(y) * width_ + x0],
+                 static_cast<size_t>(x1 - x0), command.color);
+      }
+      break;
+    case Kind::Sprite:
+      fillSprite(command, x0, y0, x1, y1);
+      break;
+    case Kind::Triangle:
+      fillTriangle(command, x0, y0, x1, y1);
+      break;
+    }
+  }
+}
+
+void SoftwareRasterizer::fillSprite(const Command &command, int x0, int y0,
+                                    int x1, int y1) noexcept {
+  const Texture *texture =
+      command.texture ? &textures_[command.texture - 1] : nullptr;
+  const bool solid = opaque(command.color) && (!texture || texture->opaque);
+  const auto count = static_cast<size_t>(x1 - x0);
+  uint32_t scratch[kTileSize];
+
+  if (!texture) {
+    if (!solid) {
+      fillSpan(scratch, count, command.color);
+    }
+    for (int y = y0; y < y1; ++y) {
+      uint32_t *dst = &pixels_[static_cast<size_t>(y) * width_ + x0];
+      if (solid) {
+        fillSpan(dst, count, command.color);
+      } else {
+        blendSpan(dst, scratch, count);
+      }
+    }
+    return;
+  }
+
+  /* Texture coordinates at pixel centres, like the GPU interpolates them */
+  const Point &p0 = command.p[0];
+  const Point &uv0 = command.uv[0];
+  const float du =
+      (command.uv[1].x - uv0.x) / (command.p[1].x - p0.x);
+  const float dv =
+      (command.uv[1].y - uv0.y) / (command.p[1].y - p0.y);
+
+  for (int y = y0; y < y1; ++y) {
+    const float v = uv0.y + (static_cast<float>(y) + 0.5f - p0.y) * dv;
+    const uint32_t *row =
+        &texture->pixels[wrapTexel(v, texture->height) * texture->width];
+    for (size_t i = 0; i < count; ++i) {
+      const float u =
+          uv0.x + (static_cast<float>(x0 + static_cast<int>(i)) + 0.5f - p0.x) *
+                      du;
+      scratch[i] = row[wrapTexel(u, texture->width)];
+    }
+
+    /* Modulating by white is exact, so it is skipped */
+    if (command.color != kWhite) {
+      modulateSpan(scratch, scratch, count, command.color);
+    }
+    uint32_t *dst = &pixels_[static_cast<size_t>(y) * width_ + x0];
+    if (solid) {
+      std::memcpy(dst, scratch, count * sizeof(uint32_t));
+    } else {
+      blendSpan(dst, scratch, count);
+    }
+  }
+}
+
+void SoftwareRasterizer::fillTriangle(const Command &command, int x0, int y0,
+                                      int x1, int y1) noexcept {
+  const Edge edges[3] = {{command.p[0], command.p[1]},
+                         {command.p[1], command.p[2]},
+                         {command.p[2], command.p[0]}};
+  const auto inside = [&edges](int x, float yc) noexcept {
+    const float xc = static_cast<float>(x) + 0.5f;
+    return edges[0].inside(xc, yc) && edges[1].inside(xc, yc) &&
+           edges[2].inside(xc, yc);
+  };
+
+  const bool solid = opaque(command.color);
+  uint32_t scratch[kTileSize];
+  if (!solid) {
+    fillSpan(scratch, static_cast<size_t>(x1 - x0), command.color);
+  }
+
+  const auto left = static_cast<float>(x0);
+  const auto right = static_cast<float>(x1);
+  for (int y = y0; y < y1; ++y) {
+    const float yc = static_cast<float>(y) + 0.5f;
+
+    /* Solve each edge for the row's span, then settle the endpoints with
+     * the exact per-pixel test so rounding never moves a pixel */
+    float lo = left;
+    float hi = right;
+    for (const Edge &edge : edges) {
+      if (edge.dy == 0.0f) {
+        continue;
+      }
+      const float cross = edge.ax + edge.dx * (yc - edge.ay) / edge.dy - 0.5f;
+      if (edge.dy < 0.0f) {
+        lo = std::max(lo, std::ceil(cross));
+      } else {
+        hi = std::min(hi, std::floor(cross) + 1.0f);
+      }
+    }
+    int start = static_cast<int>(std::clamp(lo, left, right));
+    int end = std::max(start, static_cast<int>(std::clamp(hi, left, right)));
+    while (start > x0 && inside(start - 1, yc)) {
+      --start;
+    }
+    while (start < end && !inside(start, yc)) {
+      ++start;
+    }
+    while (end > start && !inside(end - 1, yc)) {
+      --end;
+    }
+    while (end < x1 && inside(end, yc)) {
+      ++end;
+    }
+    if (start >= end) {
+      continue;
+    }
+
+    uint32_t *dst = &pixels_[static_cast<size_t>(y) * width_ + start];
+    const auto count = static_cast<size_t>(end - start);
+    if (solid) {
+      fillSpan(dst, count, command.color);
+    } else {
+      blendSpan(dst, scratch, count);
+    }
+  }
+}
@@ -0,0 +1,259 @@
+#include "span_kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIBRETRO_SPAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+/* round(x / 255) for x in [0, 255 * 255]. x / 255 is never exactly n + 0.5,
+ * so rounding half up is rounding to nearest */
+constexpr uint32_t div255(uint32_t x) noexcept {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+constexpr uint32_t channel(uint32_t pixel, int c) noexcept {
+  return (pixel >> (c * 8)) & 0xFF;
+}
+
+// ---------------------------------------------------------------------------
+// Scalar
+// ---------------------------------------------------------------------------
+void fillScalar(uint32_t *dst, size_t count, uint32_t color) noexcept {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = color;
+  }
+}
+
+void modulateScalar(uint32_t *dst, const uint32_t *src, size_t count,
+                    uint32_t color) noexcept {
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t out = 0;
+    for (int c = 0; c < 4; ++c) {
+      out |= div255(channel(src[i], c) * channel(color, c)) << (c * 8);
+    }
+    dst[i] = out;
+  }
+}
+
+void blendScalar(uint32_t *dst, const uint32_t *src, size_t count) noexcept {
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t a = channel(src[i], 3);
+    uint32_t out = 0;
+    for (int c = 0; c < 4; ++c) {
+      out |= (div255(channel(src[i], c) * a) +
+              div255(channel(dst[i], c) * (255 - a)))
+             << (c * 8);
+    }
+    dst[i] = out;
+  }
+}
+
+#ifdef LIBRETRO_SPAN_X86
+// ---------------------------------------------------------------------------
+// SSE2: 4 pixels per step, channels widened to 16 bits
+// ---------------------------------------------------------------------------
+__attribute__((target("sse2"))) __m128i div255Sse2(__m128i x) noexcept {
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("sse2"))) __m128i alphaSse2(__m128i wide) noexcept {
+  wide = _mm_shufflelo_epi16(wide, _MM_SHUFFLE(3, 3, 3, 3));
+  return _mm_shufflehi_epi16(wide, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+__attribute__((target("sse2"))) void fillSse2(uint32_t *dst, size_t count,
+                                               uint32_t color) noexcept {
+  const __m128i c = _mm_set1_epi32(static_cast<int>(color));
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), c);
+  }
+  fillScalar(dst + i, count - i, color);
+}
+
+__attribute__((target("sse2"))) void
+modulateSse2(uint32_t *dst, const uint32_t *src, size_t count,
+             uint32_t color) noexcept {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i c =
+      _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), zero);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128i s =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    const __m128i lo = div255Sse2(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), c));
+    const __m128i hi = div255Sse2(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), c));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     _mm_packus_epi16(lo, hi));
+  }
+  modulateScalar(dst + i, src + i, count - i, color);
+}
+
+__attribute__((target("sse2"))) __m128i blendHalfSse2(__m128i s,
+                                                      __m128i d) noexcept {
+  const __m128i a = alphaSse2(s);
+  const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+  return _mm_add_epi16(div255Sse2(_mm_mullo_epi16(s, a)),
+                       div255Sse2(_mm_mullo_epi16(d, inv)));
+}
+
+__attribute__((target("sse2"))) void blendSse2(uint32_t *dst,
+                                                const uint32_t *src,
+                                                size_t count) noexcept {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128i s =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    const __m128i d =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+    const __m128i lo = blendHalfSse2(_mm_unpacklo_epi8(s, zero),
+                                     _mm_unpacklo_epi8(d, zero));
+    const __m128i hi = blendHalfSse2(_mm_unpackhi_epi8(s, zero),
+                                     _mm_unpackhi_epi8(d, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     _mm_packus_epi16(lo, hi));
+  }
+  blendScalar(dst + i, src + i, count - i);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2: 8 pixels per step. Unpacking and packing both work within 128-bit
+// lanes, so pixel order is preserved
+// ---------------------------------------------------------------------------
+__attribute__((target("avx2"))) __m256i div255Avx2(__m256i x) noexcept {
+  x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("avx2"))) void fillAvx2(uint32_t *dst, size_t count,
+                                               uint32_t color) noexcept {
+  const __m256i c = _mm256_set1_epi32(static_cast<int>(color));
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), c);
+  }
+  fillScalar(dst + i, count - i, color);
+}
+
+__attribute__((target("avx2"))) void
+modulateAvx2(uint32_t *dst, const uint32_t *src, size_t count,
+             uint32_t color) noexcept {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i c =
+      _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(color)), zero);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256i s =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    const __m256i lo =
+        div255Avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), c));
+    const __m256i hi =
+        div255Avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), c));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                        _mm256_packus_epi16(lo, hi));
+  }
+  modulateScalar(dst + i, src + i, count - i, color);
+}
+
+__attribute__((target("avx2"))) __m256i blendHalfAvx2(__m256i s,
+                                                      __m256i d) noexcept {
+  __m256i a = _mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3));
+  a = _mm256_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+  const __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+  return _mm256_add_epi16(div255Avx2(_mm256_mullo_epi16(s, a)),
+                          div255Avx2(_mm256_mullo_epi16(d, inv)));
+}
+
+__attribute__((target("avx2"))) void blendAvx2(uint32_t *dst,
+                                                const uint32_t *src,
+                                                size_t count) noexcept {
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256i s =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    const __m256i d =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+    const __m256i lo = blendHalfAvx2(_mm256_unpacklo_epi8(s, zero),
+                                     _mm256_unpacklo_epi8(d, zero));
+    const __m256i hi = blendHalfAvx2(_mm256_unpackhi_epi8(s, zero),
+                                     _mm256_unpackhi_epi8(d, zero));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                        _mm256_packus_epi16(lo, hi));
+  }
+  blendScalar(dst + i, src + i, count - i);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+struct Kernels {
+  SpanIsa isa;
+  void (*fill)(uint32_t *, size_t, uint32_t) noexcept;
+  void (*modulate)(uint32_t *, const uint32_t *, size_t, uint32_t) noexcept;
+  void (*blend)(uint32_t *, const uint32_t *, size_t) noexcept;
+};
+
+constexpr Kernels kScalar{SpanIsa::Scalar, fillScalar, modulateScalar,
+                          blendScalar};
+#ifdef LIBRETRO_SPAN_X86
+constexpr Kernels kSse2{SpanIsa::Sse2, fillSse2, modulateSse2, blendSse2};
+constexpr Kernels kAvx2{SpanIsa::Avx2, fillAvx2, modulateAvx2, blendAvx2};
+#endif
+
+const Kernels &select(SpanIsa isa) noexcept {
+#ifdef LIBRETRO_SPAN_X86
+  __builtin_cpu_init();
+  if (isa == SpanIsa::Avx2 && __builtin_cpu_supports("avx2")) {
+    return kAvx2;
+  }
+  if (isa != SpanIsa::Scalar && __builtin_cpu_supports("sse2")) {
+    return kSse2;
+  }
+#else
+  (void)isa;
+#endif
+  return kScalar;
+}
+
+const Kernels *&active() noexcept {
+  static const Kernels *kernels = &select(SpanIsa::Avx2);
+  return kernels;
+}
+} // namespace
+
+SpanIsa spanIsa() noexcept { return active()->isa; }
+
+SpanIsa setSpanIsa(SpanIsa isa) noexcept {
+  active() = &select(isa);
+  return active()->isa;
+}
+
+const char *spanIsaName(SpanIsa isa) noexcept {
+  switch (isa) {
+  case SpanIsa::Avx2:
+    return "avx2";
+  case SpanIsa::Sse2:
+    return "sse2";
+  default:
+    return "scalar";
+  }
+}
+
+void fillSpan(uint32_t *dst, size_t count, uint32_t color) noexcept {
+  active()->fill(dst, count, color);
+}
+
+void modulateSpan(uint32_t *dst, const uint32_t *src, size_t count,
+                  uint32_t color) noexcept {
+  active()->modulate(dst, src, count, color);
+}
+
+void blendSpan(uint32_t *dst, const uint32_t *src, size_t count) noexcept {
+  active()->blend(dst, src, count);
+}
@@ -0,0 +1,232 @@
+#include "spatial_hash.h"
+
+#include "work_stealing_pool.h"
+
+#include <bit>
+#include <numeric>
+#include <stdexcept>
+
+SpatialHash::SpatialHash(float cell_size, size_t buckets)
+    : cell_size_{cell_size}, inverse_cell_{1.0f / cell_size} {
+  if (!(cell_size > 0.0f) || buckets == 0 || buckets > (size_t{1} << 31)) {
+    throw std::invalid_argument("SpatialHash cell size or buckets invalid");
+  }
+  buckets = std::bit_ceil(buckets);
+  mask_ = static_cast<uint32_t>(buckets - 1);
+  heads_.assign(buckets, kNone);
+}
+
+void SpatialHash::update(uint32_t id, const Aabb &box) {
+  /* Checked on cells, which also catches a NaN corner landing past the
+   * other one. An inverted range would link nothing yet count the object */
+  const Cells c = cells(box);
+  if (c.x1 < c.x0 || c.y1 < c.y0) {
+    throw std::invalid_argument("SpatialHash box is inverted");
+  }
+
+  if (id >= objects_.size()) {
+    objects_.resize(size_t{id} + 1);
+  }
+
+  Object &object = objects_[id];
+  const bool present = object.first != kNone;
+  if (present && c == object.cells) {
+    object.box = box;
+    return;
+  }
+
+  /* Make room before touching any links, so a throw leaves them intact */
+  const size_t needed = static_cast<size_t>(c.x1 - c.x0 + 1) *
+                        static_cast<size_t>(c.y1 - c.y0 + 1);
+  const size_t spare = entries_.size() - live_entries_;
+  if (needed > spare) {
+    const size_t want = entries_.size() + needed - spare;
+    if (want > kNone) {
+      throw std::length_error("SpatialHash object covers too many cells");
+    }
+    if (entries_.capacity() < want) {
+      entries_.reserve(std::max(want, entries_.capacity() * 2));
+    }
+  }
+
+  if (present) {
+    unlink(id);
+    ++relinks_;
+  } else {
+    ++size_;
+  }
+  object.box = box;
+  object.cells = c;
+  link(id);
+}
+
+void SpatialHash::remove(uint32_t id) noexcept {
+  if (!contains(id)) {
+    return;
+  }
+  unlink(id);
+  --size_;
+}
+
+bool SpatialHash::contains(uint32_t id) const noexcept {
+  return id < objects_.size() && objects_[id].first != kNone;
+}
+
+void SpatialHash::clear() noexcept {
+  std::fill(heads_.begin(), heads_.end(), kNone);
+  objects_.clear();
+  entries_.clear();
+  free_ = kNone;
+  size_ = 0;
+  live_entries_ = 0;
+}
+
+const Aabb &SpatialHash::bounds(uint32_t id) const noexcept {
+  return objects_[id].box;
+}
+
+void SpatialHash::query(std::span<const Aabb> boxes,
+                        SpatialQueryResults &results,
+                        WorkStealingPool *pool) const {
+  batch(boxes, results, pool);
+}
+
+void SpatialHash::query(std::span<const Circle> circles,
+                        SpatialQueryResults &results,
+                        WorkStealingPool *pool) const {
+  batch(circles, results, pool);
+}
+
+void SpatialHash::pairs(std::vector<std::pair<uint32_t, uint32_t>> &out) const {
+  out.clear();
+
+  /* Two objects can only overlap if they share a cell. As with queries, a
+   * pair is only reported from the first cell both cover */
+  for (uint32_t head : heads_) {
+    for (uint32_t a = head; a != kNone; a = entries_[a].next) {
+      const Entry &ea = entries_[a];
+      const Object &oa = objects_[ea.id];
+      for (uint32_t b = ea.next; b != kNone; b = entries_[b].next) {
+        const Entry &eb = entries_[b];
+        if (ea.cx != eb.cx || ea.cy != eb.cy) {
+          continue;
+        }
+        const Object &ob = objects_[eb.id];
+        if (ea.cx != std::max(oa.cells.x0, ob.cells.x0) ||
+            ea.cy != std::max(oa.cells.y0, ob.cells.y0)) {
+          continue;
+        }
+        if (oa.box.overlaps(ob.box)) {
+          out.push_back(std::minmax(ea.id, eb.id));
+        }
+      }
+    }
+  }
+}
+
+float SpatialHash::cellSize() const noexcept { return cell_size_; }
+size_t SpatialHash::buckets() const noexcept { return heads_.size(); }
+size_t SpatialHash::size() const noexcept { return size_; }
+
+SpatialHash::Stats SpatialHash::stats() const noexcept {
+  return {.objects = size_, .entries = live_entries_, .relinks = relinks_};
+}
+
+template <typename Shape>
+void SpatialHash::batch(std::span<const Shape> shapes,
+                        SpatialQueryResults &results,
+                        WorkStealingPool *pool) const {
+  /* Queries are cheap, so each job takes a block of them */
+  constexpr size_t kBlock = 64;
+  const size_t count = shapes.size();
+  const size_t blocks = (count + kBlock - 1) / kBlock;
+  const auto forEachQuery = [&](auto &&body) {
+    const auto job = [&](size_t block) noexcept {
+      const size_t end = std::min(count, (block + 1) * kBlock);
+      for (size_t i = block * kBlock; i < end; ++i) {
+        body(i);
+      }
+    };
+    if (pool) {
+      pool->parallelFor(blocks, job);
+    } else {
+      for (size_t block = 0; block < blocks; ++block) {
+        job(block);
+      }
+    }
+  };
+
+  /* Count, then fill, so every query writes its own slice without locks */
+  results.offsets.assign(count + 1, 0);
+  forEachQuery([&](size_t i) noexcept {
+    uint32_t hits = 0;
+    query(shapes[i], [&hits](uint32_t) noexcept { ++hits; });
+    results.offsets[i + 1] = hits;
+  });
+  std::partial_sum(results.offsets.begin(), results.offsets.end(),
+                   results.offsets.begin());
+
+  results.ids.resize(results.offsets[count]);
+  forEachQuery([&](size_t i) noexcept {
+    uint32_t *out = results.ids.data() + results.offsets[i];
+    query(shapes[i], [&out](uint32_t id) noexcept { *out++ = id; });
+  });
+}
+
+void SpatialHash::link(uint32_t id) noexcept {
+  Object &object = objects_[id];
+  const Cells c = object.cells;
+  for (int32_t cy = c.y0; cy <= c.y1; ++cy) {
+    for (int32_t cx = c.x0; cx <= c.x1; ++cx) {
+      const uint32_t e = allocateEntry();
+      uint32_t &head = heads_[bucket(cx, cy)];
+      entries_[e] = {.cx = cx,
+                     .cy = cy,
+                     .id = id,
+                     .prev = kNone,
+                     .next = head,
+                     .owner_next = object.first};
+      if (head != kNone) {
+        entries_[head].prev = e;
+      }
+      head = e;
+      object.first = e;
+    }
+  }
+}
+
+void SpatialHash::unlink(uint32_t id) noexcept {
+  Object &object = objects_[id];
+  uint32_t e = object.first;
+  while (e != kNone) {
+    Entry &entry = entries_[e];
+    if (entry.prev != kNone) {
+      entries_[entry.prev].next = entry.next;
+    } else {
+      heads_[bucket(entry.cx, entry.cy)] = entry.next;
+    }
+    if (entry.next != kNone) {
+      entries_[entry.next].prev = entry.prev;
+    }
+
+    /* Freed entries are chained through next */
+    const uint32_t owner_next = entry.owner_next;
+    entry.next = free_;
+    free_ = e;
+    --live_entries_;
+    e = owner_next;
+  }
+  object.first = kNone;
+}
+
+uint32_t SpatialHash::allocateEntry() noexcept {
+  ++live_entries_;
+  if (free_ != kNone) {
+    const uint32_t e = free_;
+    free_ = entries_[e].next;
+    return e;
+  }
+  /* update() reserved the capacity, so this never reallocates */
+  entries_.emplace_back();
+  return static_cast<uint32_t>(entries_.size() - 1);
+}
@@ -0,0 +1,279 @@
+#include "sprite_batch.h"
+#include "shader_cache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+const char *kVertexSource = "#version 330 core\n"
+                            "layout (location = 0) in vec2 aPos;\n"
+                            "layout (location = 1) in vec2 aUv;\n"
+                            "layout (location = 2) in vec4 aColor;\n"
+                            "uniform vec2 uViewport;\n"
+                            "out vec2 vUv;\n"
+                            "out vec4 vColor;\n"
+                            "void main()\n"
+                            "{\n"
+                            "  vec2 ndc = aPos / uViewport * 2.0 - 1.0;\n"
+                            "  gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);\n"
+                            "  vUv = aUv;\n"
+                            "  vColor = aColor;\n"
+                            "}\n";
+
+const char *kFragmentSource = "#version 330 core\n"
+                              "in vec2 vUv;\n"
+                              "in vec4 vColor;\n"
+                              "uniform sampler2D uTexture;\n"
+                              "out vec4 FragColor;\n"
+                              "void main()\n"
+                              "{\n"
+                              "  FragColor = texture(uTexture, vUv) * vColor;\n"
+                              "}\n";
+} // namespace
+
+SpriteBatch::SpriteBatch(size_t capacity) : capacity_{capacity} {
+  if (capacity_ == 0 || capacity_ * 4 > UINT32_MAX) {
+    throw std::invalid_argument("SpriteBatch capacity out of range");
+  }
+
+  program_ = buildProgram({{GL_VERTEX_SHADER, kVertexSource},
+                           {GL_FRAGMENT_SHADER, kFragmentSource}});
+  builtin_uniforms_ = {.program = program_,
+                       .viewport = glGetUniformLocation(program_, "uViewport"),
+                       .texture = glGetUniformLocation(program_, "uTexture")};
+
+  /* 1x1 white texture so untextured sprites share the textured path */
+  const uint32_t white = 0xFFFFFFFF;
+  glGenTextures(1, &white_texture_);
+  glBindTexture(GL_TEXTURE_2D, white_texture_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+               &white);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  /* Quad indices never change, so they are uploaded once */
+  std::vector<uint32_t> indices(capacity_ * 6);
+  for (uint32_t quad = 0; quad < capacity_; ++quad) {
+    const uint32_t v = quad * 4;
+    const uint32_t tris[] = {v, v + 1, v + 2, v, v + 2, v + 3};
+    std::copy(std::begin(tris), std::end(tris), indices.begin() + quad * 6);
+  }
+
+  glGenVertexArrays(1, &vao_);
+  glGenBuffers(1, &vbo_);
+  glGenBuffers(1, &ebo_);
+
+  glBindVertexArray(vao_);
+
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+  glBufferData(GL_ARRAY_BUFFER,
+               static_cast<GLsizeiptr>(capacity_ * 4 * sizeof(Vertex)),
+               nullptr, GL_STREAM_DRAW);
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+               static_cast<GLsizeiptr>(indices.size() * sizeof(uint32_t)),
+               indices.data(), GL_STATIC_DRAW);
+
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        reinterpret_cast<void *>(offsetof(Vertex, x)));
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        reinterpret_cast<void *>(offsetof(Vertex, u)));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+                        reinterpret_cast<void *>(offsetof(Vertex, color)));
+  glEnableVertexAttribArray(2);
+
+  /* Unbind for cleanup (the EBO binding stays with the VAO) */
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+  sprites_.reserve(capacity_);
+  order_.reserve(capacity_);
+  scratch_.resize(capacity_);
+}
+
+SpriteBatch::~SpriteBatch() {
+  glDeleteVertexArrays(1, &vao_);
+  glDeleteBuffers(1, &vbo_);
+  glDeleteBuffers(1, &ebo_);
+  glDeleteTextures(1, &white_texture_);
+  glDeleteProgram(program_);
+}
+
+void SpriteBatch::begin(float viewport_width, float viewport_height) noexcept {
+  viewport_width_ = viewport_width;
+  viewport_height_ = viewport_height;
+  sprites_.clear();
+  custom_uniforms_.clear();
+  stats_ = {};
+}
+
+void SpriteBatch::draw(const Sprite &sprite) {
+  sprites_.push_back(sprite);
+
+  /* Grow the sort buffers here so end() never allocates */
+  if (scratch_.size() < sprites_.size()) {
+    order_.reserve(sprites_.capacity());
+    scratch_.resize(sprites_.capacity());
+  }
+}
+
+void SpriteBatch::draw(std::span<const Sprite> sprites) {
+  sprites_.insert(sprites_.end(), sprites.begin(), sprites.end());
+
+  if (scratch_.size() < sprites_.size()) {
+    order_.reserve(sprites_.capacity());
+    scratch_.resize(sprites_.capacity());
+  }
+}
+
+void SpriteBatch::draw(std::span<const Sprite> sprites,
+                       const SpatialHash &index) {
+  visible_.clear();
+  index.query(Aabb{0.0f, 0.0f, viewport_width_, viewport_height_},
+              [this, &sprites](uint32_t id) {
+                if (id < sprites.size()) {
+                  visible_.push_back(id);
+                }
+              });
+
+  /* Hits come out in cell order; put them back in submission order */
+  std::sort(visible_.begin(), visible_.end());
+  for (uint32_t id : visible_) {
+    draw(sprites[id]);
+  }
+  stats_.culled += sprites.size() - visible_.size();
+}
+
+void SpriteBatch::end() noexcept {
+  if (sprites_.empty()) {
+    return;
+  }
+
+  order_.clear();
+  for (uint32_t i = 0; i < sprites_.size(); ++i) {
+    order_.emplace_back(sortKey(sprites_[i]), i);
+  }
+
+  /* The radix sort is stable, so sprites keep submission order per state.
+   * Frames that are already in state order skip the sort entirely */
+  if (!std::is_sorted(order_.begin(), order_.end())) {
+    radixSort(order_, scratch_);
+  }
+
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glActiveTexture(GL_TEXTURE0);
+  glBindVertexArray(vao_);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+
+  for (size_t first = 0; first < order_.size(); first += capacity_) {
+    submit(first, std::min(capacity_, order_.size() - first));
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+  glDisable(GL_BLEND);
+
+  stats_.sprites = sprites_.size();
+}
+
+const SpriteBatch::Stats &SpriteBatch::stats() const noexcept {
+  return stats_;
+}
+
+size_t SpriteBatch::capacity() const noexcept { return capacity_; }
+GLuint SpriteBatch::program() const noexcept { return program_; }
+
+void SpriteBatch::submit(size_t first, size_t count) noexcept {
+  /* Invalidating the whole buffer lets the driver orphan the storage the
+   * GPU may still be reading instead of synchronizing with it */
+  auto *vertices = static_cast<Vertex *>(glMapBufferRange(
+      GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(count * 4 * sizeof(Vertex)),
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  if (!vertices) {
+    return;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    const Sprite &s = sprites_[order_[first + i].second];
+    const float x1 = s.x + s.width;
+    const float y1 = s.y + s.height;
+
+    Vertex *quad = vertices + i * 4;
+    quad[0] = {s.x, s.y, s.u0, s.v0, s.color};
+    quad[1] = {x1, s.y, s.u1, s.v0, s.color};
+    quad[2] = {x1, y1, s.u1, s.v1, s.color};
+    quad[3] = {s.x, y1, s.u0, s.v1, s.color};
+  }
+
+  glUnmapBuffer(GL_ARRAY_BUFFER);
+  ++stats_.uploads;
+
+  /* One draw per run of sprites sharing program and texture */
+  size_t run = 0;
+  while (run < count) {
+    const Sprite &head = sprites_[order_[first + run].second];
+    size_t end = run + 1;
+    while (end < count) {
+      const Sprite &s = sprites_[order_[first + end].second];
+      if (s.program != head.program || s.texture != head.texture) {
+        break;
+      }
+      ++end;
+    }
+
+    bindState(head.program ? head.program : program_,
+              head.texture ? head.texture : white_texture_);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>((end - run) * 6),
+                   GL_UNSIGNED_INT,
+                   reinterpret_cast<void *>(run * 6 * sizeof(uint32_t)));
+    ++stats_.draw_calls;
+
+    run = end;
+  }
+}
+
+void SpriteBatch::bindState(GLuint program, GLuint texture) noexcept {
+  const Uniforms locations = uniforms(program);
+  glUseProgram(program);
+  glUniform2f(locations.viewport, viewport_width_, viewport_height_);
+  glUniform1i(locations.texture, 0);
+  glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+SpriteBatch::Uniforms SpriteBatch::uniforms(GLuint program) noexcept {
+  if (program == program_) {
+    return builtin_uniforms_;
+  }
+  for (const Uniforms &cached : custom_uniforms_) {
+    if (cached.program == program) {
+      return cached;
+    }
+  }
+
+  const Uniforms found{
+      .program = program,
+      .viewport = glGetUniformLocation(program, "uViewport"),
+      .texture = glGetUniformLocation(program, "uTexture")};
+
+  /* The cache keeps its capacity across frames, so this only allocates
+   * when a batch uses more custom programs than any before it. If that
+   * fails the program is simply looked up again next run */
+  try {
+    custom_uniforms_.push_back(found);
+  } catch (...) {
+  }
+  return found;
+}
+
+uint64_t SpriteBatch::sortKey(const Sprite &sprite) noexcept {
+  /* layer:16 | program:24 | texture:24 */
+  return uint64_t{sprite.layer} << 48 |
+         (uint64_t{sprite.program} & 0xFFFFFF) << 24 |
+         (uint64_t{sprite.texture} & 0xFFFFFF);
+}
@@ -0,0 +1,60 @@
+#include "system_schedule.h"
+
+namespace {
+bool conflicts(ComponentMask reads_a, ComponentMask writes_a,
+               ComponentMask reads_b, ComponentMask writes_b) noexcept {
+  return (writes_a & (reads_b | writes_b)) || (reads_a & writes_b);
+}
+} // namespace
+
+SystemSchedule::SystemSchedule(size_t threads) : pool_{threads} {}
+
+void SystemSchedule::run(World &world) {
+  last_jobs_ = 0;
+  for (size_t phase = 0; phase < phases_; ++phase) {
+    jobs_.clear();
+    for (const System &system : systems_) {
+      if (system.phase != phase) {
+        continue;
+      }
+      chunks_.clear();
+      world.chunks(system.reads | system.writes, chunks_);
+      for (const ChunkView &chunk : chunks_) {
+        jobs_.push_back({&system, chunk});
+      }
+    }
+
+    pool_.parallelFor(jobs_.size(), [this](size_t i) noexcept {
+      jobs_[i].system->body(jobs_[i].chunk);
+    });
+    last_jobs_ += jobs_.size();
+  }
+}
+
+size_t SystemSchedule::systemCount() const noexcept { return systems_.size(); }
+size_t SystemSchedule::phaseCount() const noexcept { return phases_; }
+
+size_t SystemSchedule::phase(size_t system) const noexcept {
+  return systems_[system].phase;
+}
+
+size_t SystemSchedule::lastJobs() const noexcept { return last_jobs_; }
+
+WorkStealingPool &SystemSchedule::pool() noexcept { return pool_; }
+
+void SystemSchedule::insert(std::string_view name, ComponentMask reads,
+                            ComponentMask writes, Body body) {
+  /* Earlier phases always finish first, so only the last one can clash */
+  size_t phase = phases_ ? phases_ - 1 : 0;
+  for (const System &other : systems_) {
+    if (other.phase == phase &&
+        conflicts(reads, writes, other.reads, other.writes)) {
+      ++phase;
+      break;
+    }
+  }
+
+  systems_.push_back({std::string{name}, reads, writes, phase,
+                      std::move(body)});
+  phases_ = phase + 1;
+}
@@ -0,0 +1,169 @@
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+/* Texels per region in the texture buffer */
+constexpr size_t kRegionTexels = 2;
+
+GLint integer(GLenum name) noexcept {
+  GLint value = 0;
+  glGetIntegerv(name, &value);
+  return value;
+}
+} // namespace
+
+TextureAtlas::TextureAtlas(uint32_t width, uint32_t height, uint32_t layers)
+    : packer_{width, height, layers} {
+  const auto max_size = static_cast<uint32_t>(integer(GL_MAX_TEXTURE_SIZE));
+  const auto max_layers =
+      static_cast<uint32_t>(integer(GL_MAX_ARRAY_TEXTURE_LAYERS));
+  if (width > max_size || height > max_size || layers > max_layers) {
+    throw std::invalid_argument("TextureAtlas size exceeds driver limits");
+  }
+
+  glGenTextures(1, &texture_);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, texture_);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, static_cast<GLsizei>(width),
+               static_cast<GLsizei>(height), static_cast<GLsizei>(layers), 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+  /* The buffer grows as regions are added; the texture view follows it */
+  glGenBuffers(1, &region_buffer_);
+  glGenTextures(1, &region_texture_);
+}
+
+TextureAtlas::~TextureAtlas() {
+  glDeleteTextures(1, &region_texture_);
+  glDeleteBuffers(1, &region_buffer_);
+  glDeleteTextures(1, &texture_);
+}
+
+uint32_t TextureAtlas::add(const Image &image) {
+  validate(image);
+  if (regions_.size() == kMaxRegions) {
+    throw std::runtime_error("TextureAtlas has no region indices left");
+  }
+
+  const auto at = packer_.insert({image.width, image.height});
+  if (!at) {
+    throw std::runtime_error("TextureAtlas is full");
+  }
+
+  const uint32_t index = store(image, *at);
+  uploadRegions(index);
+  return index;
+}
+
+std::vector<uint32_t> TextureAtlas::addAll(std::span<const Image> images) {
+  std::vector<AtlasPacker::Size> sizes;
+  sizes.reserve(images.size());
+  for (const Image &image : images) {
+    validate(image);
+    sizes.push_back({image.width, image.height});
+  }
+  if (regions_.size() + images.size() > kMaxRegions) {
+    throw std::runtime_error("TextureAtlas has no region indices left");
+  }
+
+  /* Pack on a copy so a failure leaves the atlas untouched */
+  AtlasPacker packer = packer_;
+  const auto placements = packer.insertAll(sizes);
+  if (std::ranges::any_of(placements, [](const auto &at) { return !at; })) {
+    throw std::runtime_error("TextureAtlas is full");
+  }
+  packer_ = std::move(packer);
+
+  const size_t first = regions_.size();
+  std::vector<uint32_t> indices;
+  indices.reserve(images.size());
+  for (size_t i = 0; i < images.size(); ++i) {
+    indices.push_back(store(images[i], *placements[i]));
+  }
+  if (!images.empty()) {
+    uploadRegions(first);
+  }
+  return indices;
+}
+
+const TextureAtlas::Region &
+TextureAtlas::region(uint32_t index) const noexcept {
+  return regions_[index];
+}
+
+size_t TextureAtlas::regionCount() const noexcept { return regions_.size(); }
+GLuint TextureAtlas::texture() const noexcept { return texture_; }
+GLuint TextureAtlas::regionTexture() const noexcept { return region_texture_; }
+const AtlasPacker &TextureAtlas::packer() const noexcept { return packer_; }
+
+void TextureAtlas::validate(const Image &image) const {
+  if (image.width == 0 || image.height == 0 ||
+      image.pixels.size() != size_t{image.width} * image.height) {
+    throw std::invalid_argument("TextureAtlas image size mismatch");
+  }
+  if (image.width > packer_.pageWidth() ||
+      image.height > packer_.pageHeight()) {
+    throw std::invalid_argument("TextureAtlas image larger than a layer");
+  }
+}
+
+uint32_t TextureAtlas::store(const Image &image, AtlasPacker::Placement at) {
+  glBindTexture(GL_TEXTURE_2D_ARRAY, texture_);
+  glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, static_cast<GLint>(at.x),
+                  static_cast<GLint>(at.y), static_cast<GLint>(at.page),
+                  static_cast<GLsizei>(image.width),
+                  static_cast<GLsizei>(image.height), 1, GL_RGBA,
+                  GL_UNSIGNED_BYTE, image.pixels.data());
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+  const auto width = static_cast<float>(packer_.pageWidth());
+  const auto height = static_cast<float>(packer_.pageHeight());
+  regions_.push_back({.u0 = static_cast<float>(at.x) / width,
+                      .v0 = static_cast<float>(at.y) / height,
+                      .u1 = static_cast<float>(at.x + image.width) / width,
+                      .v1 = static_cast<float>(at.y + image.height) / height,
+                      .layer = at.page});
+  return static_cast<uint32_t>(regions_.size() - 1);
+}
+
+void TextureAtlas::uploadRegions(size_t first) {
+  /* Regions as the shader reads them */
+  const auto texels = [this](size_t from, size_t to) {
+    std::vector<float> data;
+    data.reserve((to - from) * kRegionTexels * 4);
+    for (size_t i = from; i < to; ++i) {
+      const Region &r = regions_[i];
+      data.insert(data.end(), {r.u0, r.v0, r.u1, r.v1,
+                               static_cast<float>(r.layer), 0.0f, 0.0f, 0.0f});
+    }
+    return data;
+  };
+  constexpr size_t kRegionBytes = kRegionTexels * 4 * sizeof(float);
+
+  glBindBuffer(GL_TEXTURE_BUFFER, region_buffer_);
+  if (regions_.size() > region_capacity_) {
+    /* Reallocate with room to spare and upload everything */
+    region_capacity_ = std::max<size_t>(regions_.size() * 2, 64);
+    glBufferData(GL_TEXTURE_BUFFER,
+                 static_cast<GLsizeiptr>(region_capacity_ * kRegionBytes),
+                 nullptr, GL_STATIC_DRAW);
+    first = 0;
+
+    glBindTexture(GL_TEXTURE_BUFFER, region_texture_);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, region_buffer_);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+  }
+
+  const auto data = texels(first, regions_.size());
+  glBufferSubData(GL_TEXTURE_BUFFER,
+                  static_cast<GLintptr>(first * kRegionBytes),
+                  static_cast<GLsizeiptr>(data.size() * sizeof(float)),
+                  data.data());
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
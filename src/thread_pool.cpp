@@ -0,0 +1,60 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads) {
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  workers_.reserve(threads);
+  try {
+    for (size_t i = 0; i < threads; ++i) {
+      workers_.emplace_back(&ThreadPool::run, this);
+    }
+  } catch (...) {
+    /* Joinable threads must not be destroyed */
+    stop();
+    throw;
+  }
+}
+
+ThreadPool::~ThreadPool() { stop(); }
+
+void ThreadPool::submit(Task task) {
+  {
+    std::lock_guard lock{mutex_};
+    tasks_.push_back(std::move(task));
+  }
+  ready_.notify_one();
+}
+
+size_t ThreadPool::size() const noexcept { return workers_.size(); }
+
+void ThreadPool::stop() noexcept {
+  {
+    std::lock_guard lock{mutex_};
+    stopping_ = true;
+  }
+  ready_.notify_all();
+
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::run() noexcept {
+  for (;;) {
+    Task task;
+    {
+      std::unique_lock lock{mutex_};
+      ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
@@ -0,0 +1,234 @@
+#include "tilemap.h"
+#include "shader_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+static_assert(Tilemap::kChunkSize == 32, "kChunkSize is baked into the shader");
+
+/* One instance per chunk cell; the four strip vertices are its corners.
+ * Empty cells collapse to a point off screen */
+const char *kVertexSource =
+    "#version 330 core\n"
+    "layout (location = 0) in uint aTile;\n"
+    "uniform vec2 uViewport;\n"
+    "uniform vec2 uOrigin;\n"
+    "uniform vec2 uTileSize;\n"
+    "uniform samplerBuffer uRegions;\n"
+    "out vec3 vUv;\n"
+    "const int kChunkSize = 32;\n"
+    "void main()\n"
+    "{\n"
+    "  if (aTile == 0u) {\n"
+    "    gl_Position = vec4(-2.0, -2.0, 0.0, 1.0);\n"
+    "    vUv = vec3(0.0);\n"
+    "    return;\n"
+    "  }\n"
+    "  vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+    "  vec2 cell = vec2(gl_InstanceID % kChunkSize,\n"
+    "                   gl_InstanceID / kChunkSize);\n"
+    "  vec2 pos = uOrigin + (cell + corner) * uTileSize;\n"
+    "  vec2 ndc = pos / uViewport * 2.0 - 1.0;\n"
+    "  gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);\n"
+    "  int region = int(aTile - 1u) * 2;\n"
+    "  vec4 rect = texelFetch(uRegions, region);\n"
+    "  float layer = texelFetch(uRegions, region + 1).x;\n"
+    "  vUv = vec3(mix(rect.xy, rect.zw, corner), layer);\n"
+    "}\n";
+
+const char *kFragmentSource = "#version 330 core\n"
+                              "in vec3 vUv;\n"
+                              "uniform sampler2DArray uAtlas;\n"
+                              "out vec4 FragColor;\n"
+                              "void main()\n"
+                              "{\n"
+                              "  FragColor = texture(uAtlas, vUv);\n"
+                              "}\n";
+
+/* Chunks in [first, last) overlapping the span [from, from + length) */
+void visibleRange(float from, float length, float chunk, size_t count,
+                  size_t &first, size_t &last) noexcept {
+  const float limit = static_cast<float>(count);
+  first = static_cast<size_t>(std::clamp(std::floor(from / chunk), 0.0f, limit));
+  last = static_cast<size_t>(
+      std::clamp(std::ceil((from + length) / chunk), 0.0f, limit));
+}
+} // namespace
+
+Tilemap::Tilemap(size_t width, size_t height, float tile_width,
+                 float tile_height)
+    : width_{width}, height_{height}, tile_width_{tile_width},
+      tile_height_{tile_height},
+      chunks_x_{(width + kChunkSize - 1) / kChunkSize},
+      chunks_y_{(height + kChunkSize - 1) / kChunkSize} {
+  if (width_ == 0 || height_ == 0 || !(tile_width_ > 0.0f) ||
+      !(tile_height_ > 0.0f)) {
+    throw std::invalid_argument("Tilemap size out of range");
+  }
+
+  const size_t chunks = chunks_x_ * chunks_y_;
+  tiles_.assign(chunks * kChunkTiles, 0);
+  dirty_.assign(chunks, 0);
+  filled_.assign(chunks, 0);
+
+  program_ = buildProgram({{GL_VERTEX_SHADER, kVertexSource},
+                           {GL_FRAGMENT_SHADER, kFragmentSource}});
+  glUseProgram(program_);
+  glUniform1i(glGetUniformLocation(program_, "uAtlas"), 0);
+  glUniform1i(glGetUniformLocation(program_, "uRegions"), 1);
+  viewport_location_ = glGetUniformLocation(program_, "uViewport");
+  origin_location_ = glGetUniformLocation(program_, "uOrigin");
+  tile_size_location_ = glGetUniformLocation(program_, "uTileSize");
+  glUseProgram(0);
+
+  /* The whole map starts empty on the GPU too */
+  glGenVertexArrays(1, &vao_);
+  glGenBuffers(1, &vbo_);
+  glBindVertexArray(vao_);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+  glBufferData(GL_ARRAY_BUFFER,
+               static_cast<GLsizeiptr>(tiles_.size() * sizeof(uint16_t)),
+               tiles_.data(), GL_DYNAMIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glVertexAttribDivisor(0, 1);
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+Tilemap::~Tilemap() {
+  glDeleteVertexArrays(1, &vao_);
+  glDeleteBuffers(1, &vbo_);
+  glDeleteProgram(program_);
+}
+
+void Tilemap::setTile(size_t x, size_t y, uint16_t tile) noexcept {
+  if (x >= width_ || y >= height_) {
+    return;
+  }
+
+  uint16_t &cell = tiles_[index(x, y)];
+  if (cell == tile) {
+    return;
+  }
+
+  const size_t chunk = index(x, y) / kChunkTiles;
+  if (!cell) {
+    ++filled_[chunk];
+  } else if (!tile) {
+    --filled_[chunk];
+  }
+  cell = tile;
+  dirty_[chunk] = 1;
+}
+
+uint16_t Tilemap::tile(size_t x, size_t y) const noexcept {
+  return x < width_ && y < height_ ? tiles_[index(x, y)] : 0;
+}
+
+void Tilemap::fill(uint16_t tile) noexcept {
+  /* Edge chunks keep their cells past the map empty */
+  for (size_t y = 0; y < height_; ++y) {
+    for (size_t x = 0; x < width_; x += kChunkSize) {
+      const size_t first = index(x, y);
+      const size_t count = std::min(kChunkSize, width_ - x);
+      std::fill_n(tiles_.begin() + static_cast<ptrdiff_t>(first), count, tile);
+    }
+  }
+
+  for (size_t cy = 0; cy < chunks_y_; ++cy) {
+    for (size_t cx = 0; cx < chunks_x_; ++cx) {
+      const size_t w = std::min(kChunkSize, width_ - cx * kChunkSize);
+      const size_t h = std::min(kChunkSize, height_ - cy * kChunkSize);
+      filled_[cy * chunks_x_ + cx] = tile ? static_cast<uint16_t>(w * h) : 0;
+    }
+  }
+  std::fill(dirty_.begin(), dirty_.end(), uint8_t{1});
+}
+
+void Tilemap::draw(const TextureAtlas &atlas, float camera_x, float camera_y,
+                   float viewport_width, float viewport_height) noexcept {
+  stats_ = {};
+  const size_t chunks = chunks_x_ * chunks_y_;
+  if (!(viewport_width > 0.0f) || !(viewport_height > 0.0f)) {
+    stats_.chunks_culled = chunks;
+    return;
+  }
+
+  /* The view is an axis-aligned rectangle, so culling is a range per axis */
+  const float chunk_width = tile_width_ * static_cast<float>(kChunkSize);
+  const float chunk_height = tile_height_ * static_cast<float>(kChunkSize);
+  size_t first_x = 0, last_x = 0, first_y = 0, last_y = 0;
+  visibleRange(camera_x, viewport_width, chunk_width, chunks_x_, first_x,
+               last_x);
+  visibleRange(camera_y, viewport_height, chunk_height, chunks_y_, first_y,
+               last_y);
+
+  glUseProgram(program_);
+  glUniform2f(viewport_location_, viewport_width, viewport_height);
+  glUniform2f(tile_size_location_, tile_width_, tile_height_);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_BUFFER, atlas.regionTexture());
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.texture());
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glBindVertexArray(vao_);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+
+  for (size_t cy = first_y; cy < last_y; ++cy) {
+    for (size_t cx = first_x; cx < last_x; ++cx) {
+      const size_t chunk = cy * chunks_x_ + cx;
+      if (!filled_[chunk]) {
+        continue;
+      }
+      if (dirty_[chunk]) {
+        upload(chunk);
+      }
+
+      glVertexAttribIPointer(
+          0, 1, GL_UNSIGNED_SHORT, 0,
+          reinterpret_cast<void *>(chunk * kChunkTiles * sizeof(uint16_t)));
+      glUniform2f(origin_location_,
+                  static_cast<float>(cx) * chunk_width - camera_x,
+                  static_cast<float>(cy) * chunk_height - camera_y);
+      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4,
+                            static_cast<GLsizei>(kChunkTiles));
+      ++stats_.chunks_drawn;
+      ++stats_.draw_calls;
+    }
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+  glDisable(GL_BLEND);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glActiveTexture(GL_TEXTURE0);
+
+  stats_.chunks_culled = chunks - stats_.chunks_drawn;
+}
+
+const Tilemap::Stats &Tilemap::stats() const noexcept { return stats_; }
+size_t Tilemap::width() const noexcept { return width_; }
+size_t Tilemap::height() const noexcept { return height_; }
+size_t Tilemap::chunksX() const noexcept { return chunks_x_; }
+size_t Tilemap::chunksY() const noexcept { return chunks_y_; }
+
+size_t Tilemap::index(size_t x, size_t y) const noexcept {
+  const size_t chunk = (y / kChunkSize) * chunks_x_ + x / kChunkSize;
+  return chunk * kChunkTiles + (y % kChunkSize) * kChunkSize + x % kChunkSize;
+}
+
+void Tilemap::upload(size_t chunk) noexcept {
+  /* Only this chunk's slice of the buffer changes */
+  glBufferSubData(
+      GL_ARRAY_BUFFER,
+      static_cast<GLintptr>(chunk * kChunkTiles * sizeof(uint16_t)),
+      static_cast<GLsizeiptr>(kChunkTiles * sizeof(uint16_t)),
+      tiles_.data() + chunk * kChunkTiles);
+  dirty_[chunk] = 0;
+  ++stats_.chunks_uploaded;
+}
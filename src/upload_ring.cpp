@@ -0,0 +1,182 @@
+#include "upload_ring.h"
+
+#include "gl_extensions.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+
+using Clock = std::chrono::steady_clock;
+
+UploadRing::UploadRing(size_t region_bytes, size_t regions, Mode mode)
+    : region_bytes_{region_bytes}, mode_{mode} {
+  if (region_bytes == 0 || regions == 0 ||
+      region_bytes > static_cast<size_t>(PTRDIFF_MAX) / regions) {
+    throw std::invalid_argument("UploadRing region size or count invalid");
+  }
+  if (mode_ == Mode::Auto) {
+    mode_ = gl_extensions.buffer_storage ? Mode::Persistent
+                                         : Mode::Unsynchronized;
+  } else if (mode_ == Mode::Persistent && !gl_extensions.buffer_storage) {
+    throw std::runtime_error("UploadRing persistent mapping needs "
+                             "ARB_buffer_storage");
+  }
+  fences_.assign(regions, nullptr);
+
+  GLint alignment = 0;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  uniform_alignment_ = static_cast<size_t>(std::max(alignment, 1));
+
+  /* Bound to the copy target so the caller's array and element bindings
+   * are left alone */
+  const auto size = static_cast<GLsizeiptr>(region_bytes * regions);
+  glGenBuffers(1, &buffer_);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+  if (mode_ == Mode::Persistent) {
+    constexpr GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    gl_extensions.BufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+    mapped_ = static_cast<uint8_t *>(
+        glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+    ++stats_.maps;
+  } else {
+    glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  if (mode_ == Mode::Persistent && !mapped_) {
+    release();
+    throw std::runtime_error("Unable to map UploadRing buffer");
+  }
+}
+
+UploadRing::~UploadRing() { release(); }
+
+UploadAllocation UploadRing::allocate(UploadKind kind, size_t bytes) noexcept {
+  switch (kind) {
+  case UploadKind::Vertex:
+    return allocate(bytes, 16);
+  case UploadKind::Index:
+    return allocate(bytes, 4);
+  case UploadKind::Uniform:
+    return allocate(bytes, uniform_alignment_);
+  }
+  return {};
+}
+
+UploadAllocation UploadRing::allocate(size_t bytes, size_t alignment) noexcept {
+  if (bytes == 0 || alignment == 0) {
+    return {};
+  }
+  if (!waited_) {
+    waitForRegion();
+  }
+
+  /* Aligned in the buffer, not the region, since regions needn't be a
+   * multiple of the alignment */
+  const size_t base = region_ * region_bytes_;
+  const size_t absolute =
+      (base + head_ + alignment - 1) / alignment * alignment;
+  const size_t offset = absolute - base;
+  if (offset > region_bytes_ || bytes > region_bytes_ - offset) {
+    ++stats_.failures;
+    return {};
+  }
+
+  if (!mapped_) {
+    /* The GPU is done with the rest of the region (its fence was waited
+     * on), so there is nothing for the driver to synchronize with */
+    const size_t end = base + region_bytes_;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+    mapped_ = static_cast<uint8_t *>(glMapBufferRange(
+        GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(absolute),
+        static_cast<GLsizeiptr>(end - absolute),
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+            GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    ++stats_.maps;
+    if (!mapped_) {
+      ++stats_.failures;
+      return {};
+    }
+    map_offset_ = absolute;
+  }
+
+  head_ = offset + bytes;
+  ++stats_.allocations;
+  stats_.bytes_streamed += bytes;
+  return {.data = mapped_ + (absolute - map_offset_),
+          .buffer = buffer_,
+          .offset = static_cast<GLintptr>(absolute),
+          .size = static_cast<GLsizeiptr>(bytes)};
+}
+
+void UploadRing::flush() noexcept {
+  /* Coherent persistent writes are visible to later commands as they are */
+  if (mode_ != Mode::Unsynchronized || !mapped_) {
+    return;
+  }
+  const size_t written = region_ * region_bytes_ + head_ - map_offset_;
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+  glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, 0,
+                           static_cast<GLsizeiptr>(written));
+  glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  mapped_ = nullptr;
+}
+
+void UploadRing::endFrame() noexcept {
+  flush();
+  if (head_ == 0) {
+    return;
+  }
+  fences_[region_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  region_ = (region_ + 1) % fences_.size();
+  head_ = 0;
+  waited_ = false;
+}
+
+UploadRing::Mode UploadRing::mode() const noexcept { return mode_; }
+GLuint UploadRing::buffer() const noexcept { return buffer_; }
+size_t UploadRing::regionBytes() const noexcept { return region_bytes_; }
+size_t UploadRing::regions() const noexcept { return fences_.size(); }
+
+const UploadRing::Stats &UploadRing::stats() const noexcept {
+  return stats_;
+}
+
+void UploadRing::waitForRegion() noexcept {
+  waited_ = true;
+  GLsync &fence = fences_[region_];
+  if (!fence) {
+    return;
+  }
+
+  /* Polled first, so only real waits count as stalls */
+  if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+    ++stats_.stalls;
+    const auto begin = Clock::now();
+    glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    stats_.stall_ns += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                             begin)
+            .count());
+  }
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+void UploadRing::release() noexcept {
+  for (GLsync &fence : fences_) {
+    if (fence) {
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+
+  /* Deleting the buffer also unmaps it */
+  glDeleteBuffers(1, &buffer_);
+  buffer_ = 0;
+  mapped_ = nullptr;
+}
@@ -1,14 +1,55 @@
 #include "window.h"
+#include "gl_capture.h"
+#include "gl_extensions.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
 #include <stdexcept>
 
+struct Window::Redraw {
+  /* Set from any thread; the rest belongs to the thread running update() */
+  std::atomic<bool> full{true};
+  bool redraw_on_input{};
+  bool animating{};
+
+  /* Bounding box of the partial damage, if any */
+  bool partial{};
+  int left{};
+  int top{};
+  int right{};
+  int bottom{};
+
+  double deadline{std::numeric_limits<double>::infinity()};
+
+  /* What the current frame redraws */
+  Rect damage{};
+};
+
+struct Window::Events {
+  Redraw *redraw{};
+  InputQueue *input{};
+
+  /* Framebuffer size as of the last resize. GLFW only answers size queries
+   * on the main thread, and frames may be rendered elsewhere */
+  struct Size {
+    int width{};
+    int height{};
+  };
+  std::atomic<Size> framebuffer{};
+};
+
 size_t Window::window_count_ = 0;
+bool Window::gl_loaded_ = false;
 
 Window::Window(size_t width, size_t height, std::string_view title,
                const NoExceptFunctor<void()> &init_cb,
                NoExceptFunctor<void()> render_cb,
-               NoExceptFunctor<void()> cleanup_cb)
+               NoExceptFunctor<void()> cleanup_cb,
+               const WindowOptions &options)
     : width_{width}, height_{height}, title_{title},
-      render_cb_{std::move(render_cb)}, cleanup_cb_{std::move(cleanup_cb)} {
+      render_cb_{std::move(render_cb)}, cleanup_cb_{std::move(cleanup_cb)},
+      headless_{options.headless} {
 
   /* Initialize the library */
   if (window_count_ == 0) {
@@ -22,6 +63,9 @@ Window::Window(size_t width, size_t height, std::string_view title,
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
   }
 
+  /* Headless windows are never shown */
+  glfwWindowHint(GLFW_VISIBLE, options.headless ? GLFW_FALSE : GLFW_TRUE);
+
   /* Initialze the GLFW window */
   if (window_ =
           glfwCreateWindow(width_, height_, title_.c_str(), nullptr, nullptr);
@@ -36,6 +80,47 @@ Window::Window(size_t width, size_t height, std::string_view title,
     throw std::runtime_error("Unable to load GL context");
   }
 
+  try {
+    /* Headless software frames never reach a GL framebuffer */
+    const bool gl_output = !(options.headless && options.software);
+    if (options.headless && gl_output) {
+      offscreen_ = std::make_unique<OffscreenTarget>(width_, height_);
+    }
+    if ((options.logical_width || options.logical_height) && gl_output) {
+      low_res_ = std::make_unique<LowResTarget>(options.logical_width,
+                                                options.logical_height);
+    }
+    if (options.frame_arena_bytes) {
+      frame_arena_ = std::make_unique<FrameArena>(options.frame_arena_bytes);
+    }
+    if (options.software) {
+      software_ = std::make_unique<SoftwareRasterizer>(
+          options.logical_width ? options.logical_width : width_,
+          options.logical_height ? options.logical_height : height_,
+          options.software_threads);
+    }
+    if (options.on_demand) {
+      redraw_ = std::make_unique<Redraw>();
+      redraw_->redraw_on_input = options.redraw_on_input;
+    }
+    if (options.input_events) {
+      input_ = std::make_unique<InputQueue>();
+    }
+    if (!headless_) {
+      events_ = std::make_unique<Events>(redraw_.get(), input_.get());
+      install_callbacks();
+    }
+  } catch (...) {
+    frame_arena_.reset();
+    low_res_.reset();
+    offscreen_.reset();
+    glfwDestroyWindow(window_);
+    window_ = nullptr;
+    throw;
+  }
+
+  bind_target();
+
   if (init_cb) {
     init_cb();
   }
@@ -51,7 +136,15 @@ Window::Window(Window &&other) noexcept
       width_{std::exchange(other.width_, 0)},
       height_{std::exchange(other.height_, 0)}, title_{std::move(other.title_)},
       render_cb_{std::move(other.render_cb_)},
-      cleanup_cb_{std::move(other.cleanup_cb_)} {}
+      cleanup_cb_{std::move(other.cleanup_cb_)},
+      profiler_{std::move(other.profiler_)},
+      offscreen_{std::move(other.offscreen_)},
+      low_res_{std::move(other.low_res_)},
+      frame_arena_{std::move(other.frame_arena_)},
+      software_{std::move(other.software_)},
+      headless_{std::exchange(other.headless_, false)},
+      input_{std::move(other.input_)}, redraw_{std::move(other.redraw_)},
+      events_{std::move(other.events_)} {}
 
 Window &Window::operator=(Window &&other) noexcept {
   if (this != &other) {
@@ -67,17 +160,157 @@ void Window::render() {
     throw std::runtime_error("Window is nullptr");
   }
 
+  FrameProfiler *const profiler = profiler_.get();
+  if (profiler) {
+    profiler->beginFrame();
+  }
+
   /* OpenGL rendering */
   if (!load_context()) {
     throw std::runtime_error("Unable to load GL context");
   }
 
+  GLCapture::beginFrame();
+  bind_target();
+
+  /* Partial redraws only touch the damaged area */
+  const bool scissor = take_damage();
+  if (scissor) {
+    const Rect &damage = redraw_->damage;
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(damage.x, target_rect().height - damage.y - damage.height,
+              damage.width, damage.height);
+  }
+
+  if (profiler) {
+    profiler->mark(FrameProfiler::Stage::Context);
+    profiler->beginGpu();
+  }
+
   if (render_cb_) {
     render_cb_();
   }
 
-  /* Swap front and back buffers */
-  glfwSwapBuffers(window_);
+  if (scissor) {
+    glDisable(GL_SCISSOR_TEST);
+  }
+
+  if (software_) {
+    software_->finish();
+    present_software();
+  }
+
+  present();
+
+  if (profiler) {
+    profiler->endGpu();
+    profiler->mark(FrameProfiler::Stage::Render);
+  }
+
+  /* Swap front and back buffers, or read the frame back when headless */
+  if (offscreen_) {
+    offscreen_->readback();
+  } else if (!headless_) {
+    glfwSwapBuffers(window_);
+  }
+
+  /* Input consumed before this point is now on screen */
+  if (input_) {
+    input_->presented(InputQueue::now());
+  }
+
+  if (profiler) {
+    profiler->mark(FrameProfiler::Stage::Swap);
+    profiler->endFrame();
+  }
+
+  GLCapture::endFrame();
+
+  /* Reclaim the transient data of the frame before this one */
+  if (frame_arena_) {
+    frame_arena_->endFrame();
+  }
+}
+
+bool Window::update() {
+  if (!window_) {
+    throw std::runtime_error("Window is nullptr");
+  }
+
+  if (!redraw_) {
+    pollEvents();
+    render();
+    return true;
+  }
+
+  /* Never sleep with work pending: that would add input latency */
+  if (needsRender()) {
+    glfwPollEvents();
+  } else if (std::isfinite(redraw_->deadline)) {
+    glfwWaitEventsTimeout(std::max(redraw_->deadline - glfwGetTime(), 0.0));
+  } else {
+    glfwWaitEvents();
+  }
+
+  if (!needsRender()) {
+    return false;
+  }
+  render();
+  return true;
+}
+
+bool Window::needsRender() const noexcept {
+  if (!redraw_) {
+    return true;
+  }
+  return redraw_->full.load(std::memory_order_acquire) || redraw_->partial ||
+         redraw_->animating || glfwGetTime() >= redraw_->deadline;
+}
+
+void Window::invalidate() noexcept {
+  if (redraw_) {
+    redraw_->full.store(true, std::memory_order_release);
+    glfwPostEmptyEvent();
+  }
+}
+
+void Window::invalidate(Rect rect) noexcept {
+  if (!redraw_ || rect.width <= 0 || rect.height <= 0) {
+    return;
+  }
+
+  Redraw &redraw = *redraw_;
+  const int right = rect.x + rect.width;
+  const int bottom = rect.y + rect.height;
+  if (redraw.partial) {
+    redraw.left = std::min(redraw.left, rect.x);
+    redraw.top = std::min(redraw.top, rect.y);
+    redraw.right = std::max(redraw.right, right);
+    redraw.bottom = std::max(redraw.bottom, bottom);
+  } else {
+    redraw.partial = true;
+    redraw.left = rect.x;
+    redraw.top = rect.y;
+    redraw.right = right;
+    redraw.bottom = bottom;
+  }
+}
+
+void Window::invalidateAfter(double seconds) noexcept {
+  if (redraw_) {
+    redraw_->deadline =
+        std::min(redraw_->deadline, glfwGetTime() + std::max(seconds, 0.0));
+  }
+}
+
+void Window::setAnimating(bool animating) noexcept {
+  if (redraw_) {
+    redraw_->animating = animating;
+  }
+}
+
+Window::Rect Window::damage() const noexcept {
+  return redraw_ ? redraw_->damage : target_rect();
 }
 
 bool Window::shouldClose() const noexcept {
@@ -90,21 +323,25 @@ void Window::destroy() noexcept {
     return;
   }
 
-  /* Call custom cleanup code */
-  if (cleanup_cb_ && load_context()) {
-    cleanup_cb_();
+  /* Call custom cleanup code and release GL objects owned by the window */
+  if (load_context()) {
+    if (cleanup_cb_) {
+      cleanup_cb_();
+    }
+    profiler_.reset();
+    offscreen_.reset();
+    low_res_.reset();
+    software_.reset();
   }
 
   glfwDestroyWindow(window_);
   window_ = nullptr;
+  frame_arena_.reset();
+  events_.reset();
+  redraw_.reset();
+  input_.reset();
 
-  /* Decrement window count */
-  --window_count_;
-
-  /* Terminate GLFW if all windows have been destroyed */
-  if (window_count_ == 0) {
-    glfwTerminate();
-  }
+  release_glfw();
 }
 
 void Window::pollEvents() noexcept {
@@ -112,10 +349,112 @@ void Window::pollEvents() noexcept {
   glfwPollEvents();
 }
 
+void Window::waitEvents(double timeout) noexcept {
+  glfwWaitEventsTimeout(timeout);
+}
+
+void Window::makeCurrent() {
+  if (!window_) {
+    throw std::runtime_error("Window is nullptr");
+  }
+
+  if (!load_context()) {
+    throw std::runtime_error("Unable to load GL context");
+  }
+}
+
+void Window::releaseContext() noexcept { glfwMakeContextCurrent(nullptr); }
+
+void Window::setSwapInterval(int interval) {
+  /* The interval belongs to the current context */
+  makeCurrent();
+  glfwSwapInterval(interval);
+}
+
 size_t Window::width() const noexcept { return width_; };
 size_t Window::height() const noexcept { return height_; };
 std::string_view Window::title() const noexcept { return title_; }
 
+void Window::setProfiling(bool enabled) {
+  if (enabled == static_cast<bool>(profiler_)) {
+    return;
+  }
+
+  if (!window_) {
+    throw std::runtime_error("Window is nullptr");
+  }
+
+  /* Query objects belong to this window's context */
+  if (!load_context()) {
+    throw std::runtime_error("Unable to load GL context");
+  }
+
+  if (enabled) {
+    profiler_ = std::make_unique<FrameProfiler>();
+  } else {
+    profiler_.reset();
+  }
+}
+
+FrameProfiler *Window::profiler() const noexcept { return profiler_.get(); }
+
+bool Window::headless() const noexcept { return headless_; }
+
+OffscreenTarget *Window::offscreen() const noexcept { return offscreen_.get(); }
+
+LowResTarget *Window::lowRes() const noexcept { return low_res_.get(); }
+
+FrameArena *Window::frameArena() const noexcept { return frame_arena_.get(); }
+
+SoftwareRasterizer *Window::software() const noexcept {
+  return software_.get();
+}
+
+InputQueue *Window::input() const noexcept { return input_.get(); }
+
+GLuint Window::framebuffer() const noexcept {
+  if (low_res_) {
+    return low_res_->framebuffer();
+  }
+  return offscreen_ ? offscreen_->framebuffer() : 0;
+}
+
+Window::SharedContext::SharedContext(const Window &window) {
+  if (!window.window_) {
+    throw std::runtime_error("Window is nullptr");
+  }
+
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  if (context_ = glfwCreateWindow(1, 1, "", nullptr, window.window_);
+      !context_) {
+    throw std::runtime_error("Unable to create shared GL context");
+  }
+
+  ++window_count_;
+}
+
+Window::SharedContext::~SharedContext() {
+  glfwDestroyWindow(context_);
+  release_glfw();
+}
+
+void Window::SharedContext::makeCurrent() const noexcept {
+  glfwMakeContextCurrent(context_);
+}
+
+void Window::release_glfw() noexcept {
+  /* Decrement window count */
+  --window_count_;
+
+  /* Terminate GLFW if all windows have been destroyed */
+  if (window_count_ == 0) {
+    glfwTerminate();
+
+    /* A new GLFW session may hand out contexts from a different driver */
+    gl_loaded_ = false;
+  }
+}
+
 void Window::swap(Window &other) {
   std::swap(window_, other.window_);
   std::swap(width_, other.width_);
@@ -123,13 +462,197 @@ void Window::swap(Window &other) {
   std::swap(title_, other.title_);
   std::swap(render_cb_, other.render_cb_);
   std::swap(cleanup_cb_, other.cleanup_cb_);
+  std::swap(profiler_, other.profiler_);
+  std::swap(offscreen_, other.offscreen_);
+  std::swap(low_res_, other.low_res_);
+  std::swap(frame_arena_, other.frame_arena_);
+  std::swap(software_, other.software_);
+  std::swap(headless_, other.headless_);
+  std::swap(input_, other.input_);
+  std::swap(redraw_, other.redraw_);
+  std::swap(events_, other.events_);
 }
 
 bool Window::load_context() noexcept {
-  /* Make the window's context current */
-  glfwMakeContextCurrent(window_);
+  /* Make the window's context current, unless it already is on this thread.
+   * glfwGetCurrentContext is a thread-local read, so this is cheap */
+  if (glfwGetCurrentContext() != window_) {
+    glfwMakeContextCurrent(window_);
+  }
 
   /* Load OpenGL functions
-   * Returns 0 on failure and non-zero on success */
-  return gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+   * Every window is created with the same context hints, so the function
+   * pointers GLAD resolves are valid for all of them and only need to be
+   * loaded once per GLFW session. gladLoadGLLoader returns 0 on failure */
+  if (!gl_loaded_) {
+    gl_loaded_ = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress) != 0 &&
+                 loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    /* Loading replaced any capture hooks with the driver's entry points */
+    if (gl_loaded_) {
+      GLCapture::reattach();
+    }
+  }
+
+  return gl_loaded_;
+}
+
+void Window::bind_target() const noexcept {
+  /* Plain windows leave whatever the callbacks last bound */
+  if (low_res_) {
+    low_res_->bind();
+  } else if (offscreen_) {
+    offscreen_->bind();
+  }
+}
+
+void Window::present() const noexcept {
+  if (!low_res_) {
+    return;
+  }
+
+  /* Scale the logical frame onto the headless target or the window */
+  if (offscreen_) {
+    low_res_->present(offscreen_->framebuffer(), offscreen_->width(),
+                      offscreen_->height());
+  } else {
+    const Rect target = framebuffer_rect();
+    low_res_->present(0, static_cast<size_t>(target.width),
+                      static_cast<size_t>(target.height));
+  }
+}
+
+void Window::present_software() const noexcept {
+  /* Headless software windows hand out pixels() directly */
+  if (headless_) {
+    return;
+  }
+
+  /* Straight into the logical target, which present() scales as usual */
+  if (low_res_) {
+    software_->present(low_res_->framebuffer(), low_res_->width(),
+                       low_res_->height());
+  } else {
+    const Rect target = framebuffer_rect();
+    software_->present(0, static_cast<size_t>(target.width),
+                       static_cast<size_t>(target.height));
+  }
+}
+
+Window::Rect Window::target_rect() const noexcept {
+  if (low_res_) {
+    return {0, 0, static_cast<int>(low_res_->width()),
+            static_cast<int>(low_res_->height())};
+  }
+  if (software_) {
+    return {0, 0, static_cast<int>(software_->width()),
+            static_cast<int>(software_->height())};
+  }
+  if (offscreen_) {
+    return {0, 0, static_cast<int>(width_), static_cast<int>(height_)};
+  }
+  return framebuffer_rect();
+}
+
+Window::Rect Window::framebuffer_rect() const noexcept {
+  if (!events_) {
+    return {};
+  }
+  const Events::Size size =
+      events_->framebuffer.load(std::memory_order_acquire);
+  return {0, 0, size.width, size.height};
+}
+
+bool Window::take_damage() noexcept {
+  if (!redraw_) {
+    return false;
+  }
+
+  Redraw &redraw = *redraw_;
+  bool full = redraw.full.exchange(false, std::memory_order_acq_rel) ||
+              redraw.animating || !redraw.partial;
+  if (glfwGetTime() >= redraw.deadline) {
+    redraw.deadline = std::numeric_limits<double>::infinity();
+    full = true;
+  }
+
+  /* Only framebuffers the window owns still hold the rest of the last
+   * frame. Software frames are uploaded whole */
+  full = full || !(low_res_ || offscreen_) || software_;
+
+  const Rect target = target_rect();
+  if (full) {
+    redraw.damage = target;
+  } else {
+    const int left = std::clamp(redraw.left, 0, target.width);
+    const int top = std::clamp(redraw.top, 0, target.height);
+    const int right = std::clamp(redraw.right, 0, target.width);
+    const int bottom = std::clamp(redraw.bottom, 0, target.height);
+    redraw.damage = {left, top, right - left, bottom - top};
+  }
+  redraw.partial = false;
+  return !full;
+}
+
+void Window::install_callbacks() noexcept {
+  glfwSetWindowUserPointer(window_, events_.get());
+
+  /* Seeded here, on the main thread; the resize callback keeps it current */
+  Events::Size size{};
+  glfwGetFramebufferSize(window_, &size.width, &size.height);
+  events_->framebuffer.store(size, std::memory_order_release);
+
+  /* Captureless, so they convert to GLFW's function pointers. Events are
+   * stamped as they arrive: GLFW delivers them from inside poll/wait, so
+   * this is as close to the OS event as the window gets */
+  static constexpr auto input = [](GLFWwindow *window,
+                                   InputEvent event) noexcept {
+    auto *events = static_cast<Events *>(glfwGetWindowUserPointer(window));
+    if (events->input) {
+      event.time = InputQueue::now();
+      events->input->push(event);
+    }
+    if (events->redraw && events->redraw->redraw_on_input) {
+      events->redraw->full.store(true, std::memory_order_release);
+    }
+  };
+  static constexpr auto expose = [](GLFWwindow *window) noexcept {
+    auto *events = static_cast<Events *>(glfwGetWindowUserPointer(window));
+    if (events->redraw) {
+      events->redraw->full.store(true, std::memory_order_release);
+    }
+  };
+
+  using Type = InputEvent::Type;
+  glfwSetKeyCallback(window_, [](GLFWwindow *w, int key, int scancode,
+                                 int action, int mods) {
+    input(w, {.type = Type::Key,
+              .action = action,
+              .mods = mods,
+              .code = key,
+              .scancode = scancode});
+  });
+  glfwSetCharCallback(window_, [](GLFWwindow *w, unsigned int codepoint) {
+    input(w, {.type = Type::Char, .code = static_cast<int>(codepoint)});
+  });
+  glfwSetCursorPosCallback(window_, [](GLFWwindow *w, double x, double y) {
+    input(w, {.type = Type::CursorPos, .x = x, .y = y});
+  });
+  glfwSetMouseButtonCallback(
+      window_, [](GLFWwindow *w, int button, int action, int mods) {
+        input(w, {.type = Type::MouseButton,
+                  .action = action,
+                  .mods = mods,
+                  .code = button});
+      });
+  glfwSetScrollCallback(window_, [](GLFWwindow *w, double x, double y) {
+    input(w, {.type = Type::Scroll, .x = x, .y = y});
+  });
+  glfwSetFramebufferSizeCallback(
+      window_, [](GLFWwindow *w, int width, int height) {
+        auto *events = static_cast<Events *>(glfwGetWindowUserPointer(w));
+        events->framebuffer.store({width, height}, std::memory_order_release);
+        expose(w);
+      });
+  glfwSetWindowRefreshCallback(window_, [](GLFWwindow *w) { expose(w); });
 }
@@ -0,0 +1,116 @@
+#include "window_presenter.h"
+#include "gl_capture.h"
+
+WindowPresenter::WindowPresenter(Threading threading, bool vsync)
+    : threading_{threading}, vsync_{vsync} {}
+
+WindowPresenter::~WindowPresenter() {
+  {
+    std::lock_guard lock{mutex_};
+    stopping_ = true;
+  }
+  start_.notify_all();
+
+  for (auto &slot : slots_) {
+    if (slot->thread.joinable()) {
+      slot->thread.join();
+    }
+  }
+}
+
+size_t WindowPresenter::add(Window window) {
+  auto slot = std::make_unique<Slot>(std::move(window));
+
+  /* Window 0 leads: it is the only one that waits for vsync */
+  slot->window.setSwapInterval(vsync_ && slots_.empty() ? 1 : 0);
+
+  if (threading_ == Threading::PerWindow) {
+    Window::releaseContext();
+    slot->thread =
+        std::thread{&WindowPresenter::run, this, std::ref(*slot), generation_};
+  }
+
+  slots_.push_back(std::move(slot));
+  return slots_.size() - 1;
+}
+
+void WindowPresenter::present() {
+  if (threading_ == Threading::SingleThread) {
+    /* The leader goes last so its wait doesn't delay the other swaps */
+    for (size_t i = 1; i < slots_.size(); ++i) {
+      slots_[i]->window.render();
+    }
+    if (!slots_.empty()) {
+      slots_[0]->window.render();
+    }
+    ++frames_;
+    return;
+  }
+
+  {
+    std::lock_guard lock{mutex_};
+    pending_ = slots_.size();
+    ++generation_;
+  }
+  start_.notify_all();
+
+  {
+    std::unique_lock lock{mutex_};
+    done_.wait(lock, [this] { return pending_ == 0; });
+  }
+  ++frames_;
+
+  for (auto &slot : slots_) {
+    if (slot->error) {
+      std::rethrow_exception(std::exchange(slot->error, nullptr));
+    }
+  }
+}
+
+bool WindowPresenter::shouldClose() const noexcept {
+  for (const auto &slot : slots_) {
+    if (slot->window.shouldClose()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Window &WindowPresenter::window(size_t index) noexcept {
+  return slots_[index]->window;
+}
+
+size_t WindowPresenter::size() const noexcept { return slots_.size(); }
+uint64_t WindowPresenter::frames() const noexcept { return frames_; }
+
+void WindowPresenter::run(Slot &slot, uint64_t generation) noexcept {
+  /* Record this window's frames if a capture is running */
+  GLCapture::attach();
+  for (;;) {
+    {
+      std::unique_lock lock{mutex_};
+      start_.wait(lock, [&] { return stopping_ || generation_ != generation; });
+      if (stopping_) {
+        break;
+      }
+      generation = generation_;
+    }
+
+    try {
+      slot.window.render();
+    } catch (...) {
+      slot.error = std::current_exception();
+    }
+
+    {
+      std::lock_guard lock{mutex_};
+      if (--pending_ == 0) {
+        done_.notify_one();
+      }
+    }
+  }
+
+  /* Let the presenter's thread reclaim the context to destroy the window */
+  GLCapture::detach();
+  Window::releaseContext();
+}
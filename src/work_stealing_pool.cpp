@@ -0,0 +1,130 @@
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(size_t threads) {
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  for (size_t i = 0; i < threads; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+
+  /* Queue 0 belongs to the thread calling parallelFor() */
+  workers_.reserve(threads - 1);
+  try {
+    for (size_t i = 1; i < threads; ++i) {
+      workers_.emplace_back(&WorkStealingPool::loop, this, i);
+    }
+  } catch (...) {
+    /* Joinable threads must not be destroyed */
+    stop();
+    throw;
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() { stop(); }
+
+size_t WorkStealingPool::size() const noexcept { return queues_.size(); }
+
+uint64_t WorkStealingPool::steals() const noexcept {
+  return steals_.load(std::memory_order_relaxed);
+}
+
+void WorkStealingPool::run(size_t count, void *context, Call call) {
+  if (count == 0) {
+    return;
+  }
+  if (workers_.empty() || count == 1) {
+    for (size_t i = 0; i < count; ++i) {
+      call(context, i);
+    }
+    return;
+  }
+
+  /* Published before any index, so whoever pops one sees the body */
+  context_ = context;
+  call_ = call;
+  remaining_.store(count, std::memory_order_relaxed);
+
+  const size_t queues = queues_.size();
+  for (size_t q = 0; q < queues; ++q) {
+    Queue &queue = *queues_[q];
+    std::lock_guard lock{queue.mutex};
+    for (size_t i = q * count / queues; i < (q + 1) * count / queues; ++i) {
+      queue.jobs.push_back(i);
+    }
+  }
+
+  {
+    std::lock_guard lock{mutex_};
+    ++epoch_;
+  }
+  wake_.notify_all();
+
+  work(0);
+  while (remaining_.load(std::memory_order_acquire) != 0) {
+    std::this_thread::yield();
+  }
+}
+
+void WorkStealingPool::work(size_t self) noexcept {
+  size_t job = 0;
+  while (take(self, job)) {
+    call_(context_, job);
+    remaining_.fetch_sub(1, std::memory_order_acq_rel);
+  }
+}
+
+bool WorkStealingPool::take(size_t self, size_t &job) noexcept {
+  {
+    Queue &own = *queues_[self];
+    std::lock_guard lock{own.mutex};
+    if (!own.jobs.empty()) {
+      job = own.jobs.front();
+      own.jobs.pop_front();
+      return true;
+    }
+  }
+
+  /* Steal from the far end, away from where the owner is working */
+  for (size_t offset = 1; offset < queues_.size(); ++offset) {
+    Queue &victim = *queues_[(self + offset) % queues_.size()];
+    std::lock_guard lock{victim.mutex};
+    if (!victim.jobs.empty()) {
+      job = victim.jobs.back();
+      victim.jobs.pop_back();
+      steals_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::stop() noexcept {
+  {
+    std::lock_guard lock{mutex_};
+    stopping_ = true;
+  }
+  wake_.notify_all();
+
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void WorkStealingPool::loop(size_t self) noexcept {
+  uint64_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock lock{mutex_};
+      wake_.wait(lock, [this, seen] { return stopping_ || epoch_ != seen; });
+      if (stopping_) {
+        return;
+      }
+      seen = epoch_;
+    }
+    work(self);
+  }
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include "asset_archive.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+static std::vector<uint8_t> bytesOf(std::string_view s) {
+  return {s.begin(), s.end()};
+}
+
+static std::string stringOf(std::span<const uint8_t> span) {
+  return {span.begin(), span.end()};
+}
+
+/* Fresh archive path per test, removed afterwards */
+class AssetArchiveTest : public ::testing::Test {
+protected:
+  std::filesystem::path dir_ =
+      std::filesystem::temp_directory_path() /
+      ("libretro_archive_" +
+       std::string{
+           ::testing::UnitTest::GetInstance()->current_test_info()->name()});
+  std::filesystem::path pak_ = dir_ / "assets.pak";
+
+  void SetUp() override {
+    std::filesystem::remove_all(dir_);
+    std::filesystem::create_directories(dir_);
+  }
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+};
+
+// ---------------------------------------------------------------------------
+// Round trip
+// ---------------------------------------------------------------------------
+TEST_F(AssetArchiveTest, FindReturnsStoredBytes) {
+  AssetArchiveBuilder builder;
+  builder.add("shaders/quad.vs", bytesOf("vertex"));
+  builder.add("shaders/quad.fs", bytesOf("fragment"));
+  builder.add("empty", {});
+  builder.write(pak_);
+
+  AssetArchive archive{pak_};
+  EXPECT_EQ(archive.size(), 3u);
+  ASSERT_TRUE(archive.find("shaders/quad.vs"));
+  EXPECT_EQ(stringOf(*archive.find("shaders/quad.vs")), "vertex");
+  EXPECT_EQ(stringOf(*archive.find("shaders/quad.fs")), "fragment");
+  ASSERT_TRUE(archive.find("empty"));
+  EXPECT_TRUE(archive.find("empty")->empty());
+}
+
+TEST_F(AssetArchiveTest, MissingNameIsNullopt) {
+  AssetArchiveBuilder builder;
+  builder.add("a", bytesOf("1"));
+  builder.write(pak_);
+
+  AssetArchive archive{pak_};
+  EXPECT_FALSE(archive.find("b"));
+  EXPECT_FALSE(archive.contains(""));
+  EXPECT_TRUE(archive.contains("a"));
+}
+
+TEST_F(AssetArchiveTest, EntriesAreAligned) {
+  AssetArchiveBuilder builder;
+  for (int i = 0; i < 10; ++i) {
+    builder.add("entry" + std::to_string(i),
+                std::vector<uint8_t>(static_cast<size_t>(i * 7 + 1), 0xAB));
+  }
+  builder.write(pak_);
+
+  AssetArchive archive{pak_};
+  for (int i = 0; i < 10; ++i) {
+    const auto span = archive.find("entry" + std::to_string(i));
+    ASSERT_TRUE(span);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(span->data()) %
+                  AssetArchive::kAlignment,
+              0u);
+    EXPECT_EQ(span->size(), static_cast<size_t>(i * 7 + 1));
+  }
+}
+
+TEST_F(AssetArchiveTest, ManyEntriesAllFound) {
+  AssetArchiveBuilder builder;
+  for (int i = 0; i < 2000; ++i) {
+    builder.add("asset/" + std::to_string(i), bytesOf(std::to_string(i * i)));
+  }
+  builder.write(pak_);
+
+  AssetArchive archive{pak_};
+  for (int i = 0; i < 2000; ++i) {
+    const auto span = archive.find("asset/" + std::to_string(i));
+    ASSERT_TRUE(span) << i;
+    EXPECT_EQ(stringOf(*span), std::to_string(i * i));
+  }
+}
+
+TEST_F(AssetArchiveTest, NamesListIndexOrder) {
+  AssetArchiveBuilder builder;
+  builder.add("x", {});
+  builder.add("y", {});
+  builder.write(pak_);
+
+  AssetArchive archive{pak_};
+  std::vector<std::string> names{std::string{archive.name(0)},
+                                 std::string{archive.name(1)}};
+  std::sort(names.begin(), names.end());
+  EXPECT_EQ(names, (std::vector<std::string>{"x", "y"}));
+  EXPECT_TRUE(archive.name(2).empty());
+}
+
+TEST_F(AssetArchiveTest, AddFileReadsContents) {
+  {
+    std::ofstream out{dir_ / "level.bin", std::ios::binary};
+    out << "tiles";
+  }
+  AssetArchiveBuilder builder;
+  builder.addFile("level", dir_ / "level.bin");
+  builder.write(pak_);
+
+  AssetArchive archive{pak_};
+  EXPECT_EQ(stringOf(*archive.find("level")), "tiles");
+  EXPECT_THROW(builder.addFile("missing", dir_ / "missing.bin"),
+               std::runtime_error);
+}
+
+// ---------------------------------------------------------------------------
+// Errors
+// ---------------------------------------------------------------------------
+TEST_F(AssetArchiveTest, DuplicateOrEmptyNameThrows) {
+  AssetArchiveBuilder builder;
+  builder.add("a", {});
+  EXPECT_THROW(builder.add("a", {}), std::invalid_argument);
+  EXPECT_THROW(builder.add("", {}), std::invalid_argument);
+  EXPECT_EQ(builder.size(), 1u);
+}
+
+TEST_F(AssetArchiveTest, MissingFileThrows) {
+  EXPECT_THROW(AssetArchive{dir_ / "missing.pak"}, std::runtime_error);
+}
+
+TEST_F(AssetArchiveTest, CorruptHeaderThrows) {
+  {
+    std::ofstream out{pak_, std::ios::binary};
+    out << "not an archive at all, just some text that is long enough";
+  }
+  EXPECT_THROW(AssetArchive{pak_}, std::runtime_error);
+}
+
+TEST_F(AssetArchiveTest, TruncatedIndexThrows) {
+  AssetArchiveBuilder builder;
+  builder.add("a", bytesOf("contents"));
+  builder.add("b", bytesOf("contents"));
+  builder.write(pak_);
+  std::filesystem::resize_file(pak_, std::filesystem::file_size(pak_) - 40);
+  EXPECT_THROW(AssetArchive{pak_}, std::runtime_error);
+}
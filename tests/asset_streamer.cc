@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+
+#include "asset_streamer.h"
+#include "render_thread.h"
+#include "window.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helpers: a headless window, asset files on disk, and polling until an
+// asset leaves the Loading state
+// ---------------------------------------------------------------------------
+static Window makeWindow() {
+  return Window{16,        16, "Assets", []() noexcept {}, []() noexcept {},
+                []() noexcept {}, WindowOptions{.headless = true}};
+}
+
+static void writeFile(const std::filesystem::path &path,
+                      const std::string &contents) {
+  std::ofstream out{path, std::ios::binary};
+  out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+/* PPM whose pixel i is (i, 2i, 3i) */
+static std::string ppm(size_t width, size_t height) {
+  std::string file = "P6\n# test image\n" + std::to_string(width) + " " +
+                     std::to_string(height) + "\n255\n";
+  for (size_t i = 0; i < width * height; ++i) {
+    file += static_cast<char>(i);
+    file += static_cast<char>(i * 2);
+    file += static_cast<char>(i * 3);
+  }
+  return file;
+}
+
+static AssetStreamer::Status waitFor(AssetStreamer &assets,
+                                     AssetStreamer::Id id) {
+  assets.finish();
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds{10};
+  auto status = assets.status(id);
+  while (status == AssetStreamer::Status::Loading &&
+         std::chrono::steady_clock::now() < deadline) {
+    glFinish();
+    status = assets.status(id);
+  }
+  return status;
+}
+
+/* Fresh asset directory per test, removed afterwards */
+class AssetStreamerTest : public ::testing::Test {
+protected:
+  std::filesystem::path dir_ =
+      std::filesystem::temp_directory_path() /
+      ("libretro_assets_" +
+       std::string{
+           ::testing::UnitTest::GetInstance()->current_test_info()->name()});
+
+  void SetUp() override {
+    std::filesystem::remove_all(dir_);
+    std::filesystem::create_directories(dir_);
+  }
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+};
+
+// ---------------------------------------------------------------------------
+// Textures
+// ---------------------------------------------------------------------------
+TEST_F(AssetStreamerTest, TextureUploadsDecodedPixels) {
+  writeFile(dir_ / "a.ppm", ppm(4, 2));
+  auto w = makeWindow();
+  AssetStreamer assets{w};
+
+  const auto id = assets.loadTexture(dir_ / "a.ppm");
+  ASSERT_EQ(waitFor(assets, id), AssetStreamer::Status::Ready);
+  EXPECT_EQ(assets.width(id), 4u);
+  EXPECT_EQ(assets.height(id), 2u);
+  EXPECT_EQ(assets.bytes(id), 4u * 2u * 4u);
+
+  /* Read back on the window's own context */
+  std::vector<uint8_t> pixels(4 * 2 * 4);
+  glBindTexture(GL_TEXTURE_2D, assets.name(id));
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+  for (size_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(pixels[i * 4], i);
+    EXPECT_EQ(pixels[i * 4 + 1], i * 2);
+    EXPECT_EQ(pixels[i * 4 + 2], i * 3);
+    EXPECT_EQ(pixels[i * 4 + 3], 255);
+  }
+  EXPECT_EQ(assets.stats().pbo_uploads, 1u);
+}
+
+TEST_F(AssetStreamerTest, NameIsZeroUntilReady) {
+  writeFile(dir_ / "a.ppm", ppm(2, 2));
+  auto w = makeWindow();
+  AssetStreamer assets{w};
+  const auto id = assets.loadTexture(dir_ / "a.ppm");
+  if (assets.status(id) == AssetStreamer::Status::Loading) {
+    EXPECT_EQ(assets.name(id), 0u);
+  }
+  ASSERT_EQ(waitFor(assets, id), AssetStreamer::Status::Ready);
+  EXPECT_NE(assets.name(id), 0u);
+}
+
+TEST_F(AssetStreamerTest, OversizedTextureUploadsDirectly) {
+  /* 1024x1025 RGBA8 is just over one ring slot */
+  writeFile(dir_ / "big.ppm", ppm(1024, 1025));
+  auto w = makeWindow();
+  AssetStreamer assets{w};
+  const auto id = assets.loadTexture(dir_ / "big.ppm");
+  ASSERT_EQ(waitFor(assets, id), AssetStreamer::Status::Ready);
+  EXPECT_EQ(assets.stats().direct_uploads, 1u);
+  EXPECT_EQ(assets.stats().pbo_uploads, 0u);
+}
+
+TEST_F(AssetStreamerTest, ManyTexturesCycleTheRing) {
+  auto w = makeWindow();
+  AssetStreamer assets{w, 4};
+  std::vector<AssetStreamer::Id> ids;
+  for (int i = 0; i < 3 * static_cast<int>(AssetStreamer::kPboCount); ++i) {
+    const auto path = dir_ / (std::to_string(i) + ".ppm");
+    writeFile(path, ppm(16, 16));
+    ids.push_back(assets.loadTexture(path));
+  }
+  for (auto id : ids) {
+    EXPECT_EQ(waitFor(assets, id), AssetStreamer::Status::Ready);
+  }
+  EXPECT_EQ(assets.stats().pbo_uploads, ids.size());
+  EXPECT_EQ(assets.stats().bytes_uploaded, ids.size() * 16 * 16 * 4);
+}
+
+// ---------------------------------------------------------------------------
+// Buffers
+// ---------------------------------------------------------------------------
+TEST_F(AssetStreamerTest, BufferUploadsFileContents) {
+  writeFile(dir_ / "mesh.bin", "vertex data");
+  auto w = makeWindow();
+  AssetStreamer assets{w};
+  const auto id = assets.loadBuffer(dir_ / "mesh.bin");
+  ASSERT_EQ(waitFor(assets, id), AssetStreamer::Status::Ready);
+  EXPECT_EQ(assets.bytes(id), 11u);
+
+  char contents[11]{};
+  glBindBuffer(GL_COPY_READ_BUFFER, assets.name(id));
+  glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(contents), contents);
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  EXPECT_EQ(std::string(contents, sizeof(contents)), "vertex data");
+}
+
+// ---------------------------------------------------------------------------
+// Failures
+// ---------------------------------------------------------------------------
+TEST_F(AssetStreamerTest, MissingFileFails) {
+  auto w = makeWindow();
+  AssetStreamer assets{w};
+  const auto id = assets.loadTexture(dir_ / "missing.ppm");
+  EXPECT_EQ(waitFor(assets, id), AssetStreamer::Status::Failed);
+  EXPECT_EQ(assets.name(id), 0u);
+  EXPECT_EQ(assets.stats().failed, 1u);
+}
+
+TEST_F(AssetStreamerTest, MalformedImagesFail) {
+  writeFile(dir_ / "ascii.ppm", "P3\n1 1\n255\n0 0 0\n");
+  writeFile(dir_ / "short.ppm", "P6\n4 4\n255\nabc");
+  writeFile(dir_ / "deep.ppm", "P6\n1 1\n65535\n012345");
+  auto w = makeWindow();
+  AssetStreamer assets{w};
+  for (const char *name : {"ascii.ppm", "short.ppm", "deep.ppm"}) {
+    EXPECT_EQ(waitFor(assets, assets.loadTexture(dir_ / name)),
+              AssetStreamer::Status::Failed)
+        << name;
+  }
+}
+
+TEST_F(AssetStreamerTest, UnknownIdFails) {
+  auto w = makeWindow();
+  AssetStreamer assets{w};
+  EXPECT_EQ(assets.status(42), AssetStreamer::Status::Failed);
+  EXPECT_EQ(assets.name(42), 0u);
+}
+
+TEST_F(AssetStreamerTest, FullStreamerThrows) {
+  auto w = makeWindow();
+  AssetStreamer assets{w, 1, 1};
+  assets.loadBuffer(dir_ / "a");
+  EXPECT_THROW(assets.loadBuffer(dir_ / "b"), std::runtime_error);
+}
+
+// ---------------------------------------------------------------------------
+// With a render thread
+// ---------------------------------------------------------------------------
+TEST_F(AssetStreamerTest, RenderThreadSeesStreamedTexture) {
+  writeFile(dir_ / "a.ppm", ppm(8, 8));
+  AssetStreamer *streamer = nullptr;
+  AssetStreamer::Id id{};
+  std::atomic<bool> ready{false};
+
+  Window w{16,
+           16,
+           "Assets",
+           []() noexcept {},
+           [&]() noexcept {
+             if (streamer && streamer->status(id) ==
+                                 AssetStreamer::Status::Ready) {
+               ready.store(true);
+             }
+           },
+           []() noexcept {},
+           WindowOptions{.headless = true}};
+
+  AssetStreamer assets{w};
+  id = assets.loadTexture(dir_ / "a.ppm");
+  streamer = &assets;
+
+  RenderThread renderer{w};
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds{10};
+  while (!ready.load() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+  renderer.stop();
+  EXPECT_TRUE(ready.load());
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include "atlas_packer.h"
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helper: no two placements on the same page overlap, and all stay inside
+// ---------------------------------------------------------------------------
+struct Placed {
+  AtlasPacker::Placement at;
+  AtlasPacker::Size size;
+};
+
+static bool disjointAndInside(const AtlasPacker &packer,
+                              const std::vector<Placed> &placed) {
+  for (size_t i = 0; i < placed.size(); ++i) {
+    const auto &a = placed[i];
+    if (a.at.x + a.size.width > packer.pageWidth() ||
+        a.at.y + a.size.height > packer.pageHeight() ||
+        a.at.page >= packer.pages()) {
+      return false;
+    }
+    for (size_t j = i + 1; j < placed.size(); ++j) {
+      const auto &b = placed[j];
+      if (a.at.page == b.at.page && a.at.x < b.at.x + b.size.width &&
+          b.at.x < a.at.x + a.size.width && a.at.y < b.at.y + b.size.height &&
+          b.at.y < a.at.y + a.size.height) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Online packing
+// ---------------------------------------------------------------------------
+TEST(AtlasPacker, RejectsEmptyPages) {
+  EXPECT_THROW(AtlasPacker(0, 16), std::invalid_argument);
+  EXPECT_THROW(AtlasPacker(16, 0), std::invalid_argument);
+  EXPECT_THROW(AtlasPacker(16, 16, 0), std::invalid_argument);
+}
+
+TEST(AtlasPacker, FillsBottomLeftFirst) {
+  AtlasPacker packer{16, 16};
+  const auto a = packer.insert({8, 4});
+  const auto b = packer.insert({8, 2});
+  const auto c = packer.insert({4, 4});
+  ASSERT_TRUE(a && b && c);
+  EXPECT_EQ(a->x, 0u);
+  EXPECT_EQ(a->y, 0u);
+  EXPECT_EQ(b->x, 8u);
+  EXPECT_EQ(b->y, 0u);
+
+  /* Lowest top edge: resting on b beats resting on a */
+  EXPECT_EQ(c->x, 8u);
+  EXPECT_EQ(c->y, 2u);
+}
+
+TEST(AtlasPacker, RejectsEmptyAndOversizedRects) {
+  AtlasPacker packer{16, 16, 4};
+  EXPECT_FALSE(packer.insert({0, 4}));
+  EXPECT_FALSE(packer.insert({17, 4}));
+  EXPECT_FALSE(packer.insert({4, 17}));
+  EXPECT_EQ(packer.pages(), 1u);
+}
+
+TEST(AtlasPacker, OpensPagesUntilTheLimit) {
+  AtlasPacker packer{8, 8, 2};
+  const auto a = packer.insert({8, 8});
+  const auto b = packer.insert({4, 4});
+  ASSERT_TRUE(a && b);
+  EXPECT_EQ(a->page, 0u);
+  EXPECT_EQ(b->page, 1u);
+  EXPECT_EQ(packer.pages(), 2u);
+
+  /* Fits in what's left of page 1, then nothing fits anywhere */
+  EXPECT_TRUE(packer.insert({4, 8}));
+  EXPECT_FALSE(packer.insert({8, 8}));
+  EXPECT_EQ(packer.pages(), 2u);
+}
+
+TEST(AtlasPacker, ExactFitFillsThePage) {
+  AtlasPacker packer{16, 16};
+  for (int i = 0; i < 16; ++i) {
+    ASSERT_TRUE(packer.insert({4, 4})) << i;
+  }
+  EXPECT_DOUBLE_EQ(packer.occupancy(), 1.0);
+  EXPECT_FALSE(packer.insert({1, 1}));
+}
+
+TEST(AtlasPacker, RandomRectsNeverOverlap) {
+  AtlasPacker packer{128, 128, 4};
+  std::mt19937 rng{7};
+  std::uniform_int_distribution<uint32_t> side{1, 24};
+
+  std::vector<Placed> placed;
+  for (int i = 0; i < 400; ++i) {
+    const AtlasPacker::Size size{side(rng), side(rng)};
+    if (const auto at = packer.insert(size)) {
+      placed.push_back({*at, size});
+    }
+  }
+  EXPECT_GT(placed.size(), 100u);
+  EXPECT_TRUE(disjointAndInside(packer, placed));
+}
+
+// ---------------------------------------------------------------------------
+// Offline packing
+// ---------------------------------------------------------------------------
+TEST(AtlasPacker, InsertAllKeepsInputOrder) {
+  AtlasPacker packer{32, 32};
+  const std::vector<AtlasPacker::Size> sizes{{4, 2}, {8, 16}, {4, 8}};
+  const auto placements = packer.insertAll(sizes);
+  ASSERT_EQ(placements.size(), 3u);
+
+  std::vector<Placed> placed;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    ASSERT_TRUE(placements[i]);
+    placed.push_back({*placements[i], sizes[i]});
+  }
+  EXPECT_TRUE(disjointAndInside(packer, placed));
+
+  /* Tallest first: the 8x16 went in at the origin */
+  EXPECT_EQ(placements[1]->x, 0u);
+  EXPECT_EQ(placements[1]->y, 0u);
+}
+
+TEST(AtlasPacker, InsertAllPacksAtLeastAsTightly) {
+  std::mt19937 rng{11};
+  std::uniform_int_distribution<uint32_t> side{8, 48};
+  std::vector<AtlasPacker::Size> sizes(300);
+  for (auto &size : sizes) {
+    size = {side(rng), side(rng)};
+  }
+
+  AtlasPacker online{256, 256, 16};
+  for (const auto &size : sizes) {
+    ASSERT_TRUE(online.insert(size));
+  }
+  AtlasPacker offline{256, 256, 16};
+  for (const auto &at : offline.insertAll(sizes)) {
+    ASSERT_TRUE(at);
+  }
+  EXPECT_LE(offline.pages(), online.pages());
+}
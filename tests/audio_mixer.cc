@@ -0,0 +1,333 @@
+#include <gtest/gtest.h>
+
+#include "audio_mixer.h"
+#include "heap_counter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+constexpr AudioFormat kFormat{.sample_rate = 48000, .period_frames = 256};
+
+static std::vector<float> noise(size_t count, uint32_t seed) {
+  std::mt19937 rng{seed};
+  std::uniform_real_distribution<float> sample{-1.0f, 1.0f};
+  std::vector<float> samples(count);
+  for (float &s : samples) {
+    s = sample(rng);
+  }
+  return samples;
+}
+
+/* A period mixed offline */
+static std::vector<float> mixPeriod(AudioMixer &mixer,
+                                    size_t frames = kFormat.period_frames) {
+  std::vector<float> out(frames * 2);
+  mixer.mix(out);
+  return out;
+}
+
+// ---------------------------------------------------------------------------
+// Mixing
+// ---------------------------------------------------------------------------
+TEST(AudioMixer, RejectsZeroVoices) {
+  NullAudioSink sink{kFormat};
+  EXPECT_THROW(AudioMixer(sink, 0), std::invalid_argument);
+}
+
+TEST(AudioMixer, SilentWithoutVoices) {
+  NullAudioSink sink{kFormat};
+  AudioMixer mixer{sink};
+  for (float s : mixPeriod(mixer)) {
+    ASSERT_EQ(s, 0.0f);
+  }
+}
+
+TEST(AudioMixer, PansWithConstantPower) {
+  NullAudioSink sink{kFormat};
+  AudioMixer mixer{sink};
+  const std::vector<float> dc(1000, 0.5f);
+
+  const VoiceId voice = mixer.play({.samples = dc}, {.pan = -1.0f});
+  auto out = mixPeriod(mixer);
+  EXPECT_FLOAT_EQ(out[0], 0.5f);
+  EXPECT_FLOAT_EQ(out[1], 0.0f);
+
+  /* Centred, each side gets 1 / sqrt(2) */
+  mixer.set(voice, {.volume = 0.5f});
+  out = mixPeriod(mixer);
+  EXPECT_NEAR(out[0], 0.25f * std::sqrt(0.5f), 1e-6f);
+  EXPECT_FLOAT_EQ(out[0], out[1]);
+}
+
+TEST(AudioMixer, ResamplesByPitchAndRate) {
+  std::vector<float> ramp(1000);
+  for (size_t i = 0; i < ramp.size(); ++i) {
+    ramp[i] = static_cast<float>(i) / 1000.0f;
+  }
+  NullAudioSink sink{kFormat};
+
+  /* A ramp at half the output rate, played at double pitch, comes out
+   * sample for sample */
+  AudioMixer fast{sink};
+  fast.play({.samples = ramp, .sample_rate = 24000},
+            {.pan = -1.0f, .pitch = 2.0f});
+  auto out = mixPeriod(fast);
+  for (size_t i = 0; i < kFormat.period_frames; ++i) {
+    ASSERT_FLOAT_EQ(out[2 * i], ramp[i]) << i;
+  }
+
+  /* Half pitch lands halfway between samples on odd frames */
+  AudioMixer slow{sink};
+  slow.play({.samples = ramp}, {.pan = -1.0f, .pitch = 0.5f});
+  out = mixPeriod(slow);
+  EXPECT_FLOAT_EQ(out[2 * 2], ramp[1]);
+  EXPECT_FLOAT_EQ(out[2 * 3], (ramp[1] + ramp[2]) * 0.5f);
+}
+
+TEST(AudioMixer, OneShotVoicesEndAndLoopsWrap) {
+  NullAudioSink sink{kFormat};
+  AudioMixer mixer{sink};
+  const std::vector<float> clip(100, 0.25f);
+
+  mixer.play({.samples = clip}, {.pan = -1.0f});
+  mixer.play({.samples = clip}, {.pan = 1.0f, .loop = true});
+  auto out = mixPeriod(mixer);
+  EXPECT_FLOAT_EQ(out[2 * 50], 0.25f);
+  EXPECT_EQ(out[2 * 150], 0.0f);
+  EXPECT_FLOAT_EQ(out[2 * 150 + 1], 0.25f);
+  EXPECT_FLOAT_EQ(out[2 * 250 + 1], 0.25f);
+  EXPECT_EQ(mixer.activeVoices(), 1u);
+}
+
+TEST(AudioMixer, StopsVoices) {
+  NullAudioSink sink{kFormat};
+  AudioMixer mixer{sink};
+  const std::vector<float> clip(100, 0.25f);
+  const VoiceId voice = mixer.play({.samples = clip}, {.loop = true});
+  mixPeriod(mixer);
+  EXPECT_EQ(mixer.activeVoices(), 1u);
+
+  mixer.stop(voice);
+  for (float s : mixPeriod(mixer)) {
+    ASSERT_EQ(s, 0.0f);
+  }
+  EXPECT_EQ(mixer.activeVoices(), 0u);
+}
+
+TEST(AudioMixer, StealsTheOldestVoiceWhenFull) {
+  NullAudioSink sink{kFormat};
+  AudioMixer mixer{sink, 2};
+  const std::vector<float> a(1000, 0.125f), b(1000, 0.25f), c(1000, 0.5f);
+  mixer.play({.samples = a}, {.pan = -1.0f});
+  mixer.play({.samples = b}, {.pan = -1.0f});
+  mixer.play({.samples = c}, {.pan = -1.0f});
+
+  const auto out = mixPeriod(mixer);
+  EXPECT_FLOAT_EQ(out[0], 0.75f);
+  EXPECT_EQ(mixer.stats().stolen_voices, 1u);
+}
+
+TEST(AudioMixer, ClampsTheMasterOutput) {
+  NullAudioSink sink{kFormat};
+  AudioMixer mixer{sink};
+  const std::vector<float> loud(1000, 0.9f);
+  mixer.play({.samples = loud}, {.pan = -1.0f});
+  mixer.play({.samples = loud}, {.pan = -1.0f});
+  EXPECT_FLOAT_EQ(mixPeriod(mixer)[0], 1.0f);
+
+  mixer.setMasterVolume(0.5f);
+  EXPECT_FLOAT_EQ(mixPeriod(mixer)[0], 0.9f);
+}
+
+TEST(AudioMixer, CountsDroppedCommands) {
+  NullAudioSink sink{kFormat};
+  AudioMixer mixer{sink};
+  for (size_t i = 0; i < AudioMixer::kCommandCapacity; ++i) {
+    ASSERT_TRUE(mixer.setMasterVolume(1.0f));
+  }
+  EXPECT_FALSE(mixer.setMasterVolume(1.0f));
+  EXPECT_EQ(mixer.stats().dropped_commands, 1u);
+}
+
+TEST(AudioMixer, AcceptsCommandsFromManyThreads) {
+  NullAudioSink sink{kFormat};
+  AudioMixer mixer{sink, 64};
+  const std::vector<float> clip(100, 0.01f);
+
+  /* Each thread starts 16 looping voices and stops every other one */
+  std::mutex ids_mutex;
+  std::vector<VoiceId> ids;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      std::vector<VoiceId> mine;
+      for (int i = 0; i < 16; ++i) {
+        mine.push_back(mixer.play({.samples = clip}, {.loop = true}));
+      }
+      for (size_t i = 0; i < mine.size(); i += 2) {
+        mixer.stop(mine[i]);
+      }
+      std::lock_guard lock{ids_mutex};
+      ids.insert(ids.end(), mine.begin(), mine.end());
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  /* Ids are unique across threads, and each thread's stop follows its
+   * play */
+  std::sort(ids.begin(), ids.end());
+  EXPECT_EQ(std::adjacent_find(ids.begin(), ids.end()), ids.end());
+  EXPECT_EQ(std::count(ids.begin(), ids.end(), VoiceId{0}), 0);
+  mixPeriod(mixer);
+  EXPECT_EQ(mixer.activeVoices(), 32u);
+  EXPECT_EQ(mixer.stats().dropped_commands, 0u);
+}
+
+TEST(AudioMixer, KernelsAgreeBitForBit) {
+  /* Odd period so every kernel also runs its scalar tail */
+  const AudioFormat format{.sample_rate = 44100, .period_frames = 253};
+  std::vector<std::vector<float>> clips;
+  for (uint32_t i = 0; i < 8; ++i) {
+    clips.push_back(noise(300 + i * 37, i));
+  }
+
+  const auto render = [&](SpanIsa isa) {
+    NullAudioSink sink{format};
+    AudioMixer mixer{sink};
+    mixer.setIsa(isa);
+    for (size_t i = 0; i < clips.size(); ++i) {
+      mixer.play({.samples = clips[i],
+                  .sample_rate = static_cast<uint32_t>(22050 + 3000 * i)},
+                 {.volume = 0.3f,
+                  .pan = static_cast<float>(i) / 4.0f - 1.0f,
+                  .pitch = 0.7f + 0.2f * i,
+                  .loop = i % 2 == 0});
+    }
+    std::vector<float> out;
+    for (int period = 0; period < 8; ++period) {
+      const auto p = mixPeriod(mixer, format.period_frames);
+      out.insert(out.end(), p.begin(), p.end());
+    }
+    return out;
+  };
+
+  const auto reference = render(SpanIsa::Scalar);
+  for (SpanIsa isa : {SpanIsa::Sse2, SpanIsa::Avx2}) {
+    EXPECT_EQ(render(isa), reference) << spanIsaName(isa);
+  }
+}
+
+TEST(AudioMixer, MixingDoesNotAllocate) {
+  ASSERT_TRUE(heapCountingEnabled());
+  NullAudioSink sink{kFormat};
+  AudioMixer mixer{sink};
+  const auto clip = noise(4096, 1);
+  std::vector<float> out(kFormat.period_frames * 2);
+
+  const uint64_t before = heapCounters().allocations;
+  for (int i = 0; i < 64; ++i) {
+    const VoiceId voice = mixer.play({.samples = clip}, {.loop = true});
+    mixer.set(voice, {.volume = 0.5f, .pitch = 1.5f, .loop = true});
+    mixer.mix(out);
+  }
+  EXPECT_EQ(heapCounters().allocations, before);
+}
+
+// ---------------------------------------------------------------------------
+// Sinks and the mixer thread
+// ---------------------------------------------------------------------------
+TEST(AudioMixer, NoUnderrunsAt256FramePeriods) {
+  /* The mixer's side of the guarantee is mixing each period in a fraction
+   * of its duration. The device buffers 8 periods so that scheduler stalls
+   * on a loaded test machine aren't counted against it */
+  NullAudioSink sink{{.sample_rate = 48000, .period_frames = 256, .periods = 8},
+                     true};
+  AudioMixer mixer{sink};
+  const auto clip = noise(48000, 2);
+  for (int i = 0; i < 32; ++i) {
+    mixer.play({.samples = clip, .sample_rate = 44100},
+               {.volume = 0.1f, .pitch = 1.0f + 0.01f * i, .loop = true});
+  }
+
+  /* Half a second of audio */
+  mixer.start();
+  while (sink.periods() < 94) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  mixer.stop();
+  EXPECT_FALSE(mixer.running());
+  EXPECT_EQ(mixer.activeVoices(), 32u);
+  EXPECT_EQ(mixer.stats().underruns, 0u);
+  EXPECT_GE(mixer.stats().periods, 94u);
+  EXPECT_LT(mixer.stats().last_mix_us, 256.0 / 48000.0 * 1e6 / 4.0);
+}
+
+TEST(AudioMixer, PacedSinkCountsLatePeriods) {
+  NullAudioSink sink{
+      {.sample_rate = 48000, .period_frames = 48, .periods = 2}, true};
+  const std::vector<float> period(96);
+  sink.write(period);
+  sink.write(period);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  sink.write(period);
+  EXPECT_EQ(sink.underruns(), 1u);
+}
+
+TEST(WavFileSink, WritesPcmWithPatchedHeader) {
+  const auto path =
+      std::filesystem::temp_directory_path() / "libretro_audio_test.wav";
+  {
+    WavFileSink sink{path, kFormat};
+    AudioMixer mixer{sink};
+    const std::vector<float> dc(1000, 0.5f);
+    mixer.play({.samples = dc}, {.pan = -1.0f});
+    mixer.start();
+    while (mixer.stats().periods < 2) {
+      std::this_thread::yield();
+    }
+    mixer.stop();
+  }
+
+  std::ifstream in{path, std::ios::binary};
+  std::vector<char> bytes{std::istreambuf_iterator<char>{in}, {}};
+  std::filesystem::remove(path);
+  ASSERT_GE(bytes.size(), 48u);
+
+  const auto le32 = [&bytes](size_t at) {
+    uint32_t v = 0;
+    for (size_t i = 0; i < 4; ++i) {
+      v |= uint32_t{static_cast<uint8_t>(bytes[at + i])} << (i * 8);
+    }
+    return v;
+  };
+  EXPECT_EQ(std::string(bytes.data(), 4), "RIFF");
+  EXPECT_EQ(std::string(bytes.data() + 8, 8), "WAVEfmt ");
+  EXPECT_EQ(le32(24), kFormat.sample_rate);
+  EXPECT_EQ(le32(40), bytes.size() - 44);
+  EXPECT_EQ(le32(4), bytes.size() - 8);
+  EXPECT_EQ((bytes.size() - 44) % (kFormat.period_frames * 4), 0u);
+
+  /* First frame: left at half scale, right silent */
+  const auto sample = [&bytes](size_t at) {
+    return static_cast<int16_t>(static_cast<uint8_t>(bytes[at]) |
+                                static_cast<uint8_t>(bytes[at + 1]) << 8);
+  };
+  EXPECT_EQ(sample(44), 16384);
+  EXPECT_EQ(sample(46), 0);
+}
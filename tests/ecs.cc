@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include "ecs.h"
+#include "system_schedule.h"
+
+#include <cstdint>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Test components
+// ---------------------------------------------------------------------------
+struct Position {
+  float x, y;
+};
+struct Velocity {
+  float x, y;
+};
+struct Health {
+  int value;
+};
+
+// ---------------------------------------------------------------------------
+// Entities
+// ---------------------------------------------------------------------------
+TEST(World, CreateAndGet) {
+  World world;
+  const Entity e = world.create(Position{1, 2}, Velocity{3, 4});
+  ASSERT_TRUE(world.alive(e));
+  EXPECT_EQ(world.size(), 1u);
+  EXPECT_EQ(world.get<Position>(e)->y, 2.0f);
+  EXPECT_EQ(world.get<Velocity>(e)->x, 3.0f);
+  EXPECT_EQ(world.get<Health>(e), nullptr);
+  EXPECT_TRUE(world.has<Position>(e));
+  EXPECT_FALSE(world.has<Health>(e));
+}
+
+TEST(World, DestroyedHandleStaysInvalid) {
+  World world;
+  const Entity a = world.create(Health{1});
+  world.destroy(a);
+  const Entity b = world.create(Health{2});
+  /* The index is recycled under a new generation */
+  EXPECT_EQ(a.index, b.index);
+  EXPECT_FALSE(world.alive(a));
+  EXPECT_EQ(world.get<Health>(a), nullptr);
+  EXPECT_EQ(world.get<Health>(b)->value, 2);
+  world.destroy(a);
+  EXPECT_TRUE(world.alive(b));
+}
+
+TEST(World, DestroyKeepsOtherEntitiesIntact) {
+  World world;
+  std::vector<Entity> entities;
+  for (int i = 0; i < 5; ++i) {
+    entities.push_back(world.create(Health{i}));
+  }
+  world.destroy(entities[1]);
+  world.destroy(entities[3]);
+  EXPECT_EQ(world.size(), 3u);
+  EXPECT_EQ(world.get<Health>(entities[0])->value, 0);
+  EXPECT_EQ(world.get<Health>(entities[2])->value, 2);
+  EXPECT_EQ(world.get<Health>(entities[4])->value, 4);
+}
+
+TEST(World, AddAndRemoveMoveBetweenArchetypes) {
+  World world;
+  const Entity e = world.create(Position{5, 6});
+  const Entity other = world.create(Position{7, 8});
+  world.add(e, Velocity{1, 1});
+  EXPECT_EQ(world.archetypeCount(), 2u);
+  EXPECT_EQ(world.get<Position>(e)->x, 5.0f);
+  EXPECT_EQ(world.get<Velocity>(e)->y, 1.0f);
+  EXPECT_EQ(world.get<Position>(other)->x, 7.0f);
+
+  world.add(e, Velocity{2, 2});
+  EXPECT_EQ(world.get<Velocity>(e)->x, 2.0f);
+
+  world.remove<Position>(e);
+  EXPECT_FALSE(world.has<Position>(e));
+  EXPECT_EQ(world.get<Velocity>(e)->x, 2.0f);
+  world.remove<Position>(e);
+}
+
+TEST(World, InvalidOperationsThrow) {
+  World world;
+  const Entity e = world.create(Health{1});
+  world.destroy(e);
+  EXPECT_THROW(world.add(e, Health{2}), std::invalid_argument);
+  EXPECT_THROW(world.create(Health{1}, Health{2}), std::invalid_argument);
+}
+
+// ---------------------------------------------------------------------------
+// Chunked storage and queries
+// ---------------------------------------------------------------------------
+TEST(World, ColumnsAreAlignedAndContiguous) {
+  World world;
+  for (int i = 0; i < 10000; ++i) {
+    world.create(Position{float(i), 0}, Velocity{1, 0});
+  }
+
+  size_t chunks = 0;
+  size_t total = 0;
+  double sum = 0;
+  world.eachChunk<const Position, Velocity>(
+      [&](size_t count, const Position *p, Velocity *v) {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 64, 0u);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(v) % 64, 0u);
+        for (size_t i = 0; i < count; ++i) {
+          sum += p[i].x;
+        }
+        ++chunks;
+        total += count;
+      });
+  EXPECT_GT(chunks, 1u);
+  EXPECT_EQ(total, 10000u);
+  EXPECT_EQ(sum, 10000.0 * 9999.0 / 2.0);
+}
+
+TEST(World, QueriesMatchSupersets) {
+  World world;
+  world.create(Position{1, 0});
+  world.create(Position{2, 0}, Velocity{});
+  world.create(Velocity{});
+  world.create(Position{3, 0}, Health{});
+
+  float sum = 0;
+  world.each<const Position>([&sum](const Position &p) { sum += p.x; });
+  EXPECT_EQ(sum, 6.0f);
+
+  int matched = 0;
+  world.each<Position, Velocity>([&matched](Position &, Velocity &) {
+    ++matched;
+  });
+  EXPECT_EQ(matched, 1);
+}
+
+TEST(World, ChunksReleasedAsEntitiesGo) {
+  World world;
+  std::vector<Entity> entities;
+  for (int i = 0; i < 5000; ++i) {
+    entities.push_back(world.create(Health{i}));
+  }
+  for (const Entity e : entities) {
+    world.destroy(e);
+  }
+  EXPECT_EQ(world.size(), 0u);
+
+  std::vector<ChunkView> chunks;
+  world.chunks(componentMask<Health>(), chunks);
+  EXPECT_TRUE(chunks.empty());
+}
+
+// ---------------------------------------------------------------------------
+// SystemSchedule
+// ---------------------------------------------------------------------------
+TEST(SystemSchedule, ConflictsStartNewPhases) {
+  SystemSchedule schedule{2};
+  schedule.add<Position, const Velocity>("integrate",
+                                         [](size_t, Position *,
+                                            const Velocity *) noexcept {});
+  /* Reads what the first writes */
+  schedule.add<const Position, Health>("damage",
+                                       [](size_t, const Position *,
+                                          Health *) noexcept {});
+  /* Only reads: shares the phase */
+  schedule.add<const Velocity>("inspect",
+                               [](size_t, const Velocity *) noexcept {});
+  /* Writes what "inspect" reads */
+  schedule.add<Velocity>("steer", [](size_t, Velocity *) noexcept {});
+
+  EXPECT_EQ(schedule.systemCount(), 4u);
+  EXPECT_EQ(schedule.phaseCount(), 3u);
+  EXPECT_EQ(schedule.phase(0), 0u);
+  EXPECT_EQ(schedule.phase(1), 1u);
+  EXPECT_EQ(schedule.phase(2), 1u);
+  EXPECT_EQ(schedule.phase(3), 2u);
+}
+
+TEST(SystemSchedule, RunUpdatesEveryEntityInOrder) {
+  World world;
+  for (int i = 0; i < 100000; ++i) {
+    world.create(Position{0, 0}, Velocity{float(i % 10), 1}, Health{0});
+  }
+  world.create(Position{0, 0});
+
+  SystemSchedule schedule{4};
+  schedule.add<Position, const Velocity>(
+      "integrate", [](size_t n, Position *p, const Velocity *v) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+          p[i].x += v[i].x;
+          p[i].y += v[i].y;
+        }
+      });
+  schedule.add<const Position, Health>(
+      "score", [](size_t n, const Position *p, Health *h) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+          h[i].value = static_cast<int>(p[i].x + p[i].y);
+        }
+      });
+  schedule.run(world);
+  schedule.run(world);
+
+  EXPECT_GT(schedule.lastJobs(), 2u);
+  int64_t total = 0;
+  world.each<const Health>([&total](const Health &h) { total += h.value; });
+  /* Two steps of (x % 10) + 1 per entity */
+  EXPECT_EQ(total, 2 * (100000 / 10 * 45 + 100000));
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include "fixed_timestep.h"
+
+#include <stdexcept>
+
+// ---------------------------------------------------------------------------
+// Stepping
+// ---------------------------------------------------------------------------
+TEST(FixedTimestep, FirstAdvanceStartsClock) {
+  FixedTimestep clock{0.25};
+  EXPECT_EQ(clock.advance(100.0), 0u);
+  EXPECT_EQ(clock.advance(100.5), 2u);
+  EXPECT_EQ(clock.steps(), 2u);
+}
+
+TEST(FixedTimestep, RemainderCarriesOver) {
+  FixedTimestep clock{0.25};
+  clock.advance(0.0);
+  EXPECT_EQ(clock.advance(0.375), 1u);
+  EXPECT_DOUBLE_EQ(clock.alpha(), 0.5);
+  EXPECT_EQ(clock.advance(0.5), 1u);
+  EXPECT_DOUBLE_EQ(clock.alpha(), 0.0);
+}
+
+TEST(FixedTimestep, LongStallIsClamped) {
+  FixedTimestep clock{0.25, 4};
+  clock.advance(0.0);
+  EXPECT_EQ(clock.advance(10.0), 4u);
+  EXPECT_DOUBLE_EQ(clock.alpha(), 0.0);
+  EXPECT_EQ(clock.advance(10.25), 1u);
+}
+
+TEST(FixedTimestep, BackwardsClockAddsNothing) {
+  FixedTimestep clock{0.25};
+  clock.advance(5.0);
+  EXPECT_EQ(clock.advance(4.0), 0u);
+  EXPECT_EQ(clock.advance(4.25), 1u);
+}
+
+TEST(FixedTimestep, UntilNextCountsDown) {
+  FixedTimestep clock{0.25};
+  EXPECT_DOUBLE_EQ(clock.untilNext(0.0), 0.0);
+  clock.advance(0.0);
+  EXPECT_DOUBLE_EQ(clock.untilNext(0.0), 0.25);
+  EXPECT_DOUBLE_EQ(clock.untilNext(0.125), 0.125);
+  EXPECT_DOUBLE_EQ(clock.untilNext(1.0), 0.0);
+}
+
+TEST(FixedTimestep, InvalidStepThrows) {
+  EXPECT_THROW(FixedTimestep{0.0}, std::invalid_argument);
+  EXPECT_THROW(FixedTimestep{-1.0}, std::invalid_argument);
+  EXPECT_THROW((FixedTimestep{0.1, 0}), std::invalid_argument);
+}
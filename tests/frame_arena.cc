@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include "frame_arena.h"
+#include "heap_counter.h"
+#include "window.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// LinearArena
+// ---------------------------------------------------------------------------
+TEST(LinearArena, AllocationsAreAlignedAndBumped) {
+  LinearArena arena{256};
+  void *a = arena.allocate(3, 1);
+  void *b = arena.allocate(8, 64);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 64, 0u);
+  EXPECT_GT(b, a);
+  EXPECT_GE(arena.used(), 11u);
+}
+
+TEST(LinearArena, FullArenaReturnsNullUntilReset) {
+  LinearArena arena{64};
+  EXPECT_NE(arena.allocate(64, 1), nullptr);
+  EXPECT_EQ(arena.allocate(1, 1), nullptr);
+  arena.reset();
+  EXPECT_EQ(arena.used(), 0u);
+  EXPECT_NE(arena.allocate(64, 1), nullptr);
+}
+
+TEST(LinearArena, ZeroCapacityThrows) {
+  EXPECT_THROW(LinearArena{0}, std::invalid_argument);
+}
+
+// ---------------------------------------------------------------------------
+// FrameArena
+// ---------------------------------------------------------------------------
+TEST(FrameArena, DataSurvivesOneFrame) {
+  FrameArena arena{1024};
+  auto *frame0 = static_cast<char *>(arena.allocate(16, 1));
+  std::strcpy(frame0, "frame zero");
+
+  /* Frame 1 allocates from the other arena and leaves frame 0 alone */
+  arena.endFrame();
+  auto *frame1 = static_cast<char *>(arena.allocate(16, 1));
+  std::memset(frame1, 'x', 16);
+  EXPECT_STREQ(frame0, "frame zero");
+
+  /* Frame 2 reuses frame 0's memory */
+  arena.endFrame();
+  EXPECT_EQ(arena.allocate(16, 1), frame0);
+}
+
+TEST(FrameArena, CountsPerFrame) {
+  FrameArena arena{1024};
+  EXPECT_NE(arena.allocate(100, 8), nullptr);
+  EXPECT_NE(arena.allocate(28, 4), nullptr);
+  arena.endFrame();
+  EXPECT_EQ(arena.lastFrame().allocations, 2u);
+  EXPECT_EQ(arena.lastFrame().bytes, 128u);
+  EXPECT_EQ(arena.lastFrame().overflows, 0u);
+
+  arena.endFrame();
+  EXPECT_EQ(arena.lastFrame().allocations, 0u);
+}
+
+TEST(FrameArena, OverflowFallsBackUpstream) {
+  FrameArena arena{64};
+  void *big = arena.allocate(1000, 32);
+  ASSERT_NE(big, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(big) % 32, 0u);
+  std::memset(big, 0, 1000);
+  arena.endFrame();
+  EXPECT_EQ(arena.lastFrame().overflows, 1u);
+  arena.endFrame();
+}
+
+TEST(FrameArena, BacksPmrContainers) {
+  FrameArena arena{4096};
+  std::pmr::vector<int> numbers{&arena};
+  numbers.reserve(100);
+  for (int i = 0; i < 100; ++i) {
+    numbers.push_back(i);
+  }
+  std::pmr::string label{"transient string longer than SSO", &arena};
+  EXPECT_EQ(numbers[99], 99);
+  EXPECT_EQ(label.size(), 32u);
+  arena.endFrame();
+  EXPECT_EQ(arena.lastFrame().overflows, 0u);
+  EXPECT_EQ(arena.lastFrame().allocations, 2u);
+}
+
+TEST(FrameArena, HeapAllocationsAreCounted) {
+  ASSERT_TRUE(heapCountingEnabled());
+  FrameArena arena{64};
+  arena.endFrame();
+  {
+    auto leak = std::make_unique<int>(1);
+    auto other = std::make_unique<int>(2);
+  }
+  arena.endFrame();
+  EXPECT_EQ(arena.lastFrame().heap_allocations, 2u);
+}
+
+// ---------------------------------------------------------------------------
+// Window integration
+// ---------------------------------------------------------------------------
+TEST(FrameArenaWindow, DisabledByDefault) {
+  Window w{16,        16, "Arena", []() noexcept {}, []() noexcept {},
+           []() noexcept {}, WindowOptions{.headless = true}};
+  EXPECT_EQ(w.frameArena(), nullptr);
+}
+
+TEST(FrameArenaWindow, RenderFlipsArena) {
+  FrameArena *arena = nullptr;
+  Window w{16,
+           16,
+           "Arena",
+           []() noexcept {},
+           [&arena]() noexcept {
+             std::pmr::vector<float> scratch{arena};
+             scratch.resize(64);
+           },
+           []() noexcept {},
+           WindowOptions{.headless = true, .frame_arena_bytes = 4096}};
+  arena = w.frameArena();
+  ASSERT_NE(arena, nullptr);
+  EXPECT_EQ(arena->bytesPerFrame(), 4096u);
+
+  w.render();
+  EXPECT_EQ(arena->lastFrame().allocations, 1u);
+  EXPECT_EQ(arena->lastFrame().bytes, 64u * sizeof(float));
+}
+
+TEST(FrameArenaWindow, SteadyStateRenderDoesNotTouchHeap) {
+  FrameArena *arena = nullptr;
+  Window w{32,
+           32,
+           "Arena",
+           []() noexcept {},
+           [&arena]() noexcept {
+             std::pmr::vector<uint32_t> commands{arena};
+             for (uint32_t i = 0; i < 1000; ++i) {
+               commands.push_back(i);
+             }
+             std::pmr::string label{arena};
+             label = "frame data that does not fit in SSO storage";
+             glClear(GL_COLOR_BUFFER_BIT);
+           },
+           []() noexcept {},
+           WindowOptions{.headless = true, .frame_arena_bytes = 64 * 1024}};
+  arena = w.frameArena();
+
+  /* Warm up: the first frames create readback buffers and the like */
+  for (int i = 0; i < 4; ++i) {
+    w.render();
+  }
+  for (int i = 0; i < 10; ++i) {
+    w.render();
+    EXPECT_EQ(arena->lastFrame().heap_allocations, 0u) << "frame " << i;
+    EXPECT_EQ(arena->lastFrame().overflows, 0u);
+  }
+}
+
+TEST(FrameArenaWindow, MoveKeepsArena) {
+  Window a{16,        16, "Arena", []() noexcept {}, []() noexcept {},
+           []() noexcept {},
+           WindowOptions{.headless = true, .frame_arena_bytes = 256}};
+  FrameArena *arena = a.frameArena();
+  Window b{std::move(a)};
+  EXPECT_EQ(b.frameArena(), arena);
+  EXPECT_EQ(a.frameArena(), nullptr);
+}
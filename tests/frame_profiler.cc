@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include "window.h"
+
+#include <sstream>
+#include <string>
+
+// ---------------------------------------------------------------------------
+// Helper: create a window with no-op callbacks
+// ---------------------------------------------------------------------------
+static Window makeWindow() {
+  return Window{
+      64, 64, "Profiler", []() noexcept {}, []() noexcept {},
+      []() noexcept {}};
+}
+
+static size_t countLines(const std::string &s) {
+  size_t lines = 0;
+  for (char c : s) {
+    lines += c == '\n';
+  }
+  return lines;
+}
+
+// ---------------------------------------------------------------------------
+// Window integration
+// ---------------------------------------------------------------------------
+TEST(FrameProfilerWindow, DisabledByDefault) {
+  auto w = makeWindow();
+  EXPECT_EQ(w.profiler(), nullptr);
+}
+
+TEST(FrameProfilerWindow, EnableAndDisable) {
+  auto w = makeWindow();
+  w.setProfiling(true);
+  EXPECT_NE(w.profiler(), nullptr);
+  w.setProfiling(false);
+  EXPECT_EQ(w.profiler(), nullptr);
+}
+
+TEST(FrameProfilerWindow, CountsRenderedFrames) {
+  auto w = makeWindow();
+  w.setProfiling(true);
+  for (int i = 0; i < 10; ++i) {
+    w.render();
+  }
+  EXPECT_EQ(w.profiler()->frameCount(), 10u);
+  EXPECT_EQ(w.profiler()->stats().frames, 10u);
+}
+
+TEST(FrameProfilerWindow, ProfilerMovesWithWindow) {
+  auto w1 = makeWindow();
+  w1.setProfiling(true);
+  Window w2{std::move(w1)};
+  EXPECT_NE(w2.profiler(), nullptr);
+  w2.render();
+  EXPECT_EQ(w2.profiler()->frameCount(), 1u);
+}
+
+TEST(FrameProfilerWindow, GpuTimesEventuallyResolve) {
+  auto w = makeWindow();
+  w.setProfiling(true);
+  for (int i = 0; i < 8; ++i) {
+    w.render();
+    glFinish();
+  }
+  std::ostringstream csv;
+  w.profiler()->writeCsv(csv);
+  /* The last data column is only empty while a GPU query is pending */
+  EXPECT_EQ(csv.str().find(",\n"), csv.str().rfind(",\n"));
+}
+
+// ---------------------------------------------------------------------------
+// Stats and dumps
+// ---------------------------------------------------------------------------
+TEST(FrameProfilerStats, PercentilesAreOrdered) {
+  auto w = makeWindow();
+  w.setProfiling(true);
+  for (int i = 0; i < 50; ++i) {
+    w.render();
+  }
+  const auto stats = w.profiler()->stats();
+  EXPECT_LE(stats.cpu_ms.p50, stats.cpu_ms.p95);
+  EXPECT_LE(stats.cpu_ms.p95, stats.cpu_ms.p99);
+  EXPECT_GE(stats.cpu_ms.p50, 0.0);
+}
+
+TEST(FrameProfilerStats, HistoryIsBounded) {
+  auto w = makeWindow();
+  w.setProfiling(true);
+  for (int i = 0; i < 1100; ++i) {
+    w.render();
+  }
+  EXPECT_EQ(w.profiler()->frameCount(), 1100u);
+  EXPECT_EQ(w.profiler()->stats().frames, 1024u);
+}
+
+TEST(FrameProfilerStats, NamedScopesAreRecorded) {
+  FrameProfiler *profiler = nullptr;
+  Window w{64,
+           64,
+           "Profiler",
+           []() noexcept {},
+           [&profiler]() noexcept {
+             FrameProfiler::Scope outer{profiler, "outer"};
+             FrameProfiler::Scope inner{profiler, "inner"};
+           },
+           []() noexcept {}};
+  w.setProfiling(true);
+  profiler = w.profiler();
+  w.render();
+  w.render();
+
+  const auto stats = profiler->stats();
+  ASSERT_EQ(stats.scopes.size(), 2u);
+  EXPECT_EQ(stats.scopes[0].name, "outer");
+  EXPECT_EQ(stats.scopes[1].name, "inner");
+  EXPECT_GE(stats.scopes[0].ms.p50, stats.scopes[1].ms.p50);
+}
+
+TEST(FrameProfilerStats, CsvHasOneRowPerFrame) {
+  auto w = makeWindow();
+  w.setProfiling(true);
+  for (int i = 0; i < 5; ++i) {
+    w.render();
+  }
+  std::ostringstream csv;
+  w.profiler()->writeCsv(csv);
+  EXPECT_EQ(csv.str().rfind("frame,cpu_ms,", 0), 0u);
+  EXPECT_EQ(countLines(csv.str()), 6u);
+}
+
+TEST(FrameProfilerStats, JsonContainsSummary) {
+  auto w = makeWindow();
+  w.setProfiling(true);
+  w.render();
+  std::ostringstream json;
+  w.profiler()->writeJson(json);
+  EXPECT_NE(json.str().find("\"frames\": 1"), std::string::npos);
+  EXPECT_NE(json.str().find("\"p99\""), std::string::npos);
+  EXPECT_NE(json.str().find("\"swap\""), std::string::npos);
+}
@@ -0,0 +1,528 @@
+#include <gtest/gtest.h>
+
+#include "gl_capture.h"
+#include "particles.h"
+#include "render_thread.h"
+#include "sprite_batch.h"
+#include "texture_atlas.h"
+#include "tilemap.h"
+#include "upload_ring.h"
+#include "window.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helpers: a sprite scene that changes every frame, drawn by a headless
+// window, and a way to read a framebuffer back directly
+// ---------------------------------------------------------------------------
+constexpr size_t kWidth = 48;
+constexpr size_t kHeight = 32;
+
+struct CaptureScene {
+  std::unique_ptr<SpriteBatch> batch;
+  GLuint texture{};
+  int frame{};
+
+  void create() {
+    batch = std::make_unique<SpriteBatch>(64);
+
+    const uint32_t texels[] = {Sprite::rgba(255, 0, 0), Sprite::rgba(0, 255, 0),
+                               Sprite::rgba(0, 0, 255),
+                               Sprite::rgba(255, 255, 255)};
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, texels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  void destroy() noexcept {
+    batch.reset();
+    glDeleteTextures(1, &texture);
+  }
+
+  void draw() noexcept {
+    glViewport(0, 0, kWidth, kHeight);
+    glClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    const auto offset = static_cast<float>(frame * 7);
+    batch->begin(kWidth, kHeight);
+    batch->draw(Sprite{.x = 2.0f + offset, .y = 3.0f, .width = 16.0f,
+                       .height = 16.0f, .texture = texture});
+    batch->draw(Sprite{.x = 20.0f, .y = 10.0f + offset, .width = 12.0f,
+                       .height = 8.0f,
+                       .color = Sprite::rgba(255, 128, 0, 160)});
+    batch->end();
+    ++frame;
+  }
+};
+
+static std::vector<uint32_t> readFramebuffer(GLuint framebuffer) {
+  std::vector<uint32_t> pixels(kWidth * kHeight);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+  glReadPixels(0, 0, kWidth, kHeight, GL_RGBA, GL_UNSIGNED_BYTE,
+               pixels.data());
+  return pixels;
+}
+
+static GLuint readFramebufferBinding() {
+  GLint framebuffer = 0;
+  glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &framebuffer);
+  return static_cast<GLuint>(framebuffer);
+}
+
+static std::vector<uint8_t> copy(std::span<const uint8_t> data) {
+  return {data.begin(), data.end()};
+}
+
+// ---------------------------------------------------------------------------
+// Recording
+// ---------------------------------------------------------------------------
+TEST(GLCapture, OnlyOneCaptureAtATime) {
+  GLCapture capture;
+  EXPECT_THROW(GLCapture{}, std::logic_error);
+  capture.stop();
+  EXPECT_FALSE(capture.recording());
+  EXPECT_NO_THROW(GLCapture{});
+}
+
+TEST(GLCapture, CountsFramesRenderedByWindow) {
+  CaptureScene scene;
+  Window window{kWidth,
+                kHeight,
+                "Capture",
+                {},
+                [&scene]() noexcept { scene.draw(); },
+                {},
+                WindowOptions{.headless = true}};
+  scene.create();
+
+  GLCapture capture;
+  for (int i = 0; i < 3; ++i) {
+    window.render();
+  }
+  capture.stop();
+
+  EXPECT_EQ(capture.stats().frames, 3u);
+  EXPECT_GT(capture.stats().calls, 0u);
+
+  /* Mapped vertex writes are part of the stream */
+  EXPECT_GT(capture.stats().upload_bytes, 0u);
+  EXPECT_EQ(GLReplay{copy(capture.data())}.frameCount(), 3u);
+  scene.destroy();
+}
+
+TEST(GLCapture, StoppedCaptureRecordsNothing) {
+  Window window{kWidth,
+                kHeight,
+                "Capture",
+                {},
+                []() noexcept { glClear(GL_COLOR_BUFFER_BIT); },
+                {},
+                WindowOptions{.headless = true}};
+
+  GLCapture capture;
+  window.render();
+  capture.stop();
+  const size_t calls = capture.stats().calls;
+  window.render();
+
+  EXPECT_EQ(capture.stats().calls, calls);
+  EXPECT_EQ(capture.stats().frames, 1u);
+}
+
+TEST(GLCapture, RecordsFramesRenderedOnRenderThread) {
+  Window window{kWidth,
+                kHeight,
+                "Capture",
+                {},
+                []() noexcept { glClear(GL_COLOR_BUFFER_BIT); },
+                {},
+                WindowOptions{.headless = true}};
+
+  GLCapture capture;
+  RenderThread renderer{window};
+  while (renderer.running() && renderer.frames() < 3) {
+    std::this_thread::yield();
+  }
+  renderer.stop();
+
+  /* Every frame the thread rendered is in the stream, and the recording
+   * came back with the context */
+  EXPECT_EQ(capture.stats().frames, renderer.frames());
+  EXPECT_GE(capture.stats().frames, 3u);
+  window.render();
+  EXPECT_EQ(capture.stats().frames, renderer.frames() + 1);
+  capture.stop();
+  EXPECT_EQ(GLReplay{copy(capture.data())}.frameCount(),
+            renderer.frames() + 1);
+}
+
+TEST(GLCapture, CaptureDestroyedOnAnotherThreadStopsRecording) {
+  Window window{kWidth,
+                kHeight,
+                "Capture",
+                {},
+                []() noexcept { glClear(GL_COLOR_BUFFER_BIT); },
+                {},
+                WindowOptions{.headless = true}};
+
+  auto capture = std::make_unique<GLCapture>();
+  window.render();
+  std::thread{[&capture] { capture.reset(); }}.join();
+
+  /* This thread still points at the freed capture and must leave it be */
+  window.render();
+
+  /* A new capture records here as usual */
+  GLCapture next;
+  window.render();
+  EXPECT_EQ(next.stats().frames, 1u);
+}
+
+TEST(GLCapture, SaveAndLoadRoundTrip) {
+  Window window{kWidth,
+                kHeight,
+                "Capture",
+                {},
+                []() noexcept { glClear(GL_COLOR_BUFFER_BIT); },
+                {},
+                WindowOptions{.headless = true}};
+
+  GLCapture capture;
+  window.render();
+  window.render();
+  capture.stop();
+
+  const auto path =
+      std::filesystem::temp_directory_path() / "libretro_capture_test.lrgc";
+  capture.save(path);
+  GLReplay replay{path};
+  EXPECT_EQ(replay.frameCount(), 2u);
+  std::filesystem::remove(path);
+}
+
+// ---------------------------------------------------------------------------
+// Stream validation
+// ---------------------------------------------------------------------------
+TEST(GLReplay, RejectsForeignData) {
+  EXPECT_THROW(GLReplay{std::vector<uint8_t>{}}, std::invalid_argument);
+  EXPECT_THROW((GLReplay{std::vector<uint8_t>{'L', 'R', 'P', 'K', 1, 0, 0, 0}}),
+               std::invalid_argument);
+  EXPECT_THROW((GLReplay{std::vector<uint8_t>{'L', 'R', 'G', 'C', 9, 0, 0, 0}}),
+               std::invalid_argument);
+}
+
+TEST(GLReplay, RejectsTruncatedRecord) {
+  std::vector<uint8_t> data{'L', 'R', 'G', 'C', 1, 0, 0, 0};
+
+  /* Opcode 2 with a 100 byte payload that isn't there */
+  data.insert(data.end(), {2, 0, 100, 0, 0, 0, 1, 2});
+  EXPECT_THROW(GLReplay{data}, std::invalid_argument);
+}
+
+TEST(GLReplay, RejectsUnknownOpcode) {
+  std::vector<uint8_t> data{'L', 'R', 'G', 'C', 1, 0, 0, 0};
+  data.insert(data.end(), {0xFF, 0xFF, 0, 0, 0, 0});
+  EXPECT_THROW(GLReplay{data}, std::invalid_argument);
+}
+
+TEST(GLReplay, MissingFileThrows) {
+  EXPECT_THROW(GLReplay{std::filesystem::path{"/nonexistent/capture.lrgc"}},
+               std::runtime_error);
+}
+
+TEST(GLReplay, HeaderOnlyStreamHasNoFrames) {
+  GLReplay replay{std::vector<uint8_t>{'L', 'R', 'G', 'C', 1, 0, 0, 0}};
+  EXPECT_EQ(replay.frameCount(), 0u);
+  EXPECT_THROW(replay.replayFrame(0), std::out_of_range);
+}
+
+// ---------------------------------------------------------------------------
+// Replay: captured frames reproduce the pixels they drew live
+// ---------------------------------------------------------------------------
+TEST(GLReplay, FramesMatchLiveRendering) {
+  CaptureScene scene;
+  Window window{kWidth,
+                kHeight,
+                "Capture",
+                {},
+                [&scene]() noexcept { scene.draw(); },
+                {},
+                WindowOptions{.headless = true}};
+
+  /* The window's own target predates the capture, so replayed frames draw
+   * into whatever framebuffer the replay is given */
+  GLCapture capture;
+  scene.create();
+  std::vector<std::vector<uint32_t>> live;
+  for (int i = 0; i < 3; ++i) {
+    window.render();
+    live.push_back(readFramebuffer(window.framebuffer()));
+  }
+  capture.stop();
+  scene.destroy();
+  ASSERT_NE(live[0], live[1]);
+
+  GLReplay replay{copy(capture.data())};
+  ASSERT_EQ(replay.frameCount(), 3u);
+  replay.setFramebuffer(window.framebuffer());
+  replay.setup();
+
+  /* Out of order and repeated: frames only depend on setup */
+  for (size_t frame : {2u, 0u, 1u, 1u}) {
+    glBindFramebuffer(GL_FRAMEBUFFER, window.framebuffer());
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    replay.replayFrame(frame);
+    EXPECT_EQ(readFramebuffer(window.framebuffer()), live[frame])
+        << "frame " << frame;
+  }
+  EXPECT_GT(replay.stats().calls, 0u);
+}
+
+TEST(GLReplay, CaptureStartedBeforeWindowResolvesEverything) {
+  std::vector<uint8_t> data;
+  std::vector<uint32_t> live;
+  {
+    GLCapture capture;
+    CaptureScene scene;
+    Window window{kWidth,
+                  kHeight,
+                  "Capture",
+                  [&scene]() noexcept { scene.create(); },
+                  [&scene]() noexcept { scene.draw(); },
+                  [&scene]() noexcept { scene.destroy(); },
+                  WindowOptions{.headless = true}};
+    window.render();
+    window.render();
+    live = readFramebuffer(window.framebuffer());
+    capture.stop();
+    data = copy(capture.data());
+  }
+
+  /* A fresh GLFW session: the capture window's objects are recreated */
+  Window host{kWidth,
+              kHeight,
+              "Replay",
+              {},
+              {},
+              {},
+              WindowOptions{.headless = true}};
+  GLReplay replay{std::move(data)};
+  ASSERT_EQ(replay.frameCount(), 2u);
+  replay.setup();
+  replay.replayFrame(1);
+  EXPECT_EQ(replay.stats().unresolved, 0u);
+
+  /* The frame ends with the replayed offscreen target's readback */
+  const GLuint framebuffer = readFramebufferBinding();
+  EXPECT_NE(framebuffer, host.framebuffer());
+  EXPECT_EQ(readFramebuffer(framebuffer), live);
+}
+
+TEST(GLReplay, TextureArraysAndBuffersReplay) {
+  std::vector<uint8_t> data;
+  std::vector<uint32_t> live;
+  {
+    GLCapture capture;
+    std::unique_ptr<TextureAtlas> atlas;
+    std::unique_ptr<Tilemap> map;
+    Window window{kWidth,
+                  kHeight,
+                  "Capture",
+                  [&]() noexcept {
+                    atlas = std::make_unique<TextureAtlas>(16, 16, 2);
+                    map = std::make_unique<Tilemap>(8, 4, 8.0f, 8.0f);
+                  },
+                  [&]() noexcept {
+                    glClear(GL_COLOR_BUFFER_BIT);
+                    map->draw(*atlas, 0.0f, 0.0f, kWidth, kHeight);
+                  },
+                  [&]() noexcept {
+                    map.reset();
+                    atlas.reset();
+                  },
+                  WindowOptions{.headless = true}};
+
+    /* The second image lands on the second layer */
+    const std::vector<uint32_t> red(16 * 16, Sprite::rgba(255, 0, 0));
+    const std::vector<uint32_t> blue(8 * 8, Sprite::rgba(0, 0, 255));
+    atlas->add({.pixels = red, .width = 16, .height = 16});
+    atlas->add({.pixels = blue, .width = 8, .height = 8});
+    map->setTile(0, 0, 1);
+    map->setTile(3, 2, 2);
+
+    window.render();
+    live = readFramebuffer(window.framebuffer());
+    capture.stop();
+    data = copy(capture.data());
+  }
+
+  Window host{kWidth, kHeight, "Replay", {}, {}, {},
+              WindowOptions{.headless = true}};
+  GLReplay replay{std::move(data)};
+  replay.setup();
+  replay.replayFrame(0);
+  EXPECT_EQ(replay.stats().unresolved, 0u);
+  EXPECT_EQ(readFramebuffer(readFramebufferBinding()), live);
+}
+
+TEST(GLReplay, TransformFeedbackReplays) {
+  std::vector<uint8_t> data;
+  std::vector<uint32_t> live;
+  {
+    GLCapture capture;
+    std::unique_ptr<GpuParticles> particles;
+    Window window{kWidth,
+                  kHeight,
+                  "Capture",
+                  [&]() noexcept {
+                    particles = std::make_unique<GpuParticles>(16);
+                  },
+                  [&]() noexcept {
+                    glClear(GL_COLOR_BUFFER_BIT);
+                    particles->update(0.5f, {.gravity_x = 8.0f});
+                    particles->draw(kWidth, kHeight);
+                  },
+                  [&]() noexcept { particles.reset(); },
+                  WindowOptions{.headless = true}};
+
+    const std::vector<ParticleSpawn> spawns{
+        {.x = 8.0f, .y = 8.0f, .vx = 4.0f, .life = 5.0f, .size = 6.0f},
+        {.x = 30.0f, .y = 20.0f, .vy = -4.0f, .life = 5.0f, .size = 4.0f,
+         .color = Sprite::rgba(0, 255, 0)}};
+    particles->emit(spawns);
+    window.render();
+    window.render();
+    live = readFramebuffer(window.framebuffer());
+    capture.stop();
+    data = copy(capture.data());
+  }
+
+  Window host{kWidth, kHeight, "Replay", {}, {}, {},
+              WindowOptions{.headless = true}};
+  GLReplay replay{std::move(data)};
+  replay.setup();
+  replay.replayFrame(0);
+  replay.replayFrame(1);
+  EXPECT_EQ(replay.stats().unresolved, 0u);
+  EXPECT_EQ(readFramebuffer(readFramebufferBinding()), live);
+}
+
+constexpr const char *kStreamVertex = R"(#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec4 aColor;
+out vec4 color;
+void main() { gl_Position = vec4(aPos, 0.0, 1.0); color = aColor; }
+)";
+
+constexpr const char *kStreamFragment = R"(#version 330 core
+in vec4 color;
+out vec4 FragColor;
+void main() { FragColor = color; }
+)";
+
+TEST(GLReplay, UnsynchronizedUploadRingReplaysFlushedBytesOnly) {
+  constexpr size_t kRegion = 1 << 20;
+  std::vector<uint8_t> data;
+  std::vector<uint32_t> live;
+  size_t upload_bytes = 0;
+  {
+    GLCapture capture;
+    std::unique_ptr<UploadRing> ring;
+    GLuint program = 0, vao = 0;
+    int frame = 0;
+    Window window{
+        kWidth,
+        kHeight,
+        "Capture",
+        [&]() noexcept {
+          ring = std::make_unique<UploadRing>(
+              kRegion, 3, UploadRing::Mode::Unsynchronized);
+          const GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+          glShaderSource(vertex, 1, &kStreamVertex, nullptr);
+          glCompileShader(vertex);
+          const GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
+          glShaderSource(fragment, 1, &kStreamFragment, nullptr);
+          glCompileShader(fragment);
+          program = glCreateProgram();
+          glAttachShader(program, vertex);
+          glAttachShader(program, fragment);
+          glLinkProgram(program);
+          glDeleteShader(vertex);
+          glDeleteShader(fragment);
+          glGenVertexArrays(1, &vao);
+        },
+        [&]() noexcept {
+          /* A triangle that moves and changes colour every frame */
+          const float x = -1.0f + 0.25f * static_cast<float>(frame);
+          const float g = 0.3f * static_cast<float>(frame);
+          const float vertices[] = {x,        -1.0f, 1.0f, g, 0.0f, 1.0f,
+                                    x + 1.0f, -1.0f, 1.0f, g, 0.0f, 1.0f,
+                                    x,        1.0f,  0.0f, g, 1.0f, 1.0f};
+          const uint32_t indices[] = {0, 1, 2};
+          const auto v = ring->allocate(UploadKind::Vertex, sizeof(vertices));
+          const auto i = ring->allocate(UploadKind::Index, sizeof(indices));
+          std::memcpy(v.data, vertices, sizeof(vertices));
+          std::memcpy(i.data, indices, sizeof(indices));
+          ring->flush();
+
+          glViewport(0, 0, kWidth, kHeight);
+          glClear(GL_COLOR_BUFFER_BIT);
+          glUseProgram(program);
+          glBindVertexArray(vao);
+          glBindBuffer(GL_ARRAY_BUFFER, ring->buffer());
+          glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ring->buffer());
+          glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+                                reinterpret_cast<void *>(v.offset));
+          glEnableVertexAttribArray(0);
+          glVertexAttribPointer(
+              1, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+              reinterpret_cast<void *>(v.offset + 2 * sizeof(float)));
+          glEnableVertexAttribArray(1);
+          glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT,
+                         reinterpret_cast<void *>(i.offset));
+          glBindVertexArray(0);
+          ring->endFrame();
+          ++frame;
+        },
+        [&]() noexcept {
+          ring.reset();
+          glDeleteVertexArrays(1, &vao);
+          glDeleteProgram(program);
+        },
+        WindowOptions{.headless = true}};
+
+    for (int f = 0; f < 3; ++f) {
+      window.render();
+    }
+    live = readFramebuffer(window.framebuffer());
+    capture.stop();
+    upload_bytes = capture.stats().upload_bytes;
+    data = copy(capture.data());
+  }
+
+  /* Each frame maps the rest of a 1 MiB region but only flushes what it
+   * wrote, and only that is recorded */
+  EXPECT_LT(upload_bytes, size_t{16 << 10});
+
+  Window host{kWidth, kHeight, "Replay", {}, {}, {},
+              WindowOptions{.headless = true}};
+  GLReplay replay{std::move(data)};
+  replay.setup();
+  for (size_t f = 0; f < 3; ++f) {
+    replay.replayFrame(f);
+  }
+  EXPECT_EQ(replay.stats().unresolved, 0u);
+  EXPECT_EQ(readFramebuffer(readFramebufferBinding()), live);
+}
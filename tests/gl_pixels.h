@@ -0,0 +1,18 @@
+#pragma once
+
+#include "window.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/* RGBA of a headless window's pixel, packed red in the lowest byte like
+ * Sprite::rgba, with y measured from the top. Offscreen rows come back
+ * bottom-up as glReadPixels returns them, so the row is flipped here */
+inline uint32_t readPixel(Window &window, size_t x, size_t y) {
+  window.offscreen()->flush();
+  const auto pixels = window.offscreen()->pixels();
+  const size_t row = window.height() - 1 - y;
+  const size_t i = (row * window.width() + x) * 4;
+  return uint32_t{pixels[i]} | uint32_t{pixels[i + 1]} << 8 |
+         uint32_t{pixels[i + 2]} << 16 | uint32_t{pixels[i + 3]} << 24;
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include "inplace_function.h"
+#include "window.h"
+
+#include <array>
+#include <memory>
+#include <type_traits>
+
+// ---------------------------------------------------------------------------
+// Helper: counts live instances to check relocation and destruction
+// ---------------------------------------------------------------------------
+struct Tracked {
+  static inline int live = 0;
+
+  Tracked() noexcept { ++live; }
+  Tracked(const Tracked &) noexcept { ++live; }
+  Tracked(Tracked &&) noexcept { ++live; }
+  ~Tracked() { --live; }
+
+  int operator()() const noexcept { return 7; }
+};
+
+// ---------------------------------------------------------------------------
+// Type properties
+// ---------------------------------------------------------------------------
+TEST(InplaceFunctionTraits, IsMoveOnly) {
+  using F = InplaceFunction<void()>;
+  EXPECT_FALSE(std::is_copy_constructible_v<F>);
+  EXPECT_FALSE(std::is_copy_assignable_v<F>);
+  EXPECT_TRUE(std::is_nothrow_move_constructible_v<F>);
+  EXPECT_TRUE(std::is_nothrow_move_assignable_v<F>);
+}
+
+TEST(InplaceFunctionTraits, StorageIsInline) {
+  EXPECT_GE(sizeof(InplaceFunction<void(), 64>), 64u);
+  EXPECT_LT(sizeof(InplaceFunction<void(), 16>),
+            sizeof(InplaceFunction<void(), 64>));
+}
+
+TEST(InplaceFunctionTraits, WindowCallbackIsMoveOnly) {
+  using F = Window::NoExceptFunctor<void()>;
+  EXPECT_FALSE(std::is_copy_constructible_v<F>);
+  EXPECT_TRUE(std::is_nothrow_move_constructible_v<F>);
+}
+
+// ---------------------------------------------------------------------------
+// Invocation
+// ---------------------------------------------------------------------------
+TEST(InplaceFunctionCall, EmptyReturnsDefault) {
+  InplaceFunction<int()> f;
+  EXPECT_FALSE(f);
+  EXPECT_EQ(f(), 0);
+}
+
+TEST(InplaceFunctionCall, EmptyVoidIsNoOp) {
+  InplaceFunction<void()> f;
+  EXPECT_FALSE(f);
+  EXPECT_NO_FATAL_FAILURE(f());
+}
+
+TEST(InplaceFunctionCall, ForwardsArguments) {
+  InplaceFunction<int(int, int)> f{[](int a, int b) noexcept { return a * b; }};
+  EXPECT_TRUE(f);
+  EXPECT_EQ(f(6, 7), 42);
+}
+
+TEST(InplaceFunctionCall, MutableLambdaKeepsState) {
+  InplaceFunction<int()> f{[n = 0]() mutable noexcept { return ++n; }};
+  EXPECT_EQ(f(), 1);
+  EXPECT_EQ(f(), 2);
+}
+
+TEST(InplaceFunctionCall, HoldsMoveOnlyCapture) {
+  auto p = std::make_unique<int>(5);
+  InplaceFunction<int()> f{[p = std::move(p)]() noexcept { return *p; }};
+  EXPECT_EQ(f(), 5);
+}
+
+TEST(InplaceFunctionCall, HoldsCaptureUpToCapacity) {
+  std::array<char, 64> data{};
+  data[63] = 9;
+  InplaceFunction<int(), 64> f{[data]() noexcept { return int{data[63]}; }};
+  EXPECT_EQ(f(), 9);
+}
+
+// ---------------------------------------------------------------------------
+// Ownership
+// ---------------------------------------------------------------------------
+TEST(InplaceFunctionOwnership, DestroysTarget) {
+  {
+    InplaceFunction<int()> f{Tracked{}};
+    EXPECT_EQ(Tracked::live, 1);
+  }
+  EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(InplaceFunctionOwnership, MoveConstructRelocatesTarget) {
+  {
+    InplaceFunction<int()> f1{Tracked{}};
+    InplaceFunction<int()> f2{std::move(f1)};
+    EXPECT_FALSE(f1);
+    EXPECT_TRUE(f2);
+    EXPECT_EQ(f2(), 7);
+    EXPECT_EQ(Tracked::live, 1);
+  }
+  EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(InplaceFunctionOwnership, MoveAssignDestroysPreviousTarget) {
+  {
+    InplaceFunction<int()> f1{Tracked{}};
+    InplaceFunction<int()> f2{Tracked{}};
+    EXPECT_EQ(Tracked::live, 2);
+    f2 = std::move(f1);
+    EXPECT_EQ(Tracked::live, 1);
+    EXPECT_EQ(f2(), 7);
+  }
+  EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(InplaceFunctionOwnership, SelfMoveAssignmentIsHarmless) {
+  InplaceFunction<int()> f{[]() noexcept { return 3; }};
+  auto &ref = f;
+  f = std::move(ref);
+  EXPECT_EQ(f(), 3);
+}
+
+TEST(InplaceFunctionOwnership, SwapExchangesTargets) {
+  InplaceFunction<int()> f1{[]() noexcept { return 1; }};
+  InplaceFunction<int()> f2{[]() noexcept { return 2; }};
+  std::swap(f1, f2);
+  EXPECT_EQ(f1(), 2);
+  EXPECT_EQ(f2(), 1);
+}
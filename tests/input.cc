@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+// clang-format on
+#include "input.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static InputEvent key(int code, int action, int64_t time = 1) {
+  return {.type = InputEvent::Type::Key,
+          .action = action,
+          .code = code,
+          .time = time};
+}
+
+// ---------------------------------------------------------------------------
+// Queue
+// ---------------------------------------------------------------------------
+TEST(InputQueue, DrainsInArrivalOrder) {
+  InputQueue queue;
+  queue.push(key(GLFW_KEY_A, GLFW_PRESS));
+  queue.push({.type = InputEvent::Type::CursorPos, .x = 3.0, .y = 4.0});
+  queue.push(key(GLFW_KEY_A, GLFW_RELEASE));
+
+  std::vector<InputEvent::Type> types;
+  EXPECT_EQ(queue.drain([&types](const InputEvent &e) noexcept {
+    types.push_back(e.type);
+  }),
+            3u);
+  EXPECT_EQ(types, (std::vector{InputEvent::Type::Key,
+                                InputEvent::Type::CursorPos,
+                                InputEvent::Type::Key}));
+
+  InputEvent event;
+  EXPECT_FALSE(queue.pop(event));
+}
+
+TEST(InputQueue, CountsDroppedEventsWhenFull) {
+  InputQueue queue;
+  for (size_t i = 0; i < InputQueue::kCapacity + 10; ++i) {
+    queue.push(key(static_cast<int>(i % 300), GLFW_PRESS));
+  }
+  EXPECT_EQ(queue.dropped(), 10u);
+
+  /* The oldest events survive */
+  InputEvent event;
+  ASSERT_TRUE(queue.pop(event));
+  EXPECT_EQ(event.code, 0);
+}
+
+// ---------------------------------------------------------------------------
+// Latency
+// ---------------------------------------------------------------------------
+TEST(InputQueue, NoSampleUntilSomethingIsConsumed) {
+  InputQueue queue;
+  queue.push(key(GLFW_KEY_A, GLFW_PRESS, 100));
+  queue.presented(1'000'000);
+  EXPECT_EQ(queue.latency().samples, 0u);
+}
+
+TEST(InputQueue, OldestConsumedEventSetsTheSample) {
+  InputQueue queue;
+  queue.push(key(GLFW_KEY_A, GLFW_PRESS, 1'000'000));
+  queue.push(key(GLFW_KEY_B, GLFW_PRESS, 3'000'000));
+  queue.drain([](const InputEvent &) noexcept {});
+
+  queue.presented(5'000'000);
+  InputLatency latency = queue.latency();
+  EXPECT_EQ(latency.samples, 1u);
+  EXPECT_DOUBLE_EQ(latency.last_ms, 4.0);
+
+  /* Nothing new was consumed */
+  queue.presented(9'000'000);
+  EXPECT_EQ(queue.latency().samples, 1u);
+
+  InputEvent event;
+  queue.push(key(GLFW_KEY_C, GLFW_PRESS, 10'000'000));
+  ASSERT_TRUE(queue.pop(event));
+  queue.presented(12'000'000);
+  latency = queue.latency();
+  EXPECT_EQ(latency.samples, 2u);
+  EXPECT_DOUBLE_EQ(latency.last_ms, 2.0);
+  EXPECT_DOUBLE_EQ(latency.mean_ms, 3.0);
+  EXPECT_DOUBLE_EQ(latency.max_ms, 4.0);
+
+  queue.resetLatency();
+  EXPECT_EQ(queue.latency().samples, 0u);
+  EXPECT_DOUBLE_EQ(queue.latency().max_ms, 0.0);
+}
+
+TEST(InputQueue, EventConsumedAfterTheSwapWaitsForTheNextFrame) {
+  InputQueue queue;
+  queue.push(key(GLFW_KEY_A, GLFW_PRESS, 8'000'000));
+  queue.drain([](const InputEvent &) noexcept {});
+
+  queue.presented(5'000'000);
+  EXPECT_EQ(queue.latency().samples, 0u);
+  queue.presented(9'000'000);
+  EXPECT_EQ(queue.latency().samples, 1u);
+  EXPECT_DOUBLE_EQ(queue.latency().last_ms, 1.0);
+}
+
+TEST(InputQueue, PipelinedSampleClosesWhenItsSnapshotIsPresented) {
+  InputQueue queue;
+  queue.push(key(GLFW_KEY_A, GLFW_PRESS, 1'000'000));
+  queue.drain([](const InputEvent &) noexcept {});
+  const int64_t stamp = queue.takeConsumed();
+  EXPECT_EQ(stamp, 1'000'000);
+  EXPECT_EQ(queue.takeConsumed(), 0);
+
+  /* A frame still drawing the previous snapshot doesn't count */
+  queue.rendered(0);
+  queue.presented(3'000'000);
+  EXPECT_EQ(queue.latency().samples, 0u);
+
+  queue.rendered(stamp);
+  queue.presented(6'000'000);
+  EXPECT_EQ(queue.latency().samples, 1u);
+  EXPECT_DOUBLE_EQ(queue.latency().last_ms, 5.0);
+
+  /* Drawing the same snapshot again adds nothing */
+  queue.rendered(stamp);
+  queue.presented(8'000'000);
+  EXPECT_EQ(queue.latency().samples, 1u);
+}
+
+TEST(InputQueue, PipelinedPresentLeavesUntakenEventsAlone) {
+  InputQueue queue;
+  EXPECT_EQ(queue.takeConsumed(), 0);
+
+  /* Consumed but not yet published with a snapshot */
+  queue.push(key(GLFW_KEY_A, GLFW_PRESS, 1'000'000));
+  queue.drain([](const InputEvent &) noexcept {});
+  queue.presented(2'000'000);
+  EXPECT_EQ(queue.latency().samples, 0u);
+  EXPECT_EQ(queue.takeConsumed(), 1'000'000);
+}
+
+TEST(InputQueue, NowIsMonotonic) {
+  const int64_t a = InputQueue::now();
+  std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  EXPECT_GT(InputQueue::now(), a);
+}
+
+// ---------------------------------------------------------------------------
+// State
+// ---------------------------------------------------------------------------
+TEST(InputState, TracksKeysButtonsAndCursor) {
+  InputState state;
+  state.apply(key(GLFW_KEY_SPACE, GLFW_PRESS));
+  state.apply({.type = InputEvent::Type::MouseButton,
+               .action = GLFW_PRESS,
+               .code = GLFW_MOUSE_BUTTON_RIGHT});
+  state.apply({.type = InputEvent::Type::CursorPos, .x = 12.5, .y = 7.0});
+  EXPECT_TRUE(state.keyDown(GLFW_KEY_SPACE));
+  EXPECT_FALSE(state.keyDown(GLFW_KEY_ENTER));
+  EXPECT_TRUE(state.buttonDown(GLFW_MOUSE_BUTTON_RIGHT));
+  EXPECT_DOUBLE_EQ(state.cursorX(), 12.5);
+  EXPECT_DOUBLE_EQ(state.cursorY(), 7.0);
+
+  /* Repeats keep the key down; release lifts it */
+  state.apply(key(GLFW_KEY_SPACE, GLFW_REPEAT));
+  EXPECT_TRUE(state.keyDown(GLFW_KEY_SPACE));
+  state.apply(key(GLFW_KEY_SPACE, GLFW_RELEASE));
+  EXPECT_FALSE(state.keyDown(GLFW_KEY_SPACE));
+}
+
+TEST(InputState, IgnoresOutOfRangeCodes) {
+  InputState state;
+  state.apply(key(GLFW_KEY_UNKNOWN, GLFW_PRESS));
+  state.apply(key(100000, GLFW_PRESS));
+  state.apply({.type = InputEvent::Type::MouseButton,
+               .action = GLFW_PRESS,
+               .code = 42});
+  EXPECT_FALSE(state.keyDown(GLFW_KEY_UNKNOWN));
+  EXPECT_FALSE(state.keyDown(100000));
+  EXPECT_FALSE(state.buttonDown(42));
+}
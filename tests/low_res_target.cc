@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include "window.h"
+
+#include <array>
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+// Helper: headless window with a logical resolution. The render callback
+// clears the logical frame to `clear` and paints logical pixel (0, 0) red
+// ---------------------------------------------------------------------------
+static Window makeLowRes(size_t w, size_t h, size_t lw, size_t lh,
+                         const float *clear) {
+  return Window{w,
+                h,
+                "LowRes",
+                []() noexcept {},
+                [clear]() noexcept {
+                  glClearColor(clear[0], clear[1], clear[2], 1.0f);
+                  glClear(GL_COLOR_BUFFER_BIT);
+                  glEnable(GL_SCISSOR_TEST);
+                  glScissor(0, 0, 1, 1);
+                  glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
+                  glClear(GL_COLOR_BUFFER_BIT);
+                  glDisable(GL_SCISSOR_TEST);
+                },
+                []() noexcept {},
+                WindowOptions{.headless = true,
+                              .logical_width = lw,
+                              .logical_height = lh}};
+}
+
+/* RGB of a window pixel, origin bottom-left like glReadPixels */
+static std::array<uint8_t, 3> pixelAt(Window &w, size_t x, size_t y) {
+  w.offscreen()->flush();
+  const auto pixels = w.offscreen()->pixels();
+  const size_t i = (y * w.width() + x) * 4;
+  return {pixels[i], pixels[i + 1], pixels[i + 2]};
+}
+
+constexpr float kBlue[] = {0.0f, 0.0f, 1.0f};
+constexpr std::array<uint8_t, 3> kRed{255, 0, 0};
+constexpr std::array<uint8_t, 3> kBlueRgb{0, 0, 255};
+constexpr std::array<uint8_t, 3> kBlack{0, 0, 0};
+
+// ---------------------------------------------------------------------------
+// Window integration
+// ---------------------------------------------------------------------------
+TEST(LowResWindow, DisabledByDefault) {
+  Window w{
+      64, 64, "LowRes", []() noexcept {}, []() noexcept {}, []() noexcept {}};
+  EXPECT_EQ(w.lowRes(), nullptr);
+}
+
+TEST(LowResWindow, FramebufferIsLogicalTarget) {
+  auto w = makeLowRes(64, 48, 16, 12, kBlue);
+  ASSERT_NE(w.lowRes(), nullptr);
+  EXPECT_EQ(w.framebuffer(), w.lowRes()->framebuffer());
+  EXPECT_EQ(w.lowRes()->width(), 16u);
+  EXPECT_EQ(w.lowRes()->height(), 12u);
+}
+
+TEST(LowResWindow, CallbacksSeeLogicalViewport) {
+  GLint viewport[4]{};
+  Window w{64,
+           48,
+           "LowRes",
+           []() noexcept {},
+           [&viewport]() noexcept { glGetIntegerv(GL_VIEWPORT, viewport); },
+           []() noexcept {},
+           WindowOptions{
+               .headless = true, .logical_width = 16, .logical_height = 12}};
+  w.render();
+  w.render();
+  EXPECT_EQ(viewport[2], 16);
+  EXPECT_EQ(viewport[3], 12);
+}
+
+// ---------------------------------------------------------------------------
+// Presentation
+// ---------------------------------------------------------------------------
+TEST(LowResPresent, IntegerScaleFillsExactFit) {
+  auto w = makeLowRes(64, 48, 16, 12, kBlue);
+  w.render();
+  /* Logical pixel (0, 0) becomes a 4x4 block */
+  EXPECT_EQ(pixelAt(w, 0, 0), kRed);
+  EXPECT_EQ(pixelAt(w, 3, 3), kRed);
+  EXPECT_EQ(pixelAt(w, 4, 0), kBlueRgb);
+  EXPECT_EQ(pixelAt(w, 0, 4), kBlueRgb);
+  EXPECT_EQ(pixelAt(w, 63, 47), kBlueRgb);
+}
+
+TEST(LowResPresent, LetterboxesRemainder) {
+  auto w = makeLowRes(70, 48, 16, 12, kBlue);
+  w.render();
+  /* Scale 4 leaves 6 spare columns: 3 black on each side */
+  EXPECT_EQ(pixelAt(w, 0, 10), kBlack);
+  EXPECT_EQ(pixelAt(w, 2, 10), kBlack);
+  EXPECT_EQ(pixelAt(w, 3, 0), kRed);
+  EXPECT_EQ(pixelAt(w, 66, 10), kBlueRgb);
+  EXPECT_EQ(pixelAt(w, 67, 10), kBlack);
+}
+
+TEST(LowResPresent, ViewportUsesLargestIntegerScale) {
+  auto w = makeLowRes(64, 48, 16, 12, kBlue);
+  const auto vp = w.lowRes()->presentViewport(1920, 1080);
+  EXPECT_EQ(vp.width, 16 * 90);
+  EXPECT_EQ(vp.height, 12 * 90);
+  EXPECT_EQ(vp.x, (1920 - 16 * 90) / 2);
+  EXPECT_EQ(vp.y, 0);
+}
+
+TEST(LowResPresent, SmallerDestinationFitsFractionally) {
+  auto w = makeLowRes(64, 48, 16, 12, kBlue);
+  const auto vp = w.lowRes()->presentViewport(8, 12);
+  EXPECT_EQ(vp.width, 8);
+  EXPECT_EQ(vp.height, 6);
+  EXPECT_EQ(vp.y, 3);
+}
+
+// ---------------------------------------------------------------------------
+// Palette quantization
+// ---------------------------------------------------------------------------
+TEST(LowResPalette, SnapsToNearestColor) {
+  constexpr float kDarkRed[] = {0.7f, 0.1f, 0.1f};
+  auto w = makeLowRes(32, 24, 16, 12, kDarkRed);
+  const uint32_t palette[] = {0xFF000000, 0xFF0000FF, 0xFFFFFFFF};
+  w.lowRes()->setPalette(palette);
+  EXPECT_EQ(w.lowRes()->paletteSize(), 3u);
+  w.render();
+  EXPECT_EQ(pixelAt(w, 10, 10), kRed);
+}
+
+TEST(LowResPalette, EmptyPaletteDisablesQuantization) {
+  auto w = makeLowRes(32, 24, 16, 12, kBlue);
+  const uint32_t palette[] = {0xFF000000};
+  w.lowRes()->setPalette(palette);
+  w.lowRes()->setPalette({});
+  w.render();
+  EXPECT_EQ(pixelAt(w, 10, 10), kBlueRgb);
+}
+
+TEST(LowResPalette, TooManyColorsThrows) {
+  auto w = makeLowRes(32, 24, 16, 12, kBlue);
+  std::array<uint32_t, LowResTarget::kMaxPaletteSize + 1> palette{};
+  EXPECT_THROW(w.lowRes()->setPalette(palette), std::invalid_argument);
+}
+
+TEST(LowResPalette, PresentRestoresClearColorAndViewport) {
+  auto w = makeLowRes(32, 24, 16, 12, kBlue);
+  const uint32_t palette[] = {0xFF000000, 0xFF0000FF};
+  w.lowRes()->setPalette(palette);
+
+  glClearColor(0.25f, 0.5f, 0.75f, 1.0f);
+  glViewport(1, 2, 3, 4);
+  w.lowRes()->present(w.offscreen()->framebuffer(), 32, 24);
+
+  GLfloat color[4]{};
+  GLint viewport[4]{};
+  glGetFloatv(GL_COLOR_CLEAR_VALUE, color);
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  EXPECT_FLOAT_EQ(color[0], 0.25f);
+  EXPECT_FLOAT_EQ(color[1], 0.5f);
+  EXPECT_FLOAT_EQ(color[2], 0.75f);
+  EXPECT_FLOAT_EQ(color[3], 1.0f);
+  EXPECT_EQ(viewport[0], 1);
+  EXPECT_EQ(viewport[1], 2);
+  EXPECT_EQ(viewport[2], 3);
+  EXPECT_EQ(viewport[3], 4);
+}
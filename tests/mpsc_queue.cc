@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include "mpsc_queue.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Single-threaded semantics
+// ---------------------------------------------------------------------------
+TEST(MpscQueue, StartsEmpty) {
+  MpscQueue<int, 4> queue;
+  int value = -1;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_FALSE(queue.tryPop(value));
+  EXPECT_EQ(value, -1);
+}
+
+TEST(MpscQueue, RejectsPushWhenFull) {
+  MpscQueue<int, 4> queue;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.tryPush(i));
+  }
+  EXPECT_EQ(queue.size(), 4u);
+  EXPECT_FALSE(queue.tryPush(99));
+
+  /* Popping one frees exactly one slot */
+  int value = -1;
+  ASSERT_TRUE(queue.tryPop(value));
+  EXPECT_EQ(value, 0);
+  EXPECT_TRUE(queue.tryPush(4));
+  EXPECT_FALSE(queue.tryPush(5));
+}
+
+TEST(MpscQueue, DrainWrapsAroundTheRing) {
+  MpscQueue<int, 4> queue;
+  std::vector<int> seen;
+  for (int i = 0; i < 30; i += 3) {
+    ASSERT_TRUE(queue.tryPush(i));
+    ASSERT_TRUE(queue.tryPush(i + 1));
+    ASSERT_TRUE(queue.tryPush(i + 2));
+    EXPECT_EQ(queue.drain([&seen](const int &v) noexcept { seen.push_back(v); }),
+              3u);
+  }
+
+  ASSERT_EQ(seen.size(), 30u);
+  for (int i = 0; i < 30; ++i) {
+    EXPECT_EQ(seen[i], i);
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+// ---------------------------------------------------------------------------
+// Concurrent producers
+// ---------------------------------------------------------------------------
+TEST(MpscQueue, DeliversEveryProducersItemsInTheirOrder) {
+  constexpr uint64_t kProducers = 4;
+  constexpr uint64_t kItems = 100000;
+
+  /* Small enough that producers keep finding it full */
+  MpscQueue<uint64_t, 64> queue;
+  std::vector<std::thread> producers;
+  for (uint64_t p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&queue, p] {
+      for (uint64_t i = 1; i <= kItems;) {
+        if (queue.tryPush(p << 32 | i)) {
+          ++i;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  /* Each producer's items arrive in its own order, none lost or repeated */
+  std::vector<uint64_t> next(kProducers, 1);
+  uint64_t received = 0;
+  bool ordered = true;
+  while (received < kProducers * kItems) {
+    const size_t popped = queue.drain([&](const uint64_t &v) noexcept {
+      uint64_t &expected = next[v >> 32];
+      ordered = ordered && (v & 0xFFFFFFFF) == expected;
+      ++expected;
+    });
+    received += popped;
+    if (!popped) {
+      std::this_thread::yield();
+    }
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+
+  EXPECT_TRUE(ordered);
+  EXPECT_TRUE(queue.empty());
+  for (uint64_t n : next) {
+    EXPECT_EQ(n, kItems + 1);
+  }
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include "window.h"
+
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+// Helper: create a headless window that clears to a fixed color
+// ---------------------------------------------------------------------------
+static Window makeHeadless(size_t w = 32, size_t h = 16) {
+  return Window{w,
+                h,
+                "Headless",
+                []() noexcept {},
+                []() noexcept {
+                  glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
+                  glClear(GL_COLOR_BUFFER_BIT);
+                },
+                []() noexcept {},
+                WindowOptions{.headless = true}};
+}
+
+// ---------------------------------------------------------------------------
+// Window integration
+// ---------------------------------------------------------------------------
+TEST(OffscreenWindow, VisibleWindowHasNoOffscreenTarget) {
+  Window w{
+      64, 64, "Visible", []() noexcept {}, []() noexcept {}, []() noexcept {}};
+  EXPECT_FALSE(w.headless());
+  EXPECT_EQ(w.offscreen(), nullptr);
+  EXPECT_EQ(w.framebuffer(), 0u);
+}
+
+TEST(OffscreenWindow, HeadlessWindowHasFramebuffer) {
+  auto w = makeHeadless();
+  EXPECT_TRUE(w.headless());
+  ASSERT_NE(w.offscreen(), nullptr);
+  EXPECT_NE(w.framebuffer(), 0u);
+  EXPECT_EQ(w.offscreen()->width(), 32u);
+  EXPECT_EQ(w.offscreen()->height(), 16u);
+}
+
+TEST(OffscreenWindow, OffscreenTargetMovesWithWindow) {
+  auto w1 = makeHeadless();
+  Window w2{std::move(w1)};
+  EXPECT_FALSE(w1.headless());
+  EXPECT_TRUE(w2.headless());
+  EXPECT_NO_THROW(w2.render());
+}
+
+TEST(OffscreenWindow, DisablingProfilingKeepsOffscreenTarget) {
+  auto w = makeHeadless();
+  w.setProfiling(true);
+  w.setProfiling(false);
+  EXPECT_TRUE(w.headless());
+  EXPECT_NO_THROW(w.render());
+}
+
+// ---------------------------------------------------------------------------
+// Readback
+// ---------------------------------------------------------------------------
+TEST(OffscreenReadback, NoPixelsBeforeFirstFrame) {
+  auto w = makeHeadless();
+  EXPECT_TRUE(w.offscreen()->pixels().empty());
+}
+
+TEST(OffscreenReadback, ReadbackLagsOneFrame) {
+  auto w = makeHeadless();
+  w.render();
+  EXPECT_EQ(w.offscreen()->framesRead(), 0u);
+  w.render();
+  EXPECT_EQ(w.offscreen()->framesRead(), 1u);
+}
+
+TEST(OffscreenReadback, FlushCollectsPendingFrame) {
+  auto w = makeHeadless();
+  w.render();
+  w.offscreen()->flush();
+  EXPECT_EQ(w.offscreen()->framesRead(), 1u);
+  w.offscreen()->flush();
+  EXPECT_EQ(w.offscreen()->framesRead(), 1u);
+}
+
+TEST(OffscreenReadback, PixelsMatchRenderedFrame) {
+  auto w = makeHeadless(32, 16);
+  w.render();
+  w.offscreen()->flush();
+
+  const auto pixels = w.offscreen()->pixels();
+  ASSERT_EQ(pixels.size(), 32u * 16u * 4u);
+  for (size_t i = 0; i < pixels.size(); i += 4) {
+    ASSERT_EQ(pixels[i + 0], 255u);
+    ASSERT_EQ(pixels[i + 1], 0u);
+    ASSERT_EQ(pixels[i + 2], 0u);
+    ASSERT_EQ(pixels[i + 3], 255u);
+  }
+}
+
+TEST(OffscreenReadback, InitCallbackSeesOffscreenFramebuffer) {
+  GLint bound = -1;
+  Window w{16,
+           16,
+           "Headless",
+           [&bound]() noexcept {
+             glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &bound);
+           },
+           []() noexcept {},
+           []() noexcept {},
+           WindowOptions{.headless = true}};
+  EXPECT_EQ(static_cast<GLuint>(bound), w.framebuffer());
+}
@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+
+#include "gl_pixels.h"
+#include "particles.h"
+#include "window.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helpers: random spawns, and a headless window drawing GPU particles
+// ---------------------------------------------------------------------------
+constexpr uint32_t kBlack = 0xFF000000;
+constexpr uint32_t kRed = 0xFF0000FF;
+
+static std::vector<ParticleSpawn> randomSpawns(size_t count) {
+  std::mt19937 rng{17};
+  std::uniform_real_distribution<float> pos{0.0f, 320.0f}, vel{-50.0f, 50.0f},
+      life{0.05f, 2.0f};
+  std::vector<ParticleSpawn> spawns(count);
+  for (auto &p : spawns) {
+    p = {.x = pos(rng),
+         .y = pos(rng),
+         .vx = vel(rng),
+         .vy = vel(rng),
+         .life = life(rng)};
+  }
+  return spawns;
+}
+
+struct GpuFixture {
+  std::unique_ptr<GpuParticles> particles;
+  Window window;
+
+  explicit GpuFixture(size_t capacity, size_t w = 16, size_t h = 16)
+      : window{w,
+               h,
+               "Particles",
+               [this, capacity]() noexcept {
+                 particles = std::make_unique<GpuParticles>(capacity);
+               },
+               [this, w, h]() noexcept {
+                 glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+                 glClear(GL_COLOR_BUFFER_BIT);
+                 particles->draw(static_cast<float>(w),
+                                 static_cast<float>(h));
+               },
+               [this]() noexcept { particles.reset(); },
+               WindowOptions{.headless = true}} {}
+
+  std::vector<float> state() {
+    std::vector<float> state(particles->capacity() *
+                             GpuParticles::kStateFloats);
+    glBindBuffer(GL_ARRAY_BUFFER, particles->stateBuffer());
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0,
+                       static_cast<GLsizeiptr>(state.size() * sizeof(float)),
+                       state.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return state;
+  }
+};
+
+// ---------------------------------------------------------------------------
+// CPU simulation
+// ---------------------------------------------------------------------------
+TEST(CpuParticles, RejectsZeroCapacity) {
+  EXPECT_THROW(CpuParticles{0}, std::invalid_argument);
+}
+
+TEST(CpuParticles, IntegratesGravityAndDrag) {
+  CpuParticles particles{8};
+  const ParticleSpawn spawn{.x = 1.0f, .y = 2.0f, .vx = 2.0f, .life = 1.0f};
+  particles.emit({&spawn, 1});
+
+  /* Drag 0.5 over half a second keeps 75% of the velocity */
+  particles.update(0.5f, {.gravity_y = 10.0f, .drag = 0.5f});
+  EXPECT_FLOAT_EQ(particles.vx()[0], 1.5f);
+  EXPECT_FLOAT_EQ(particles.vy()[0], 3.75f);
+  EXPECT_FLOAT_EQ(particles.x()[0], 1.75f);
+  EXPECT_FLOAT_EQ(particles.y()[0], 3.875f);
+  EXPECT_FLOAT_EQ(particles.life()[0], 0.5f);
+}
+
+TEST(CpuParticles, DieWhenLifeRunsOut) {
+  CpuParticles particles{8};
+  const std::vector<ParticleSpawn> spawns{{.life = 0.1f}, {.life = 0.3f}};
+  particles.emit(spawns);
+  EXPECT_EQ(particles.alive(), 2u);
+  particles.update(0.2f, {});
+  EXPECT_EQ(particles.alive(), 1u);
+  particles.update(0.2f, {});
+  EXPECT_EQ(particles.alive(), 0u);
+}
+
+TEST(CpuParticles, EmitOverwritesTheOldest) {
+  CpuParticles particles{3};
+  std::vector<ParticleSpawn> spawns(4);
+  for (size_t i = 0; i < spawns.size(); ++i) {
+    spawns[i] = {.x = static_cast<float>(i), .life = 1.0f};
+  }
+  particles.emit(spawns);
+  EXPECT_EQ(particles.x()[0], 3.0f);
+  EXPECT_EQ(particles.x()[1], 1.0f);
+  EXPECT_EQ(particles.x()[2], 2.0f);
+}
+
+TEST(CpuParticles, KernelsAgreeBitForBit) {
+  /* Odd count so every kernel also runs its scalar tail */
+  const auto spawns = randomSpawns(1003);
+  const ParticleForces forces{.gravity_x = 3.0f, .gravity_y = 98.0f,
+                              .drag = 0.3f};
+
+  CpuParticles reference{spawns.size()};
+  ASSERT_EQ(reference.setIsa(SpanIsa::Scalar), SpanIsa::Scalar);
+  reference.emit(spawns);
+  for (int i = 0; i < 10; ++i) {
+    reference.update(1.0f / 60.0f, forces);
+  }
+
+  for (SpanIsa isa : {SpanIsa::Sse2, SpanIsa::Avx2}) {
+    CpuParticles particles{spawns.size()};
+    particles.setIsa(isa);
+    particles.emit(spawns);
+    for (int i = 0; i < 10; ++i) {
+      particles.update(1.0f / 60.0f, forces);
+    }
+    const auto equal = [](std::span<const float> a, std::span<const float> b) {
+      return std::vector(a.begin(), a.end()) == std::vector(b.begin(), b.end());
+    };
+    EXPECT_TRUE(equal(particles.x(), reference.x())) << spanIsaName(isa);
+    EXPECT_TRUE(equal(particles.y(), reference.y())) << spanIsaName(isa);
+    EXPECT_TRUE(equal(particles.vx(), reference.vx())) << spanIsaName(isa);
+    EXPECT_TRUE(equal(particles.vy(), reference.vy())) << spanIsaName(isa);
+    EXPECT_TRUE(equal(particles.life(), reference.life())) << spanIsaName(isa);
+  }
+}
+
+TEST(CpuParticles, DrawsLiveParticlesIntoRasterizer) {
+  SoftwareRasterizer rasterizer{16, 16, 1};
+  CpuParticles particles{4};
+  const std::vector<ParticleSpawn> spawns{
+      {.x = 4.0f, .y = 4.0f, .life = 1.0f, .size = 4.0f, .color = kRed},
+      {.x = 12.0f, .y = 12.0f, .life = -1.0f, .size = 4.0f, .color = kRed}};
+  particles.emit(spawns);
+
+  rasterizer.clear(kBlack);
+  particles.draw(rasterizer);
+  rasterizer.finish();
+  EXPECT_EQ(rasterizer.pixels()[4 * 16 + 4], kRed);
+  EXPECT_EQ(rasterizer.pixels()[12 * 16 + 12], kBlack);
+}
+
+// ---------------------------------------------------------------------------
+// GPU simulation
+// ---------------------------------------------------------------------------
+TEST(GpuParticles, MatchesCpuSimulation) {
+  const auto spawns = randomSpawns(500);
+  const ParticleForces forces{.gravity_y = 98.0f, .drag = 0.2f};
+
+  GpuFixture f{spawns.size()};
+  CpuParticles cpu{spawns.size()};
+  f.particles->emit(spawns);
+  cpu.emit(spawns);
+  for (int i = 0; i < 5; ++i) {
+    f.particles->update(1.0f / 60.0f, forces);
+    cpu.update(1.0f / 60.0f, forces);
+  }
+
+  const auto state = f.state();
+  for (size_t i = 0; i < spawns.size(); ++i) {
+    const float *s = state.data() + i * GpuParticles::kStateFloats;
+    ASSERT_NEAR(s[0], cpu.x()[i], 1e-3f) << i;
+    ASSERT_NEAR(s[1], cpu.y()[i], 1e-3f) << i;
+    ASSERT_NEAR(s[2], cpu.vx()[i], 1e-3f) << i;
+    ASSERT_NEAR(s[3], cpu.vy()[i], 1e-3f) << i;
+    ASSERT_NEAR(s[4], cpu.life()[i], 1e-5f) << i;
+  }
+}
+
+TEST(GpuParticles, EmitOverwritesTheOldest) {
+  GpuFixture f{4};
+  std::vector<ParticleSpawn> spawns(6);
+  for (size_t i = 0; i < spawns.size(); ++i) {
+    spawns[i] = {.x = static_cast<float>(i), .life = 1.0f};
+  }
+  f.particles->emit(std::span{spawns}.first(3));
+  f.particles->emit(std::span{spawns}.subspan(3));
+
+  const auto state = f.state();
+  const size_t k = GpuParticles::kStateFloats;
+  EXPECT_EQ(state[0 * k], 4.0f);
+  EXPECT_EQ(state[1 * k], 5.0f);
+  EXPECT_EQ(state[2 * k], 2.0f);
+  EXPECT_EQ(state[3 * k], 3.0f);
+}
+
+TEST(GpuParticles, DrawsLiveParticlesOnly) {
+  GpuFixture f{4};
+  const std::vector<ParticleSpawn> spawns{
+      {.x = 4.0f, .y = 4.0f, .life = 1.0f, .size = 4.0f, .color = kRed},
+      {.x = 12.0f, .y = 12.0f, .life = 0.01f, .size = 4.0f, .color = kRed}};
+  f.particles->emit(spawns);
+  f.particles->update(0.02f, {});
+
+  f.window.render();
+  EXPECT_EQ(readPixel(f.window, 4, 4), kRed);
+  EXPECT_EQ(readPixel(f.window, 12, 12), kBlack);
+  EXPECT_EQ(readPixel(f.window, 8, 8), kBlack);
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "radix_sort.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helper: sort with radixSort and return the result
+// ---------------------------------------------------------------------------
+static std::vector<SortEntry> sorted(std::vector<SortEntry> entries) {
+  std::vector<SortEntry> scratch(entries.size());
+  radixSort(entries, scratch);
+  return entries;
+}
+
+// ---------------------------------------------------------------------------
+// Ordering
+// ---------------------------------------------------------------------------
+TEST(RadixSort, EmptyAndSingleAreUnchanged) {
+  EXPECT_TRUE(sorted({}).empty());
+  EXPECT_EQ(sorted({{5, 0}}), (std::vector<SortEntry>{{5, 0}}));
+}
+
+TEST(RadixSort, MatchesStdSortOnRandomKeys) {
+  std::mt19937_64 rng{7};
+  std::vector<SortEntry> entries;
+  for (uint32_t i = 0; i < 10000; ++i) {
+    entries.emplace_back(rng(), i);
+  }
+
+  auto expected = entries;
+  std::stable_sort(expected.begin(), expected.end(),
+                   [](const auto &a, const auto &b) { return a.first < b.first; });
+  EXPECT_EQ(sorted(entries), expected);
+}
+
+TEST(RadixSort, IsStableForEqualKeys) {
+  std::vector<SortEntry> entries;
+  for (uint32_t i = 0; i < 100; ++i) {
+    entries.emplace_back(i % 3, i);
+  }
+
+  const auto result = sorted(entries);
+  for (size_t i = 1; i < result.size(); ++i) {
+    if (result[i].first == result[i - 1].first) {
+      EXPECT_LT(result[i - 1].second, result[i].second);
+    }
+  }
+}
+
+TEST(RadixSort, HandlesKeysInHighBytesOnly) {
+  std::vector<SortEntry> entries{
+      {3ULL << 56, 0}, {1ULL << 56, 1}, {2ULL << 56, 2}, {1ULL << 56, 3}};
+  const std::vector<SortEntry> expected{
+      {1ULL << 56, 1}, {1ULL << 56, 3}, {2ULL << 56, 2}, {3ULL << 56, 0}};
+  EXPECT_EQ(sorted(entries), expected);
+}
+
+TEST(RadixSort, ShortScratchLeavesInputUntouched) {
+  std::vector<SortEntry> entries{{2, 0}, {1, 1}};
+  std::vector<SortEntry> scratch(1);
+  radixSort(entries, scratch);
+  EXPECT_EQ(entries, (std::vector<SortEntry>{{2, 0}, {1, 1}}));
+}
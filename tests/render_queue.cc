@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include "render_queue.h"
+#include "window.h"
+
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helper: headless window that owns a trivial program and VAOs
+// ---------------------------------------------------------------------------
+struct QueueFixture {
+  GLuint programs[2]{};
+  GLuint vaos[2]{};
+  Window window;
+
+  QueueFixture()
+      : window{16,
+               16,
+               "RenderQueue",
+               [this]() noexcept {
+                 const char *vs = "#version 330 core\n"
+                                  "void main() { gl_Position = vec4(0.0); }\n";
+                 const char *fs = "#version 330 core\n"
+                                  "out vec4 c;\n"
+                                  "void main() { c = vec4(1.0); }\n";
+                 for (auto &program : programs) {
+                   const GLuint v = glCreateShader(GL_VERTEX_SHADER);
+                   glShaderSource(v, 1, &vs, nullptr);
+                   glCompileShader(v);
+                   const GLuint f = glCreateShader(GL_FRAGMENT_SHADER);
+                   glShaderSource(f, 1, &fs, nullptr);
+                   glCompileShader(f);
+                   program = glCreateProgram();
+                   glAttachShader(program, v);
+                   glAttachShader(program, f);
+                   glLinkProgram(program);
+                   glDeleteShader(v);
+                   glDeleteShader(f);
+                 }
+                 glGenVertexArrays(2, vaos);
+               },
+               []() noexcept {},
+               [this]() noexcept {
+                 glDeleteVertexArrays(2, vaos);
+                 glDeleteProgram(programs[0]);
+                 glDeleteProgram(programs[1]);
+               },
+               WindowOptions{.headless = true}} {}
+
+  DrawCommand draw(size_t program, size_t vao, float depth = 0.0f) const {
+    return {.program = programs[program],
+            .vao = vaos[vao],
+            .depth = depth,
+            .mode = GL_POINTS,
+            .count = 1,
+            .index_type = 0};
+  }
+};
+
+// ---------------------------------------------------------------------------
+// GLStateCache
+// ---------------------------------------------------------------------------
+TEST(GLStateCache, RepeatedBindIsSkipped) {
+  QueueFixture f;
+  GLStateCache state;
+  state.useProgram(f.programs[0]);
+  state.useProgram(f.programs[0]);
+  state.bindVertexArray(f.vaos[0]);
+  state.bindVertexArray(f.vaos[0]);
+  EXPECT_EQ(state.counters().binds_issued, 2u);
+  EXPECT_EQ(state.counters().binds_skipped, 2u);
+
+  GLint current = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+  EXPECT_EQ(static_cast<GLuint>(current), f.programs[0]);
+}
+
+TEST(GLStateCache, InvalidateForcesNextBind) {
+  QueueFixture f;
+  GLStateCache state;
+  state.useProgram(f.programs[0]);
+  glUseProgram(0);
+  state.invalidate();
+  state.useProgram(f.programs[0]);
+  EXPECT_EQ(state.counters().binds_issued, 2u);
+
+  GLint current = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+  EXPECT_EQ(static_cast<GLuint>(current), f.programs[0]);
+}
+
+TEST(GLStateCache, TexturesTrackedPerUnit) {
+  QueueFixture f;
+  GLuint textures[2]{};
+  glGenTextures(2, textures);
+
+  GLStateCache state;
+  state.bindTexture2D(0, textures[0]);
+  state.bindTexture2D(1, textures[0]);
+  state.bindTexture2D(0, textures[0]);
+  state.bindTexture2D(1, textures[1]);
+  EXPECT_EQ(state.counters().binds_issued, 3u);
+  EXPECT_EQ(state.counters().binds_skipped, 1u);
+
+  glDeleteTextures(2, textures);
+}
+
+TEST(GLStateCache, ResetCountersKeepsState) {
+  QueueFixture f;
+  GLStateCache state;
+  state.useProgram(f.programs[0]);
+  state.resetCounters();
+  state.useProgram(f.programs[0]);
+  EXPECT_EQ(state.counters().binds_issued, 0u);
+  EXPECT_EQ(state.counters().binds_skipped, 1u);
+}
+
+// ---------------------------------------------------------------------------
+// RenderQueue
+// ---------------------------------------------------------------------------
+TEST(RenderQueue, KeyOrdersProgramThenVaoThenTextureThenDepth) {
+  const auto key = [](GLuint p, GLuint v, GLuint t, float d) {
+    return RenderQueue::sortKey(
+        {.program = p, .vao = v, .texture = t, .depth = d});
+  };
+  EXPECT_LT(key(1, 9, 9, 1.0f), key(2, 0, 0, 0.0f));
+  EXPECT_LT(key(1, 1, 9, 1.0f), key(1, 2, 0, 0.0f));
+  EXPECT_LT(key(1, 1, 1, 1.0f), key(1, 1, 2, 0.0f));
+  EXPECT_LT(key(1, 1, 1, 0.25f), key(1, 1, 1, 0.5f));
+  EXPECT_EQ(key(1, 1, 1, -3.0f), key(1, 1, 1, 0.0f));
+}
+
+TEST(RenderQueue, SubmitGroupsByState) {
+  QueueFixture f;
+  RenderQueue queue;
+  GLStateCache state;
+
+  /* Worst case order: every draw alternates program and VAO */
+  for (int i = 0; i < 100; ++i) {
+    queue.push(f.draw(i % 2, (i / 2) % 2));
+  }
+  EXPECT_EQ(queue.size(), 100u);
+
+  queue.submit(state);
+  EXPECT_EQ(queue.size(), 0u);
+
+  /* 2 programs, each with 2 VAOs: 2 program + 4 VAO binds, and unit 0
+   * set to no texture once */
+  EXPECT_EQ(state.counters().binds_issued, 7u);
+  EXPECT_EQ(state.counters().binds_skipped, 293u);
+}
+
+TEST(RenderQueue, UntexturedDrawUnbindsPreviousTexture) {
+  QueueFixture f;
+  GLuint texture = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+               nullptr);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  /* Programs sort first, so the textured draw runs before the other */
+  const size_t first = f.programs[0] < f.programs[1] ? 0 : 1;
+  RenderQueue queue;
+  DrawCommand textured = f.draw(first, 0);
+  textured.texture = texture;
+  queue.push(f.draw(1 - first, 0));
+  queue.push(textured);
+
+  GLStateCache state;
+  queue.submit(state);
+
+  GLint bound = -1;
+  glActiveTexture(GL_TEXTURE0);
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+  EXPECT_EQ(bound, 0);
+  glDeleteTextures(1, &texture);
+}
+
+TEST(RenderQueue, ClearDropsCommands) {
+  QueueFixture f;
+  RenderQueue queue;
+  queue.push(f.draw(0, 0));
+  queue.clear();
+  EXPECT_EQ(queue.size(), 0u);
+
+  GLStateCache state;
+  queue.submit(state);
+  EXPECT_EQ(state.counters().binds_issued, 0u);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "render_thread.h"
+#include "triple_buffer.h"
+#include "window.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// ---------------------------------------------------------------------------
+// Helper: wait (bounded) until a condition holds
+// ---------------------------------------------------------------------------
+template <typename F> static bool waitFor(F &&condition) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds{10};
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Lifecycle
+// ---------------------------------------------------------------------------
+TEST(RenderThread, RendersOnAnotherThread) {
+  std::atomic<std::thread::id> render_id{};
+  Window w{16,
+           16,
+           "RenderThread",
+           []() noexcept {},
+           [&render_id]() noexcept {
+             render_id.store(std::this_thread::get_id());
+           },
+           []() noexcept {},
+           WindowOptions{.headless = true}};
+
+  RenderThread renderer{w};
+  ASSERT_TRUE(waitFor([&] { return renderer.frames() >= 3; }));
+  EXPECT_TRUE(renderer.running());
+  renderer.stop();
+
+  EXPECT_FALSE(renderer.running());
+  EXPECT_NE(render_id.load(), std::this_thread::get_id());
+}
+
+TEST(RenderThread, StopReturnsContextToCaller) {
+  Window w{16,
+           16,
+           "RenderThread",
+           []() noexcept {},
+           []() noexcept {
+             glClearColor(0.0f, 1.0f, 0.0f, 1.0f);
+             glClear(GL_COLOR_BUFFER_BIT);
+           },
+           []() noexcept {},
+           WindowOptions{.headless = true}};
+
+  RenderThread renderer{w};
+  ASSERT_TRUE(waitFor([&] { return renderer.frames() >= 2; }));
+  renderer.stop();
+
+  /* GL calls work on this thread again */
+  w.offscreen()->flush();
+  EXPECT_GE(w.offscreen()->framesRead(), 1u);
+  EXPECT_EQ(w.offscreen()->pixels()[1], 255);
+
+  /* And the window can keep rendering serially */
+  EXPECT_NO_THROW(w.render());
+}
+
+TEST(RenderThread, StopIsIdempotent) {
+  Window w{16,        16, "RenderThread", []() noexcept {}, []() noexcept {},
+           []() noexcept {}, WindowOptions{.headless = true}};
+  RenderThread renderer{w};
+  renderer.stop();
+  EXPECT_NO_THROW(renderer.stop());
+}
+
+TEST(RenderThread, DestructorJoinsAndWindowCleansUp) {
+  bool cleaned = false;
+  {
+    Window w{16,
+             16,
+             "RenderThread",
+             []() noexcept {},
+             []() noexcept {},
+             [&cleaned]() noexcept { cleaned = true; },
+             WindowOptions{.headless = true}};
+    RenderThread renderer{w};
+    ASSERT_TRUE(waitFor([&] { return renderer.frames() >= 1; }));
+  }
+  EXPECT_TRUE(cleaned);
+}
+
+// ---------------------------------------------------------------------------
+// Snapshot hand-off
+// ---------------------------------------------------------------------------
+TEST(RenderThread, RenderCallbackSeesPublishedSnapshots) {
+  TripleBuffer<int> snapshots;
+  std::atomic<int> seen{0};
+  Window w{16,
+           16,
+           "RenderThread",
+           []() noexcept {},
+           [&]() noexcept {
+             snapshots.update();
+             seen.store(snapshots.front());
+           },
+           []() noexcept {},
+           WindowOptions{.headless = true}};
+
+  RenderThread renderer{w};
+  for (int i = 1; i <= 100; ++i) {
+    snapshots.publish(i);
+  }
+  EXPECT_TRUE(waitFor([&] { return seen.load() == 100; }));
+  renderer.stop();
+}
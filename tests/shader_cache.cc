@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include "shader_cache.h"
+#include "window.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+static Window makeWindow() {
+  return Window{64,
+                64,
+                "ShaderCache",
+                []() noexcept {},
+                []() noexcept {},
+                []() noexcept {},
+                WindowOptions{.headless = true}};
+}
+
+static const std::string kVertex = "#version 330 core\n"
+                                   "layout (location = 0) in vec3 aPos;\n"
+                                   "void main() { gl_Position = vec4(aPos, "
+                                   "1.0); }\n";
+
+static std::string fragment(float red) {
+  return "#version 330 core\n"
+         "out vec4 FragColor;\n"
+         "void main() { FragColor = vec4(" +
+         std::to_string(red) + ", 0.0, 0.0, 1.0); }\n";
+}
+
+/* Fresh cache directory per test, removed afterwards */
+class ShaderCacheDisk : public ::testing::Test {
+protected:
+  std::filesystem::path dir_ =
+      std::filesystem::temp_directory_path() /
+      ("libretro_shader_cache_" +
+       std::string{
+           ::testing::UnitTest::GetInstance()->current_test_info()->name()});
+
+  void SetUp() override { std::filesystem::remove_all(dir_); }
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+};
+
+// ---------------------------------------------------------------------------
+// Deduplication and errors
+// ---------------------------------------------------------------------------
+TEST(ShaderCacheMemory, IdenticalSourcesShareProgram) {
+  auto w = makeWindow();
+  ShaderCache cache;
+  const GLuint a = cache.program(kVertex, fragment(1.0f));
+  const GLuint b = cache.program(kVertex, fragment(1.0f));
+  EXPECT_NE(a, 0u);
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(cache.stats().programs_linked, 1u);
+  EXPECT_EQ(cache.stats().dedup_hits, 1u);
+}
+
+TEST(ShaderCacheMemory, SharedStageCompiledOnce) {
+  auto w = makeWindow();
+  ShaderCache cache;
+  const GLuint a = cache.program(kVertex, fragment(1.0f));
+  const GLuint b = cache.program(kVertex, fragment(0.5f));
+  EXPECT_NE(a, b);
+  EXPECT_EQ(cache.stats().shaders_compiled, 3u);
+  EXPECT_EQ(cache.stats().programs_linked, 2u);
+}
+
+TEST(ShaderCacheMemory, ReleasedShadersRecompileOnMiss) {
+  auto w = makeWindow();
+  ShaderCache cache;
+  cache.program(kVertex, fragment(1.0f));
+  cache.releaseShaders();
+  cache.program(kVertex, fragment(0.5f));
+  EXPECT_EQ(cache.stats().shaders_compiled, 4u);
+}
+
+TEST(ShaderCacheMemory, CompileErrorThrowsWithLog) {
+  auto w = makeWindow();
+  ShaderCache cache;
+  try {
+    cache.program(kVertex, "#version 330 core\nvoid main() { oops; }\n");
+    FAIL() << "expected ShaderError";
+  } catch (const ShaderError &e) {
+    EXPECT_NE(std::string{e.what()}.find("fragment"), std::string::npos);
+  }
+}
+
+TEST(ShaderCacheMemory, LinkErrorThrows) {
+  auto w = makeWindow();
+  ShaderCache cache;
+  /* Compiles on its own, but a stage without main() cannot link */
+  const std::string bad_fragment = "#version 330 core\n"
+                                   "void helper() {}\n";
+  EXPECT_THROW(cache.program(kVertex, bad_fragment), ShaderError);
+}
+
+// ---------------------------------------------------------------------------
+// Uncached programs
+// ---------------------------------------------------------------------------
+TEST(BuildProgram, LinksOwnedProgram) {
+  auto w = makeWindow();
+  const std::string red = fragment(1.0f);
+  const GLuint program = buildProgram(
+      {{GL_VERTEX_SHADER, kVertex.c_str()}, {GL_FRAGMENT_SHADER, red.c_str()}});
+  EXPECT_NE(program, 0u);
+
+  GLint attached = -1;
+  glGetProgramiv(program, GL_ATTACHED_SHADERS, &attached);
+  EXPECT_EQ(attached, 2);
+  glDeleteProgram(program);
+}
+
+TEST(BuildProgram, CapturesVaryings) {
+  auto w = makeWindow();
+  const char *source = "#version 330 core\n"
+                       "out float outValue;\n"
+                       "void main() { outValue = 1.0; }\n";
+  const char *const varyings[] = {"outValue"};
+  const GLuint program = buildProgram({{GL_VERTEX_SHADER, source}}, varyings);
+
+  GLint count = 0;
+  glGetProgramiv(program, GL_TRANSFORM_FEEDBACK_VARYINGS, &count);
+  EXPECT_EQ(count, 1);
+  glDeleteProgram(program);
+}
+
+TEST(BuildProgram, ErrorsThrowShaderError) {
+  auto w = makeWindow();
+  try {
+    buildProgram({{GL_VERTEX_SHADER, kVertex.c_str()},
+                  {GL_FRAGMENT_SHADER, "#version 330 core\noops;\n"}});
+    FAIL() << "expected ShaderError";
+  } catch (const ShaderError &e) {
+    EXPECT_NE(std::string{e.what()}.find("fragment"), std::string::npos);
+  }
+  EXPECT_THROW(buildProgram({{GL_VERTEX_SHADER, kVertex.c_str()},
+                             {GL_FRAGMENT_SHADER, "#version 330 core\n"
+                                                  "void helper() {}\n"}}),
+               ShaderError);
+}
+
+// ---------------------------------------------------------------------------
+// On-disk program binaries
+// ---------------------------------------------------------------------------
+TEST_F(ShaderCacheDisk, ColdCacheStoresBinary) {
+  auto w = makeWindow();
+  ShaderCache cache{dir_};
+  if (!cache.binarySupported()) {
+    GTEST_SKIP() << "driver exposes no program binary formats";
+  }
+  cache.program(kVertex, fragment(1.0f));
+  EXPECT_EQ(cache.stats().binary_stores, 1u);
+  EXPECT_FALSE(std::filesystem::is_empty(dir_));
+}
+
+TEST_F(ShaderCacheDisk, WarmCacheSkipsCompilation) {
+  auto w = makeWindow();
+  {
+    ShaderCache cold{dir_};
+    if (!cold.binarySupported()) {
+      GTEST_SKIP() << "driver exposes no program binary formats";
+    }
+    cold.program(kVertex, fragment(1.0f));
+  }
+
+  ShaderCache warm{dir_};
+  EXPECT_NE(warm.program(kVertex, fragment(1.0f)), 0u);
+  EXPECT_EQ(warm.stats().binary_loads, 1u);
+  EXPECT_EQ(warm.stats().shaders_compiled, 0u);
+  EXPECT_EQ(warm.stats().programs_linked, 0u);
+}
+
+TEST_F(ShaderCacheDisk, CorruptBinaryFallsBackToSource) {
+  auto w = makeWindow();
+  {
+    ShaderCache cold{dir_};
+    if (!cold.binarySupported()) {
+      GTEST_SKIP() << "driver exposes no program binary formats";
+    }
+    cold.program(kVertex, fragment(1.0f));
+  }
+
+  for (const auto &entry : std::filesystem::directory_iterator{dir_}) {
+    std::ofstream{entry.path(), std::ios::binary | std::ios::trunc}
+        << "garbage";
+  }
+
+  ShaderCache warm{dir_};
+  EXPECT_NE(warm.program(kVertex, fragment(1.0f)), 0u);
+  EXPECT_EQ(warm.stats().binary_loads, 0u);
+  EXPECT_EQ(warm.stats().programs_linked, 1u);
+}
@@ -0,0 +1,483 @@
+#include <gtest/gtest.h>
+
+#include "software_rasterizer.h"
+#include "sprite_batch.h"
+#include "window.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helpers: a scene both backends can draw. Sprites refer to scene textures
+// by 1-based index, which is exactly the id the rasterizer hands out
+// ---------------------------------------------------------------------------
+struct Triangle {
+  SoftwareRasterizer::Point a, b, c;
+  uint32_t color;
+};
+
+struct TextureData {
+  size_t width;
+  size_t height;
+  std::vector<uint32_t> pixels;
+};
+
+struct Scene {
+  size_t width = 96;
+  size_t height = 80;
+  uint32_t clear = Sprite::rgba(20, 40, 60);
+  std::vector<TextureData> textures;
+  std::vector<Sprite> sprites;
+  std::vector<Triangle> triangles;
+};
+
+static std::vector<uint32_t> renderSoftware(const Scene &scene,
+                                            size_t threads = 1) {
+  SoftwareRasterizer raster{scene.width, scene.height, threads};
+  for (const auto &t : scene.textures) {
+    raster.createTexture(t.width, t.height, t.pixels);
+  }
+  raster.clear(scene.clear);
+  for (const Sprite &s : scene.sprites) {
+    raster.draw(s);
+  }
+  for (const Triangle &t : scene.triangles) {
+    raster.drawTriangle(t.a, t.b, t.c, t.color);
+  }
+  raster.finish();
+  return {raster.pixels().begin(), raster.pixels().end()};
+}
+
+/* Flat-colored triangles in pixel coordinates, blended like sprites */
+const char *kTriangleVertex = "#version 330 core\n"
+                              "layout (location = 0) in vec2 aPos;\n"
+                              "uniform vec2 uViewport;\n"
+                              "void main()\n"
+                              "{\n"
+                              "  vec2 ndc = aPos / uViewport * 2.0 - 1.0;\n"
+                              "  gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);\n"
+                              "}\n";
+
+const char *kTriangleFragment = "#version 330 core\n"
+                                "uniform vec4 uColor;\n"
+                                "out vec4 FragColor;\n"
+                                "void main()\n"
+                                "{\n"
+                                "  FragColor = uColor;\n"
+                                "}\n";
+
+struct GlResources {
+  std::unique_ptr<SpriteBatch> batch;
+  std::vector<GLuint> textures;
+  GLuint program{};
+  GLuint vao{};
+  GLuint vbo{};
+
+  void create(const Scene &scene) {
+    batch = std::make_unique<SpriteBatch>(16);
+    for (const auto &t : scene.textures) {
+      GLuint texture = 0;
+      glGenTextures(1, &texture);
+      glBindTexture(GL_TEXTURE_2D, texture);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, static_cast<GLsizei>(t.width),
+                   static_cast<GLsizei>(t.height), 0, GL_RGBA,
+                   GL_UNSIGNED_BYTE, t.pixels.data());
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      textures.push_back(texture);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    const GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &kTriangleVertex, nullptr);
+    glCompileShader(vertex);
+    const GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment, 1, &kTriangleFragment, nullptr);
+    glCompileShader(fragment);
+    program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+  }
+
+  void draw(const Scene &scene) {
+    const auto w = static_cast<float>(scene.width);
+    const auto h = static_cast<float>(scene.height);
+    const auto channel = [](uint32_t color, int c) {
+      return static_cast<float>((color >> (c * 8)) & 0xFF) / 255.0f;
+    };
+
+    glClearColor(channel(scene.clear, 0), channel(scene.clear, 1),
+                 channel(scene.clear, 2), channel(scene.clear, 3));
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    /* One batch per sprite keeps submission order across textures */
+    for (Sprite s : scene.sprites) {
+      s.texture = s.texture ? textures[s.texture - 1] : 0;
+      batch->begin(w, h);
+      batch->draw(s);
+      batch->end();
+    }
+
+    glUseProgram(program);
+    glUniform2f(glGetUniformLocation(program, "uViewport"), w, h);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    for (const Triangle &t : scene.triangles) {
+      const float vertices[] = {t.a.x, t.a.y, t.b.x, t.b.y, t.c.x, t.c.y};
+      glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices,
+                   GL_STREAM_DRAW);
+      glUniform4f(glGetUniformLocation(program, "uColor"),
+                  channel(t.color, 0), channel(t.color, 1),
+                  channel(t.color, 2), channel(t.color, 3));
+      glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    glDisable(GL_BLEND);
+    glBindVertexArray(0);
+  }
+
+  void destroy() noexcept {
+    batch.reset();
+    glDeleteTextures(static_cast<GLsizei>(textures.size()), textures.data());
+    glDeleteProgram(program);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+  }
+};
+
+/* The same scene through SpriteBatch on the GPU, rows top to bottom */
+static std::vector<uint32_t> renderGl(const Scene &scene) {
+  GlResources gl;
+  Window window{scene.width,
+                scene.height,
+                "SoftwareRasterizer",
+                [&gl, &scene]() noexcept { gl.create(scene); },
+                [&gl, &scene]() noexcept { gl.draw(scene); },
+                [&gl]() noexcept { gl.destroy(); },
+                WindowOptions{.headless = true}};
+  window.render();
+  window.offscreen()->flush();
+
+  const auto bytes = window.offscreen()->pixels();
+  std::vector<uint32_t> pixels(scene.width * scene.height);
+  for (size_t y = 0; y < scene.height; ++y) {
+    const uint8_t *row = &bytes[(scene.height - 1 - y) * scene.width * 4];
+    for (size_t x = 0; x < scene.width; ++x) {
+      const uint8_t *p = row + x * 4;
+      pixels[y * scene.width + x] = Sprite::rgba(p[0], p[1], p[2], p[3]);
+    }
+  }
+  return pixels;
+}
+
+static ::testing::AssertionResult samePixels(const std::vector<uint32_t> &a,
+                                             const std::vector<uint32_t> &b,
+                                             size_t width) {
+  size_t mismatches = 0;
+  size_t first = 0;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i] != b[i] && mismatches++ == 0) {
+      first = i;
+    }
+  }
+  if (mismatches == 0) {
+    return ::testing::AssertionSuccess();
+  }
+  char message[128];
+  std::snprintf(message, sizeof(message),
+                "%zu pixels differ, first at (%zu, %zu): %08x vs %08x",
+                mismatches, first % width, first / width, a[first], b[first]);
+  return ::testing::AssertionFailure() << message;
+}
+
+/* 4x4 texture whose texels are all distinct */
+static TextureData gradient(uint8_t alpha = 255) {
+  TextureData t{4, 4, {}};
+  for (uint32_t i = 0; i < 16; ++i) {
+    t.pixels.push_back(Sprite::rgba(static_cast<uint8_t>(i * 16),
+                                    static_cast<uint8_t>(255 - i * 16),
+                                    static_cast<uint8_t>(i * 7), alpha));
+  }
+  return t;
+}
+
+constexpr uint32_t kRed = Sprite::rgba(255, 0, 0);
+constexpr uint32_t kGreen = Sprite::rgba(0, 255, 0);
+constexpr uint32_t kBlue = Sprite::rgba(0, 0, 255);
+
+// ---------------------------------------------------------------------------
+// Rasterization rules
+// ---------------------------------------------------------------------------
+TEST(SoftwareRasterizer, ClearFillsEveryPixel) {
+  Scene scene;
+  const auto pixels = renderSoftware(scene);
+  for (const uint32_t p : pixels) {
+    ASSERT_EQ(p, scene.clear);
+  }
+}
+
+TEST(SoftwareRasterizer, SpriteCoversPixelCentresInside) {
+  Scene scene{.width = 8, .height = 8, .clear = 0};
+  scene.sprites.push_back(
+      {.x = 0.6f, .y = 1.4f, .width = 1.0f, .height = 1.0f, .color = kRed});
+  const auto pixels = renderSoftware(scene);
+  /* Only pixel (1, 1) has its centre inside [0.6, 1.6) x [1.4, 2.4) */
+  for (size_t i = 0; i < pixels.size(); ++i) {
+    EXPECT_EQ(pixels[i], i == 1 * 8 + 1 ? kRed : 0u) << i;
+  }
+}
+
+TEST(SoftwareRasterizer, SharedEdgeIsCoveredOnce) {
+  Scene scene{.width = 32, .height = 32, .clear = 0xFF000000};
+  const uint32_t half = Sprite::rgba(255, 255, 255, 128);
+  /* The diagonal runs through pixel centres */
+  scene.triangles.push_back({{0, 0}, {32, 0}, {32, 32}, half});
+  scene.triangles.push_back({{0, 0}, {32, 32}, {0, 32}, half});
+  const auto pixels = renderSoftware(scene);
+  for (const uint32_t p : pixels) {
+    ASSERT_EQ(p, Sprite::rgba(128, 128, 128, 191));
+  }
+}
+
+TEST(SoftwareRasterizer, ClearDropsEarlierCommands) {
+  SoftwareRasterizer raster{32, 32, 1};
+  raster.draw({.width = 8, .height = 8});
+  raster.drawTriangle({0, 0}, {8, 0}, {0, 8}, kRed);
+  raster.clear(kBlue);
+  raster.finish();
+  EXPECT_EQ(raster.stats().commands, 1u);
+  EXPECT_EQ(raster.pixels()[0], kBlue);
+}
+
+TEST(SoftwareRasterizer, DegenerateTriangleDrawsNothing) {
+  SoftwareRasterizer raster{16, 16, 1};
+  raster.drawTriangle({0, 0}, {8, 8}, {16, 16}, kRed);
+  raster.finish();
+  EXPECT_EQ(raster.stats().commands, 0u);
+}
+
+TEST(SoftwareRasterizer, BinsOnlyTouchedTiles) {
+  SoftwareRasterizer raster{256, 128, 1};
+  raster.draw({.x = 60, .y = 10, .width = 8, .height = 8});
+  raster.finish();
+  /* Straddles the boundary between the first two tiles */
+  EXPECT_EQ(raster.stats().tiles, 2u);
+}
+
+TEST(SoftwareRasterizer, InvalidArgumentsThrow) {
+  EXPECT_THROW(SoftwareRasterizer(0, 16), std::invalid_argument);
+  SoftwareRasterizer raster{16, 16, 1};
+  const uint32_t texel = kRed;
+  EXPECT_THROW(raster.createTexture(2, 2, {&texel, 1}), std::invalid_argument);
+  EXPECT_THROW(raster.draw({.texture = 1}), std::invalid_argument);
+}
+
+// ---------------------------------------------------------------------------
+// Threading: tiles keep submission order, so any thread count gives the
+// same frame
+// ---------------------------------------------------------------------------
+TEST(SoftwareRasterizerThreads, ResultIndependentOfThreadCount) {
+  Scene scene{.width = 320, .height = 240};
+  scene.textures.push_back(gradient(160));
+  std::mt19937 rng{7};
+  std::uniform_real_distribution<float> pos{-16.0f, 320.0f};
+  for (int i = 0; i < 2000; ++i) {
+    scene.sprites.push_back({.x = pos(rng),
+                             .y = pos(rng),
+                             .width = 24,
+                             .height = 24,
+                             .color = static_cast<uint32_t>(rng()) | 0x40000000,
+                             .texture = static_cast<uint32_t>(i % 2)});
+  }
+  for (int i = 0; i < 200; ++i) {
+    scene.triangles.push_back(
+        {{pos(rng), pos(rng)}, {pos(rng), pos(rng)}, {pos(rng), pos(rng)},
+         static_cast<uint32_t>(rng())});
+  }
+  const auto serial = renderSoftware(scene, 1);
+  EXPECT_TRUE(samePixels(renderSoftware(scene, 4), serial, scene.width));
+  EXPECT_TRUE(samePixels(renderSoftware(scene, 7), serial, scene.width));
+}
+
+// ---------------------------------------------------------------------------
+// Pixel-exact against the GL path
+// ---------------------------------------------------------------------------
+TEST(SoftwareRasterizerVsGl, OpaqueSprites) {
+  Scene scene;
+  scene.sprites.push_back(
+      {.x = 3.3f, .y = 2.7f, .width = 70.6f, .height = 20.2f, .color = kRed});
+  scene.sprites.push_back({.x = 50.1f,
+                           .y = 10.9f,
+                           .width = 30.3f,
+                           .height = 60.4f,
+                           .color = kGreen});
+  scene.sprites.push_back(
+      {.x = -5.0f, .y = 70.2f, .width = 120.0f, .height = 30.0f, .color = kBlue});
+  EXPECT_TRUE(samePixels(renderSoftware(scene), renderGl(scene), scene.width));
+}
+
+TEST(SoftwareRasterizerVsGl, TexturedSprites) {
+  Scene scene;
+  scene.textures.push_back(gradient());
+  /* Magnified 3x, tinted, repeated twice and mirrored */
+  scene.sprites.push_back({.x = 2, .y = 2, .width = 12, .height = 12,
+                           .texture = 1});
+  scene.sprites.push_back({.x = 20,
+                           .y = 4,
+                           .width = 40,
+                           .height = 24,
+                           .color = Sprite::rgba(200, 150, 100),
+                           .texture = 1});
+  scene.sprites.push_back({.x = 10,
+                           .y = 40,
+                           .width = 48,
+                           .height = 32,
+                           .u1 = 2.0f,
+                           .v1 = 2.0f,
+                           .texture = 1});
+  scene.sprites.push_back({.x = 60,
+                           .y = 30,
+                           .width = 32,
+                           .height = 32,
+                           .u0 = 1.0f,
+                           .u1 = 0.0f,
+                           .texture = 1});
+  EXPECT_TRUE(samePixels(renderSoftware(scene), renderGl(scene), scene.width));
+}
+
+TEST(SoftwareRasterizerVsGl, TranslucentSprites) {
+  Scene scene;
+  scene.textures.push_back(gradient(100));
+  scene.sprites.push_back({.x = 4,
+                           .y = 4,
+                           .width = 60,
+                           .height = 50,
+                           .color = Sprite::rgba(255, 0, 0, 128)});
+  scene.sprites.push_back({.x = 30,
+                           .y = 20,
+                           .width = 60,
+                           .height = 50,
+                           .color = Sprite::rgba(0, 200, 255, 30)});
+  scene.sprites.push_back({.x = 10,
+                           .y = 30,
+                           .width = 40,
+                           .height = 40,
+                           .color = Sprite::rgba(255, 255, 255, 201),
+                           .texture = 1});
+  EXPECT_TRUE(samePixels(renderSoftware(scene), renderGl(scene), scene.width));
+}
+
+TEST(SoftwareRasterizerVsGl, Triangles) {
+  Scene scene;
+  scene.triangles.push_back({{5.25f, 3.5f}, {90.75f, 20.25f}, {30.5f, 75.0f},
+                             kRed});
+  /* Both windings, translucent, and a quad split along pixel centres */
+  scene.triangles.push_back({{70.0f, 10.0f}, {20.25f, 40.5f}, {80.5f, 70.75f},
+                             Sprite::rgba(0, 255, 0, 140)});
+  scene.triangles.push_back({{8, 40}, {40, 40}, {40, 72}, kBlue});
+  scene.triangles.push_back({{8, 40}, {40, 72}, {8, 72},
+                             Sprite::rgba(255, 255, 0, 90)});
+  scene.triangles.push_back({{60.5f, 60.25f}, {95.0f, 79.5f}, {1.0f, 79.0f},
+                             Sprite::rgba(255, 0, 255, 200)});
+  EXPECT_TRUE(samePixels(renderSoftware(scene), renderGl(scene), scene.width));
+}
+
+// ---------------------------------------------------------------------------
+// Presentation
+// ---------------------------------------------------------------------------
+TEST(SoftwareRasterizerPresent, UploadMatchesPixels) {
+  std::unique_ptr<SoftwareRasterizer> raster;
+  Window window{48,
+                40,
+                "SoftwarePresent",
+                [&raster]() noexcept {
+                  raster = std::make_unique<SoftwareRasterizer>(48, 40, 2);
+                },
+                [&raster, &window]() noexcept {
+                  raster->clear(kBlue);
+                  raster->draw({.x = 4, .y = 2, .width = 8, .height = 3,
+                                .color = kRed});
+                  raster->finish();
+                  raster->present(window.framebuffer(), 48, 40);
+                },
+                [&raster]() noexcept { raster.reset(); },
+                WindowOptions{.headless = true}};
+  window.render();
+  window.offscreen()->flush();
+
+  /* Readback rows are bottom to top */
+  const auto bytes = window.offscreen()->pixels();
+  const auto pixel = [&bytes](size_t x, size_t y) {
+    const uint8_t *p = &bytes[((39 - y) * 48 + x) * 4];
+    return Sprite::rgba(p[0], p[1], p[2], p[3]);
+  };
+  EXPECT_EQ(pixel(4, 2), kRed);
+  EXPECT_EQ(pixel(11, 4), kRed);
+  EXPECT_EQ(pixel(12, 4), kBlue);
+  EXPECT_EQ(pixel(4, 5), kBlue);
+  EXPECT_EQ(raster->stats().uploads, 1u);
+}
+
+TEST(SoftwareWindow, DisabledByDefault) {
+  Window w{16, 16, "Software", []() noexcept {}, []() noexcept {},
+           []() noexcept {}, WindowOptions{.headless = true}};
+  EXPECT_EQ(w.software(), nullptr);
+}
+
+TEST(SoftwareWindow, HeadlessOutputsPixelsDirectly) {
+  SoftwareRasterizer *raster = nullptr;
+  Window w{64,
+           48,
+           "Software",
+           []() noexcept {},
+           [&raster]() noexcept {
+             raster->clear(kGreen);
+             raster->draw({.width = 1, .height = 1, .color = kRed});
+           },
+           []() noexcept {},
+           WindowOptions{.headless = true,
+                         .logical_width = 16,
+                         .logical_height = 12,
+                         .software = true,
+                         .software_threads = 2}};
+  raster = w.software();
+  ASSERT_NE(raster, nullptr);
+  EXPECT_TRUE(w.headless());
+  EXPECT_EQ(w.offscreen(), nullptr);
+  EXPECT_EQ(w.lowRes(), nullptr);
+  EXPECT_EQ(raster->width(), 16u);
+  EXPECT_EQ(raster->height(), 12u);
+  EXPECT_EQ(raster->threads(), 2u);
+
+  w.render();
+  EXPECT_EQ(raster->pixels()[0], kRed);
+  EXPECT_EQ(raster->pixels()[1], kGreen);
+  EXPECT_EQ(raster->stats().uploads, 0u);
+}
+
+TEST(SoftwareWindow, VisibleWindowUploadsOncePerFrame) {
+  Window w{32, 24, "Software", []() noexcept {}, []() noexcept {},
+           []() noexcept {},
+           WindowOptions{.logical_width = 16,
+                         .logical_height = 12,
+                         .software = true}};
+  ASSERT_NE(w.software(), nullptr);
+  w.render();
+  w.render();
+  EXPECT_EQ(w.software()->stats().uploads, 2u);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include "span_kernels.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helpers: restore the default kernels after each test, random pixels, and
+// the instruction sets this CPU can run
+// ---------------------------------------------------------------------------
+struct SpanKernels : ::testing::Test {
+  SpanIsa saved = spanIsa();
+  ~SpanKernels() override { setSpanIsa(saved); }
+};
+
+static std::vector<uint32_t> randomPixels(size_t count, uint32_t seed) {
+  std::mt19937 rng{seed};
+  std::vector<uint32_t> pixels(count);
+  for (auto &p : pixels) {
+    p = rng();
+  }
+  /* Make sure the extremes are covered */
+  pixels[0] = 0x00000000;
+  pixels[1] = 0xFFFFFFFF;
+  pixels[2] = 0x80FFFFFF;
+  return pixels;
+}
+
+static std::vector<SpanIsa> supportedIsas() {
+  std::vector<SpanIsa> isas;
+  for (const SpanIsa isa : {SpanIsa::Scalar, SpanIsa::Sse2, SpanIsa::Avx2}) {
+    if (setSpanIsa(isa) == isa) {
+      isas.push_back(isa);
+    }
+  }
+  return isas;
+}
+
+// Odd length so the vector loops leave a scalar tail
+constexpr size_t kCount = 1031;
+
+// ---------------------------------------------------------------------------
+// Scalar reference
+// ---------------------------------------------------------------------------
+TEST_F(SpanKernels, ScalarModulateRoundsToNearest) {
+  setSpanIsa(SpanIsa::Scalar);
+  const uint32_t src = 0x80FF4001;
+  uint32_t dst = 0;
+  modulateSpan(&dst, &src, 1, 0x80808080);
+  /* a: 128*128/255 = 64.25, b: 255*128/255 = 128, g: 64*128/255 = 32.13,
+   * r: 1*128/255 = 0.502 */
+  EXPECT_EQ(dst, 0x40802001u);
+}
+
+TEST_F(SpanKernels, ScalarBlendMatchesGlFormula) {
+  setSpanIsa(SpanIsa::Scalar);
+  const uint32_t src = 0x80FF0000; // blue, alpha 128
+  uint32_t dst = 0xFF0000FF;       // opaque red
+  blendSpan(&dst, &src, 1);
+  /* r: 255*127/255 = 127, b: 255*128/255 = 128,
+   * a: 128*128/255 + 255*127/255 = 64.25 + 127 */
+  EXPECT_EQ(dst, 0xBF80007Fu);
+}
+
+TEST_F(SpanKernels, BlendRoundsEachProduct) {
+  setSpanIsa(SpanIsa::Scalar);
+  const uint32_t src = 0x1E00C800;
+  uint32_t dst = 0xFF001400;
+  blendSpan(&dst, &src, 1);
+  /* g: 200*30/255 = 23.53 and 20*225/255 = 17.65 round to 24 + 18, where
+   * rounding the sum (41.18) would give 41 */
+  EXPECT_EQ((dst >> 8) & 0xFF, 42u);
+}
+
+TEST_F(SpanKernels, BlendExtremesAreExact) {
+  setSpanIsa(SpanIsa::Scalar);
+  const uint32_t src[] = {0x00123456, 0xFF123456};
+  uint32_t dst[] = {0xFFABCDEF, 0xFFABCDEF};
+  blendSpan(dst, src, 2);
+  EXPECT_EQ(dst[0], 0xFFABCDEFu);
+  EXPECT_EQ(dst[1], 0xFF123456u);
+}
+
+// ---------------------------------------------------------------------------
+// Every instruction set matches the scalar kernels bit for bit
+// ---------------------------------------------------------------------------
+TEST_F(SpanKernels, FillMatchesScalar) {
+  for (const SpanIsa isa : supportedIsas()) {
+    setSpanIsa(isa);
+    std::vector<uint32_t> dst(kCount, 0);
+    fillSpan(dst.data() + 1, kCount - 2, 0x11223344);
+    EXPECT_EQ(dst.front(), 0u) << spanIsaName(isa);
+    EXPECT_EQ(dst.back(), 0u) << spanIsaName(isa);
+    EXPECT_EQ(dst[kCount / 2], 0x11223344u) << spanIsaName(isa);
+    EXPECT_EQ(dst[kCount - 2], 0x11223344u) << spanIsaName(isa);
+  }
+}
+
+TEST_F(SpanKernels, ModulateMatchesScalar) {
+  const auto src = randomPixels(kCount, 1);
+  std::vector<uint32_t> expected(kCount);
+  setSpanIsa(SpanIsa::Scalar);
+  modulateSpan(expected.data(), src.data(), kCount, 0xC0804020);
+
+  for (const SpanIsa isa : supportedIsas()) {
+    setSpanIsa(isa);
+    std::vector<uint32_t> dst(kCount);
+    modulateSpan(dst.data(), src.data(), kCount, 0xC0804020);
+    EXPECT_EQ(dst, expected) << spanIsaName(isa);
+  }
+}
+
+TEST_F(SpanKernels, BlendMatchesScalar) {
+  const auto src = randomPixels(kCount, 2);
+  const auto background = randomPixels(kCount, 3);
+  auto expected = background;
+  setSpanIsa(SpanIsa::Scalar);
+  blendSpan(expected.data(), src.data(), kCount);
+
+  for (const SpanIsa isa : supportedIsas()) {
+    setSpanIsa(isa);
+    auto dst = background;
+    blendSpan(dst.data(), src.data(), kCount);
+    EXPECT_EQ(dst, expected) << spanIsaName(isa);
+  }
+}
+
+TEST_F(SpanKernels, UnsupportedIsaFallsBack) {
+  EXPECT_EQ(setSpanIsa(SpanIsa::Scalar), SpanIsa::Scalar);
+  const SpanIsa best = setSpanIsa(SpanIsa::Avx2);
+  EXPECT_EQ(spanIsa(), best);
+}
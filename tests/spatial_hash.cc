@@ -0,0 +1,262 @@
+#include <gtest/gtest.h>
+
+#include "spatial_hash.h"
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helpers: random boxes and brute-force answers to compare against
+// ---------------------------------------------------------------------------
+static std::vector<Aabb> randomBoxes(size_t count, float world, float size,
+                                     uint32_t seed) {
+  std::mt19937 rng{seed};
+  std::uniform_real_distribution<float> pos{-world, world}, extent{0.5f, size};
+  std::vector<Aabb> boxes(count);
+  for (auto &b : boxes) {
+    const float x = pos(rng), y = pos(rng);
+    b = {x, y, x + extent(rng), y + extent(rng)};
+  }
+  return boxes;
+}
+
+template <typename Shape>
+static std::vector<uint32_t> bruteForce(const std::vector<Aabb> &boxes,
+                                        const Shape &shape) {
+  std::vector<uint32_t> ids;
+  for (uint32_t i = 0; i < boxes.size(); ++i) {
+    if (shape.overlaps(boxes[i])) {
+      ids.push_back(i);
+    }
+  }
+  return ids;
+}
+
+template <typename Shape>
+static std::vector<uint32_t> sortedQuery(const SpatialHash &hash,
+                                         const Shape &shape) {
+  std::vector<uint32_t> ids;
+  hash.query(shape, [&ids](uint32_t id) { ids.push_back(id); });
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+static SpatialHash build(const std::vector<Aabb> &boxes, float cell = 16.0f) {
+  SpatialHash hash{cell, 256};
+  for (uint32_t i = 0; i < boxes.size(); ++i) {
+    hash.update(i, boxes[i]);
+  }
+  return hash;
+}
+
+// ---------------------------------------------------------------------------
+// Queries
+// ---------------------------------------------------------------------------
+TEST(SpatialHash, RejectsBadCellSizeAndBuckets) {
+  EXPECT_THROW(SpatialHash(0.0f), std::invalid_argument);
+  EXPECT_THROW(SpatialHash(-1.0f), std::invalid_argument);
+  EXPECT_THROW(SpatialHash(8.0f, 0), std::invalid_argument);
+  EXPECT_EQ(SpatialHash(8.0f, 100).buckets(), 128u);
+}
+
+TEST(SpatialHash, BoxQueriesMatchBruteForce) {
+  /* Boxes up to three cells wide, in a world small enough for collisions
+   * between cells that share a bucket */
+  const auto boxes = randomBoxes(2000, 300.0f, 40.0f, 1);
+  const SpatialHash hash = build(boxes);
+  EXPECT_EQ(hash.size(), boxes.size());
+
+  for (const Aabb &query : randomBoxes(200, 320.0f, 120.0f, 2)) {
+    ASSERT_EQ(sortedQuery(hash, query), bruteForce(boxes, query));
+  }
+}
+
+TEST(SpatialHash, CircleQueriesMatchBruteForce) {
+  const auto boxes = randomBoxes(2000, 300.0f, 40.0f, 3);
+  const SpatialHash hash = build(boxes);
+
+  std::mt19937 rng{4};
+  std::uniform_real_distribution<float> pos{-320.0f, 320.0f}, r{0.0f, 60.0f};
+  for (int i = 0; i < 200; ++i) {
+    const Circle circle{pos(rng), pos(rng), r(rng)};
+    ASSERT_EQ(sortedQuery(hash, circle), bruteForce(boxes, circle));
+  }
+}
+
+TEST(SpatialHash, ReportsEachObjectOnce) {
+  SpatialHash hash{4.0f};
+  hash.update(7, {0.0f, 0.0f, 30.0f, 30.0f});
+  EXPECT_EQ(hash.stats().entries, 64u);
+
+  std::vector<uint32_t> ids;
+  hash.query(Aabb{-10.0f, -10.0f, 40.0f, 40.0f},
+             [&ids](uint32_t id) { ids.push_back(id); });
+  EXPECT_EQ(ids, std::vector<uint32_t>{7});
+}
+
+TEST(SpatialHash, TouchingEdgesDontOverlap) {
+  SpatialHash hash{8.0f};
+  hash.update(0, {0.0f, 0.0f, 8.0f, 8.0f});
+  EXPECT_TRUE(sortedQuery(hash, Aabb{8.0f, 0.0f, 16.0f, 8.0f}).empty());
+  EXPECT_EQ(sortedQuery(hash, Aabb{7.5f, 0.0f, 16.0f, 8.0f}).size(), 1u);
+}
+
+// ---------------------------------------------------------------------------
+// Updates
+// ---------------------------------------------------------------------------
+TEST(SpatialHash, MovesWithinACellDontRelink) {
+  SpatialHash hash{16.0f};
+  hash.update(0, {1.0f, 1.0f, 3.0f, 3.0f});
+  hash.update(0, {5.0f, 5.0f, 7.0f, 7.0f});
+  EXPECT_EQ(hash.stats().relinks, 0u);
+  EXPECT_EQ(hash.bounds(0).min_x, 5.0f);
+  EXPECT_TRUE(sortedQuery(hash, Aabb{0.0f, 0.0f, 2.0f, 2.0f}).empty());
+
+  hash.update(0, {20.0f, 5.0f, 22.0f, 7.0f});
+  EXPECT_EQ(hash.stats().relinks, 1u);
+  EXPECT_EQ(sortedQuery(hash, Aabb{16.0f, 0.0f, 32.0f, 16.0f}),
+            std::vector<uint32_t>{0});
+  EXPECT_TRUE(sortedQuery(hash, Aabb{0.0f, 0.0f, 16.0f, 16.0f}).empty());
+}
+
+TEST(SpatialHash, MovingObjectsStayConsistent) {
+  auto boxes = randomBoxes(1000, 200.0f, 30.0f, 5);
+  SpatialHash hash = build(boxes);
+
+  std::mt19937 rng{6};
+  std::uniform_real_distribution<float> step{-12.0f, 12.0f};
+  for (int frame = 0; frame < 20; ++frame) {
+    for (uint32_t i = 0; i < boxes.size(); ++i) {
+      const float dx = step(rng), dy = step(rng);
+      boxes[i] = {boxes[i].min_x + dx, boxes[i].min_y + dy,
+                  boxes[i].max_x + dx, boxes[i].max_y + dy};
+      hash.update(i, boxes[i]);
+    }
+  }
+
+  /* Entries are recycled rather than accumulated */
+  size_t expected = 0;
+  for (const Aabb &b : boxes) {
+    const auto cells = [](float lo, float hi) {
+      return static_cast<size_t>(std::floor(hi / 16.0f) -
+                                 std::floor(lo / 16.0f) + 1);
+    };
+    expected += cells(b.min_x, b.max_x) * cells(b.min_y, b.max_y);
+  }
+  EXPECT_EQ(hash.stats().entries, expected);
+
+  for (const Aabb &query : randomBoxes(100, 260.0f, 80.0f, 7)) {
+    ASSERT_EQ(sortedQuery(hash, query), bruteForce(boxes, query));
+  }
+}
+
+TEST(SpatialHash, RemoveAndClear) {
+  SpatialHash hash{8.0f};
+  hash.update(0, {0.0f, 0.0f, 4.0f, 4.0f});
+  hash.update(3, {1.0f, 1.0f, 20.0f, 4.0f});
+  EXPECT_TRUE(hash.contains(3));
+  EXPECT_FALSE(hash.contains(1));
+
+  hash.remove(3);
+  hash.remove(3);
+  EXPECT_FALSE(hash.contains(3));
+  EXPECT_EQ(hash.size(), 1u);
+  EXPECT_EQ(hash.stats().entries, 1u);
+  EXPECT_EQ(sortedQuery(hash, Aabb{0.0f, 0.0f, 30.0f, 30.0f}),
+            std::vector<uint32_t>{0});
+
+  hash.clear();
+  EXPECT_EQ(hash.size(), 0u);
+  EXPECT_TRUE(sortedQuery(hash, Aabb{0.0f, 0.0f, 30.0f, 30.0f}).empty());
+}
+
+TEST(SpatialHash, InvertedBoxesThrowAndLeaveTheHashAlone) {
+  SpatialHash hash{8.0f};
+  hash.update(0, {0.0f, 0.0f, 4.0f, 4.0f});
+
+  /* One cell below, and far below */
+  EXPECT_THROW(hash.update(1, {8.0f, 0.0f, 0.0f, 4.0f}), std::invalid_argument);
+  EXPECT_THROW(hash.update(0, {0.0f, 1e6f, 4.0f, -1e6f}),
+               std::invalid_argument);
+  EXPECT_THROW(hash.update(0, {0.0f, 0.0f, -1e30f, 4.0f}),
+               std::invalid_argument);
+
+  EXPECT_FALSE(hash.contains(1));
+  EXPECT_EQ(hash.size(), 1u);
+  EXPECT_EQ(hash.stats().entries, 1u);
+  EXPECT_EQ(sortedQuery(hash, Aabb{0.0f, 0.0f, 30.0f, 30.0f}),
+            std::vector<uint32_t>{0});
+}
+
+TEST(SpatialHash, NaNCoordinatesMapToACell) {
+  const float nan = std::nanf("");
+  SpatialHash hash{8.0f};
+  hash.update(0, {nan, nan, nan, nan});
+  hash.update(1, {0.0f, 0.0f, 4.0f, 4.0f});
+  EXPECT_EQ(hash.size(), 2u);
+
+  /* Queries with NaN corners are well defined and find nothing */
+  EXPECT_TRUE(sortedQuery(hash, Aabb{nan, nan, nan, nan}).empty());
+  EXPECT_TRUE(sortedQuery(hash, Circle{nan, 0.0f, 4.0f}).empty());
+}
+
+// ---------------------------------------------------------------------------
+// Batches and pairs
+// ---------------------------------------------------------------------------
+TEST(SpatialHash, ParallelBatchMatchesSingleQueries) {
+  const auto boxes = randomBoxes(3000, 300.0f, 40.0f, 8);
+  const SpatialHash hash = build(boxes);
+  const auto queries = randomBoxes(1000, 320.0f, 60.0f, 9);
+  std::vector<Circle> circles;
+  for (const Aabb &q : queries) {
+    circles.push_back({q.min_x, q.min_y, q.max_x - q.min_x});
+  }
+
+  WorkStealingPool pool{4};
+  SpatialQueryResults serial, parallel;
+  hash.query(std::span{queries}, serial);
+  hash.query(std::span{queries}, parallel, &pool);
+  ASSERT_EQ(parallel.size(), queries.size());
+  EXPECT_EQ(parallel.offsets, serial.offsets);
+  EXPECT_EQ(parallel.ids, serial.ids);
+
+  for (size_t i = 0; i < queries.size(); ++i) {
+    std::vector<uint32_t> single;
+    hash.query(queries[i], [&single](uint32_t id) { single.push_back(id); });
+    const auto hits = parallel[i];
+    ASSERT_EQ(std::vector(hits.begin(), hits.end()), single) << i;
+  }
+
+  hash.query(std::span{circles}, parallel, &pool);
+  for (size_t i = 0; i < circles.size(); ++i) {
+    const auto hits = parallel[i];
+    std::vector<uint32_t> sorted(hits.begin(), hits.end());
+    std::sort(sorted.begin(), sorted.end());
+    ASSERT_EQ(sorted, bruteForce(boxes, circles[i])) << i;
+  }
+}
+
+TEST(SpatialHash, PairsMatchBruteForce) {
+  const auto boxes = randomBoxes(1500, 200.0f, 30.0f, 10);
+  const SpatialHash hash = build(boxes);
+
+  std::vector<std::pair<uint32_t, uint32_t>> pairs;
+  hash.pairs(pairs);
+  std::sort(pairs.begin(), pairs.end());
+
+  std::vector<std::pair<uint32_t, uint32_t>> expected;
+  for (uint32_t a = 0; a < boxes.size(); ++a) {
+    for (uint32_t b = a + 1; b < boxes.size(); ++b) {
+      if (boxes[a].overlaps(boxes[b])) {
+        expected.emplace_back(a, b);
+      }
+    }
+  }
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(pairs, expected);
+}
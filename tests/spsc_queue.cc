@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include "spsc_queue.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Single-threaded semantics
+// ---------------------------------------------------------------------------
+TEST(SpscQueue, StartsEmpty) {
+  SpscQueue<int, 4> queue;
+  int value = -1;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_FALSE(queue.tryPop(value));
+  EXPECT_EQ(value, -1);
+}
+
+TEST(SpscQueue, PopsInPushOrder) {
+  SpscQueue<int, 8> queue;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(queue.tryPush(i));
+  }
+  EXPECT_EQ(queue.size(), 5u);
+
+  int value = -1;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueue, RejectsPushWhenFull) {
+  SpscQueue<int, 4> queue;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.tryPush(i));
+  }
+  EXPECT_FALSE(queue.tryPush(99));
+
+  /* Popping one frees exactly one slot */
+  int value = -1;
+  ASSERT_TRUE(queue.tryPop(value));
+  EXPECT_EQ(value, 0);
+  EXPECT_TRUE(queue.tryPush(4));
+  EXPECT_FALSE(queue.tryPush(5));
+}
+
+TEST(SpscQueue, WrapsAroundTheRing) {
+  SpscQueue<int, 4> queue;
+  int value = -1;
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(queue.tryPush(i));
+    ASSERT_TRUE(queue.tryPush(i + 1000));
+    ASSERT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(value, i);
+    ASSERT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(value, i + 1000);
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueue, DrainVisitsEverythingOnce) {
+  SpscQueue<int, 8> queue;
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_TRUE(queue.tryPush(i));
+  }
+
+  std::vector<int> seen;
+  EXPECT_EQ(queue.drain([&seen](const int &v) noexcept { seen.push_back(v); }),
+            6u);
+  EXPECT_EQ(seen, (std::vector<int>{0, 1, 2, 3, 4, 5}));
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.drain([](const int &) noexcept {}), 0u);
+
+  /* The whole ring is free again */
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_TRUE(queue.tryPush(i));
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Concurrent producer and consumer
+// ---------------------------------------------------------------------------
+TEST(SpscQueue, DeliversEverythingInOrderAcrossThreads) {
+  constexpr uint64_t kItems = 500000;
+
+  /* Small enough that both sides keep hitting full and empty */
+  SpscQueue<uint64_t, 64> queue;
+  std::thread producer{[&queue] {
+    for (uint64_t i = 1; i <= kItems;) {
+      if (queue.tryPush(i)) {
+        ++i;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }};
+
+  uint64_t expected = 1;
+  bool ordered = true;
+  while (expected <= kItems) {
+    if (!queue.drain([&](const uint64_t &v) noexcept {
+          ordered = ordered && v == expected;
+          ++expected;
+        })) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  EXPECT_TRUE(ordered);
+  EXPECT_TRUE(queue.empty());
+}
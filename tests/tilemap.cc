@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include "gl_pixels.h"
+#include "texture_atlas.h"
+#include "tilemap.h"
+#include "window.h"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helpers: a headless window drawing a tilemap over a black background,
+// and solid-color images for the atlas
+// ---------------------------------------------------------------------------
+constexpr uint32_t kBlack = 0xFF000000;
+constexpr uint32_t kRed = 0xFF0000FF;
+constexpr uint32_t kGreen = 0xFF00FF00;
+constexpr uint32_t kBlue = 0xFFFF0000;
+
+struct TilemapFixture {
+  std::unique_ptr<TextureAtlas> atlas;
+  std::unique_ptr<Tilemap> map;
+  float camera_x = 0.0f;
+  float camera_y = 0.0f;
+  Window window;
+
+  TilemapFixture(size_t map_width, size_t map_height, size_t w = 32,
+                 size_t h = 16)
+      : window{w,
+               h,
+               "Tilemap",
+               [this, map_width, map_height]() noexcept {
+                 atlas = std::make_unique<TextureAtlas>(64, 64);
+                 map = std::make_unique<Tilemap>(map_width, map_height, 8.0f,
+                                                 8.0f);
+               },
+               [this, w, h]() noexcept {
+                 glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+                 glClear(GL_COLOR_BUFFER_BIT);
+                 map->draw(*atlas, camera_x, camera_y, static_cast<float>(w),
+                           static_cast<float>(h));
+               },
+               [this]() noexcept {
+                 map.reset();
+                 atlas.reset();
+               },
+               WindowOptions{.headless = true}} {}
+
+  /* Region index of a new 4x4 image in one color, as a tile index */
+  uint16_t addSolid(uint32_t color) {
+    const std::vector<uint32_t> pixels(16, color);
+    return static_cast<uint16_t>(
+        atlas->add({.pixels = pixels, .width = 4, .height = 4}) + 1);
+  }
+};
+
+// ---------------------------------------------------------------------------
+// TextureAtlas
+// ---------------------------------------------------------------------------
+TEST(TextureAtlas, RegionsCoverTheirPixels) {
+  TilemapFixture f{4, 4};
+  const std::vector<uint32_t> wide(16 * 8, kRed);
+  const uint32_t a = f.atlas->add({.pixels = wide, .width = 16, .height = 8});
+  const uint32_t b = f.atlas->add({.pixels = wide, .width = 8, .height = 16});
+  EXPECT_EQ(a, 0u);
+  EXPECT_EQ(b, 1u);
+  EXPECT_EQ(f.atlas->regionCount(), 2u);
+
+  const auto &r = f.atlas->region(a);
+  EXPECT_FLOAT_EQ(r.u1 - r.u0, 16.0f / 64.0f);
+  EXPECT_FLOAT_EQ(r.v1 - r.v0, 8.0f / 64.0f);
+  EXPECT_EQ(r.layer, 0u);
+}
+
+TEST(TextureAtlas, RejectsBadImages) {
+  TilemapFixture f{4, 4};
+  const std::vector<uint32_t> pixels(16, kRed);
+  EXPECT_THROW(f.atlas->add({.pixels = pixels, .width = 4, .height = 3}),
+               std::invalid_argument);
+  const std::vector<uint32_t> huge(128 * 4, kRed);
+  EXPECT_THROW(f.atlas->add({.pixels = huge, .width = 128, .height = 4}),
+               std::invalid_argument);
+  EXPECT_EQ(f.atlas->regionCount(), 0u);
+}
+
+TEST(TextureAtlas, FullAtlasThrows) {
+  TilemapFixture f{4, 4};
+  const std::vector<uint32_t> page(64 * 64, kRed);
+  f.atlas->add({.pixels = page, .width = 64, .height = 64});
+  EXPECT_THROW(f.addSolid(kRed), std::runtime_error);
+}
+
+TEST(TextureAtlas, AddAllIsAllOrNothing) {
+  TilemapFixture f{4, 4};
+  const std::vector<uint32_t> half(64 * 32, kRed);
+  const TextureAtlas::Image image{.pixels = half, .width = 64, .height = 32};
+  const std::vector<TextureAtlas::Image> three{image, image, image};
+  EXPECT_THROW(f.atlas->addAll(three), std::runtime_error);
+  EXPECT_EQ(f.atlas->regionCount(), 0u);
+
+  const auto indices = f.atlas->addAll(std::span{three}.first(2));
+  EXPECT_EQ(indices, (std::vector<uint32_t>{0, 1}));
+}
+
+// ---------------------------------------------------------------------------
+// Tile storage
+// ---------------------------------------------------------------------------
+TEST(Tilemap, RejectsEmptyMaps) {
+  TilemapFixture f{4, 4};
+  EXPECT_THROW(Tilemap(0, 4, 8.0f, 8.0f), std::invalid_argument);
+  EXPECT_THROW(Tilemap(4, 4, 0.0f, 8.0f), std::invalid_argument);
+}
+
+TEST(Tilemap, SetAndGetTiles) {
+  TilemapFixture f{70, 40};
+  EXPECT_EQ(f.map->chunksX(), 3u);
+  EXPECT_EQ(f.map->chunksY(), 2u);
+
+  f.map->setTile(0, 0, 1);
+  f.map->setTile(69, 39, 7);
+  f.map->setTile(70, 0, 9);
+  EXPECT_EQ(f.map->tile(0, 0), 1);
+  EXPECT_EQ(f.map->tile(69, 39), 7);
+  EXPECT_EQ(f.map->tile(70, 0), 0);
+  EXPECT_EQ(f.map->tile(1, 0), 0);
+
+  f.map->fill(3);
+  EXPECT_EQ(f.map->tile(69, 39), 3);
+  EXPECT_EQ(f.map->tile(33, 0), 3);
+}
+
+// ---------------------------------------------------------------------------
+// Rendering
+// ---------------------------------------------------------------------------
+TEST(Tilemap, DrawsTilesFromTheAtlas) {
+  TilemapFixture f{8, 4};
+  const uint16_t red = f.addSolid(kRed);
+  const uint16_t green = f.addSolid(kGreen);
+  f.map->setTile(0, 0, red);
+  f.map->setTile(1, 0, green);
+  f.map->setTile(3, 1, red);
+
+  f.window.render();
+  EXPECT_EQ(readPixel(f.window, 1, 1), kRed);
+  EXPECT_EQ(readPixel(f.window, 7, 7), kRed);
+  EXPECT_EQ(readPixel(f.window, 8, 0), kGreen);
+  EXPECT_EQ(readPixel(f.window, 20, 4), kBlack);
+  EXPECT_EQ(readPixel(f.window, 26, 12), kRed);
+  EXPECT_EQ(f.map->stats().draw_calls, 1u);
+}
+
+TEST(Tilemap, CameraScrollsTheMap) {
+  TilemapFixture f{8, 4};
+  f.map->setTile(1, 0, f.addSolid(kGreen));
+  f.map->setTile(4, 1, f.addSolid(kBlue));
+
+  f.camera_x = 8.0f;
+  f.window.render();
+  EXPECT_EQ(readPixel(f.window, 0, 0), kGreen);
+  EXPECT_EQ(readPixel(f.window, 24, 8), kBlue);
+
+  /* Sub-tile offsets move whole pixels */
+  f.camera_x = 12.0f;
+  f.window.render();
+  EXPECT_EQ(readPixel(f.window, 0, 0), kGreen);
+  EXPECT_EQ(readPixel(f.window, 4, 0), kBlack);
+}
+
+TEST(Tilemap, CullsChunksOutsideTheView) {
+  /* 4x4 chunks of 256x256 pixels; the view is 32x16 */
+  TilemapFixture f{128, 128};
+  f.map->fill(f.addSolid(kRed));
+
+  f.window.render();
+  EXPECT_EQ(f.map->stats().chunks_drawn, 1u);
+  EXPECT_EQ(f.map->stats().chunks_culled, 15u);
+  EXPECT_EQ(readPixel(f.window, 31, 15), kRed);
+
+  /* Straddling a chunk corner */
+  f.camera_x = 240.0f;
+  f.camera_y = 250.0f;
+  f.window.render();
+  EXPECT_EQ(f.map->stats().chunks_drawn, 4u);
+  EXPECT_EQ(readPixel(f.window, 0, 0), kRed);
+  EXPECT_EQ(readPixel(f.window, 31, 15), kRed);
+
+  /* Entirely off the map */
+  f.camera_x = -100.0f;
+  f.window.render();
+  EXPECT_EQ(f.map->stats().chunks_drawn, 0u);
+  EXPECT_EQ(readPixel(f.window, 0, 0), kBlack);
+}
+
+TEST(Tilemap, SkipsEmptyChunks) {
+  TilemapFixture f{128, 128, 64, 64};
+  f.map->setTile(0, 0, f.addSolid(kRed));
+  f.camera_x = 260.0f;
+  f.camera_y = 260.0f;
+  f.window.render();
+  EXPECT_EQ(f.map->stats().chunks_drawn, 0u);
+  EXPECT_EQ(f.map->stats().chunks_culled, 16u);
+
+  /* Clearing the only tile empties its chunk again */
+  f.camera_x = f.camera_y = 0.0f;
+  f.window.render();
+  EXPECT_EQ(f.map->stats().chunks_drawn, 1u);
+  f.map->setTile(0, 0, 0);
+  f.window.render();
+  EXPECT_EQ(f.map->stats().chunks_drawn, 0u);
+}
+
+TEST(Tilemap, UploadsOnlyDirtyVisibleChunks) {
+  TilemapFixture f{128, 128};
+  const uint16_t red = f.addSolid(kRed);
+  const uint16_t green = f.addSolid(kGreen);
+  f.map->fill(red);
+
+  f.window.render();
+  EXPECT_EQ(f.map->stats().chunks_uploaded, 1u);
+  f.window.render();
+  EXPECT_EQ(f.map->stats().chunks_uploaded, 0u);
+
+  /* An edit off screen waits until its chunk is in view */
+  f.map->setTile(2, 1, green);
+  f.map->setTile(100, 100, green);
+  f.window.render();
+  EXPECT_EQ(f.map->stats().chunks_uploaded, 1u);
+  EXPECT_EQ(readPixel(f.window, 20, 10), kGreen);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include "triple_buffer.h"
+
+#include <array>
+#include <cstdint>
+#include <thread>
+
+// ---------------------------------------------------------------------------
+// Single-threaded semantics
+// ---------------------------------------------------------------------------
+TEST(TripleBuffer, StartsValueInitialized) {
+  TripleBuffer<int> buffer;
+  EXPECT_FALSE(buffer.update());
+  EXPECT_EQ(buffer.front(), 0);
+}
+
+TEST(TripleBuffer, UpdateSeesPublishedValue) {
+  TripleBuffer<int> buffer;
+  buffer.publish(5);
+  EXPECT_EQ(buffer.front(), 0);
+  EXPECT_TRUE(buffer.update());
+  EXPECT_EQ(buffer.front(), 5);
+  EXPECT_FALSE(buffer.update());
+  EXPECT_EQ(buffer.front(), 5);
+}
+
+TEST(TripleBuffer, ConsumerGetsLatestOfSeveral) {
+  TripleBuffer<int> buffer;
+  buffer.publish(1);
+  buffer.publish(2);
+  buffer.publish(3);
+  EXPECT_TRUE(buffer.update());
+  EXPECT_EQ(buffer.front(), 3);
+  EXPECT_FALSE(buffer.update());
+}
+
+TEST(TripleBuffer, BackNeverAliasesFront) {
+  TripleBuffer<int> buffer;
+  for (int i = 1; i <= 10; ++i) {
+    buffer.back() = i;
+    buffer.publish();
+    ASSERT_TRUE(buffer.update());
+    EXPECT_NE(&buffer.back(), &buffer.front());
+    EXPECT_EQ(buffer.front(), i);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Concurrent producer and consumer
+// ---------------------------------------------------------------------------
+TEST(TripleBuffer, SnapshotsAreNeverTornOrStale) {
+  /* Every element of a snapshot carries the same sequence number */
+  using Snapshot = std::array<uint64_t, 64>;
+  constexpr uint64_t kPublishes = 200000;
+
+  TripleBuffer<Snapshot> buffer;
+  std::thread producer{[&buffer] {
+    for (uint64_t seq = 1; seq <= kPublishes; ++seq) {
+      buffer.back().fill(seq);
+      buffer.publish();
+    }
+  }};
+
+  uint64_t last = 0;
+  bool torn = false;
+  bool backwards = false;
+  while (last < kPublishes) {
+    if (!buffer.update()) {
+      continue;
+    }
+    const Snapshot &s = buffer.front();
+    for (uint64_t v : s) {
+      torn |= v != s[0];
+    }
+    backwards |= s[0] <= last;
+    last = s[0];
+  }
+  producer.join();
+
+  EXPECT_FALSE(torn);
+  EXPECT_FALSE(backwards);
+}
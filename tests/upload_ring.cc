@@ -0,0 +1,291 @@
+#include <gtest/gtest.h>
+
+#include "gl_extensions.h"
+#include "gl_pixels.h"
+#include "upload_ring.h"
+#include "window.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helpers: a headless window whose frames run a callback, and the modes the
+// driver supports
+// ---------------------------------------------------------------------------
+struct RingFixture {
+  std::function<void()> frame;
+  Window window{16,
+                16,
+                "UploadRing",
+                []() noexcept {},
+                [this]() noexcept {
+                  if (frame) {
+                    frame();
+                  }
+                },
+                []() noexcept {},
+                WindowOptions{.headless = true}};
+};
+
+/* Needs a current context for the extension flags */
+static std::vector<UploadRing::Mode> supportedModes() {
+  std::vector<UploadRing::Mode> modes{UploadRing::Mode::Unsynchronized};
+  if (gl_extensions.buffer_storage) {
+    modes.push_back(UploadRing::Mode::Persistent);
+  }
+  return modes;
+}
+
+static std::vector<uint8_t> readBuffer(GLuint buffer, GLintptr offset,
+                                       size_t size) {
+  std::vector<uint8_t> bytes(size);
+  glFinish();
+  glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+  glGetBufferSubData(GL_COPY_READ_BUFFER, offset,
+                     static_cast<GLsizeiptr>(size), bytes.data());
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  return bytes;
+}
+
+// ---------------------------------------------------------------------------
+// Construction and allocation
+// ---------------------------------------------------------------------------
+TEST(UploadRing, RejectsBadSizesAndModes) {
+  RingFixture f;
+  EXPECT_THROW(UploadRing(0), std::invalid_argument);
+  EXPECT_THROW(UploadRing(1024, 0), std::invalid_argument);
+  if (!gl_extensions.buffer_storage) {
+    EXPECT_THROW(UploadRing(1024, 3, UploadRing::Mode::Persistent),
+                 std::runtime_error);
+  }
+
+  const UploadRing ring{1024};
+  EXPECT_NE(ring.mode(), UploadRing::Mode::Auto);
+  EXPECT_EQ(ring.mode(), gl_extensions.buffer_storage
+                             ? UploadRing::Mode::Persistent
+                             : UploadRing::Mode::Unsynchronized);
+  EXPECT_EQ(ring.regions(), 3u);
+  EXPECT_NE(ring.buffer(), 0u);
+}
+
+TEST(UploadRing, AllocationsAreAlignedAndDisjoint) {
+  RingFixture f;
+  GLint uniform_alignment = 0;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+
+  for (const auto mode : supportedModes()) {
+    UploadRing ring{4096, 3, mode};
+    const auto vertices = ring.allocate(UploadKind::Vertex, 10);
+    const auto indices = ring.allocate(UploadKind::Index, 6);
+    const auto uniforms = ring.allocate(UploadKind::Uniform, 64);
+    const auto more = ring.allocate(UploadKind::Vertex, 4);
+    ASSERT_TRUE(vertices && indices && uniforms && more);
+
+    EXPECT_EQ(vertices.offset % 16, 0);
+    EXPECT_EQ(indices.offset % 4, 0);
+    EXPECT_EQ(uniforms.offset % uniform_alignment, 0);
+    EXPECT_EQ(more.offset % 16, 0);
+    EXPECT_GE(indices.offset, vertices.offset + vertices.size);
+    EXPECT_GE(uniforms.offset, indices.offset + indices.size);
+    EXPECT_GE(more.offset, uniforms.offset + uniforms.size);
+    EXPECT_EQ(ring.stats().allocations, 4u);
+    EXPECT_EQ(ring.stats().bytes_streamed, 84u);
+    ring.endFrame();
+  }
+}
+
+TEST(UploadRing, OddRegionSizesKeepBufferOffsetsAligned) {
+  RingFixture f;
+  GLint uniform_alignment = 0;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+
+  for (const auto mode : supportedModes()) {
+    /* Regions start at 1000 and 2000, neither aligned for uniforms */
+    UploadRing ring{1000, 3, mode};
+    for (size_t frame = 0; frame < 3; ++frame) {
+      const auto indices = ring.allocate(UploadKind::Index, 6);
+      const auto uniforms = ring.allocate(UploadKind::Uniform, 64);
+      const auto vertices = ring.allocate(UploadKind::Vertex, 12);
+      ASSERT_TRUE(indices && uniforms && vertices) << frame;
+
+      EXPECT_EQ(indices.offset % 4, 0);
+      EXPECT_EQ(uniforms.offset % uniform_alignment, 0) << frame;
+      EXPECT_EQ(vertices.offset % 16, 0) << frame;
+      EXPECT_GE(static_cast<size_t>(indices.offset), frame * 1000);
+      EXPECT_LE(static_cast<size_t>(vertices.offset + vertices.size),
+                (frame + 1) * 1000);
+
+      /* glBindBufferRange rejects misaligned uniform offsets */
+      glBindBufferRange(GL_UNIFORM_BUFFER, 0, ring.buffer(), uniforms.offset,
+                        uniforms.size);
+      EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR)) << frame;
+      glBindBufferBase(GL_UNIFORM_BUFFER, 0, 0);
+      ring.endFrame();
+    }
+  }
+}
+
+TEST(UploadRing, WritesReachTheBuffer) {
+  RingFixture f;
+  for (const auto mode : supportedModes()) {
+    UploadRing ring{4096, 3, mode};
+    std::vector<uint8_t> expected(300);
+    for (size_t i = 0; i < expected.size(); ++i) {
+      expected[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    /* Written across two flushes, which remaps an unsynchronized ring */
+    const auto first = ring.allocate(UploadKind::Vertex, 100);
+    ASSERT_TRUE(first);
+    std::memcpy(first.data, expected.data(), 100);
+    ring.flush();
+    const auto second = ring.allocate(UploadKind::Vertex, 200);
+    ASSERT_TRUE(second);
+    std::memcpy(second.data, expected.data() + 100, 200);
+    ring.endFrame();
+
+    const auto a = readBuffer(ring.buffer(), first.offset, 100);
+    const auto b = readBuffer(ring.buffer(), second.offset, 200);
+    EXPECT_TRUE(std::equal(a.begin(), a.end(), expected.begin()));
+    EXPECT_TRUE(std::equal(b.begin(), b.end(), expected.begin() + 100));
+    if (mode == UploadRing::Mode::Persistent) {
+      EXPECT_EQ(ring.stats().maps, 1u);
+    } else {
+      EXPECT_EQ(ring.stats().maps, 2u);
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Frames and regions
+// ---------------------------------------------------------------------------
+TEST(UploadRing, FramesRotateThroughRegions) {
+  RingFixture f;
+  for (const auto mode : supportedModes()) {
+    UploadRing ring{1024, 3, mode};
+    for (size_t frame = 0; frame < 7; ++frame) {
+      const auto a = ring.allocate(UploadKind::Index, 8);
+      ASSERT_TRUE(a);
+      EXPECT_EQ(static_cast<size_t>(a.offset), (frame % 3) * 1024);
+      ring.endFrame();
+      glFinish();
+    }
+
+    /* Frames that allocate nothing don't use up a region */
+    ring.endFrame();
+    ring.endFrame();
+    EXPECT_EQ(ring.allocate(UploadKind::Index, 8).offset, 1024);
+    ring.endFrame();
+
+    /* Every fence had signalled by the time its region came round again */
+    EXPECT_EQ(ring.stats().stalls, 0u);
+    EXPECT_EQ(ring.stats().stall_ns, 0u);
+  }
+}
+
+TEST(UploadRing, FrameOverflowFailsWithoutLosingTheRegion) {
+  RingFixture f;
+  for (const auto mode : supportedModes()) {
+    UploadRing ring{256, 3, mode};
+    EXPECT_FALSE(ring.allocate(UploadKind::Vertex, 0));
+    EXPECT_FALSE(ring.allocate(UploadKind::Vertex, 257));
+    ASSERT_TRUE(ring.allocate(UploadKind::Vertex, 200));
+    EXPECT_FALSE(ring.allocate(UploadKind::Vertex, 64));
+    EXPECT_EQ(ring.stats().failures, 2u);
+
+    /* What is left still serves smaller allocations */
+    const auto rest = ring.allocate(UploadKind::Index, 48);
+    ASSERT_TRUE(rest);
+    EXPECT_EQ(rest.offset, 200);
+    EXPECT_EQ(ring.stats().bytes_streamed, 248u);
+    ring.endFrame();
+    EXPECT_EQ(ring.allocate(UploadKind::Vertex, 256).offset, 256);
+    ring.endFrame();
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Drawing from the ring
+// ---------------------------------------------------------------------------
+constexpr const char *kRingVertex = R"(#version 330 core
+layout (location = 0) in vec2 aPos;
+void main() { gl_Position = vec4(aPos, 0.0, 1.0); }
+)";
+
+constexpr const char *kRingFragment = R"(#version 330 core
+layout (std140) uniform Tint { vec4 color; };
+out vec4 FragColor;
+void main() { FragColor = color; }
+)";
+
+TEST(UploadRing, DrawsVerticesIndicesAndUniformsFromTheRing) {
+  RingFixture f;
+  for (const auto mode : supportedModes()) {
+    UploadRing ring{4096, 3, mode};
+
+    const GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &kRingVertex, nullptr);
+    glCompileShader(vertex);
+    const GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment, 1, &kRingFragment, nullptr);
+    glCompileShader(fragment);
+    const GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    glUniformBlockBinding(program, glGetUniformBlockIndex(program, "Tint"), 0);
+
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+
+    /* A quad over the left half, red on even frames and green on odd */
+    for (int frame = 0; frame < 4; ++frame) {
+      f.frame = [&]() noexcept {
+        const float quad[] = {-1.0f, -1.0f, 0.0f, -1.0f,
+                              0.0f,  1.0f,  -1.0f, 1.0f};
+        const uint32_t tris[] = {0, 1, 2, 0, 2, 3};
+        const float color[] = {frame % 2 ? 0.0f : 1.0f,
+                               frame % 2 ? 1.0f : 0.0f, 0.0f, 1.0f};
+        const auto v = ring.allocate(UploadKind::Vertex, sizeof(quad));
+        const auto i = ring.allocate(UploadKind::Index, sizeof(tris));
+        const auto u = ring.allocate(UploadKind::Uniform, sizeof(color));
+        std::memcpy(v.data, quad, sizeof(quad));
+        std::memcpy(i.data, tris, sizeof(tris));
+        std::memcpy(u.data, color, sizeof(color));
+        ring.flush();
+
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glUseProgram(program);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, ring.buffer());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ring.buffer());
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0,
+                              reinterpret_cast<void *>(v.offset));
+        glEnableVertexAttribArray(0);
+        glBindBufferRange(GL_UNIFORM_BUFFER, 0, ring.buffer(), u.offset,
+                          u.size);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT,
+                       reinterpret_cast<void *>(i.offset));
+        glBindVertexArray(0);
+        ring.endFrame();
+      };
+      f.window.render();
+
+      const uint32_t drawn = frame % 2 ? 0xFF00FF00 : 0xFF0000FF;
+      EXPECT_EQ(readPixel(f.window, 4, 8), drawn) << frame;
+      EXPECT_EQ(readPixel(f.window, 12, 8), 0xFF000000) << frame;
+    }
+    f.frame = nullptr;
+
+    EXPECT_EQ(ring.stats().allocations, 12u);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteProgram(program);
+  }
+}
@@ -2,7 +2,10 @@
 
 #include "window.h"
 
+#include <cstdint>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 // ---------------------------------------------------------------------------
 // Helper: create a window with no-op callbacks
@@ -239,3 +242,242 @@ TEST(WindowMultiple, EachWindowHasIndependentDimensions) {
   EXPECT_EQ(w2.width(), 800u);
   EXPECT_EQ(w2.height(), 600u);
 }
+
+// ---------------------------------------------------------------------------
+// On-demand rendering. Idle updates post an empty event first so a real
+// GLFW wait returns instead of blocking the test
+// ---------------------------------------------------------------------------
+struct OnDemandScene {
+  int frames = 0;
+  float red = 0.0f;
+};
+
+static Window makeOnDemand(OnDemandScene &scene, bool headless = true) {
+  return Window{32,
+                16,
+                "OnDemand",
+                []() noexcept {},
+                [&scene]() noexcept {
+                  ++scene.frames;
+                  glClearColor(scene.red, 0.0f, 1.0f, 1.0f);
+                  glClear(GL_COLOR_BUFFER_BIT);
+                },
+                []() noexcept {},
+                WindowOptions{.headless = headless, .on_demand = true}};
+}
+
+static bool idleUpdate(Window &w) {
+  glfwPostEmptyEvent();
+  return w.update();
+}
+
+TEST(WindowOnDemand, ContinuousWindowAlwaysRenders) {
+  int frames = 0;
+  Window w{32,
+           16,
+           "Continuous",
+           []() noexcept {},
+           [&frames]() noexcept { ++frames; },
+           []() noexcept {},
+           WindowOptions{.headless = true}};
+
+  EXPECT_TRUE(w.needsRender());
+  EXPECT_TRUE(w.update());
+  EXPECT_TRUE(w.update());
+  EXPECT_EQ(frames, 2);
+}
+
+TEST(WindowOnDemand, IdleWindowSkipsFrames) {
+  OnDemandScene scene;
+  auto w = makeOnDemand(scene);
+
+  /* The first frame always draws */
+  EXPECT_TRUE(w.needsRender());
+  EXPECT_TRUE(w.update());
+  EXPECT_FALSE(w.needsRender());
+  EXPECT_FALSE(idleUpdate(w));
+  EXPECT_FALSE(idleUpdate(w));
+  EXPECT_EQ(scene.frames, 1);
+}
+
+TEST(WindowOnDemand, InvalidateRendersOnce) {
+  OnDemandScene scene;
+  auto w = makeOnDemand(scene);
+  w.update();
+
+  w.invalidate();
+  EXPECT_TRUE(w.needsRender());
+  EXPECT_TRUE(w.update());
+  EXPECT_FALSE(idleUpdate(w));
+  EXPECT_EQ(scene.frames, 2);
+  EXPECT_EQ(w.damage(), (Window::Rect{0, 0, 32, 16}));
+}
+
+TEST(WindowOnDemand, AnimatingRendersEveryUpdate) {
+  OnDemandScene scene;
+  auto w = makeOnDemand(scene);
+  w.update();
+
+  w.setAnimating(true);
+  EXPECT_TRUE(w.update());
+  EXPECT_TRUE(w.update());
+  w.setAnimating(false);
+  EXPECT_FALSE(idleUpdate(w));
+  EXPECT_EQ(scene.frames, 3);
+}
+
+TEST(WindowOnDemand, TimerFiresOnce) {
+  OnDemandScene scene;
+  auto w = makeOnDemand(scene);
+  w.update();
+
+  w.invalidateAfter(60.0);
+  EXPECT_FALSE(w.needsRender());
+
+  /* The earliest timer wins, and update() waits for it */
+  w.invalidateAfter(0.01);
+  EXPECT_TRUE(w.update());
+  EXPECT_FALSE(idleUpdate(w));
+  EXPECT_EQ(scene.frames, 2);
+}
+
+TEST(WindowOnDemand, InvalidateFromAnotherThread) {
+  OnDemandScene scene;
+  auto w = makeOnDemand(scene);
+  w.update();
+
+  std::thread{[&w]() { w.invalidate(); }}.join();
+  EXPECT_TRUE(w.update());
+  EXPECT_EQ(scene.frames, 2);
+}
+
+TEST(WindowOnDemand, PartialDamageIsScissored) {
+  OnDemandScene scene;
+  auto w = makeOnDemand(scene);
+  w.update();
+
+  /* Damage accumulates as a bounding box */
+  scene.red = 1.0f;
+  w.invalidate(Window::Rect{4, 2, 4, 3});
+  w.invalidate(Window::Rect{10, 6, 2, 2});
+  EXPECT_TRUE(w.update());
+  EXPECT_EQ(w.damage(), (Window::Rect{4, 2, 8, 6}));
+
+  std::vector<uint32_t> pixels(32 * 16);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, w.framebuffer());
+  glReadPixels(0, 0, 32, 16, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+  /* Rows come back bottom-up; the damage is measured from the top */
+  int redrawn = 0;
+  for (int y = 0; y < 16; ++y) {
+    for (int x = 0; x < 32; ++x) {
+      const uint32_t pixel = pixels[static_cast<size_t>((15 - y) * 32 + x)];
+      const bool inside = x >= 4 && x < 12 && y >= 2 && y < 8;
+      EXPECT_EQ(pixel & 0xFF, inside ? 0xFFu : 0u) << x << "," << y;
+      redrawn += inside;
+    }
+  }
+  EXPECT_EQ(redrawn, 48);
+
+  /* Scissoring ends with the frame */
+  EXPECT_FALSE(glIsEnabled(GL_SCISSOR_TEST));
+}
+
+TEST(WindowOnDemand, DamageIsClippedToFrame) {
+  OnDemandScene scene;
+  auto w = makeOnDemand(scene);
+  w.update();
+
+  w.invalidate(Window::Rect{28, -4, 10, 8});
+  w.update();
+  EXPECT_EQ(w.damage(), (Window::Rect{28, 0, 4, 4}));
+}
+
+TEST(WindowOnDemand, DefaultFramebufferRedrawsEverything) {
+  OnDemandScene scene;
+  auto w = makeOnDemand(scene, false);
+  w.update();
+
+  w.invalidate(Window::Rect{1, 1, 2, 2});
+  EXPECT_TRUE(w.update());
+  EXPECT_NE(w.damage(), (Window::Rect{1, 1, 2, 2}));
+  EXPECT_EQ(w.damage().x, 0);
+  EXPECT_EQ(w.damage().y, 0);
+}
+
+TEST(WindowOnDemand, StateMovesWithWindow) {
+  OnDemandScene scene;
+  auto w1 = makeOnDemand(scene);
+  w1.update();
+  Window w2{std::move(w1)};
+
+  EXPECT_FALSE(idleUpdate(w2));
+  w2.invalidate();
+  EXPECT_TRUE(w2.update());
+  EXPECT_EQ(scene.frames, 2);
+}
+
+// ---------------------------------------------------------------------------
+// Input events
+// ---------------------------------------------------------------------------
+static Window makeInputWindow(bool on_demand = false) {
+  return Window{32,
+                16,
+                "Input",
+                []() noexcept {},
+                []() noexcept {},
+                []() noexcept {},
+                WindowOptions{.headless = true,
+                              .on_demand = on_demand,
+                              .input_events = true}};
+}
+
+TEST(WindowInput, QueueIsOptIn) {
+  auto plain = makeWindow(32, 16);
+  EXPECT_EQ(plain.input(), nullptr);
+
+  auto w = makeInputWindow();
+  ASSERT_NE(w.input(), nullptr);
+  EXPECT_TRUE(w.update());
+  EXPECT_EQ(w.input()->dropped(), 0u);
+}
+
+TEST(WindowInput, SwapMeasuresConsumedEvents) {
+  auto w = makeInputWindow();
+  InputQueue &input = *w.input();
+
+  /* Pending but unconsumed input isn't on screen yet */
+  input.push({.type = InputEvent::Type::Key,
+              .action = GLFW_PRESS,
+              .code = GLFW_KEY_A,
+              .time = InputQueue::now()});
+  w.render();
+  EXPECT_EQ(input.latency().samples, 0u);
+
+  EXPECT_EQ(input.drain([](const InputEvent &) noexcept {}), 1u);
+  w.render();
+  const InputLatency latency = input.latency();
+  EXPECT_EQ(latency.samples, 1u);
+  EXPECT_GT(latency.last_ms, 0.0);
+  EXPECT_EQ(latency.max_ms, latency.last_ms);
+
+  w.render();
+  EXPECT_EQ(input.latency().samples, 1u);
+}
+
+TEST(WindowInput, QueueMovesWithWindow) {
+  auto w1 = makeInputWindow();
+  InputQueue *input = w1.input();
+  Window w2{std::move(w1)};
+  EXPECT_EQ(w1.input(), nullptr);
+  EXPECT_EQ(w2.input(), input);
+}
+
+TEST(WindowInput, WorksAlongsideOnDemand) {
+  auto w = makeInputWindow(true);
+  ASSERT_NE(w.input(), nullptr);
+  EXPECT_TRUE(w.update());
+  EXPECT_FALSE(idleUpdate(w));
+  w.invalidate();
+  EXPECT_TRUE(w.update());
+}
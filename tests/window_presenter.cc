@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "window_presenter.h"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Helper: headless window that counts its frames and records which thread
+// rendered them
+// ---------------------------------------------------------------------------
+struct FrameLog {
+  std::atomic<int> frames{0};
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+};
+
+static Window makeWindow(FrameLog &log) {
+  return Window{16,
+                16,
+                "Presenter",
+                []() noexcept {},
+                [&log]() noexcept {
+                  ++log.frames;
+                  std::lock_guard lock{log.mutex};
+                  log.threads.insert(std::this_thread::get_id());
+                },
+                []() noexcept {},
+                WindowOptions{.headless = true}};
+}
+
+// ---------------------------------------------------------------------------
+// Single thread
+// ---------------------------------------------------------------------------
+TEST(WindowPresenter, PresentRendersEveryWindowOnce) {
+  FrameLog logs[3];
+  WindowPresenter presenter;
+  for (auto &log : logs) {
+    presenter.add(makeWindow(log));
+  }
+  EXPECT_EQ(presenter.size(), 3u);
+
+  presenter.present();
+  presenter.present();
+  EXPECT_EQ(presenter.frames(), 2u);
+  for (auto &log : logs) {
+    EXPECT_EQ(log.frames.load(), 2);
+    EXPECT_EQ(log.threads, std::set{std::this_thread::get_id()});
+  }
+}
+
+TEST(WindowPresenter, EmptyPresenterPresents) {
+  WindowPresenter presenter;
+  EXPECT_NO_THROW(presenter.present());
+  EXPECT_FALSE(presenter.shouldClose());
+}
+
+TEST(WindowPresenter, WindowsStayAccessible) {
+  FrameLog log;
+  WindowPresenter presenter;
+  const size_t index = presenter.add(makeWindow(log));
+  EXPECT_EQ(presenter.window(index).width(), 16u);
+  EXPECT_TRUE(presenter.window(index).headless());
+}
+
+// ---------------------------------------------------------------------------
+// Thread per window
+// ---------------------------------------------------------------------------
+TEST(WindowPresenterThreaded, EachWindowRendersOnItsOwnThread) {
+  FrameLog logs[4];
+  WindowPresenter presenter{WindowPresenter::Threading::PerWindow};
+  for (auto &log : logs) {
+    presenter.add(makeWindow(log));
+  }
+
+  for (int i = 0; i < 5; ++i) {
+    presenter.present();
+  }
+
+  std::set<std::thread::id> all;
+  for (auto &log : logs) {
+    /* present() only returns once every window has rendered */
+    EXPECT_EQ(log.frames.load(), 5);
+    ASSERT_EQ(log.threads.size(), 1u);
+    all.insert(*log.threads.begin());
+  }
+  EXPECT_EQ(all.size(), 4u);
+  EXPECT_EQ(all.count(std::this_thread::get_id()), 0u);
+}
+
+TEST(WindowPresenterThreaded, WindowAddedLaterJoinsNextFrame) {
+  FrameLog first, second;
+  WindowPresenter presenter{WindowPresenter::Threading::PerWindow};
+  presenter.add(makeWindow(first));
+  presenter.present();
+  presenter.add(makeWindow(second));
+  presenter.present();
+  EXPECT_EQ(first.frames.load(), 2);
+  EXPECT_EQ(second.frames.load(), 1);
+}
+
+TEST(WindowPresenterThreaded, DestructionCleansUpWindows) {
+  int cleaned = 0;
+  {
+    WindowPresenter presenter{WindowPresenter::Threading::PerWindow};
+    for (int i = 0; i < 2; ++i) {
+      presenter.add(Window{16,
+                           16,
+                           "Presenter",
+                           []() noexcept {},
+                           []() noexcept {},
+                           [&cleaned]() noexcept { ++cleaned; },
+                           WindowOptions{.headless = true}});
+    }
+    presenter.present();
+  }
+  EXPECT_EQ(cleaned, 2);
+}
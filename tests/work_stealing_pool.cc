@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include "work_stealing_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// parallelFor
+// ---------------------------------------------------------------------------
+TEST(WorkStealingPool, EveryIndexRunsOnce) {
+  WorkStealingPool pool{4};
+  EXPECT_EQ(pool.size(), 4u);
+  std::vector<std::atomic<int>> hits(10007);
+  pool.parallelFor(hits.size(), [&hits](size_t i) noexcept { ++hits[i]; });
+  for (const auto &h : hits) {
+    ASSERT_EQ(h.load(), 1);
+  }
+}
+
+TEST(WorkStealingPool, ReusableAcrossRuns) {
+  WorkStealingPool pool{3};
+  std::atomic<size_t> total{0};
+  for (int run = 0; run < 200; ++run) {
+    pool.parallelFor(17, [&total](size_t i) noexcept { total += i; });
+  }
+  EXPECT_EQ(total.load(), 200u * (16 * 17 / 2));
+}
+
+TEST(WorkStealingPool, ZeroCountReturnsImmediately) {
+  WorkStealingPool pool{2};
+  bool called = false;
+  pool.parallelFor(0, [&called](size_t) noexcept { called = true; });
+  EXPECT_FALSE(called);
+}
+
+TEST(WorkStealingPool, SingleThreadRunsInline) {
+  WorkStealingPool pool{1};
+  const auto caller = std::this_thread::get_id();
+  bool inline_only = true;
+  pool.parallelFor(100, [&](size_t) noexcept {
+    inline_only = inline_only && std::this_thread::get_id() == caller;
+  });
+  EXPECT_TRUE(inline_only);
+}
+
+TEST(WorkStealingPool, IdleThreadsStealUnevenWork) {
+  WorkStealingPool pool{4};
+  /* The caller's block is slow, everyone else's is instant */
+  pool.parallelFor(64, [](size_t i) noexcept {
+    if (i < 16) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  });
+  EXPECT_GT(pool.steals(), 0u);
+}
@@ -0,0 +1,49 @@
+#include "asset_archive.h"
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/* Packs every regular file under a directory into an AssetArchive. Entry
+ * names are paths relative to that directory, with '/' separators:
+ *
+ *   pack_assets <output.pak> <asset directory>
+ */
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    std::cerr << "usage: " << argv[0] << " <output.pak> <asset directory>\n";
+    return 2;
+  }
+
+  const std::filesystem::path output = argv[1];
+  const std::filesystem::path root = argv[2];
+
+  try {
+    /* Sorted so the same tree always packs into the same archive */
+    std::vector<std::filesystem::path> files;
+    for (const auto &entry :
+         std::filesystem::recursive_directory_iterator{root}) {
+      if (entry.is_regular_file()) {
+        files.push_back(entry.path());
+      }
+    }
+    std::sort(files.begin(), files.end());
+
+    AssetArchiveBuilder builder;
+    for (const auto &file : files) {
+      builder.addFile(file.lexically_relative(root).generic_string(), file);
+    }
+    builder.write(output);
+
+    std::cout << "Packed " << builder.size() << " files into "
+              << output.string() << '\n';
+  } catch (const std::exception &e) {
+    std::cerr << "pack_assets: " << e.what() << '\n';
+    return 1;
+  }
+
+  return 0;
+}
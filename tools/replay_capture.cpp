@@ -0,0 +1,69 @@
+#include "gl_capture.h"
+#include "window.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/* Replays a GLCapture stream in a hidden window and reports how long each
+ * frame takes, waiting for the GPU after every frame:
+ *
+ *   replay_capture <capture.lrgc> [passes]
+ */
+int main(int argc, char **argv) {
+  if (argc != 2 && argc != 3) {
+    std::cerr << "usage: " << argv[0] << " <capture.lrgc> [passes]\n";
+    return 2;
+  }
+
+  const int passes = argc == 3 ? std::atoi(argv[2]) : 100;
+  if (passes <= 0) {
+    std::cerr << "replay_capture: passes must be positive\n";
+    return 2;
+  }
+
+  try {
+    Window window{1, 1, "replay_capture", {}, {}, {},
+                  WindowOptions{.headless = true}};
+    GLReplay replay{std::filesystem::path{argv[1]}};
+    if (replay.frameCount() == 0) {
+      std::cerr << "replay_capture: " << argv[1] << " has no frames\n";
+      return 1;
+    }
+
+    replay.setup();
+    glFinish();
+
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> times;
+    times.reserve(replay.frameCount() * static_cast<size_t>(passes));
+    for (int pass = 0; pass < passes; ++pass) {
+      for (size_t frame = 0; frame < replay.frameCount(); ++frame) {
+        const auto start = Clock::now();
+        replay.replayFrame(frame);
+        glFinish();
+        times.push_back(
+            std::chrono::duration<double, std::milli>(Clock::now() - start)
+                .count());
+      }
+    }
+
+    std::sort(times.begin(), times.end());
+    std::cout << replay.frameCount() << " frames x " << passes << " passes, "
+              << replay.stats().calls << " calls replayed, "
+              << replay.stats().unresolved << " unresolved\n"
+              << "frame ms: min " << times.front() << "  median "
+              << times[times.size() / 2] << "  p99 "
+              << times[times.size() * 99 / 100] << "  max " << times.back()
+              << '\n';
+  } catch (const std::exception &e) {
+    std::cerr << "replay_capture: " << e.what() << '\n';
+    return 1;
+  }
+
+  return 0;
+}